@@ -0,0 +1,102 @@
+/*
+ * Checksum and delimiter scanning microbenchmark
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Reports sentences per second for each NMEA scanning kernel available on
+ * this CPU: checksum validation, field scanning and newline search over a
+ * synthetic capture.
+ *
+ * Usage: bench_checksum [megabytes] [passes]
+ */
+
+#include "bench_common.h"
+#include "nmea_scan.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    size_t passes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+
+    std::string capture = make_capture(megabytes * 1024 * 1024);
+
+    // Pre-split so the checksum and field timings exclude framing
+    std::vector<std::string_view> sentences;
+    size_t start = 0;
+    for (size_t i = 0; i < capture.size(); i++) {
+        if (capture[i] == '\n') {
+            sentences.emplace_back(capture.data() + start, i - 1 - start);
+            start = i + 1;
+        }
+    }
+    std::printf("%zu sentences, %zu bytes, %zu passes, active kernel: %s\n",
+                sentences.size(), capture.size(), passes, nmea_kernel().name);
+
+    size_t expected_valid = 0;
+    for (auto s : sentences) {
+        expected_valid += nmea_checksum_valid(s, *nmea_available_kernels().front());
+    }
+
+    for (const NmeaKernel* kernel : nmea_available_kernels()) {
+        char label[64];
+
+        BenchTimer checksum_timer;
+        size_t valid = 0;
+        for (size_t pass = 0; pass < passes; pass++) {
+            for (auto s : sentences) {
+                valid += nmea_checksum_valid(s, *kernel);
+            }
+        }
+        std::snprintf(label, sizeof(label), "%s checksum", kernel->name);
+        report(label, sentences.size() * passes, capture.size() * passes, checksum_timer.seconds());
+        if (valid != expected_valid * passes) {
+            std::fprintf(stderr, "%s: checksum mismatch\n", kernel->name);
+            return 1;
+        }
+
+        BenchTimer fields_timer;
+        size_t fields_seen = 0;
+        NmeaFields fields;
+        for (size_t pass = 0; pass < passes; pass++) {
+            for (auto s : sentences) {
+                nmea_scan_fields(s, fields, *kernel);
+                fields_seen += fields.count;
+            }
+        }
+        std::snprintf(label, sizeof(label), "%s scan_fields", kernel->name);
+        report(label, sentences.size() * passes, capture.size() * passes, fields_timer.seconds());
+        do_not_optimize(fields_seen);
+
+        BenchTimer newline_timer;
+        size_t lines = 0;
+        for (size_t pass = 0; pass < passes; pass++) {
+            const char* p = capture.data();
+            const char* end = p + capture.size();
+            while ((p = kernel->find_byte(p, end, '\n')) != end) {
+                lines++;
+                p++;
+            }
+        }
+        std::snprintf(label, sizeof(label), "%s find newline", kernel->name);
+        report(label, lines, capture.size() * passes, newline_timer.seconds());
+    }
+
+    // Reference point: glibc's own vectorized memchr
+    BenchTimer memchr_timer;
+    size_t lines = 0;
+    for (size_t pass = 0; pass < passes; pass++) {
+        const char* p = capture.data();
+        const char* end = p + capture.size();
+        while ((p = static_cast<const char*>(std::memchr(p, '\n', end - p))) != nullptr) {
+            lines++;
+            p++;
+        }
+    }
+    report("libc memchr newline", lines, capture.size() * passes, memchr_timer.seconds());
+    return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * Shared helpers for the AIS forwarder microbenchmarks
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Representative sentence bodies (without leading '!' and checksum).
+// A realistic coastal mix: mostly class A position reports, some base
+// stations and class B, a two-part static message and some non-AIS chatter.
+inline const std::vector<std::string>& sample_bodies() {
+    static const std::vector<std::string> bodies = {
+        "AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0",
+        "AIVDM,1,1,,A,15RTgt0PAso;90TKcjM8h6g208CQ,0",
+        "AIVDM,1,1,,A,13u?etPv2;0n:dDPwUM1U1Cb069D,0",
+        "AIVDM,1,1,,B,15MgK45P3@G?fl0E`JbR0OwT0@MS,0",
+        "AIVDM,1,1,,B,403OviQuMGCqWrRO9>E6fE700@GO,0",
+        "AIVDM,1,1,,A,B52K>;h00Fc>jpUlNV@ikwpUoP06,0",
+        "AIVDM,2,1,3,B,55P5TL01VIaAL@7WKO@mBplU@<PDhh000000001S;AJ::4A80?4i@E53,0",
+        "AIVDM,2,2,3,B,1@0000000000000,2",
+        "AIVDO,1,1,,,B5NJ;PP005l4ot5Isbl03wsUkP06,0",
+        "GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,",
+    };
+    return bodies;
+}
+
+// Wrap a body as a complete NMEA sentence with a valid XOR checksum
+inline std::string make_sentence(const std::string& body, const char* line_ending = "\r\n") {
+    unsigned char sum = 0;
+    for (char c : body) {
+        sum ^= static_cast<unsigned char>(c);
+    }
+    char tail[8];
+    std::snprintf(tail, sizeof(tail), "*%02X", sum);
+    char lead = body.compare(0, 2, "GP") == 0 ? '$' : '!';
+    return std::string(1, lead) + body + tail + line_ending;
+}
+
+// Build a capture of roughly `target_bytes` by cycling through the samples
+inline std::string make_capture(size_t target_bytes, const char* line_ending = "\r\n") {
+    std::vector<std::string> sentences;
+    for (const auto& body : sample_bodies()) {
+        sentences.push_back(make_sentence(body, line_ending));
+    }
+
+    std::string capture;
+    capture.reserve(target_bytes + 128);
+    size_t i = 0;
+    while (capture.size() < target_bytes) {
+        capture += sentences[i++ % sentences.size()];
+    }
+    return capture;
+}
+
+class BenchTimer {
+public:
+    BenchTimer() : start_(std::chrono::steady_clock::now()) {}
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+inline void report(const char* name, size_t sentences, size_t bytes, double seconds) {
+    std::printf("%-28s %10.0f sentences/s %9.1f MB/s  (%zu sentences in %.3f s)\n",
+                name, sentences / seconds, bytes / seconds / 1e6, sentences, seconds);
+}
+
+// Prevent the optimizer from discarding a computed value
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
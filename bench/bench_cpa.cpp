@@ -0,0 +1,144 @@
+/*
+ * Collision monitor microbenchmark
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Spreads synthetic targets over a 600 x 600 nm sea area around our own
+ * ship and feeds position reports round-robin, with an own-ship report
+ * after every 100 target reports. Reports the cost per target report, the
+ * cost and number of CPA checks per own-ship report, and for comparison
+ * the cost of checking every target on each own-ship report.
+ *
+ * Usage: bench_cpa [targets...]   (default: 5000 50000)
+ */
+
+#include "bench_common.h"
+#include "collision_monitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+struct Target {
+    uint32_t mmsi;
+    double lat;
+    double lon;
+    uint16_t sog;
+    uint16_t cog;
+};
+
+AisPositionFix fix_of(const Target& target) {
+    return AisPositionFix{static_cast<int32_t>(target.lon * 600000), static_cast<int32_t>(target.lat * 600000),
+                          target.sog, target.cog, AIS_HEADING_NOT_AVAILABLE};
+}
+
+// Every target against our own ship, as the monitor would without a grid
+size_t brute_force(const std::vector<Target>& targets, const Target& own, double cpa_nm) {
+    double own_vx = own.sog / 10.0 * std::sin(own.cog / 10.0 * PI / 180);
+    double own_vy = own.sog / 10.0 * std::cos(own.cog / 10.0 * PI / 180);
+    double scale = std::cos(own.lat * PI / 180);
+    size_t close = 0;
+    for (const auto& target : targets) {
+        double dx = (target.lon - own.lon) * 60 * scale;
+        double dy = (target.lat - own.lat) * 60;
+        double vx = target.sog / 10.0 * std::sin(target.cog / 10.0 * PI / 180) - own_vx;
+        double vy = target.sog / 10.0 * std::cos(target.cog / 10.0 * PI / 180) - own_vy;
+        double speed2 = vx * vx + vy * vy;
+        double tcpa = speed2 > 1e-6 ? -(dx * vx + dy * vy) / speed2 : 0;
+        double cx = dx + vx * std::max(tcpa, 0.0);
+        double cy = dy + vy * std::max(tcpa, 0.0);
+        close += std::sqrt(cx * cx + cy * cy) < cpa_nm;
+    }
+    return close;
+}
+
+void run(size_t count) {
+    std::mt19937 rng(42);
+    const double own_lat = 52.0, own_lon = 4.0;
+    std::uniform_real_distribution<double> dlat(-5.0, 5.0);
+    std::uniform_real_distribution<double> dlon(-8.0, 8.0);
+    std::uniform_int_distribution<int> sog(0, 250);
+    std::uniform_int_distribution<int> cog(0, 3599);
+
+    std::vector<Target> targets(count);
+    for (size_t i = 0; i < count; i++) {
+        targets[i] = Target{static_cast<uint32_t>(200000000 + i), own_lat + dlat(rng), own_lon + dlon(rng),
+                            static_cast<uint16_t>(sog(rng)), static_cast<uint16_t>(cog(rng))};
+    }
+    Target own{366000000, own_lat, own_lon, 120, 450};
+
+    CollisionMonitor monitor(count, 0.5, 15, 12);
+    size_t alerts = 0;
+    monitor.set_alert_handler([&alerts](const CpaAlert&) { alerts++; });
+
+    auto now = CollisionMonitor::Clock::now();
+    for (const auto& target : targets) {
+        monitor.update(target.mmsi, false, fix_of(target), now);
+    }
+    monitor.update(own.mmsi, true, fix_of(own), now);
+
+    // Round-robin target reports, nudged along their course
+    const size_t reports = 2000000;
+    const size_t own_every = 100;
+    double target_seconds = 0;
+    double own_seconds = 0;
+    uint64_t own_checks = 0;
+    size_t own_reports = 0;
+    for (size_t n = 0; n < reports; n++) {
+        now += std::chrono::microseconds(200);
+        Target& target = targets[n % count];
+        target.lat += 0.00001 * std::cos(target.cog / 10.0 * PI / 180);
+        target.lon += 0.00001 * std::sin(target.cog / 10.0 * PI / 180);
+
+        BenchTimer timer;
+        monitor.update(target.mmsi, false, fix_of(target), now);
+        target_seconds += timer.seconds();
+
+        if (n % own_every == 0) {
+            uint64_t before = monitor.checks();
+            BenchTimer own_timer;
+            monitor.update(own.mmsi, true, fix_of(own), now);
+            own_seconds += own_timer.seconds();
+            own_checks += monitor.checks() - before;
+            own_reports++;
+        }
+    }
+
+    BenchTimer brute_timer;
+    size_t close = 0;
+    const size_t brute_rounds = 200;
+    for (size_t i = 0; i < brute_rounds; i++) {
+        close += brute_force(targets, own, 0.5);
+    }
+    double brute_seconds = brute_timer.seconds();
+    do_not_optimize(close);
+
+    std::printf("%zu targets:\n", count);
+    std::printf("  target report   %8.1f ns\n", target_seconds * 1e9 / reports);
+    std::printf("  own-ship report %8.2f us, %.0f CPA checks (grid)\n", own_seconds * 1e6 / own_reports,
+                static_cast<double>(own_checks) / own_reports);
+    std::printf("  own-ship report %8.2f us, %zu CPA checks (every target)\n", brute_seconds * 1e6 / brute_rounds,
+                count);
+    std::printf("  %zu alerts\n", alerts);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            run(std::strtoul(argv[i], nullptr, 10));
+        }
+    } else {
+        run(5000);
+        run(50000);
+    }
+    return 0;
+}
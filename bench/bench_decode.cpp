@@ -0,0 +1,126 @@
+/*
+ * AIS decode microbenchmark
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Checks the decoder against published sample messages, then measures
+ * sentences per second for sentence parsing plus payload decoding over a
+ * synthetic capture.
+ *
+ * Usage: bench_decode [megabytes] [passes]
+ */
+
+#include "ais_decoder.h"
+#include "bench_common.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    if (!ok) {
+        std::fprintf(stderr, "Known-vector check failed: %s\n", what);
+        failures++;
+    }
+}
+
+static bool near(double value, double expected) {
+    return std::fabs(value - expected) < 0.000002;
+}
+
+static void check_known_vectors() {
+    AisMessage m;
+
+    expect(ais_decode_sentence("!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C", m) == AisDecodeResult::Ok, "type 1 decodes");
+    expect(m.type == 1 && m.mmsi == 477553000, "type 1 mmsi");
+    expect(m.position_a.nav_status == 5 && m.position_a.sog == 0, "type 1 status/sog");
+    expect(near(ais_degrees(m.position_a.lat), 47.582833) && near(ais_degrees(m.position_a.lon), -122.345833), "type 1 position");
+    expect(m.position_a.cog == 510 && m.position_a.heading == 181 && m.position_a.second == 15, "type 1 course");
+
+    expect(ais_decode_sentence("!AIVDM,1,1,,B,403OviQuMGCqWrRO9>E6fE700@GO,0*4D", m) == AisDecodeResult::Ok, "type 4 decodes");
+    expect(m.type == 4 && m.mmsi == 3669702, "type 4 mmsi");
+    expect(m.base_station.year == 2007 && m.base_station.month == 5 && m.base_station.day == 14, "type 4 date");
+    expect(m.base_station.hour == 19 && m.base_station.minute == 57 && m.base_station.second == 39, "type 4 time");
+    expect(near(ais_degrees(m.base_station.lat), 36.883767) && near(ais_degrees(m.base_station.lon), -76.352362), "type 4 position");
+
+    expect(ais_decode_payload("55P5TL01VIaAL@7WKO@mBplU@<PDhh000000001S;AJ::4A80?4i@E531@0000000000000", 2, m) == AisDecodeResult::Ok, "type 5 decodes");
+    expect(m.type == 5 && m.mmsi == 369190000 && m.static_voyage.imo == 6710932, "type 5 ids");
+    expect(std::strcmp(m.static_voyage.callsign, "WDA9674") == 0 && std::strcmp(m.static_voyage.shipname, "MT.MITCHELL") == 0, "type 5 names");
+    expect(m.static_voyage.shiptype == 99 && m.static_voyage.to_bow == 90 && m.static_voyage.to_starboard == 10, "type 5 dimensions");
+    expect(m.static_voyage.draught == 60 && std::strcmp(m.static_voyage.destination, "SEATTLE") == 0, "type 5 voyage");
+
+    expect(ais_decode_sentence("!AIVDM,1,1,,A,B52K>;h00Fc>jpUlNV@ikwpUoP06,0*4C", m) == AisDecodeResult::Ok, "type 18 decodes");
+    expect(m.type == 18 && m.mmsi == 338087471 && m.position_b.sog == 1, "type 18 mmsi/sog");
+    expect(near(ais_degrees(m.position_b.lat), 40.684540) && near(ais_degrees(m.position_b.lon), -74.072132), "type 18 position");
+    expect(m.position_b.cog == 796 && m.position_b.heading == AIS_HEADING_NOT_AVAILABLE, "type 18 course");
+
+    expect(ais_decode_sentence("!AIVDM,1,1,,B,C5N3SRgPEnJGEBT>NhWAwwo862PaLELTBJ:V00000000S0D:R220,0*0B", m) == AisDecodeResult::Ok, "type 19 decodes");
+    expect(m.type == 19 && m.mmsi == 367059850 && m.extended_b.sog == 87, "type 19 mmsi/sog");
+    expect(std::strcmp(m.extended_b.shipname, "CAPT.J.RIMES") == 0 && m.extended_b.shiptype == 70, "type 19 static");
+    expect(m.extended_b.to_bow == 5 && m.extended_b.to_stern == 21 && m.extended_b.to_port == 4, "type 19 dimensions");
+
+    expect(ais_decode_payload("E>kb9O9aS@7PUh10dh19@;0Tah2cWrfP:l?M`00003vP100", 0, m) == AisDecodeResult::Ok, "type 21 decodes");
+    expect(m.type == 21 && m.mmsi == 993692028 && m.aid.aid_type == 19, "type 21 ids");
+    expect(std::strcmp(m.aid.name, "SF OAK BAY BR VAIS E") == 0 && m.aid.virtual_aid, "type 21 name");
+
+    expect(ais_decode_sentence("!AIVDM,1,1,,A,H42O55i18tMET00000000000000,2*6D", m) == AisDecodeResult::Ok, "type 24A decodes");
+    expect(m.type == 24 && m.mmsi == 271041815 && m.static_b.part == 0, "type 24A ids");
+    expect(std::strcmp(m.static_b.shipname, "PROGUY") == 0, "type 24A name");
+    expect(ais_decode_sentence("!AIVDM,1,1,,A,H42O55lti4hhhilD3nink000?050,0*40", m) == AisDecodeResult::Ok, "type 24B decodes");
+    expect(m.static_b.part == 1 && m.static_b.shiptype == 60 && std::strcmp(m.static_b.callsign, "TC6163") == 0, "type 24B static");
+
+    expect(ais_decode_payload("15RTgt0PAso;90TKcjM8h6g", 0, m) == AisDecodeResult::TooShort, "truncated payload rejected");
+    expect(ais_decode_payload("15RTgt0PAso;90TKcjM8h6g208C~", 0, m) == AisDecodeResult::BadPayload, "bad armoring rejected");
+}
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    size_t passes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+
+    check_known_vectors();
+    if (failures != 0) {
+        return 1;
+    }
+    std::printf("Known-vector checks passed\n");
+
+    std::string capture = make_capture(megabytes * 1024 * 1024);
+    std::vector<std::string_view> sentences;
+    size_t start = 0;
+    for (size_t i = 0; i < capture.size(); i++) {
+        if (capture[i] == '\n') {
+            sentences.emplace_back(capture.data() + start, i - 1 - start);
+            start = i + 1;
+        }
+    }
+
+    BenchTimer parse_timer;
+    size_t parsed = 0;
+    AivdmSentence header;
+    for (size_t pass = 0; pass < passes; pass++) {
+        for (auto s : sentences) {
+            parsed += aivdm_parse(s, header);
+        }
+    }
+    report("aivdm_parse", parsed, capture.size() * passes, parse_timer.seconds());
+
+    BenchTimer decode_timer;
+    size_t decoded = 0;
+    uint64_t mmsi_sum = 0;
+    AisMessage msg;
+    for (size_t pass = 0; pass < passes; pass++) {
+        for (auto s : sentences) {
+            if (ais_decode_sentence(s, msg) == AisDecodeResult::Ok) {
+                decoded++;
+                mmsi_sum += msg.mmsi;
+            }
+        }
+    }
+    report("ais_decode_sentence", decoded, capture.size() * passes, decode_timer.seconds());
+    do_not_optimize(mmsi_sum);
+    return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * Duplicate suppression microbenchmark
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Simulates a station fed by several overlapping receivers: every message
+ * arrives `copies` times, a few milliseconds apart, from a population of
+ * `distinct` messages per window. Reports the cost per lookup and the hit
+ * ratio at the configured table size.
+ *
+ * Usage: bench_dedup [distinct_per_window] [copies] [table_entries]
+ */
+
+#include "bench_common.h"
+#include "dedup_cache.h"
+
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    size_t distinct = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+    size_t copies = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 3;
+    size_t entries = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 65536;
+    const size_t windows = 20;
+
+    // Random 28-character payloads, as in a class A position report
+    std::mt19937_64 rng(42);
+    const char armor[] = "0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVW`abcdefghijklmnopqrstuvw";
+    std::vector<std::string> payloads(distinct * windows);
+    for (auto& p : payloads) {
+        p.resize(28);
+        for (auto& c : p) {
+            c = armor[rng() % 64];
+        }
+    }
+
+    DedupCache cache(entries, std::chrono::milliseconds(10000));
+    auto now = DedupCache::Clock::now();
+    const auto step = std::chrono::microseconds(10000000 / (distinct * copies));
+
+    BenchTimer timer;
+    size_t lookups = 0;
+    size_t forwarded = 0;
+    for (size_t i = 0; i < payloads.size(); i++) {
+        // Copies from the other receivers trail the first by one step each
+        for (size_t c = 0; c < copies; c++) {
+            forwarded += !cache.seen(payloads[i], now);
+            now += step;
+            lookups++;
+        }
+    }
+    double seconds = timer.seconds();
+
+    std::printf("%zu lookups in %.3f s: %.1f ns/lookup\n", lookups, seconds, seconds * 1e9 / lookups);
+    std::printf("forwarded %zu of %zu (expected %zu), hit ratio %.1f%%, %lu live entries overwritten early\n",
+                forwarded, lookups, payloads.size(), cache.hit_ratio() * 100.0,
+                static_cast<unsigned long>(cache.evictions()));
+    return forwarded == payloads.size() ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+/*
+ * Filter rule microbenchmark
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Evaluates compiled output filters against a feed: a recorded capture
+ * file if one is given, otherwise the sample sentences spread over random
+ * MMSIs, positions and speeds around the North Sea. Messages are decoded
+ * once up front, as the forwarder does, so only rule evaluation is timed.
+ * Rules are written as config text and go through the config parser.
+ *
+ * Usage: bench_filter [rules] [capture_file]
+ */
+
+#include "ais_decoder.h"
+#include "bench_common.h"
+#include "config.h"
+#include "filter_rules.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+FilterFields fields_of(const std::string& line) {
+    FilterFields fields;
+    AivdmSentence header;
+    if (!aivdm_parse(line, header)) {
+        return fields;
+    }
+    fields.type = static_cast<uint8_t>(ais_payload_type(header.payload));
+    fields.own_ship = header.own_ship;
+
+    AisMessage msg;
+    AisDecodeResult result = ais_decode_payload(header.payload, header.fill_bits, msg);
+    if (result == AisDecodeResult::Ok || result == AisDecodeResult::Unsupported) {
+        fields.mmsi = msg.mmsi;
+    }
+    AisPositionFix fix;
+    if (result == AisDecodeResult::Ok && ais_position(msg, fix)) {
+        fields.has_position = true;
+        fields.lat = fix.lat;
+        fields.lon = fix.lon;
+        fields.sog = fix.sog;
+    }
+    return fields;
+}
+
+std::vector<FilterFields> recorded_feed(const char* path) {
+    std::vector<FilterFields> feed;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.rfind("!AIVDM", 0) == 0 || line.rfind("!AIVDO", 0) == 0) {
+            feed.push_back(fields_of(line));
+        }
+    }
+    return feed;
+}
+
+std::vector<FilterFields> synthetic_feed(size_t count, std::mt19937& rng) {
+    std::vector<FilterFields> samples;
+    for (const auto& body : sample_bodies()) {
+        if (body.compare(0, 4, "AIVD") == 0) {
+            std::string sentence = make_sentence(body, "");
+            samples.push_back(fields_of(sentence));
+        }
+    }
+
+    std::uniform_int_distribution<uint32_t> mmsi(200000000, 775999999);
+    std::uniform_real_distribution<double> lat(50.0, 60.0);
+    std::uniform_real_distribution<double> lon(-5.0, 10.0);
+    std::uniform_int_distribution<int> sog(0, 250);
+
+    std::vector<FilterFields> feed(count);
+    for (size_t i = 0; i < count; i++) {
+        feed[i] = samples[i % samples.size()];
+        feed[i].mmsi = mmsi(rng);
+        feed[i].has_position = true;    // The forwarder falls back to the vessel table
+        feed[i].lat = static_cast<int32_t>(lat(rng) * 600000);
+        feed[i].lon = static_cast<int32_t>(lon(rng) * 600000);
+        feed[i].sog = static_cast<uint16_t>(sog(rng));
+    }
+    return feed;
+}
+
+// A mix of what stations actually configure: local areas, fleets by MMSI
+// range, moving traffic by type
+std::string random_rule(size_t n, std::mt19937& rng) {
+    std::uniform_real_distribution<double> lat(50.0, 59.5);
+    std::uniform_real_distribution<double> lon(-5.0, 9.5);
+    std::uniform_int_distribution<uint32_t> mmsi(200000000, 775000000);
+    std::string rule = "rule" + std::to_string(n);
+    switch (n % 4) {
+        case 0: {
+            double south = lat(rng);
+            double west = lon(rng);
+            rule += " bbox=" + std::to_string(south) + "," + std::to_string(west) + "," +
+                    std::to_string(south + 0.2) + "," + std::to_string(west + 0.3);
+            break;
+        }
+        case 1: {
+            uint32_t first = mmsi(rng);
+            rule += " mmsi=" + std::to_string(first) + "-" + std::to_string(first + 20000) + "," +
+                    std::to_string(mmsi(rng)) + " not_mmsi=" + std::to_string(first + 5);
+            break;
+        }
+        case 2:
+            rule += " types=1-3,18,19 min_sog=" + std::to_string(15 + n % 10);
+            break;
+        default: {
+            double south = lat(rng);
+            double west = lon(rng);
+            rule += " types=5,24 bbox=" + std::to_string(south) + "," + std::to_string(west) + "," +
+                    std::to_string(south + 0.1) + "," + std::to_string(west + 0.1) + " own=exclude";
+            break;
+        }
+    }
+    return rule;
+}
+
+void run(const char* name, const CompiledFilter& filter, const std::vector<FilterFields>& feed, size_t passes) {
+    size_t matched = 0;
+    BenchTimer timer;
+    for (size_t pass = 0; pass < passes; pass++) {
+        for (const auto& fields : feed) {
+            matched += filter.matches(fields);
+        }
+    }
+    double seconds = timer.seconds();
+    do_not_optimize(matched);
+
+    size_t evaluations = feed.size() * passes;
+    std::printf("%-28s %4zu rules %7.1f ns/message  %5.1f%% matched\n", name, filter.rules(),
+                seconds * 1e9 / evaluations, matched * 100.0 / evaluations);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t rule_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 300;
+    std::mt19937 rng(42);
+
+    std::vector<FilterFields> feed = argc > 2 ? recorded_feed(argv[2]) : synthetic_feed(100000, rng);
+    if (feed.empty()) {
+        std::fprintf(stderr, "No AIVDM sentences in %s\n", argv[2]);
+        return 1;
+    }
+    size_t passes = std::max<size_t>(1, 2000000 / feed.size());
+
+    FilterRule everything;
+    run("no rules", CompiledFilter(everything, {}), feed, passes);
+
+    OutputConfig inline_only;
+    if (!parse_output_spec("udp:127.0.0.1:10110 types=1-3,18,19 own=exclude not_mmsi=244660000", inline_only)) {
+        return 1;
+    }
+    run("inline types/own/mmsi", CompiledFilter(inline_only.filter, {}), feed, passes);
+
+    std::vector<FilterRule> rules;
+    for (size_t n = 0; n < rule_count; n++) {
+        FilterRule rule;
+        if (!parse_filter_spec(random_rule(n, rng), rule)) {
+            std::fprintf(stderr, "Bad rule %zu\n", n);
+            return 1;
+        }
+        rules.push_back(rule);
+    }
+    run("alternatives", CompiledFilter(everything, rules), feed, passes);
+
+    // Positions only: the type bitset discards static-only rules up front
+    FilterRule positions;
+    parse_filter_spec("positions types=1-3,18,19", positions);
+    run("alternatives, types=1-3,18,19", CompiledFilter(positions, rules), feed, passes);
+    return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * Framing microbenchmark
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Compares the original std::string "leftover" framing from main() with
+ * SentenceSplitter on a multi-megabyte synthetic capture. Both variants are
+ * fed in recv()-sized chunks and count the "!AIVDM"/"!AIVDO" sentences they
+ * would forward.
+ *
+ * Usage: bench_framing [megabytes] [chunk_bytes]
+ */
+
+#include "bench_common.h"
+#include "sentence_splitter.h"
+
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// The framing loop exactly as it was in main() before SentenceSplitter
+static size_t frame_legacy(const std::string& capture, size_t chunk) {
+    size_t forwarded = 0;
+    std::string leftover;
+    char buffer[1024];
+    if (chunk > sizeof(buffer) - 1) {
+        chunk = sizeof(buffer) - 1;
+    }
+
+    for (size_t off = 0; off < capture.size(); off += chunk) {
+        size_t n = std::min(chunk, capture.size() - off);
+        std::memcpy(buffer, capture.data() + off, n);
+        buffer[n] = '\0';
+        leftover += std::string(buffer);
+
+        size_t pos = 0;
+        std::string delimiter = "\r\n";
+        while ((pos = leftover.find(delimiter)) != std::string::npos) {
+            std::string nmea_str = leftover.substr(0, pos);
+            leftover.erase(0, pos + delimiter.length());
+            if (nmea_str.rfind("!AIVDM", 0) == 0 || nmea_str.rfind("!AIVDO", 0) == 0) {
+                forwarded++;
+                do_not_optimize(nmea_str);
+            }
+        }
+    }
+    return forwarded;
+}
+
+static size_t frame_splitter(const std::string& capture, size_t chunk) {
+    size_t forwarded = 0;
+    SentenceSplitter splitter;
+
+    size_t off = 0;
+    while (off < capture.size()) {
+        // Stand-in for recv() writing into the splitter's buffer
+        char* dst = splitter.write_ptr();
+        size_t n = std::min({chunk, capture.size() - off, splitter.write_space()});
+        std::memcpy(dst, capture.data() + off, n);
+        splitter.commit(n);
+        off += n;
+
+        std::string_view nmea;
+        while (splitter.next(nmea)) {
+            if (nmea.rfind("!AIVDM", 0) == 0 || nmea.rfind("!AIVDO", 0) == 0) {
+                forwarded++;
+                do_not_optimize(nmea);
+            }
+        }
+    }
+    return forwarded;
+}
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    size_t chunk = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1023;
+
+    std::string capture = make_capture(megabytes * 1024 * 1024);
+    std::printf("Framing %zu bytes in %zu byte reads\n", capture.size(), chunk);
+
+    BenchTimer legacy_timer;
+    size_t legacy_count = frame_legacy(capture, chunk);
+    report("legacy std::string", legacy_count, capture.size(), legacy_timer.seconds());
+
+    BenchTimer splitter_timer;
+    size_t splitter_count = frame_splitter(capture, chunk);
+    report("SentenceSplitter", splitter_count, capture.size(), splitter_timer.seconds());
+
+    if (legacy_count != splitter_count) {
+        std::fprintf(stderr, "Mismatch: legacy=%zu splitter=%zu\n", legacy_count, splitter_count);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * End-to-end loopback benchmark
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * The whole daemon path over real sockets: a thread plays the transponder,
+ * serving synthetic traffic (see TrafficGenerator: 200 vessels, 10% static
+ * data, 1% corrupt sentences) on a loopback TCP port as fast as it is read.
+ * A TcpInput connects to it and feeds a Forwarder (duplicate suppression
+ * off), which sends one datagram per sentence to a UDP socket on the same
+ * event loop that counts what arrives. Reports sentences forwarded per
+ * second until the last one has been handed to the kernel, CPU time per
+ * sentence, and the receive-to-send latency from the output's histogram.
+ *
+ * Usage: bench_loopback [megabytes]   (default: 8)
+ */
+
+#include "bench_common.h"
+#include "config.h"
+#include "event_loop.h"
+#include "forwarder.h"
+#include "inputs.h"
+#include "log.h"
+#include "traffic.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// Bind a loopback socket to an ephemeral port; returns the port
+int bind_loopback(int fd) {
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(addr);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || getsockname(fd, (struct sockaddr*)&addr, &length) < 0) {
+        return -1;
+    }
+    return ntohs(addr.sin_port);
+}
+
+Config make_config(int tcp_port, int udp_port) {
+    Config config;
+    config.dedup_window_ms = 0;
+    InputConfig input;
+    parse_input_spec("tcp:127.0.0.1:" + std::to_string(tcp_port), input);
+    config.inputs.push_back(input);
+    OutputConfig output;
+    parse_output_spec("udp:127.0.0.1:" + std::to_string(udp_port), output);
+    config.outputs.push_back(output);
+    return config;
+}
+
+// Sentences the forwarder sends for the capture
+uint64_t expected_sentences(const std::string& capture) {
+    Forwarder forwarder(make_config(9, 9));
+    auto now = SentenceSink::Clock::now();
+    size_t start = 0;
+    while (start < capture.size()) {
+        size_t end = capture.find("\r\n", start);
+        forwarder.process(std::string_view(capture).substr(start, end - start), now);
+        start = end + 2;
+    }
+    return forwarder.sentences_forwarded();
+}
+
+// Serve the capture to the first client, then close
+void transponder(int listen_fd, const std::string& capture) {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd == -1) {
+        return;
+    }
+    size_t done = 0;
+    while (done < capture.size()) {
+        ssize_t n = send(fd, capture.data() + done, capture.size() - done, MSG_NOSIGNAL);
+        if (n <= 0 && errno != EINTR) {
+            break;
+        }
+        done += n > 0 ? static_cast<size_t>(n) : 0;
+    }
+    close(fd);
+}
+
+double cpu_seconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// Upper bound of the bucket holding the given share of the observations
+double quantile_ms(const Histogram& histogram, double share) {
+    uint64_t total = 0;
+    for (size_t i = 0; i <= Histogram::BUCKETS; i++) {
+        total += histogram.bucket(i);
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < Histogram::BUCKETS; i++) {
+        seen += histogram.bucket(i);
+        if (seen >= share * total) {
+            return Histogram::BOUNDS_NS[i] / 1e6;
+        }
+    }
+    return -1;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    TrafficOptions options;
+    options.corrupt_ratio = 0.01;
+    TrafficGenerator traffic(options);
+    std::string capture;
+    capture.reserve(megabytes * 1000000 + 256);
+    while (capture.size() < megabytes * 1000000) {
+        traffic.next(capture);
+        traffic.advance(0.01);
+    }
+    uint64_t expected = expected_sentences(capture);
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int receiver = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int buffer = 32 * 1024 * 1024;     // Beyond rmem_max needs CAP_NET_ADMIN; fewer arrive without it
+    if (setsockopt(receiver, SOL_SOCKET, SO_RCVBUFFORCE, &buffer, sizeof(buffer)) < 0) {
+        setsockopt(receiver, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    }
+    int tcp_port = bind_loopback(listen_fd);
+    int udp_port = bind_loopback(receiver);
+    if (tcp_port < 0 || udp_port < 0 || listen(listen_fd, 1) < 0) {
+        std::fprintf(stderr, "Cannot set up loopback sockets\n");
+        return 1;
+    }
+
+    // Keep the per-run log lines out of the results
+    set_log_enabled(false, false);
+
+    Config config = make_config(tcp_port, udp_port);
+    EventLoop loop;
+    Forwarder forwarder(config);
+    forwarder.open();
+    loop.set_after_dispatch([&forwarder] { forwarder.flush(SentenceSink::Clock::now()); });
+
+    uint64_t received = 0;
+    loop.add(receiver, EPOLLIN, [receiver, &received](uint32_t) {
+        char datagram[2048];
+        while (recv(receiver, datagram, sizeof(datagram), 0) > 0) {
+            received++;
+        }
+    });
+
+    std::printf("%zu MB, %llu sentences to forward\n", megabytes, static_cast<unsigned long long>(expected));
+    auto input = make_input(config.inputs[0], 0, loop, forwarder, config);
+    std::thread server(transponder, listen_fd, std::cref(capture));
+
+    BenchTimer timer;
+    double cpu = cpu_seconds();
+    input->start();
+    while (forwarder.sentences_forwarded() < expected && timer.seconds() < 60) {
+        loop.run_once(10);
+    }
+    double seconds = timer.seconds();
+    cpu = cpu_seconds() - cpu;
+    for (int i = 0; i < 10; i++) {
+        loop.run_once(10);      // Collect the last datagrams
+    }
+
+    server.join();
+    report("tcp -> udp loopback", forwarder.sentences_forwarded(), capture.size(), seconds);
+    const Histogram& latency = forwarder.output().destinations()[0].latency;
+    std::printf("%-28s %10.2f us CPU per sentence, %llu of %llu datagrams received\n", "",
+                cpu * 1e6 / static_cast<double>(forwarder.sentences_forwarded()),
+                static_cast<unsigned long long>(received),
+                static_cast<unsigned long long>(forwarder.sentences_forwarded()));
+    std::printf("%-28s receive to send latency: p50 <= %.2f ms, p99 <= %.2f ms\n", "", quantile_ms(latency, 0.5),
+                quantile_ms(latency, 0.99));
+    close(listen_fd);
+    return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * Pipeline scaling benchmark
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Feeds the sample capture through 1, 2 and 4 FIFO inputs, each written by
+ * its own thread as fast as the reader takes it, and forwards everything
+ * (duplicate suppression off) to an unused local UDP port, one datagram
+ * per sentence. Each input count runs once on the single-threaded event
+ * loop and once in pipeline mode (one thread per input, a decode thread
+ * and an egress thread, blocking when a queue is full), and reports
+ * end-to-end sentences per second until the last message has been handed
+ * to the kernel.
+ *
+ * The writer threads compete for the same cores, so run it on a machine
+ * with at least inputs + 3 cores to see the pipeline's scaling.
+ *
+ * Usage: bench_pipeline [megabytes per input]   (default: 8)
+ */
+
+#include "bench_common.h"
+#include "config.h"
+#include "event_loop.h"
+#include "forwarder.h"
+#include "inputs.h"
+#include "log.h"
+#include "pipeline.h"
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+Config make_config(size_t inputs, bool pipeline) {
+    Config config;
+    config.dedup_window_ms = 0;
+    config.pipeline = pipeline;
+    config.pipeline_block = true;
+    for (size_t i = 0; i < inputs; i++) {
+        InputConfig input;
+        parse_input_spec("file:/tmp/bench_pipeline." + std::to_string(getpid()) + "." + std::to_string(i), input);
+        config.inputs.push_back(input);
+    }
+    OutputConfig output;
+    parse_output_spec("udp:127.0.0.1:9", output);
+    config.outputs.push_back(output);
+    return config;
+}
+
+// Sentences the forwarder sends for one copy of the capture
+uint64_t expected_per_input(const std::string& capture) {
+    Forwarder forwarder(make_config(1, false));
+    forwarder.open();
+    auto now = SentenceSink::Clock::now();
+    size_t start = 0;
+    while (start < capture.size()) {
+        size_t end = capture.find("\r\n", start);
+        forwarder.process(std::string_view(capture).substr(start, end - start), now);
+        start = end + 2;
+    }
+    return forwarder.sentences_forwarded();
+}
+
+void feed(const std::string& path, const std::string& capture) {
+    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);     // Waits for the reader
+    if (fd == -1) {
+        return;
+    }
+    size_t done = 0;
+    while (done < capture.size()) {
+        ssize_t n = write(fd, capture.data() + done, capture.size() - done);
+        if (n <= 0) {
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    close(fd);
+}
+
+void run(size_t inputs, bool pipelined, const std::string& capture, uint64_t expected) {
+    Config config = make_config(inputs, pipelined);
+    for (const auto& input : config.inputs) {
+        unlink(input.path.c_str());
+        mkfifo(input.path.c_str(), 0600);
+    }
+
+    EventLoop loop;
+    Forwarder forwarder(config);
+    forwarder.open();
+    loop.set_after_dispatch([&forwarder] { forwarder.flush(SentenceSink::Clock::now()); });
+
+    std::vector<std::unique_ptr<Input>> sources;
+    std::unique_ptr<Pipeline> pipeline;
+    if (pipelined) {
+        pipeline = std::make_unique<Pipeline>(config, config.inputs, forwarder, loop);
+        pipeline->start();
+    } else {
+        for (const auto& input : config.inputs) {
+            sources.push_back(make_input(input, static_cast<uint16_t>(sources.size()), loop, forwarder, config));
+            sources.back()->start();
+        }
+    }
+
+    BenchTimer timer;
+    std::vector<std::thread> writers;
+    for (const auto& input : config.inputs) {
+        writers.emplace_back(feed, input.path, std::cref(capture));
+    }
+
+    uint64_t total = expected * inputs;
+    while (forwarder.sentences_forwarded() < total || (pipeline && !pipeline->idle())) {
+        loop.run_once(10);
+        if (timer.seconds() > 60) {
+            std::fprintf(stderr, "Timed out with %llu of %llu sentences forwarded\n",
+                         static_cast<unsigned long long>(forwarder.sentences_forwarded()),
+                         static_cast<unsigned long long>(total));
+            break;
+        }
+    }
+    forwarder.flush(SentenceSink::Clock::now());
+    double seconds = timer.seconds();
+
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    if (pipeline) {
+        pipeline->stop();
+    }
+    for (const auto& input : config.inputs) {
+        unlink(input.path.c_str());
+    }
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "%zu input%s, %s", inputs, inputs == 1 ? "" : "s",
+                  pipelined ? "pipeline" : "single thread");
+    report(name, forwarder.sentences_forwarded(), capture.size() * inputs, seconds);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    std::string capture = make_capture(megabytes * 1000000);
+    uint64_t expected = expected_per_input(capture);
+
+    // Keep the per-run log lines out of the results
+    set_log_enabled(false, true);
+
+    std::printf("%u CPUs, %zu MB per input\n", std::thread::hardware_concurrency(), megabytes);
+    for (size_t inputs : {1, 2, 4}) {
+        run(inputs, false, capture, expected);
+        run(inputs, true, capture, expected);
+    }
+    return 0;
+}
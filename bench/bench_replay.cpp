@@ -0,0 +1,149 @@
+/*
+ * Capture and replay benchmark
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Records the sample capture, one sentence per millisecond, to a capture
+ * file with and without compression and reports the recording rate and
+ * the file size against the plain NMEA text. Then reads each file back
+ * with CaptureReader, and finally replays it through a ReplayInput at
+ * replay_speed=max into a Forwarder (duplicate suppression off) sending to
+ * an unused local UDP port, one datagram per sentence, until the last
+ * sentence has been handed to the kernel.
+ *
+ * The sample capture cycles through a handful of sentences, so zlib does
+ * far better on it than on real traffic; record a busy site to judge the
+ * compression.
+ *
+ * Usage: bench_replay [megabytes]   (default: 16)
+ */
+
+#include "bench_common.h"
+#include "capture.h"
+#include "config.h"
+#include "event_loop.h"
+#include "forwarder.h"
+#include "inputs.h"
+#include "log.h"
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+std::vector<std::string_view> split_sentences(const std::string& capture) {
+    std::vector<std::string_view> sentences;
+    size_t start = 0;
+    while (start < capture.size()) {
+        size_t end = capture.find("\r\n", start);
+        sentences.push_back(std::string_view(capture).substr(start, end - start));
+        start = end + 2;
+    }
+    return sentences;
+}
+
+Config make_config(const std::string& path) {
+    Config config;
+    config.dedup_window_ms = 0;
+    config.replay_speed = 0;
+    InputConfig input;
+    parse_input_spec("replay:" + path, input);
+    config.inputs.push_back(input);
+    OutputConfig output;
+    parse_output_spec("udp:127.0.0.1:9", output);
+    config.outputs.push_back(output);
+    return config;
+}
+
+void record(const std::string& path, bool compress, const std::vector<std::string_view>& sentences, size_t bytes) {
+    unlink(path.c_str());
+    BenchTimer timer;
+    {
+        CaptureWriter writer(path, compress);
+        writer.open();
+        auto time = SentenceSink::Clock::now();
+        for (auto sentence : sentences) {
+            writer.record(sentence, time, 0);
+            time += std::chrono::milliseconds(1);
+        }
+    }
+    double seconds = timer.seconds();
+
+    struct stat st;
+    stat(path.c_str(), &st);
+    report(compress ? "record, zlib" : "record", sentences.size(), bytes, seconds);
+    std::printf("%-28s %10.1f%% of the NMEA text (%lld bytes)\n", "", st.st_size * 100.0 / bytes,
+                static_cast<long long>(st.st_size));
+}
+
+void read_back(const std::string& path, bool compress, size_t bytes) {
+    CaptureReader reader;
+    if (!reader.open(path)) {
+        std::fprintf(stderr, "Cannot open %s: %s\n", path.c_str(), reader.error().c_str());
+        return;
+    }
+    BenchTimer timer;
+    CaptureReader::Record record;
+    size_t count = 0;
+    size_t length = 0;
+    while (reader.next(record)) {
+        count++;
+        length += record.sentence.size();
+    }
+    do_not_optimize(length);
+    report(compress ? "read, zlib" : "read", count, bytes, timer.seconds());
+}
+
+void replay(const std::string& path, bool compress, const std::vector<std::string_view>& sentences, size_t bytes) {
+    Config config = make_config(path);
+
+    // Sentences forwarded once the whole capture has gone through
+    uint64_t total;
+    {
+        Forwarder forwarder(config);
+        auto now = SentenceSink::Clock::now();
+        for (auto sentence : sentences) {
+            forwarder.process(sentence, now);
+        }
+        total = forwarder.sentences_forwarded();
+    }
+
+    EventLoop loop;
+    Forwarder forwarder(config);
+    forwarder.open();
+    loop.set_after_dispatch([&forwarder] { forwarder.flush(SentenceSink::Clock::now()); });
+    auto input = make_input(config.inputs[0], 0, loop, forwarder, config);
+
+    BenchTimer timer;
+    input->start();
+    while (forwarder.sentences_forwarded() < total && timer.seconds() < 60) {
+        loop.run_once(10);
+    }
+    report(compress ? "replay=max, zlib" : "replay=max", sentences.size(), bytes, timer.seconds());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+    std::string capture = make_capture(megabytes * 1000000);
+    std::vector<std::string_view> sentences = split_sentences(capture);
+
+    // Keep the per-run log lines out of the results
+    set_log_enabled(false, true);
+
+    std::printf("%zu MB, %zu sentences\n", megabytes, sentences.size());
+    for (bool compress : {false, true}) {
+        std::string path = "/tmp/bench_replay." + std::to_string(getpid()) + (compress ? ".z" : "");
+        record(path, compress, sentences, capture.size());
+        read_back(path, compress, capture.size());
+        replay(path, compress, sentences, capture.size());
+        unlink(path.c_str());
+    }
+    return 0;
+}
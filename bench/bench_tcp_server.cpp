@@ -0,0 +1,204 @@
+/*
+ * TCP server fan-out benchmark
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Connects 1 to 512 loopback clients to a TcpServer and pushes the sample
+ * capture through it, one message per send() and a flush() every 64
+ * messages as the event loop would after a busy wakeup. A reader thread
+ * drains every client with epoll; the writer stays within a bounded
+ * amount of data ahead of it so no client is evicted. Reports messages
+ * per second into the server, bytes per second out to all clients, and
+ * the server thread's CPU time per message.
+ *
+ * A last run leaves one client in eight unread and sends the capture four
+ * times, more than the kernel will buffer for them, to show slow clients
+ * being evicted while the others keep up.
+ *
+ * Usage: bench_tcp_server [megabytes]   (default: 2)
+ */
+
+#include "bench_common.h"
+#include "config.h"
+#include "event_loop.h"
+#include "log.h"
+#include "tcp_server.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <string>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr int BENCH_PORT = 39172;
+constexpr size_t FLUSH_EVERY = 64;          // Messages per simulated wakeup
+constexpr uint64_t WINDOW = 32 * 1024;      // Bytes per client in flight
+
+double thread_cpu_seconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+std::vector<std::string> split_sentences(const std::string& capture) {
+    std::vector<std::string> sentences;
+    size_t start = 0;
+    while (start < capture.size()) {
+        size_t end = capture.find("\r\n", start);
+        sentences.push_back(capture.substr(start, end - start));
+        start = end + 2;
+    }
+    return sentences;
+}
+
+int connect_client(bool reading) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (!reading) {
+        // A small window so the kernel can't soak up the whole run
+        int size = 4096;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(BENCH_PORT);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Read every readable client until told to stop; counts bytes read
+void drain(const std::vector<int>& fds, std::atomic<uint64_t>& received, const std::atomic<bool>& stop) {
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    for (int fd : fds) {
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    std::vector<struct epoll_event> events(256);
+    std::vector<char> buffer(256 * 1024);
+    while (!stop) {
+        int n = epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), 10);
+        for (int i = 0; i < n; i++) {
+            ssize_t got = recv(events[i].data.fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+            if (got > 0) {
+                received.fetch_add(static_cast<uint64_t>(got), std::memory_order_relaxed);
+            } else if (got == 0) {
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, events[i].data.fd, nullptr);
+            }
+        }
+    }
+    close(epoll_fd);
+}
+
+void run(size_t clients, size_t unread, const std::vector<std::string>& sentences, int passes = 1) {
+    OutputConfig config;
+    parse_output_spec("tcp-server:127.0.0.1:" + std::to_string(BENCH_PORT) + " clients=1024", config);
+
+    EventLoop loop;
+    TcpServer server(loop, config);
+    if (!server.start()) {
+        return;
+    }
+
+    std::vector<int> readers;
+    std::vector<int> idle;
+    for (size_t i = 0; i < clients; i++) {
+        bool reading = unread == 0 || i % (clients / unread) != 0;
+        int fd = connect_client(reading);
+        if (fd == -1) {
+            std::fprintf(stderr, "Connecting client %zu failed\n", i);
+            break;
+        }
+        (reading ? readers : idle).push_back(fd);
+        loop.run_once(0);
+    }
+    while (server.clients() < readers.size() + idle.size()) {
+        loop.run_once(10);
+    }
+
+    std::atomic<uint64_t> received{0};
+    std::atomic<bool> stop{false};
+    std::thread reader(drain, std::cref(readers), std::ref(received), std::cref(stop));
+
+    BenchTimer timer;
+    double cpu_start = thread_cpu_seconds();
+    uint64_t written = 0;                   // Bytes per reading client
+    size_t messages = 0;
+    for (int pass = 0; pass < passes; pass++) {
+        for (const auto& sentence : sentences) {
+            std::string_view view(sentence);
+            server.send(&view, 1);
+            written += sentence.size() + 2;
+            if (++messages % FLUSH_EVERY == 0) {
+                server.flush();
+                loop.run_once(0);
+                while (written * readers.size() > received.load(std::memory_order_relaxed) + WINDOW * readers.size()) {
+                    loop.run_once(1);
+                    server.flush();
+                }
+            }
+        }
+    }
+    server.flush();
+    while (received.load(std::memory_order_relaxed) < written * readers.size() && timer.seconds() < 60) {
+        loop.run_once(1);
+    }
+    double cpu = thread_cpu_seconds() - cpu_start;
+    double seconds = timer.seconds();
+
+    stop = true;
+    reader.join();
+    for (int fd : readers) {
+        close(fd);
+    }
+    for (int fd : idle) {
+        close(fd);
+    }
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "%zu clients%s", clients, unread > 0 ? ", 1 in 8 idle" : "");
+    std::printf("%-28s %10.0f messages/s %9.1f MB/s out  %6.2f us CPU per message",
+                name, messages / seconds, received.load() / seconds / 1e6, cpu * 1e6 / messages);
+    if (unread > 0) {
+        std::printf("  (%llu evicted)", static_cast<unsigned long long>(server.evicted()));
+    }
+    std::printf("\n");
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2;
+    std::vector<std::string> sentences = split_sentences(make_capture(megabytes * 1000000));
+
+    // Two descriptors per client
+    struct rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    // Keep the per-client log lines out of the results
+    set_log_enabled(false, true);
+
+    std::printf("%zu MB, %zu messages\n", megabytes, sentences.size());
+    for (size_t clients : {1, 16, 128, 512}) {
+        run(clients, 0, sentences);
+    }
+    run(128, 16, sentences, 4);
+    return 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * I/O backend benchmark
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Sends the sample capture over loopback UDP, one sentence per datagram,
+ * to a UDP input, and forwards everything (duplicate suppression off) to an
+ * unused local UDP port. Runs once with io_backend=epoll and once with
+ * io_backend=io_uring, and reports the event loop thread's CPU time per
+ * sentence alongside the end-to-end rate. The sender stays a bounded
+ * number of sentences ahead of the forwarder so loopback never drops.
+ *
+ * Usage: bench_uring [megabytes]   (default: 4)
+ */
+
+#include "bench_common.h"
+#include "config.h"
+#include "event_loop.h"
+#include "forwarder.h"
+#include "inputs.h"
+#include "log.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <netinet/in.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr uint16_t BENCH_PORT = 39171;
+constexpr uint64_t WINDOW = 64;             // Datagrams in flight, well inside the socket buffer
+
+Config make_config(bool io_uring) {
+    Config config;
+    config.dedup_window_ms = 0;
+    config.io_uring = io_uring;
+    InputConfig input;
+    parse_input_spec("udp:127.0.0.1:" + std::to_string(BENCH_PORT), input);
+    config.inputs.push_back(input);
+    OutputConfig output;
+    parse_output_spec("udp:127.0.0.1:9", output);
+    config.outputs.push_back(output);
+    return config;
+}
+
+std::vector<std::string> split_lines(const std::string& capture) {
+    std::vector<std::string> lines;
+    size_t start = 0;
+    while (start < capture.size()) {
+        size_t end = capture.find("\r\n", start) + 2;
+        lines.push_back(capture.substr(start, end - start));
+        start = end;
+    }
+    return lines;
+}
+
+// Sentences forwarded once each datagram has been processed
+std::vector<uint64_t> expected_after(const std::vector<std::string>& lines) {
+    Forwarder forwarder(make_config(false));
+    forwarder.open();
+    auto now = SentenceSink::Clock::now();
+    std::vector<uint64_t> expected;
+    expected.reserve(lines.size());
+    for (const auto& line : lines) {
+        forwarder.process(std::string_view(line).substr(0, line.size() - 2), now);
+        expected.push_back(forwarder.sentences_forwarded());
+    }
+    return expected;
+}
+
+double thread_cpu_seconds() {
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+void send_all(const std::vector<std::string>& lines, const std::vector<uint64_t>& expected,
+              const std::atomic<uint64_t>& forwarded, const std::atomic<bool>& stop) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(BENCH_PORT);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    for (size_t i = 0; i < lines.size() && !stop; i++) {
+        while (i >= WINDOW && forwarded.load(std::memory_order_acquire) < expected[i - WINDOW] && !stop) {
+            std::this_thread::yield();
+        }
+        sendto(fd, lines[i].data(), lines[i].size(), 0, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+    }
+    close(fd);
+}
+
+void run(bool io_uring, const std::vector<std::string>& lines, const std::vector<uint64_t>& expected,
+         size_t bytes) {
+    Config config = make_config(io_uring);
+    EventLoop loop;
+    Forwarder forwarder(config);
+    forwarder.open();
+    loop.set_after_dispatch([&forwarder] { forwarder.flush(SentenceSink::Clock::now()); });
+    auto input = make_input(config.inputs[0], 0, loop, forwarder, config);
+    input->start();
+
+    std::atomic<uint64_t> forwarded{0};
+    std::atomic<bool> stop{false};
+    BenchTimer timer;
+    double cpu_start = thread_cpu_seconds();
+    std::thread sender(send_all, std::cref(lines), std::cref(expected), std::cref(forwarded), std::cref(stop));
+
+    uint64_t total = expected.back();
+    while (forwarder.sentences_forwarded() < total) {
+        loop.run_once(10);
+        forwarded.store(forwarder.sentences_forwarded(), std::memory_order_release);
+        if (timer.seconds() > 60) {
+            std::fprintf(stderr, "Timed out with %llu of %llu sentences forwarded\n",
+                         static_cast<unsigned long long>(forwarder.sentences_forwarded()),
+                         static_cast<unsigned long long>(total));
+            break;
+        }
+    }
+    forwarder.flush(SentenceSink::Clock::now());
+    double cpu = thread_cpu_seconds() - cpu_start;
+    double seconds = timer.seconds();
+    stop = true;
+    sender.join();
+
+    uint64_t sentences = forwarder.sentences_forwarded();
+    report(io_uring ? "io_uring" : "epoll", sentences, bytes, seconds);
+    std::printf("%-28s %10.2f us loop CPU per sentence\n", "", cpu * 1e6 / (sentences ? sentences : 1));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t megabytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+    std::string capture = make_capture(megabytes * 1000000);
+    std::vector<std::string> lines = split_lines(capture);
+    std::vector<uint64_t> expected = expected_after(lines);
+
+    // Keep the per-run log lines out of the results
+    set_log_enabled(false, true);
+
+    std::printf("%zu MB, %zu datagrams\n", megabytes, lines.size());
+    run(false, lines, expected, capture.size());
+    run(true, lines, expected, capture.size());
+    return 0;
+}
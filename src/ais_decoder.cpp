@@ -0,0 +1,436 @@
+/*
+ * AIS Message Decoder
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "ais_decoder.h"
+#include "nmea_scan.h"
+
+#include <array>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t ARMOR_INVALID = 0xFF;
+
+// Map each armored payload character to its 6-bit value
+constexpr std::array<uint8_t, 256> make_armor_table() {
+    std::array<uint8_t, 256> table{};
+    for (size_t c = 0; c < table.size(); c++) {
+        if (c >= '0' && c <= 'W') {
+            table[c] = static_cast<uint8_t>(c - '0');
+        } else if (c >= '`' && c <= 'w') {
+            table[c] = static_cast<uint8_t>(c - '0' - 8);
+        } else {
+            table[c] = ARMOR_INVALID;
+        }
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> ARMOR_TABLE = make_armor_table();
+
+// 6-bit ASCII used by text fields
+constexpr char SIXBIT_ASCII[65] =
+    "@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_ !\"#$%&'()*+,-./0123456789:;<=>?";
+
+// Payload bits, packed big-endian, with slack so 64-bit loads never overrun
+constexpr size_t BIT_BUFFER_BYTES = AIS_MAX_PAYLOAD_CHARS * 6 / 8 + 8;
+
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t bits) : data_(data), bits_(bits) {}
+
+    size_t bits() const { return bits_; }
+
+    // Unsigned field of `width` bits (1..57) starting at bit `pos`
+    uint32_t u(size_t pos, unsigned width) const {
+        uint64_t word;
+        std::memcpy(&word, data_ + pos / 8, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+        return static_cast<uint32_t>((word << (pos % 8)) >> (64 - width));
+    }
+
+    // Two's complement signed field
+    int32_t s(size_t pos, unsigned width) const {
+        uint32_t raw = u(pos, width);
+        uint32_t sign = 1u << (width - 1);
+        return static_cast<int32_t>((raw ^ sign) - sign);
+    }
+
+    bool b(size_t pos) const { return u(pos, 1) != 0; }
+
+    // 6-bit text of `chars` characters into `out` (capacity chars + 1),
+    // with trailing '@' padding and spaces removed
+    void text(size_t pos, size_t chars, char* out) const {
+        size_t len = 0;
+        for (size_t i = 0; i < chars; i++) {
+            out[i] = SIXBIT_ASCII[u(pos + i * 6, 6)];
+            if (out[i] != '@' && out[i] != ' ') {
+                len = i + 1;
+            }
+        }
+        out[len] = '\0';
+    }
+
+private:
+    const uint8_t* data_;
+    size_t bits_;
+};
+
+// Un-armor `payload` into `out`, returning the number of payload bits or -1
+long unarmor(std::string_view payload, unsigned fill_bits, uint8_t* out) {
+    size_t n = payload.size();
+    if (n > AIS_MAX_PAYLOAD_CHARS) {
+        return -1;
+    }
+
+    const auto* p = reinterpret_cast<const uint8_t*>(payload.data());
+    size_t i = 0;
+    size_t o = 0;
+
+    // Four characters make exactly three bytes
+    for (; i + 4 <= n; i += 4) {
+        uint8_t a = ARMOR_TABLE[p[i]];
+        uint8_t b = ARMOR_TABLE[p[i + 1]];
+        uint8_t c = ARMOR_TABLE[p[i + 2]];
+        uint8_t d = ARMOR_TABLE[p[i + 3]];
+        if ((a | b | c | d) & 0xC0) {
+            return -1;
+        }
+        uint32_t v = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | d;
+        out[o++] = static_cast<uint8_t>(v >> 16);
+        out[o++] = static_cast<uint8_t>(v >> 8);
+        out[o++] = static_cast<uint8_t>(v);
+    }
+
+    uint32_t acc = 0;
+    unsigned acc_bits = 0;
+    for (; i < n; i++) {
+        uint8_t v = ARMOR_TABLE[p[i]];
+        if (v == ARMOR_INVALID) {
+            return -1;
+        }
+        acc = (acc << 6) | v;
+        acc_bits += 6;
+    }
+    if (acc_bits > 0) {
+        // Left-align the remaining 6, 12 or 18 bits into whole bytes
+        acc <<= 24 - acc_bits;
+        out[o++] = static_cast<uint8_t>(acc >> 16);
+        out[o++] = static_cast<uint8_t>(acc >> 8);
+        out[o++] = static_cast<uint8_t>(acc);
+    }
+    std::memset(out + o, 0, BIT_BUFFER_BYTES - o);
+
+    size_t bits = n * 6;
+    return fill_bits > bits ? -1 : static_cast<long>(bits - fill_bits);
+}
+
+void decode_position_a(const BitReader& r, AisPositionReportA& m) {
+    m.nav_status = static_cast<uint8_t>(r.u(38, 4));
+    m.rot = static_cast<int8_t>(r.s(42, 8));
+    m.sog = static_cast<uint16_t>(r.u(50, 10));
+    m.accuracy = r.b(60);
+    m.lon = r.s(61, 28);
+    m.lat = r.s(89, 27);
+    m.cog = static_cast<uint16_t>(r.u(116, 12));
+    m.heading = static_cast<uint16_t>(r.u(128, 9));
+    m.second = static_cast<uint8_t>(r.u(137, 6));
+    m.maneuver = static_cast<uint8_t>(r.u(143, 2));
+    m.raim = r.b(148);
+    m.radio = r.u(149, 19);
+}
+
+void decode_base_station(const BitReader& r, AisBaseStationReport& m) {
+    m.year = static_cast<uint16_t>(r.u(38, 14));
+    m.month = static_cast<uint8_t>(r.u(52, 4));
+    m.day = static_cast<uint8_t>(r.u(56, 5));
+    m.hour = static_cast<uint8_t>(r.u(61, 5));
+    m.minute = static_cast<uint8_t>(r.u(66, 6));
+    m.second = static_cast<uint8_t>(r.u(72, 6));
+    m.accuracy = r.b(78);
+    m.lon = r.s(79, 28);
+    m.lat = r.s(107, 27);
+    m.epfd = static_cast<uint8_t>(r.u(134, 4));
+    m.raim = r.b(148);
+    m.radio = r.u(149, 19);
+}
+
+void decode_static_voyage(const BitReader& r, AisStaticVoyageData& m) {
+    m.ais_version = static_cast<uint8_t>(r.u(38, 2));
+    m.imo = r.u(40, 30);
+    r.text(70, 7, m.callsign);
+    r.text(112, 20, m.shipname);
+    m.shiptype = static_cast<uint8_t>(r.u(232, 8));
+    m.to_bow = static_cast<uint16_t>(r.u(240, 9));
+    m.to_stern = static_cast<uint16_t>(r.u(249, 9));
+    m.to_port = static_cast<uint8_t>(r.u(258, 6));
+    m.to_starboard = static_cast<uint8_t>(r.u(264, 6));
+    m.epfd = static_cast<uint8_t>(r.u(270, 4));
+    m.month = static_cast<uint8_t>(r.u(274, 4));
+    m.day = static_cast<uint8_t>(r.u(278, 5));
+    m.hour = static_cast<uint8_t>(r.u(283, 5));
+    m.minute = static_cast<uint8_t>(r.u(288, 6));
+    m.draught = static_cast<uint8_t>(r.u(294, 8));
+    r.text(302, 20, m.destination);
+    m.dte = r.b(422);
+}
+
+void decode_position_b(const BitReader& r, AisPositionReportB& m) {
+    m.sog = static_cast<uint16_t>(r.u(46, 10));
+    m.accuracy = r.b(56);
+    m.lon = r.s(57, 28);
+    m.lat = r.s(85, 27);
+    m.cog = static_cast<uint16_t>(r.u(112, 12));
+    m.heading = static_cast<uint16_t>(r.u(124, 9));
+    m.second = static_cast<uint8_t>(r.u(133, 6));
+    m.cs_unit = r.b(141);
+    m.display = r.b(142);
+    m.dsc = r.b(143);
+    m.band = r.b(144);
+    m.msg22 = r.b(145);
+    m.assigned = r.b(146);
+    m.raim = r.b(147);
+    m.radio = r.u(148, 20);
+}
+
+void decode_extended_b(const BitReader& r, AisExtendedPositionReportB& m) {
+    m.sog = static_cast<uint16_t>(r.u(46, 10));
+    m.accuracy = r.b(56);
+    m.lon = r.s(57, 28);
+    m.lat = r.s(85, 27);
+    m.cog = static_cast<uint16_t>(r.u(112, 12));
+    m.heading = static_cast<uint16_t>(r.u(124, 9));
+    m.second = static_cast<uint8_t>(r.u(133, 6));
+    r.text(143, 20, m.shipname);
+    m.shiptype = static_cast<uint8_t>(r.u(263, 8));
+    m.to_bow = static_cast<uint16_t>(r.u(271, 9));
+    m.to_stern = static_cast<uint16_t>(r.u(280, 9));
+    m.to_port = static_cast<uint8_t>(r.u(289, 6));
+    m.to_starboard = static_cast<uint8_t>(r.u(295, 6));
+    m.epfd = static_cast<uint8_t>(r.u(301, 4));
+    m.raim = r.b(305);
+    m.dte = r.b(306);
+    m.assigned = r.b(307);
+}
+
+void decode_aid(const BitReader& r, AisAidToNavigation& m) {
+    m.aid_type = static_cast<uint8_t>(r.u(38, 5));
+    r.text(43, 20, m.name);
+    m.accuracy = r.b(163);
+    m.lon = r.s(164, 28);
+    m.lat = r.s(192, 27);
+    m.to_bow = static_cast<uint16_t>(r.u(219, 9));
+    m.to_stern = static_cast<uint16_t>(r.u(228, 9));
+    m.to_port = static_cast<uint8_t>(r.u(237, 6));
+    m.to_starboard = static_cast<uint8_t>(r.u(243, 6));
+    m.epfd = static_cast<uint8_t>(r.u(249, 4));
+    m.second = static_cast<uint8_t>(r.u(253, 6));
+    m.off_position = r.b(259);
+    m.raim = r.b(268);
+    m.virtual_aid = r.b(269);
+    m.assigned = r.b(270);
+
+    // Up to 14 more name characters follow in longer messages
+    if (r.bits() >= 278) {
+        size_t len = std::strlen(m.name);
+        size_t extra = (r.bits() - 272) / 6;
+        if (extra > 14) {
+            extra = 14;
+        }
+        if (len == 20) {
+            r.text(272, extra, m.name + len);
+        }
+    }
+}
+
+void decode_static_b(const BitReader& r, uint32_t mmsi, AisStaticDataB& m) {
+    m.part = static_cast<uint8_t>(r.u(38, 2));
+    if (m.part == 0) {
+        r.text(40, 20, m.shipname);
+        return;
+    }
+    m.shipname[0] = '\0';
+    m.shiptype = static_cast<uint8_t>(r.u(40, 8));
+    r.text(48, 3, m.vendor_id);
+    m.model = static_cast<uint8_t>(r.u(66, 4));
+    m.serial = r.u(70, 20);
+    r.text(90, 7, m.callsign);
+    if (mmsi / 10000000 == 98) {
+        m.mothership_mmsi = r.u(132, 30);
+        m.to_bow = m.to_stern = 0;
+        m.to_port = m.to_starboard = 0;
+    } else {
+        m.mothership_mmsi = 0;
+        m.to_bow = static_cast<uint16_t>(r.u(132, 9));
+        m.to_stern = static_cast<uint16_t>(r.u(141, 9));
+        m.to_port = static_cast<uint8_t>(r.u(150, 6));
+        m.to_starboard = static_cast<uint8_t>(r.u(156, 6));
+    }
+}
+
+// Parse a small decimal field; -1 if empty or not a number
+int parse_small_int(std::string_view s) {
+    if (s.empty() || s.size() > 3) {
+        return -1;
+    }
+    int v = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') {
+            return -1;
+        }
+        v = v * 10 + (c - '0');
+    }
+    return v;
+}
+
+}  // namespace
+
+bool aivdm_parse(std::string_view sentence, AivdmSentence& out) {
+    // "!xxVDM" or "!xxVDO" for any talker id (AI, AB, BS, ...)
+    if (sentence.size() < 15 || sentence[0] != '!' || sentence.compare(3, 2, "VD") != 0 ||
+        (sentence[5] != 'M' && sentence[5] != 'O')) {
+        return false;
+    }
+
+    NmeaFields fields;
+    nmea_scan_fields(sentence, fields);
+    if (fields.count < 6) {
+        return false;
+    }
+
+    int count = parse_small_int(fields.field(sentence, 1));
+    int number = parse_small_int(fields.field(sentence, 2));
+    if (count < 1 || count > 9 || number < 1 || number > count) {
+        return false;
+    }
+
+    std::string_view seq = fields.field(sentence, 3);
+    int sequence_id = seq.empty() ? -1 : parse_small_int(seq);
+    if (!seq.empty() && (sequence_id < 0 || sequence_id > 9)) {
+        return false;
+    }
+
+    std::string_view channel = fields.field(sentence, 4);
+    int fill = parse_small_int(fields.field(sentence, 6));
+    if (fill < 0 || fill > 5) {
+        return false;
+    }
+
+    out.own_ship = sentence[5] == 'O';
+    out.fragment_count = static_cast<uint8_t>(count);
+    out.fragment_number = static_cast<uint8_t>(number);
+    out.sequence_id = static_cast<int8_t>(sequence_id);
+    out.channel = channel.empty() ? 0 : channel[0];
+    out.payload = fields.field(sentence, 5);
+    out.fill_bits = static_cast<uint8_t>(fill);
+    return true;
+}
+
+unsigned ais_payload_type(std::string_view payload) {
+    // The type is the first six bits, i.e. exactly the first character
+    if (payload.empty() || ARMOR_TABLE[static_cast<uint8_t>(payload[0])] == ARMOR_INVALID) {
+        return 0;
+    }
+    return ARMOR_TABLE[static_cast<uint8_t>(payload[0])];
+}
+
+AisDecodeResult ais_decode_payload(std::string_view payload, unsigned fill_bits, AisMessage& msg) {
+    uint8_t buffer[BIT_BUFFER_BYTES];
+    long bits = unarmor(payload, fill_bits, buffer);
+    if (bits < 0) {
+        return AisDecodeResult::BadPayload;
+    }
+    if (bits < 38) {
+        return AisDecodeResult::TooShort;
+    }
+
+    BitReader r(buffer, static_cast<size_t>(bits));
+    msg.type = static_cast<uint8_t>(r.u(0, 6));
+    msg.repeat = static_cast<uint8_t>(r.u(6, 2));
+    msg.mmsi = r.u(8, 30);
+
+    // Shortest length accepted per type; some transmitters trim spare bits,
+    // and anything read past the end of the payload decodes as zero
+    switch (msg.type) {
+        case 1:
+        case 2:
+        case 3:
+            if (bits < 149) return AisDecodeResult::TooShort;
+            decode_position_a(r, msg.position_a);
+            break;
+        case 4:
+            if (bits < 138) return AisDecodeResult::TooShort;
+            decode_base_station(r, msg.base_station);
+            break;
+        case 5:
+            if (bits < 420) return AisDecodeResult::TooShort;
+            decode_static_voyage(r, msg.static_voyage);
+            break;
+        case 18:
+            if (bits < 148) return AisDecodeResult::TooShort;
+            decode_position_b(r, msg.position_b);
+            break;
+        case 19:
+            if (bits < 305) return AisDecodeResult::TooShort;
+            decode_extended_b(r, msg.extended_b);
+            break;
+        case 21:
+            if (bits < 271) return AisDecodeResult::TooShort;
+            decode_aid(r, msg.aid);
+            break;
+        case 24:
+            if (bits < 160) return AisDecodeResult::TooShort;
+            decode_static_b(r, msg.mmsi, msg.static_b);
+            break;
+        default:
+            return AisDecodeResult::Unsupported;
+    }
+    return AisDecodeResult::Ok;
+}
+
+AisDecodeResult ais_decode_sentence(std::string_view sentence, AisMessage& msg) {
+    AivdmSentence parsed;
+    if (!aivdm_parse(sentence, parsed) || parsed.fragment_count != 1) {
+        return AisDecodeResult::BadSentence;
+    }
+    AisDecodeResult result = ais_decode_payload(parsed.payload, parsed.fill_bits, msg);
+    msg.own_ship = parsed.own_ship;
+    return result;
+}
+
+bool ais_position(const AisMessage& msg, AisPositionFix& fix) {
+    switch (msg.type) {
+        case 1:
+        case 2:
+        case 3:
+            fix = {msg.position_a.lon, msg.position_a.lat, msg.position_a.sog,
+                   msg.position_a.cog, msg.position_a.heading};
+            break;
+        case 4:
+            fix = {msg.base_station.lon, msg.base_station.lat, 0, AIS_COG_NOT_AVAILABLE,
+                   AIS_HEADING_NOT_AVAILABLE};
+            break;
+        case 18:
+            fix = {msg.position_b.lon, msg.position_b.lat, msg.position_b.sog,
+                   msg.position_b.cog, msg.position_b.heading};
+            break;
+        case 19:
+            fix = {msg.extended_b.lon, msg.extended_b.lat, msg.extended_b.sog,
+                   msg.extended_b.cog, msg.extended_b.heading};
+            break;
+        case 21:
+            fix = {msg.aid.lon, msg.aid.lat, 0, AIS_COG_NOT_AVAILABLE, AIS_HEADING_NOT_AVAILABLE};
+            break;
+        default:
+            return false;
+    }
+    return fix.lon != AIS_LON_NOT_AVAILABLE && fix.lat != AIS_LAT_NOT_AVAILABLE &&
+           fix.lon >= -180 * 600000 && fix.lon <= 180 * 600000 &&
+           fix.lat >= -90 * 600000 && fix.lat <= 90 * 600000;
+}
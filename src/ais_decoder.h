@@ -0,0 +1,225 @@
+/*
+ * AIS Message Decoder
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Decodes the 6-bit armored payload of !AIVDM/!AIVDO sentences into plain
+ * structs. The payload is un-armored through a constexpr lookup table into a
+ * fixed bit buffer and fields are extracted with a 64-bit big-endian bit
+ * reader, so decoding never touches the heap.
+ *
+ * Supported message types:
+ *   1, 2, 3  Class A position report
+ *   4        Base station report
+ *   5        Class A static and voyage data
+ *   18       Class B position report
+ *   19       Class B extended position report
+ *   21       Aid-to-navigation report
+ *   24       Class B static data (part A and B)
+ *
+ * Numeric fields are kept in their on-air units (e.g. 1/10000 minute for
+ * latitude/longitude, 1/10 knot for SOG); see the helpers at the end of this
+ * file for conversion and the "not available" sentinels.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Longest payload accepted, in armored characters (five-slot messages need 168)
+constexpr size_t AIS_MAX_PAYLOAD_CHARS = 256;
+
+// "Not available" values defined by ITU-R M.1371
+constexpr int32_t AIS_LON_NOT_AVAILABLE = 181 * 600000;
+constexpr int32_t AIS_LAT_NOT_AVAILABLE = 91 * 600000;
+constexpr uint16_t AIS_SOG_NOT_AVAILABLE = 1023;
+constexpr uint16_t AIS_COG_NOT_AVAILABLE = 3600;
+constexpr uint16_t AIS_HEADING_NOT_AVAILABLE = 511;
+
+// Header fields of one !AIVDM/!AIVDO sentence
+struct AivdmSentence {
+    bool own_ship = false;          // !AIVDO rather than !AIVDM
+    uint8_t fragment_count = 0;
+    uint8_t fragment_number = 0;
+    int8_t sequence_id = -1;        // Sequential message id, -1 if empty
+    char channel = 0;               // 'A', 'B', '1', '2' or 0 if empty
+    std::string_view payload;
+    uint8_t fill_bits = 0;
+};
+
+struct AisPositionReportA {         // Types 1, 2, 3
+    uint8_t nav_status;
+    int8_t rot;                     // Raw rate-of-turn indicator, -128 = not available
+    uint16_t sog;
+    bool accuracy;
+    int32_t lon;
+    int32_t lat;
+    uint16_t cog;
+    uint16_t heading;
+    uint8_t second;
+    uint8_t maneuver;
+    bool raim;
+    uint32_t radio;
+};
+
+struct AisBaseStationReport {       // Type 4
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    bool accuracy;
+    int32_t lon;
+    int32_t lat;
+    uint8_t epfd;
+    bool raim;
+    uint32_t radio;
+};
+
+struct AisStaticVoyageData {        // Type 5
+    uint8_t ais_version;
+    uint32_t imo;
+    char callsign[8];
+    char shipname[21];
+    uint8_t shiptype;
+    uint16_t to_bow;
+    uint16_t to_stern;
+    uint8_t to_port;
+    uint8_t to_starboard;
+    uint8_t epfd;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t draught;                // 1/10 metre
+    char destination[21];
+    bool dte;
+};
+
+struct AisPositionReportB {         // Type 18
+    uint16_t sog;
+    bool accuracy;
+    int32_t lon;
+    int32_t lat;
+    uint16_t cog;
+    uint16_t heading;
+    uint8_t second;
+    bool cs_unit;
+    bool display;
+    bool dsc;
+    bool band;
+    bool msg22;
+    bool assigned;
+    bool raim;
+    uint32_t radio;
+};
+
+struct AisExtendedPositionReportB { // Type 19
+    uint16_t sog;
+    bool accuracy;
+    int32_t lon;
+    int32_t lat;
+    uint16_t cog;
+    uint16_t heading;
+    uint8_t second;
+    char shipname[21];
+    uint8_t shiptype;
+    uint16_t to_bow;
+    uint16_t to_stern;
+    uint8_t to_port;
+    uint8_t to_starboard;
+    uint8_t epfd;
+    bool raim;
+    bool dte;
+    bool assigned;
+};
+
+struct AisAidToNavigation {         // Type 21
+    uint8_t aid_type;
+    char name[35];                  // Name plus name extension
+    bool accuracy;
+    int32_t lon;
+    int32_t lat;
+    uint16_t to_bow;
+    uint16_t to_stern;
+    uint8_t to_port;
+    uint8_t to_starboard;
+    uint8_t epfd;
+    uint8_t second;
+    bool off_position;
+    bool raim;
+    bool virtual_aid;
+    bool assigned;
+};
+
+struct AisStaticDataB {             // Type 24
+    uint8_t part;                   // 0 = part A, 1 = part B
+    char shipname[21];              // Part A
+    uint8_t shiptype;               // Part B from here on
+    char vendor_id[4];
+    uint8_t model;
+    uint32_t serial;
+    char callsign[8];
+    uint16_t to_bow;
+    uint16_t to_stern;
+    uint8_t to_port;
+    uint8_t to_starboard;
+    uint32_t mothership_mmsi;       // Auxiliary craft (MMSI 98xxxxxxx) only
+};
+
+struct AisMessage {
+    uint8_t type;
+    uint8_t repeat;
+    uint32_t mmsi;
+    bool own_ship;                  // Set by ais_decode_sentence() for !AIVDO
+    union {
+        AisPositionReportA position_a;
+        AisBaseStationReport base_station;
+        AisStaticVoyageData static_voyage;
+        AisPositionReportB position_b;
+        AisExtendedPositionReportB extended_b;
+        AisAidToNavigation aid;
+        AisStaticDataB static_b;
+    };
+};
+
+enum class AisDecodeResult {
+    Ok,
+    Unsupported,        // Valid payload of a message type not decoded here
+    BadPayload,         // Invalid armoring character or too long
+    TooShort,           // Fewer bits than the message type requires
+    BadSentence,        // Not a parsable single-fragment !AIVDM/!AIVDO sentence
+};
+
+// Parse the comma-separated header of an !AIVDM/!AIVDO sentence
+bool aivdm_parse(std::string_view sentence, AivdmSentence& out);
+
+// Message type of an armored payload without decoding it; 0 if invalid
+unsigned ais_payload_type(std::string_view payload);
+
+// Decode an armored payload (possibly reassembled from several fragments)
+AisDecodeResult ais_decode_payload(std::string_view payload, unsigned fill_bits, AisMessage& msg);
+
+// Parse and decode a complete single-fragment sentence
+AisDecodeResult ais_decode_sentence(std::string_view sentence, AisMessage& msg);
+
+// Position, speed and course common to the position-bearing message types
+struct AisPositionFix {
+    int32_t lon;
+    int32_t lat;
+    uint16_t sog;
+    uint16_t cog;
+    uint16_t heading;
+};
+
+// Extract the position from types 1-3, 4, 18, 19 and 21; false for others or
+// when the position is "not available"
+bool ais_position(const AisMessage& msg, AisPositionFix& fix);
+
+inline double ais_degrees(int32_t raw) { return raw / 600000.0; }
+inline double ais_knots(uint16_t sog) { return sog / 10.0; }
+inline double ais_course(uint16_t cog) { return cog / 10.0; }
@@ -6,13 +6,38 @@
  * 
  * This program connects to an AIS (Automatic Identification System) transponder over TCP,
  * monitors the connection health, and forwards valid NMEA sentences to MarineTraffic via UDP.
+ * Any number of TCP transponders, UDP NMEA listeners and local files can be served at once
+ * from a single epoll event loop.
  * It provides robust connection management, system notifications for connection events,
  * and is suitable for running as a systemd service or standalone daemon.
  * 
  * Features:
  * - TCP connection to AIS transponder with keepalive and health checks.
+ * - Non-blocking connects with jittered exponential backoff for sub-second reconnection.
+ * - Multiple inputs (TCP, UDP, file, serial) declared in the config file, one thread.
+ * - Optional pipeline mode: a thread per input, a decode thread and an egress thread
+ *   joined by lock-free rings, with CPU pinning and a drop-or-block full-queue policy.
+ * - Optional io_uring backend for UDP inputs and outputs, falling back to epoll.
+ * - Timestamped binary capture of received traffic, replayed through a memory-mapped
+ *   input at recorded speed, scaled, or flat out.
  * - UDP forwarding of "!AIVDM" and "!AIVDO" NMEA sentences to MarineTraffic.
- * - System notifications via syslog and desktop notification (notify-send).
+ * - Fan-out to several UDP destinations with per-destination filters, batched with sendmmsg.
+ * - Filter rules on type, MMSI ranges, own ship, bounding box and speed, compiled to bitsets.
+ * - Optional packing of several sentences per datagram for metered uplinks.
+ * - Memory-mapped store-and-forward spool per destination for uplink outages, drained
+ *   oldest first at a set rate once the destination is reachable again.
+ * - Local TCP server outputs for chart plotters and loggers, with bounded per-client
+ *   queues and eviction of clients that fall behind.
+ * - NMEA checksum verification; corrupt sentences are counted and dropped.
+ * - Reassembly of multi-fragment messages so they are forwarded as a whole.
+ * - Time-windowed duplicate suppression for stations with overlapping receivers.
+ * - Live vessel table served as JSON and replayed NMEA over a local HTTP endpoint.
+ * - CPA/TCPA collision alerts against our own ship, using a spatial grid of targets.
+ * - Prometheus metrics over HTTP or to a file: lock-free counters and per-output
+ *   receive-to-send latency histograms.
+ * - Configuration reload on SIGHUP or file change, keeping unchanged inputs connected.
+ * - System notifications via syslog and desktop notification (notify-send), sent from a
+ *   background thread with rate limiting so the forwarding loop never waits on them.
  * - Automatic reconnection and notification on connection loss/restoration.
  * - Designed for reliability and fast detection of connection issues.
  * 
@@ -21,246 +46,107 @@
  *   Customize notification user and addresses as needed.
  * 
  * Dependencies:
- *   - POSIX sockets
- *   - syslog/logger
+ *   - POSIX sockets, Linux epoll and timerfd
+ *   - syslog(3), POSIX threads
  *   - notify-send (for desktop notifications)
  * 
  * License: MIT
  */
 
-#include <iostream>
-#include <cstring>
+#include <cstdio>
 #include <string>
-#include <fstream>
-#include <sys/socket.h>
-#include <arpa/inet.h>
+#include <memory>
+#include <vector>
 #include <unistd.h>
 #include <cstdlib>
 #include <chrono>
-#include <ctime>
-#include <sys/select.h>
-#include <errno.h>
-#include <netinet/tcp.h>
 #include <getopt.h>
+#include <algorithm>
+#include <functional>
 
-// Configuration structure
-struct Config {
-    std::string ais_ip = "192.168.50.37";     // Default AIS IP
-    int ais_port = 39150;                      // Default AIS port
-    std::string mt_ip = "5.9.207.224";        // Default MarineTraffic IP
-    int mt_port = 10170;                       // Default MarineTraffic port
-    std::string notification_user = "david";   // User for desktop notifications
-    std::string config_file = "";             // Optional config file path
-};
-
-// Function to load configuration from file
-bool load_config_file(const std::string& filename, Config& config) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        return false;
-    }
-    
-    std::string line;
-    while (std::getline(file, line)) {
-        // Skip comments and empty lines
-        if (line.empty() || line[0] == '#') continue;
-        
-        size_t eq_pos = line.find('=');
-        if (eq_pos == std::string::npos) continue;
-        
-        std::string key = line.substr(0, eq_pos);
-        std::string value = line.substr(eq_pos + 1);
-        
-        // Trim whitespace
-        key.erase(0, key.find_first_not_of(" \t"));
-        key.erase(key.find_last_not_of(" \t") + 1);
-        value.erase(0, value.find_first_not_of(" \t"));
-        value.erase(value.find_last_not_of(" \t") + 1);
-        
-        if (key == "ais_ip") config.ais_ip = value;
-        else if (key == "ais_port") config.ais_port = std::stoi(value);
-        else if (key == "mt_ip") config.mt_ip = value;
-        else if (key == "mt_port") config.mt_port = std::stoi(value);
-        else if (key == "notification_user") config.notification_user = value;
-    }
-    
-    return true;
-}
-
-// Function to load configuration from environment variables
-void load_env_config(Config& config) {
-    const char* env_val;
-    
-    if ((env_val = getenv("AIS_IP")) != nullptr) {
-        config.ais_ip = env_val;
-    }
-    if ((env_val = getenv("AIS_PORT")) != nullptr) {
-        config.ais_port = std::stoi(env_val);
-    }
-    if ((env_val = getenv("MT_IP")) != nullptr) {
-        config.mt_ip = env_val;
-    }
-    if ((env_val = getenv("MT_PORT")) != nullptr) {
-        config.mt_port = std::stoi(env_val);
-    }
-    if ((env_val = getenv("NOTIFICATION_USER")) != nullptr) {
-        config.notification_user = env_val;
-    }
-}
+#include "alloc_stats.h"
+#include "config.h"
+#include "config_reload.h"
+#include "event_loop.h"
+#include "forwarder.h"
+#include "inputs.h"
+#include "log.h"
+#include "metrics.h"
+#include "metrics_exporter.h"
+#include "nmea_scan.h"
+#include "notification.h"
+#include "pipeline.h"
+#include "query_server.h"
+#include "tcp_server.h"
 
 // Function to show usage information
 void show_usage(const char* program_name) {
-    std::cout << "Usage: " << program_name << " [OPTIONS]\n"
-              << "\nOptions:\n"
-              << "  -h, --help                 Show this help message\n"
-              << "  -c, --config FILE          Load configuration from file\n"
-              << "  -a, --ais-ip IP            AIS transponder IP address\n"
-              << "  -p, --ais-port PORT        AIS transponder port\n"
-              << "  -m, --mt-ip IP             MarineTraffic server IP address\n"
-              << "  -t, --mt-port PORT         MarineTraffic server port\n"
-              << "  -u, --user USER            User for desktop notifications\n"
-              << "\nEnvironment Variables:\n"
-              << "  AIS_IP                     AIS transponder IP address\n"
-              << "  AIS_PORT                   AIS transponder port\n"
-              << "  MT_IP                      MarineTraffic server IP address\n"
-              << "  MT_PORT                    MarineTraffic server port\n"
-              << "  NOTIFICATION_USER          User for desktop notifications\n"
-              << "\nConfiguration File Format:\n"
-              << "  ais_ip=192.168.50.37\n"
-              << "  ais_port=39150\n"
-              << "  mt_ip=5.9.207.224\n"
-              << "  mt_port=10170\n"
-              << "  notification_user=david\n"
-              << "\nPriority: Command line > Environment > Config file > Defaults\n";
-}
-
-// Function to send system notification
-void send_notification(const std::string& title, const std::string& message, const std::string& notification_user, const std::string& urgency = "normal") {
-    // Always log to syslog for reliable notification
-    std::string syslog_command = "logger -t ais_forwarder \"" + title + ": " + message + "\"";
-    system(syslog_command.c_str());
-    
-    // Try to send desktop notification to active user sessions
-    // This works better for systemd services
-    std::string desktop_notify = "sudo -u " + notification_user + " DISPLAY=:0 DBUS_SESSION_BUS_ADDRESS=unix:path=/run/user/$(id -u " + notification_user + ")/bus notify-send --urgency=" + urgency + " \"" + title + "\" \"" + message + "\" 2>/dev/null || true";
-    system(desktop_notify.c_str());
-}
-
-// Function to get current timestamp as string
-std::string get_timestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    char buffer[100];
-    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", std::localtime(&time_t));
-    return std::string(buffer);
-}
-
-// Function to set socket timeout
-bool set_socket_timeout(int socket_fd, int timeout_seconds) {
-    struct timeval timeout;
-    timeout.tv_sec = timeout_seconds;
-    timeout.tv_usec = 0;
-    
-    if (setsockopt(socket_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) {
-        std::cerr << "Failed to set receive timeout" << std::endl;
-        return false;
-    }
-    
-    if (setsockopt(socket_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) < 0) {
-        std::cerr << "Failed to set send timeout" << std::endl;
-        return false;
-    }
-    
-    return true;
-}
-
-// Function to test if connection is still alive
-bool is_connection_alive(int socket_fd) {
-    // Try to send a small amount of data to test the connection
-    // This will fail immediately if the connection is broken
-    char test_byte = 0;
-    ssize_t result = send(socket_fd, &test_byte, 0, MSG_NOSIGNAL);
-    
-    if (result < 0) {
-        if (errno == EPIPE || errno == ECONNRESET || errno == ENOTCONN) {
-            return false;  // Connection definitely broken
-        }
-    }
-    
-    // Check socket error status
-    int error = 0;
-    socklen_t len = sizeof(error);
-    int retval = getsockopt(socket_fd, SOL_SOCKET, SO_ERROR, &error, &len);
-    
-    if (retval != 0 || error != 0) {
-        return false;
-    }
-    
-    // Try to peek at data without removing it from the queue
-    char peek_byte;
-    ssize_t peek_result = recv(socket_fd, &peek_byte, 1, MSG_PEEK | MSG_DONTWAIT);
-    
-    if (peek_result == 0) {
-        // Connection closed by peer
-        return false;
-    } else if (peek_result < 0) {
-        // Check if it's just no data available (normal) or actual error
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            return true;  // No data available, but connection is fine
-        } else if (errno == ECONNRESET || errno == ENOTCONN || errno == EPIPE) {
-            return false;  // Connection broken
-        }
-    }
-    
-    return true;  // Data available or connection appears good
-}
-
-// Function to create and connect AIS socket
-int connect_to_ais(const Config& config) {
-    int ais_sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (ais_sock == -1) {
-        std::string error_msg = "Error creating AIS socket";
-        std::cerr << get_timestamp() << " - " << error_msg << std::endl;
-        send_notification("AIS Socket Error", error_msg, config.notification_user, "critical");
-        return -1;
-    }
-
-    // Enable TCP keepalive to detect broken connections faster
-    int keepalive = 1;
-    if (setsockopt(ais_sock, SOL_SOCKET, SO_KEEPALIVE, &keepalive, sizeof(keepalive)) < 0) {
-        std::cerr << "Warning: Failed to set SO_KEEPALIVE" << std::endl;
-    }
-    
-    // Set keepalive parameters for faster detection
-    int keepidle = 10;   // Start keepalive after 10 seconds of inactivity
-    int keepintvl = 5;   // Send keepalive every 5 seconds
-    int keepcnt = 3;     // Give up after 3 failed keepalive attempts
-    
-    setsockopt(ais_sock, IPPROTO_TCP, TCP_KEEPIDLE, &keepidle, sizeof(keepidle));
-    setsockopt(ais_sock, IPPROTO_TCP, TCP_KEEPINTVL, &keepintvl, sizeof(keepintvl));
-    setsockopt(ais_sock, IPPROTO_TCP, TCP_KEEPCNT, &keepcnt, sizeof(keepcnt));
-
-    // Define AIS address
-    struct sockaddr_in ais_addr;
-    ais_addr.sin_family = AF_INET;
-    ais_addr.sin_port = htons(config.ais_port);
-    inet_pton(AF_INET, config.ais_ip.c_str(), &ais_addr.sin_addr);
-
-    // Connect to AIS
-    if (connect(ais_sock, (struct sockaddr*)&ais_addr, sizeof(ais_addr)) < 0) {
-        close(ais_sock);
-        return -1;
-    }
-    
-    // Set socket timeouts (10 seconds for faster detection)
-    if (!set_socket_timeout(ais_sock, 10)) {
-        std::string error_msg = "Failed to set socket timeouts";
-        std::cerr << get_timestamp() << " - " << error_msg << std::endl;
-        close(ais_sock);
-        return -1;
-    }
-    
-    return ais_sock;
+    std::printf("Usage: %s [OPTIONS]\n"
+                "\nOptions:\n"
+                "  -h, --help                 Show this help message\n"
+                "  -c, --config FILE          Load configuration from file\n"
+                "  -a, --ais-ip IP            AIS transponder IP address\n"
+                "  -p, --ais-port PORT        AIS transponder port\n"
+                "  -m, --mt-ip IP             MarineTraffic server IP address\n"
+                "  -t, --mt-port PORT         MarineTraffic server port\n"
+                "  -u, --user USER            User for desktop notifications\n"
+                "\nEnvironment Variables:\n"
+                "  AIS_IP                     AIS transponder IP address\n"
+                "  AIS_PORT                   AIS transponder port\n"
+                "  MT_IP                      MarineTraffic server IP address\n"
+                "  MT_PORT                    MarineTraffic server port\n"
+                "  NOTIFICATION_USER          User for desktop notifications\n"
+                "\nConfiguration File Format:\n"
+                "  ais_ip=192.168.50.37\n"
+                "  ais_port=39150\n"
+                "  mt_ip=5.9.207.224\n"
+                "  mt_port=10170\n"
+                "  notification_user=david\n"
+                "  notification_interval_s=60\n"
+                "  connect_timeout_ms=3000\n"
+                "  reconnect_min_ms=250\n"
+                "  reconnect_max_ms=30000\n"
+                "  tcp_user_timeout_ms=25000\n"
+                "  fragment_timeout_ms=2000\n"
+                "  vessel_capacity=16384\n"
+                "  vessel_ttl_s=3600\n"
+                "  query_port=8080\n"
+                "  query_bind=127.0.0.1\n"
+                "  cpa_alert_nm=0.5                (0 = no collision alerts)\n"
+                "  tcpa_alert_min=15\n"
+                "  cpa_range_nm=12\n"
+                "  pipeline=off                    (on = threads per input, decode and egress)\n"
+                "  pipeline_queue=4096\n"
+                "  pipeline_full=drop               (or block)\n"
+                "  cpu_ingest=1,2                   (pin threads; omit for no pinning)\n"
+                "  cpu_decode=3\n"
+                "  cpu_egress=3\n"
+                "  io_backend=epoll                 (or io_uring for UDP inputs and outputs)\n"
+                "  capture=/var/lib/ais/site.cap    (record received sentences)\n"
+                "  capture_compress=off\n"
+                "  replay_speed=1                   (or 10, 0.5, max for replay: inputs)\n"
+                "  metrics_port=9108                (Prometheus /metrics; 0 = off)\n"
+                "  metrics_bind=127.0.0.1\n"
+                "  metrics_file=/var/lib/node_exporter/ais.prom\n"
+                "  metrics_interval_s=15\n"
+                "  config_watch=off                 (on = reload when the file changes, as on SIGHUP)\n"
+                "  dedup_window_ms=10000\n"
+                "  dedup_entries=65536\n"
+                "  input=tcp:192.168.50.37:39150   (repeat for each input;\n"
+                "  input=udp:10110                  defaults to ais_ip:ais_port)\n"
+                "  input=file:/var/run/ais.fifo\n"
+                "  input=replay:/var/lib/ais/site.cap\n"
+                "  input=serial:/dev/ttyUSB0:38400\n"
+                "  output=udp:5.9.207.224:10170    (repeat for each destination;\n"
+                "  output=udp:127.0.0.1:10110 types=1-3,18 own=exclude   defaults to mt_ip:mt_port)\n"
+                "  output=udp:5.9.207.224:10170 coalesce=1400 coalesce_ms=100\n"
+                "  output=udp:5.9.207.224:10170 spool=/var/spool/ais/mt.spool spool_mb=64 spool_rate=50\n"
+                "  output=udp:127.0.0.1:10111 filter=harbour,fast\n"
+                "  output=tcp-server:10110 clients=256 buffer=65536 slow=close   (or skip)\n"
+                "  filter=harbour bbox=51.85,4.0,52.0,4.4   (repeat a name for alternatives)\n"
+                "  filter=fast types=1-3,18,19 min_sog=20 not_mmsi=244660000\n"
+                "\nPriority: Command line > Environment > Config file > Defaults\n",
+                program_name);
 }
 
 // Function to run the daemon
@@ -300,8 +186,18 @@ void daemonize() {
     close(STDERR_FILENO);
 }
 
+// A running input and the configuration snapshot it was started with
+struct Source {
+    std::shared_ptr<const Config> config;
+    std::unique_ptr<Input> input;
+};
+
 int main(int argc, char* argv[]) {
-    Config config;
+    // Threads started from here on leave SIGHUP to the reload handler
+    ConfigWatcher::block_signals();
+
+    std::string config_file;
+    std::vector<std::function<void(Config&)>> overrides;
     
     // Command line options
     static struct option long_options[] = {
@@ -315,32 +211,38 @@ int main(int argc, char* argv[]) {
         {0, 0, 0, 0}
     };
     
-    // Parse command line arguments
+    // Parse command line arguments. They are kept and applied to every
+    // configuration loaded, so they still win after a reload.
     int option_index = 0;
     int c;
     
     while ((c = getopt_long(argc, argv, "hc:a:p:m:t:u:", long_options, &option_index)) != -1) {
+        std::string value = optarg != nullptr ? optarg : "";
         switch (c) {
             case 'h':
                 show_usage(argv[0]);
                 return 0;
             case 'c':
-                config.config_file = optarg;
+                config_file = value;
                 break;
             case 'a':
-                config.ais_ip = optarg;
+                overrides.push_back([value](Config& config) { config.ais_ip = value; });
                 break;
-            case 'p':
-                config.ais_port = std::stoi(optarg);
+            case 'p': {
+                int port = std::stoi(value);
+                overrides.push_back([port](Config& config) { config.ais_port = port; });
                 break;
+            }
             case 'm':
-                config.mt_ip = optarg;
+                overrides.push_back([value](Config& config) { config.mt_ip = value; });
                 break;
-            case 't':
-                config.mt_port = std::stoi(optarg);
+            case 't': {
+                int port = std::stoi(value);
+                overrides.push_back([port](Config& config) { config.mt_port = port; });
                 break;
+            }
             case 'u':
-                config.notification_user = optarg;
+                overrides.push_back([value](Config& config) { config.notification_user = value; });
                 break;
             case '?':
                 show_usage(argv[0]);
@@ -349,211 +251,290 @@ int main(int argc, char* argv[]) {
                 break;
         }
     }
+    auto command_line = [&overrides](Config& config) {
+        for (const auto& apply : overrides) {
+            apply(config);
+        }
+    };
     
     // Load configuration in priority order: defaults -> config file -> environment -> command line
-    
-    // 1. Load from config file if specified
-    if (!config.config_file.empty()) {
-        if (!load_config_file(config.config_file, config)) {
-            std::cerr << "Warning: Could not load config file: " << config.config_file << std::endl;
+    Config loaded;
+    if (!config_file.empty()) {
+        if (!load_snapshot(config_file, command_line, false, loaded)) {
+            log_error() << "Warning: Could not load config file: " << config_file;
         }
     } else {
         // Try default config file locations
-        if (load_config_file("/etc/ais_forwarder.conf", config)) {
-            std::cout << get_timestamp() << " - Loaded configuration from /etc/ais_forwarder.conf" << std::endl;
-        } else if (load_config_file("./ais_forwarder.conf", config)) {
-            std::cout << get_timestamp() << " - Loaded configuration from ./ais_forwarder.conf" << std::endl;
+        for (const char* path : {"/etc/ais_forwarder.conf", "./ais_forwarder.conf"}) {
+            if (load_snapshot(path, command_line, false, loaded)) {
+                log_info() << get_timestamp() << " - Loaded configuration from " << path;
+                config_file = path;
+                break;
+            }
+        }
+        if (config_file.empty()) {
+            load_snapshot("", command_line, false, loaded);
         }
     }
-    
-    // 2. Override with environment variables
-    load_env_config(config);
-    
-    // 3. Command line arguments already parsed and override everything
+
+    // The running configuration is replaced as a whole on reload. Components
+    // set up once keep the startup snapshot; each input keeps the one it was
+    // started with.
+    const std::shared_ptr<const Config> startup = std::make_shared<const Config>(std::move(loaded));
+    std::shared_ptr<const Config> live = startup;
+    const Config& config = *startup;
     
     // Print configuration
-    std::cout << get_timestamp() << " - Configuration:" << std::endl;
-    std::cout << "  AIS: " << config.ais_ip << ":" << config.ais_port << std::endl;
-    std::cout << "  MarineTraffic: " << config.mt_ip << ":" << config.mt_port << std::endl;
-    std::cout << "  Notification User: " << config.notification_user << std::endl;
-
-    // UDP Socket for MarineTraffic
-    int mt_sock = socket(AF_INET, SOCK_DGRAM, 0);
-    if (mt_sock == -1) {
-        std::cerr << "Error creating MT socket" << std::endl;
+    log_info() << get_timestamp() << " - Configuration:";
+    std::vector<InputConfig> inputs = effective_inputs(config);
+    for (const auto& input : inputs) {
+        log_info() << "  Input: " << input.spec;
+    }
+    for (const auto& output : effective_outputs(config)) {
+        log_info() << "  Output: " << output.spec;
+    }
+    log_info() << "  Notification User: " << config.notification_user;
+
+    set_notification_interval(std::chrono::seconds(config.notification_interval_s));
+
+    log_info() << get_timestamp() << " - Using " << nmea_kernel().name << " NMEA scan kernel";
+
+    EventLoop loop;
+    if (!loop.valid()) {
+        log_error() << "Error creating event loop";
         return 1;
     }
 
-    // Define MarineTraffic address
-    struct sockaddr_in mt_addr;
-    mt_addr.sin_family = AF_INET;
-    mt_addr.sin_port = htons(config.mt_port);
-    inet_pton(AF_INET, config.mt_ip.c_str(), &mt_addr.sin_addr);
+    Forwarder forwarder(config);
+    if (!forwarder.open()) {
+        return 1;
+    }
 
-    int ais_sock = -1;
-    bool was_connected = false;  // Track previous connection state
-    bool connection_lost_notified = false;  // Track if we've already notified about loss
-    std::string leftover;  // To store any incomplete NMEA sentence from previous reads
-    
-    while (true) {
-        // Try to establish/maintain AIS connection
-        if (ais_sock == -1) {
-            std::cout << get_timestamp() << " - Attempting to connect to AIS transponder..." << std::endl;
-            ais_sock = connect_to_ais(config);
-            
-            if (ais_sock != -1) {
-                std::string success_msg = "Successfully connected to AIS transponder at " + config.ais_ip + ":" + std::to_string(config.ais_port);
-                std::cout << get_timestamp() << " - " << success_msg << std::endl;
-                
-                // Only send notification if we had a previous connection (reconnection)
-                // or if this is the first successful connection after failed attempts
-                if (was_connected || connection_lost_notified) {
-                    send_notification("AIS Connection Restored", success_msg, config.notification_user, "normal");
-                } else {
-                    // First time connecting since service start
-                    send_notification("AIS Forwarder Started", success_msg, config.notification_user, "normal");
-                }
-                
-                was_connected = true;
-                connection_lost_notified = false;  // Reset the notification flag
-                leftover.clear();  // Clear any leftover data from previous connection
-            } else {
-                // Connection failed
-                if (was_connected && !connection_lost_notified) {
-                    // We had a connection before and haven't notified about the loss yet
-                    std::string error_msg = "Failed to reconnect to AIS transponder at " + config.ais_ip + ":" + std::to_string(config.ais_port);
-                    send_notification("AIS Connection Failed", error_msg, config.notification_user, "critical");
-                    connection_lost_notified = true;
-                }
-                // Wait before retrying (no notification spam)
-                sleep(10);
-                continue;
-            }
+    // Local NMEA servers for chart plotters and loggers
+    std::vector<std::unique_ptr<TcpServer>> servers;
+    auto start_server = [&loop, &forwarder, &servers](const OutputConfig& output) {
+        servers.push_back(std::make_unique<TcpServer>(loop, output));
+        if (!servers.back()->start()) {
+            servers.pop_back();
+            return false;
         }
-        
-        // Connection is established, monitor and forward data
-        auto last_health_check = std::chrono::steady_clock::now();
-        const auto health_check_interval = std::chrono::seconds(5);  // Check every 5 seconds for faster detection
-        
-        while (ais_sock != -1) {
-            // Periodic connection health check
-            auto now = std::chrono::steady_clock::now();
-            if (now - last_health_check >= health_check_interval) {
-                if (!is_connection_alive(ais_sock)) {
-                    std::string error_msg = "AIS connection health check failed - connection lost";
-                    std::string timestamp_msg = get_timestamp() + " - " + error_msg;
-                    
-                    std::cerr << timestamp_msg << std::endl;
-                    
-                    // Send notification only once when connection is lost
-                    if (!connection_lost_notified) {
-                        send_notification("AIS Connection Lost", error_msg, config.notification_user, "critical");
-                        connection_lost_notified = true;
-                    }
-                    
-                    close(ais_sock);
-                    ais_sock = -1;
-                    break;  // Break out of data processing loop to reconnect
-                }
-                last_health_check = now;
-            }
+        forwarder.add_server(servers.back().get());
+        return true;
+    };
+    for (const auto& output : effective_outputs(config)) {
+        if (output.tcp_server && !start_server(output)) {
+            return 1;
+        }
+    }
 
-            // Use select to wait for data with timeout
-            fd_set read_fds;
-            FD_ZERO(&read_fds);
-            FD_SET(ais_sock, &read_fds);
-            
-            struct timeval timeout;
-            timeout.tv_sec = 2;   // 2 second timeout for more frequent health checks
-            timeout.tv_usec = 0;
-            
-            int select_result = select(ais_sock + 1, &read_fds, NULL, NULL, &timeout);
-            
-            if (select_result < 0) {
-                std::string error_msg = "Error in select() call - connection may be broken";
-                std::string timestamp_msg = get_timestamp() + " - " + error_msg;
-                
-                std::cerr << timestamp_msg << std::endl;
-                
-                // Send notification only once when connection is lost
-                if (!connection_lost_notified) {
-                    send_notification("AIS Connection Error", error_msg, config.notification_user, "critical");
-                    connection_lost_notified = true;
-                }
-                
-                close(ais_sock);
-                ais_sock = -1;
-                break;
-            } else if (select_result == 0) {
-                // Timeout - no data available, continue to health check
-                continue;
-            }
+    // Local vessel snapshot endpoint
+    std::unique_ptr<QueryServer> query_server;
+    if (config.query_port > 0 && forwarder.vessels().enabled()) {
+        query_server = std::make_unique<QueryServer>(loop, forwarder.vessels(), config);
+        if (!query_server->start()) {
+            query_server.reset();
+        }
+    }
 
-            // Data is available, read it
-            char buffer[1024];
-            ssize_t bytes_received = recv(ais_sock, buffer, sizeof(buffer) - 1, 0);
-            
-            if (bytes_received < 0) {
-                std::string error_msg = "Error reading from AIS socket - connection may be lost";
-                std::string timestamp_msg = get_timestamp() + " - " + error_msg;
-                
-                std::cerr << timestamp_msg << std::endl;
-                
-                // Send notification only once when connection is lost
-                if (!connection_lost_notified) {
-                    send_notification("AIS Connection Lost", error_msg, config.notification_user, "critical");
-                    connection_lost_notified = true;
-                }
-                
-                close(ais_sock);
-                ais_sock = -1;
-                break;
+    // Open every input; each one reconnects on its own from here on. In
+    // pipeline mode each input gets its own thread instead.
+    std::vector<Source> sources;
+    auto start_input = [&loop, &forwarder, &sources](const InputConfig& input,
+                                                     const std::shared_ptr<const Config>& snapshot) {
+        // Reuse the lowest free id, so ids stay small across reloads
+        uint16_t id = 0;
+        while (std::any_of(sources.begin(), sources.end(), [id](const Source& source) {
+            return source.input->id() == id;
+        })) {
+            id++;
+        }
+        sources.push_back({snapshot, make_input(input, id, loop, forwarder, *snapshot)});
+        sources.back().input->start();
+    };
+    std::unique_ptr<Pipeline> pipeline;
+    if (config.pipeline) {
+        pipeline = std::make_unique<Pipeline>(config, inputs, forwarder, loop);
+        if (!pipeline->start()) {
+            return 1;
+        }
+    } else {
+        for (const auto& input : inputs) {
+            start_input(input, startup);
+        }
+    }
+
+    // Prometheus metrics: every component registers the counters it keeps,
+    // again after a reload has replaced some of them. Declared after them,
+    // so it goes first on the way out.
+    MetricsRegistry metrics;
+    std::unique_ptr<MetricsExporter> metrics_exporter;
+    auto register_metrics = [&metrics, &forwarder, &sources, &pipeline, &query_server] {
+        metrics.clear();
+        forwarder.register_metrics(metrics);
+        for (const auto& source : sources) {
+            source.input->register_metrics(metrics);
+        }
+        if (pipeline) {
+            pipeline->register_metrics(metrics);
+        }
+        if (query_server) {
+            const QueryServer* server = query_server.get();
+            metrics.counter("ais_query_requests_total", "Vessel query requests served", "",
+                            [server] { return static_cast<double>(server->requests()); });
+        }
+        metrics.counter("ais_notifications_total", "Desktop notifications by outcome",
+                        MetricsRegistry::label("outcome", "delivered"),
+                        [] { return static_cast<double>(notification_stats().delivered); });
+        metrics.counter("ais_notifications_total", "", MetricsRegistry::label("outcome", "coalesced"),
+                        [] { return static_cast<double>(notification_stats().coalesced); });
+        metrics.counter("ais_notifications_total", "", MetricsRegistry::label("outcome", "suppressed"),
+                        [] { return static_cast<double>(notification_stats().suppressed); });
+        metrics.counter("ais_notifications_total", "", MetricsRegistry::label("outcome", "dropped"),
+                        [] { return static_cast<double>(notification_stats().dropped); });
+        metrics.counter("ais_process_allocations_total", "Heap allocations since start", "",
+                        [] { return static_cast<double>(memory_stats().allocations); });
+        metrics.gauge("ais_process_peak_resident_bytes", "Peak resident set size", "",
+                      [] { return static_cast<double>(memory_stats().peak_rss_bytes); });
+    };
+    if (config.metrics_port > 0 || !config.metrics_file.empty()) {
+        register_metrics();
+        metrics_exporter = std::make_unique<MetricsExporter>(loop, metrics, config);
+        if (!metrics_exporter->start()) {
+            metrics_exporter.reset();
+        }
+    }
+
+    // Reload on SIGHUP, or when the file changes with config_watch=on. The
+    // new snapshot is applied only if the whole file is valid, and only
+    // what changed is touched.
+    ConfigWatcher watcher(loop, [&] {
+        if (config_file.empty()) {
+            log_error() << get_timestamp() << " - No configuration file to reload";
+            return;
+        }
+        log_info() << get_timestamp() << " - Reloading configuration from " << config_file;
+        Config next;
+        if (!load_snapshot(config_file, command_line, true, next)) {
+            log_error() << get_timestamp() << " - Configuration rejected, keeping the running configuration";
+            return;
+        }
+        for (const auto& name : keep_restart_settings(*live, next)) {
+            log_info() << get_timestamp() << " - Changing " << name << " needs a restart, ignored";
+        }
+        ConfigDiff diff = diff_config(*live, next);
+        if (diff.empty()) {
+            log_info() << get_timestamp() << " - Configuration unchanged";
+            live = std::make_shared<const Config>(std::move(next));
+            return;
+        }
+
+        // Outputs first: if the new destinations can't be opened, nothing
+        // has been changed yet
+        auto snapshot = std::make_shared<const Config>(std::move(next));
+        if (diff.udp_outputs_changed) {
+            if (pipeline) {
+                pipeline->pause_egress();
+            }
+            bool opened = forwarder.reconfigure_outputs(*snapshot);
+            if (pipeline) {
+                pipeline->resume_egress();
+            }
+            if (!opened) {
+                log_error() << get_timestamp() << " - Configuration rejected, keeping the running configuration";
+                return;
             }
-            
-            if (bytes_received == 0) {
-                std::string error_msg = "AIS connection closed by remote host";
-                std::string timestamp_msg = get_timestamp() + " - " + error_msg;
-                
-                std::cerr << timestamp_msg << std::endl;
-                
-                // Send notification only once when connection is lost
-                if (!connection_lost_notified) {
-                    send_notification("AIS Connection Closed", error_msg, config.notification_user, "critical");
-                    connection_lost_notified = true;
+            for (const auto& output : effective_outputs(*snapshot)) {
+                if (!output.tcp_server) {
+                    log_info() << "  Output: " << output.spec;
                 }
-                
-                close(ais_sock);
-                ais_sock = -1;
-                break;
             }
+        }
 
-            // Process received data
-            buffer[bytes_received] = '\0';
-            leftover += std::string(buffer);
-            
-            // Split the string by '\r\n' to extract complete NMEA sentences
-            size_t pos = 0;
-            std::string delimiter = "\r\n";
-            while ((pos = leftover.find(delimiter)) != std::string::npos) {
-                // Extract a complete NMEA sentence
-                std::string nmea_str = leftover.substr(0, pos);
-
-                // Remove the extracted sentence from the leftover string
-                leftover.erase(0, pos + delimiter.length());
-
-                // Filter out unwanted messages
-                if (nmea_str.rfind("!AIVDM", 0) == 0 || nmea_str.rfind("!AIVDO", 0) == 0) {
-                    // Send NMEA string to MarineTraffic
-                    sendto(mt_sock, nmea_str.c_str(), nmea_str.size(), 0, (struct sockaddr*)&mt_addr, sizeof(mt_addr));
-                }
+        for (const auto& output : diff.servers_removed) {
+            auto it = std::find_if(servers.begin(), servers.end(), [&output](const auto& server) {
+                return same_output(server->config(), output);
+            });
+            if (it != servers.end()) {
+                log_info() << get_timestamp() << " - Closing " << output.spec;
+                forwarder.remove_server(it->get());
+                servers.erase(it);
             }
         }
-    }
+        for (const auto& output : diff.servers_added) {
+            start_server(output);
+        }
 
-    // This should never be reached, but clean up if it is
-    if (ais_sock != -1) {
-        close(ais_sock);
-    }
-    close(mt_sock);
+        for (const auto& input : diff.inputs_removed) {
+            auto it = std::find_if(sources.begin(), sources.end(), [&input](const Source& source) {
+                return source.input->input_config().spec == input.spec;
+            });
+            if (it != sources.end()) {
+                log_info() << get_timestamp() << " - Closing input " << input.spec;
+                uint16_t id = it->input->id();
+                sources.erase(it);
+                forwarder.on_source_reset(id);
+            }
+        }
+        for (const auto& input : diff.inputs_added) {
+            log_info() << "  Input: " << input.spec;
+            start_input(input, snapshot);
+        }
+
+        if (diff.notification_interval_changed) {
+            set_notification_interval(std::chrono::seconds(snapshot->notification_interval_s));
+        }
+        live = snapshot;
+        if (metrics_exporter) {
+            register_metrics();
+        }
+        log_info() << get_timestamp() << " - Configuration reloaded: " << diff.inputs_added.size() << " inputs opened, "
+                   << diff.inputs_removed.size() << " closed, "
+                   << (diff.udp_outputs_changed ? "UDP outputs replaced" : "UDP outputs unchanged") << ", "
+                   << diff.servers_added.size() << " servers started, " << diff.servers_removed.size() << " stopped";
+    });
+    watcher.start(config_file, config.config_watch);
+
+    // Everything the handlers of one wakeup queued goes out in one batch. A
+    // one-shot timer wakes the loop when a packed datagram falls due.
+    int flush_timer = loop.add_timer(std::chrono::milliseconds(0), std::chrono::milliseconds(0), [] {});
+    std::chrono::steady_clock::time_point flush_armed;
+    loop.set_after_dispatch([&loop, &forwarder, flush_timer, &flush_armed] {
+        auto now = std::chrono::steady_clock::now();
+        forwarder.flush(now);
+
+        std::chrono::steady_clock::time_point deadline;
+        if (forwarder.next_flush(deadline) && (deadline != flush_armed || flush_armed <= now)) {
+            auto wait = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+            loop.arm_timer(flush_timer, std::max(wait, std::chrono::milliseconds(1)));
+            flush_armed = deadline;
+        }
+    });
+
+    // Housekeeping timers
+    loop.add_timer(std::chrono::seconds(1), std::chrono::seconds(1), [&forwarder] {
+        forwarder.tick(std::chrono::steady_clock::now());
+    });
+    loop.add_timer(std::chrono::minutes(10), std::chrono::minutes(10), [&forwarder, &sources, &pipeline] {
+        forwarder.log_stats();
+        for (const auto& source : sources) {
+            source.input->log_stats();
+        }
+        if (pipeline) {
+            pipeline->log_stats();
+        }
+
+        NotificationStats notifications = notification_stats();
+        log_info() << get_timestamp() << " - Notifications: " << notifications.delivered << " delivered, "
+                   << notifications.coalesced << " coalesced, " << notifications.suppressed << " rate limited, "
+                   << notifications.dropped << " dropped";
+        MemoryStats memory = memory_stats();
+        log_info() << get_timestamp() << " - Memory: " << memory.peak_rss_bytes / 1024 << " kB peak resident, "
+                   << memory.allocations << " allocations, " << memory.allocations - memory.frees << " live";
+    });
+
+    MemoryStats memory = memory_stats();
+    log_info() << get_timestamp() << " - Started: " << memory.peak_rss_bytes / 1024 << " kB peak resident, "
+               << memory.allocations << " allocations";
+    loop.run();
     return 0;
 }
@@ -0,0 +1,100 @@
+/*
+ * Allocation Statistics
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "alloc_stats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+std::atomic<uint64_t> frees{0};
+
+// malloc(), retrying through the new handler, which may throw
+void* allocate(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void* pointer;
+    while ((pointer = std::malloc(size != 0 ? size : 1)) == nullptr) {
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            return nullptr;
+        }
+        handler();
+    }
+    return pointer;
+}
+
+void release(void* pointer) noexcept {
+    if (pointer != nullptr) {
+        frees.fetch_add(1, std::memory_order_relaxed);
+        std::free(pointer);
+    }
+}
+
+}  // namespace
+
+MemoryStats memory_stats() {
+    MemoryStats stats;
+    stats.allocations = allocations.load(std::memory_order_relaxed);
+    stats.frees = frees.load(std::memory_order_relaxed);
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        stats.peak_rss_bytes = static_cast<uint64_t>(usage.ru_maxrss) * 1024;     // Reported in KiB
+    }
+    return stats;
+}
+
+void* operator new(std::size_t size) {
+    void* pointer = allocate(size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& nothrow) noexcept {
+    return operator new(size, nothrow);
+}
+
+void operator delete(void* pointer) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    release(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    release(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    release(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    release(pointer);
+}
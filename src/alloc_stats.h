@@ -0,0 +1,26 @@
+/*
+ * Allocation Statistics
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * The program-wide operator new and delete are replaced by versions that
+ * count calls on the way to malloc() and free(), so the daemon can report
+ * how many heap allocations it makes, and tests can check that forwarding
+ * a sentence makes none. Each count is one relaxed atomic increment.
+ *
+ * Peak resident set size comes from getrusage(2). Linking anything that
+ * calls memory_stats() links in the replacements.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+struct MemoryStats {
+    uint64_t allocations = 0;       // operator new calls since start
+    uint64_t frees = 0;             // operator delete calls with a non-null pointer
+    uint64_t peak_rss_bytes = 0;    // High-water mark of resident memory
+};
+
+MemoryStats memory_stats();
@@ -0,0 +1,368 @@
+/*
+ * NMEA Capture Files
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "capture.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef AIS_FORWARDER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "log.h"
+
+namespace {
+
+constexpr char MAGIC[8] = {'A', 'I', 'S', 'C', 'A', 'P', 0, 0};
+constexpr uint32_t VERSION = 1;
+constexpr size_t FILE_HEADER_SIZE = 16;
+constexpr size_t BLOCK_HEADER_SIZE = 24;
+constexpr uint32_t BLOCK_ZLIB = 1;
+constexpr uint32_t BLOCK_SESSION = 2;               // First block after an open()
+constexpr uint64_t MAX_GAP_NS = std::chrono::nanoseconds(CAPTURE_MAX_GAP).count();
+constexpr size_t MAX_RECORD_FRAMING = 10 + 3 + 5;   // Varint time, source and length
+
+void put_le(char* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out[i] = static_cast<char>(value >> (8 * i));
+    }
+}
+
+uint64_t get_le(const char* in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+    }
+    return value;
+}
+
+void put_varint(std::vector<char>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool get_varint(const char*& in, const char* end, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; in < end && shift < 64; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(*in++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// CaptureWriter
+
+CaptureWriter::CaptureWriter(const std::string& path, bool compress) : path_(path), compress_(compress) {
+#ifndef AIS_FORWARDER_HAVE_ZLIB
+    if (compress_) {
+        log_error() << get_timestamp() << " - Built without zlib; capturing to " << path_ << " uncompressed";
+        compress_ = false;
+    }
+#endif
+    block_.reserve(CAPTURE_BLOCK_SIZE);
+}
+
+CaptureWriter::~CaptureWriter() {
+    if (fd_ != -1) {
+        flush();
+        close(fd_);
+    }
+}
+
+bool CaptureWriter::open() {
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    struct stat st;
+    if (fd_ == -1 || fstat(fd_, &st) < 0) {
+        log_error() << get_timestamp() << " - Cannot open capture file " << path_ << ": " << strerror(errno);
+        if (fd_ != -1) {
+            close(fd_);
+            fd_ = -1;
+        }
+        return false;
+    }
+
+    if (st.st_size == 0) {
+        char header[FILE_HEADER_SIZE] = {};
+        std::memcpy(header, MAGIC, sizeof(MAGIC));
+        put_le(header + 8, VERSION, 4);
+        if (!write_all(fd_, header, sizeof(header))) {
+            log_error() << get_timestamp() << " - Cannot write capture file " << path_ << ": " << strerror(errno);
+            close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        bytes_ += sizeof(header);
+    }
+
+    new_session_ = true;
+    log_info() << get_timestamp() << " - Capturing received sentences to " << path_
+               << (compress_ ? " (compressed)" : "");
+    return true;
+}
+
+void CaptureWriter::record(std::string_view sentence, Clock::time_point time, uint16_t source) {
+    if (fd_ == -1) {
+        return;
+    }
+    if (block_.size() + sentence.size() + MAX_RECORD_FRAMING > CAPTURE_BLOCK_SIZE && records_ > 0) {
+        flush();
+    }
+
+    // Pipeline input threads stamp sentences independently, so they can
+    // arrive a little out of order; keep time moving forward within a session
+    uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                            time.time_since_epoch()).count());
+    if (ns < last_ns_ && !(new_session_ && records_ == 0)) {
+        ns = last_ns_;
+    }
+    if (records_ == 0) {
+        first_ns_ = last_ns_ = ns;
+    }
+
+    put_varint(block_, ns - last_ns_);
+    put_varint(block_, source);
+    put_varint(block_, sentence.size());
+    block_.insert(block_.end(), sentence.begin(), sentence.end());
+    last_ns_ = ns;
+    records_++;
+    sentences_++;
+}
+
+void CaptureWriter::flush() {
+    if (fd_ == -1 || records_ == 0) {
+        return;
+    }
+
+    uint32_t flags = new_session_ ? BLOCK_SESSION : 0;
+    stored_.resize(BLOCK_HEADER_SIZE);
+#ifdef AIS_FORWARDER_HAVE_ZLIB
+    if (compress_) {
+        uLongf length = compressBound(static_cast<uLong>(block_.size()));
+        stored_.resize(BLOCK_HEADER_SIZE + length);
+        if (compress2(reinterpret_cast<Bytef*>(stored_.data() + BLOCK_HEADER_SIZE), &length,
+                      reinterpret_cast<const Bytef*>(block_.data()), static_cast<uLong>(block_.size()),
+                      Z_BEST_SPEED) == Z_OK &&
+            length < block_.size()) {
+            stored_.resize(BLOCK_HEADER_SIZE + length);
+            flags |= BLOCK_ZLIB;
+        } else {
+            stored_.resize(BLOCK_HEADER_SIZE);
+        }
+    }
+#endif
+    if ((flags & BLOCK_ZLIB) == 0) {
+        stored_.insert(stored_.end(), block_.begin(), block_.end());
+    }
+
+    put_le(stored_.data(), block_.size(), 4);
+    put_le(stored_.data() + 4, stored_.size() - BLOCK_HEADER_SIZE, 4);
+    put_le(stored_.data() + 8, records_, 4);
+    put_le(stored_.data() + 12, flags, 4);
+    put_le(stored_.data() + 16, first_ns_, 8);
+
+    if (write_all(fd_, stored_.data(), stored_.size())) {
+        bytes_ += stored_.size();
+        raw_bytes_ += block_.size();
+        new_session_ = false;
+    } else {
+        if (errors_++ == 0) {
+            log_error() << get_timestamp() << " - Error writing capture file " << path_ << ": " << strerror(errno);
+        }
+    }
+    block_.clear();
+    records_ = 0;
+}
+
+void CaptureWriter::log_stats() const {
+    LogLine line = log_info();
+    line << get_timestamp() << " - Capture " << path_ << ": " << sentences_ << " sentences, " << bytes_
+         << " bytes written";
+    if (compress_ && raw_bytes_ > 0) {
+        line << " (" << static_cast<int>((bytes_ * 100.0) / raw_bytes_ + 0.5) << "% of " << raw_bytes_ << ")";
+    }
+    line << ", " << errors_ << " blocks lost, " << missed_ << " sentences missed";
+}
+
+void CaptureWriter::register_metrics(MetricsRegistry& metrics) const {
+    std::string labels = MetricsRegistry::label("path", path_);
+    metrics.counter("ais_capture_sentences_total", "Sentences recorded to the capture file", labels,
+                    [this] { return static_cast<double>(sentences_); });
+    metrics.counter("ais_capture_bytes_total", "Bytes written to the capture file", labels,
+                    [this] { return static_cast<double>(bytes_); });
+    metrics.counter("ais_capture_blocks_lost_total", "Capture blocks that could not be written", labels,
+                    [this] { return static_cast<double>(errors_); });
+    metrics.counter("ais_capture_sentences_missed_total", "Received sentences that could not be recorded", labels,
+                    [this] { return static_cast<double>(missed_); });
+}
+
+// ---------------------------------------------------------------------------
+// CaptureReader
+
+CaptureReader::~CaptureReader() {
+    if (map_ != nullptr) {
+        munmap(const_cast<char*>(map_), size_);
+    }
+}
+
+bool CaptureReader::open(const std::string& path) {
+    if (map_ != nullptr) {
+        munmap(const_cast<char*>(map_), size_);
+        map_ = nullptr;
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        error_ = strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        error_ = strerror(errno);
+        close(fd);
+        return false;
+    }
+    if (static_cast<size_t>(st.st_size) < FILE_HEADER_SIZE) {
+        error_ = "not a capture file";
+        close(fd);
+        return false;
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        error_ = strerror(errno);
+        return false;
+    }
+    map_ = static_cast<const char*>(map);
+    madvise(map, size_, MADV_SEQUENTIAL);
+
+    if (std::memcmp(map_, MAGIC, sizeof(MAGIC)) != 0 || get_le(map_ + 8, 4) != VERSION) {
+        error_ = "not a capture file, or an unsupported version";
+        return false;
+    }
+    rewind();
+    return true;
+}
+
+void CaptureReader::rewind() {
+    offset_ = FILE_HEADER_SIZE;
+    cursor_ = end_ = nullptr;
+    remaining_ = 0;
+    started_ = false;
+}
+
+bool CaptureReader::load_block() {
+    if (offset_ + BLOCK_HEADER_SIZE > size_) {
+        return false;   // End of file, or the header of a torn block
+    }
+    const char* header = map_ + offset_;
+    size_t raw_size = get_le(header, 4);
+    size_t stored_size = get_le(header + 4, 4);
+    uint32_t flags = static_cast<uint32_t>(get_le(header + 12, 4));
+    if (stored_size > size_ - offset_ - BLOCK_HEADER_SIZE) {
+        return false;
+    }
+    const char* stored = header + BLOCK_HEADER_SIZE;
+
+    if (flags & BLOCK_ZLIB) {
+#ifdef AIS_FORWARDER_HAVE_ZLIB
+        inflated_.resize(raw_size);
+        uLongf length = static_cast<uLongf>(raw_size);
+        if (uncompress(reinterpret_cast<Bytef*>(inflated_.data()), &length, reinterpret_cast<const Bytef*>(stored),
+                       static_cast<uLong>(stored_size)) != Z_OK ||
+            length != raw_size) {
+            error_ = "damaged block at offset " + std::to_string(offset_);
+            return false;
+        }
+        cursor_ = inflated_.data();
+#else
+        error_ = "compressed capture, but built without zlib";
+        return false;
+#endif
+    } else {
+        if (raw_size != stored_size) {
+            error_ = "damaged block at offset " + std::to_string(offset_);
+            return false;
+        }
+        cursor_ = stored;
+    }
+
+    end_ = cursor_ + raw_size;
+    remaining_ = static_cast<uint32_t>(get_le(header + 8, 4));
+
+    // A new session's clock has its own origin; carry on from where the last
+    // one stopped
+    uint64_t first_ns = get_le(header + 16, 8);
+    if (!started_) {
+        ns_ = first_ns;
+        started_ = true;
+    } else if ((flags & BLOCK_SESSION) == 0 && first_ns > clock_ns_) {
+        ns_ += std::min(first_ns - clock_ns_, MAX_GAP_NS);
+    }
+    clock_ns_ = first_ns;
+    offset_ += BLOCK_HEADER_SIZE + stored_size;
+    return true;
+}
+
+bool CaptureReader::next(Record& record) {
+    while (remaining_ == 0) {
+        if (!load_block()) {
+            return false;
+        }
+    }
+
+    uint64_t delta;
+    uint64_t source;
+    uint64_t length;
+    if (!get_varint(cursor_, end_, delta) || !get_varint(cursor_, end_, source) ||
+        !get_varint(cursor_, end_, length) || length > static_cast<uint64_t>(end_ - cursor_)) {
+        error_ = "damaged record before offset " + std::to_string(offset_);
+        remaining_ = 0;
+        offset_ = size_;
+        return false;
+    }
+
+    clock_ns_ += delta;
+    ns_ += std::min(delta, MAX_GAP_NS);
+    record.ns = ns_;
+    record.source = static_cast<uint16_t>(source);
+    record.sentence = std::string_view(cursor_, static_cast<size_t>(length));
+    cursor_ += length;
+    remaining_--;
+    return true;
+}
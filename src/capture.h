@@ -0,0 +1,131 @@
+/*
+ * NMEA Capture Files
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Records every received sentence with its steady-clock receive time
+ * (`capture=<path>`) so the traffic of a site can be replayed later through
+ * a `replay:<path>` input. The file is a 16-byte header followed by
+ * independent blocks of at most CAPTURE_BLOCK_SIZE bytes of records:
+ *
+ *   header:  "AISCAP" 0 0 | u32 version | u32 reserved
+ *   block:   u32 raw_size | u32 stored_size | u32 records | u32 flags
+ *            | u64 first_ns | stored_size bytes (zlib stream if flags & 1)
+ *   record:  varint ns since the previous record | varint source
+ *            | varint length | sentence bytes
+ *
+ * Integers are little-endian. Timestamps are nanoseconds of the monotonic
+ * clock, so they survive wall-clock steps but only mean something relative
+ * to each other within one run of the daemon. Each open() appends a new
+ * session, and its first block is flagged (flags & 2); the reader joins the
+ * sessions end to end, and never lets time step backwards or jump by more
+ * than CAPTURE_MAX_GAP. A sentence costs about 5 bytes of framing at
+ * typical receive rates; `capture_compress=on` deflates each block at zlib's
+ * fastest level.
+ *
+ * Blocks are written whole, with one write(), when full and from the
+ * forwarder's one-second tick, so a crash loses at most the last second
+ * and leaves at most one torn block, which the reader stops at.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "metrics.h"
+
+constexpr size_t CAPTURE_BLOCK_SIZE = 64 * 1024;   // Raw record bytes per block
+constexpr std::chrono::seconds CAPTURE_MAX_GAP(10); // Longest pause the reader replays
+
+class CaptureWriter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    CaptureWriter(const std::string& path, bool compress);
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    // Open the file for appending, writing the header if it is new; false on failure
+    bool open();
+
+    // Append one sentence from input `source`, received at `time`
+    void record(std::string_view sentence, Clock::time_point time, uint16_t source);
+
+    // Count a received sentence that could not be recorded
+    void missed() { missed_++; }
+
+    // Write the block collected so far
+    void flush();
+
+    void log_stats() const;
+    void register_metrics(MetricsRegistry& metrics) const;
+
+private:
+    std::string path_;
+    bool compress_;
+    int fd_ = -1;
+    std::vector<char> block_;           // Records of the block being collected
+    std::vector<char> stored_;          // Header and stored bytes of the block being written
+    uint32_t records_ = 0;              // In block_
+    uint64_t first_ns_ = 0;             // Of the first record in block_
+    uint64_t last_ns_ = 0;              // Of the last record written this session
+    bool new_session_ = true;           // No block written since open()
+
+    uint64_t sentences_ = 0;
+    uint64_t raw_bytes_ = 0;            // Record bytes before compression
+    uint64_t bytes_ = 0;                // Bytes written to the file
+    uint64_t errors_ = 0;               // Blocks that could not be written
+    uint64_t missed_ = 0;               // Sentences that never reached record()
+};
+
+// Sequential reader over a memory-mapped capture file. Uncompressed blocks
+// are read in place; compressed ones are inflated into one reused buffer.
+class CaptureReader {
+public:
+    struct Record {
+        uint64_t ns;                    // Receive time on the joined timeline, nanoseconds
+        uint16_t source;
+        std::string_view sentence;      // Valid until the next call to next()
+    };
+
+    CaptureReader() = default;
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    // Map `path` and check its header; false with error() set on failure
+    bool open(const std::string& path);
+
+    // The next record; false at the end of the file or at a damaged block
+    bool next(Record& record);
+
+    // Start again from the first record
+    void rewind();
+
+    const std::string& error() const { return error_; }
+    size_t size() const { return size_; }
+
+private:
+    bool load_block();
+
+    const char* map_ = nullptr;
+    size_t size_ = 0;
+    size_t offset_ = 0;                 // Of the next block
+    const char* cursor_ = nullptr;      // Next record in the current block
+    const char* end_ = nullptr;
+    uint32_t remaining_ = 0;            // Records left in the current block
+    bool started_ = false;              // A block has been loaded since rewind()
+    uint64_t clock_ns_ = 0;             // Recorded time of the previous record
+    uint64_t ns_ = 0;                   // Joined time of the previous record
+    std::vector<char> inflated_;
+    std::string error_;
+};
@@ -0,0 +1,306 @@
+/*
+ * Collision Monitor
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "collision_monitor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "hash.h"
+
+namespace {
+
+constexpr double TARGET_MAX_AGE_S = 360;    // Class A at anchor reports every 3 minutes
+constexpr double OWN_MAX_AGE_S = 120;
+constexpr double CLEAR_FACTOR = 1.5;        // Re-arm once CPA opens to this multiple
+constexpr double PI = 3.14159265358979323846;
+
+double radians(double degrees) {
+    return degrees * PI / 180.0;
+}
+
+// Velocity in knots east and north; "not available" counts as stopped
+void velocity(const AisPositionFix& fix, double& vx, double& vy) {
+    if (fix.sog == AIS_SOG_NOT_AVAILABLE || fix.cog == AIS_COG_NOT_AVAILABLE) {
+        vx = vy = 0;
+        return;
+    }
+    double knots = ais_knots(fix.sog);
+    double course = radians(ais_course(fix.cog));
+    vx = knots * std::sin(course);
+    vy = knots * std::cos(course);
+}
+
+size_t next_power_of_two(size_t n) {
+    size_t size = 1;
+    while (size < n) {
+        size <<= 1;
+    }
+    return size;
+}
+
+}  // namespace
+
+CollisionMonitor::CollisionMonitor(size_t capacity, double cpa_nm, double tcpa_min, double range_nm)
+    : capacity_(capacity),
+      cpa_nm_(cpa_nm),
+      tcpa_h_(tcpa_min / 60.0),
+      range_nm_(range_nm),
+      cell_deg_(range_nm / 60.0),
+      cols_(static_cast<int32_t>(std::ceil(360.0 / cell_deg_))),
+      epoch_(Clock::now()),
+      keys_(next_power_of_two(std::max<size_t>(capacity * 2, 16)), 0),   // At most half full
+      slots_(keys_.size(), 0),
+      index_mask_(keys_.size() - 1),
+      mmsi_(capacity, 0),
+      lat_(capacity),
+      lon_(capacity),
+      vx_(capacity),
+      vy_(capacity),
+      t_(capacity),
+      alerted_(capacity),
+      heads_(next_power_of_two(std::max<size_t>(capacity, 64)), NONE),
+      bucket_mask_(heads_.size() - 1),
+      bucket_(capacity, NONE),
+      next_(capacity, NONE),
+      prev_(capacity, NONE) {
+    free_.reserve(capacity);
+    for (size_t slot = capacity; slot > 0; slot--) {
+        free_.push_back(static_cast<uint32_t>(slot - 1));
+    }
+}
+
+double CollisionMonitor::seconds(Clock::time_point now) const {
+    return std::chrono::duration<double>(now - epoch_).count();
+}
+
+int32_t CollisionMonitor::row_of(double lat) const {
+    return static_cast<int32_t>(std::floor((lat + 90.0) / cell_deg_));
+}
+
+int32_t CollisionMonitor::col_of(double lon) const {
+    int32_t col = static_cast<int32_t>(std::floor((lon + 180.0) / cell_deg_)) % cols_;
+    return col < 0 ? col + cols_ : col;
+}
+
+size_t CollisionMonitor::bucket_of(int32_t row, int32_t col) const {
+    uint32_t hash = static_cast<uint32_t>(row) * 73856093u ^ static_cast<uint32_t>(col) * 19349663u;
+    return (hash ^ (hash >> 15)) & bucket_mask_;
+}
+
+void CollisionMonitor::link(size_t slot) {
+    size_t bucket = bucket_of(row_of(lat_[slot]), col_of(lon_[slot]));
+    if (bucket_[slot] == bucket) {
+        return;
+    }
+    if (bucket_[slot] != NONE) {
+        unlink(slot);
+    }
+    next_[slot] = heads_[bucket];
+    prev_[slot] = NONE;
+    if (heads_[bucket] != NONE) {
+        prev_[heads_[bucket]] = static_cast<uint32_t>(slot);
+    }
+    heads_[bucket] = static_cast<uint32_t>(slot);
+    bucket_[slot] = static_cast<uint32_t>(bucket);
+}
+
+void CollisionMonitor::unlink(size_t slot) {
+    if (prev_[slot] != NONE) {
+        next_[prev_[slot]] = next_[slot];
+    } else {
+        heads_[bucket_[slot]] = next_[slot];
+    }
+    if (next_[slot] != NONE) {
+        prev_[next_[slot]] = prev_[slot];
+    }
+    bucket_[slot] = NONE;
+}
+
+size_t CollisionMonitor::index_of(uint32_t mmsi) const {
+    size_t index = static_cast<size_t>(hash_mix64(mmsi)) & index_mask_;
+    while (keys_[index] != 0 && keys_[index] != mmsi) {
+        index = (index + 1) & index_mask_;
+    }
+    return index;
+}
+
+// Backward-shift deletion, as in VesselTable
+void CollisionMonitor::erase_index(size_t hole) {
+    size_t next = hole;
+    while (true) {
+        next = (next + 1) & index_mask_;
+        if (keys_[next] == 0) {
+            break;
+        }
+        size_t home = static_cast<size_t>(hash_mix64(keys_[next])) & index_mask_;
+        bool stays = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (!stays) {
+            keys_[hole] = keys_[next];
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+    }
+    keys_[hole] = 0;
+}
+
+size_t CollisionMonitor::claim(uint32_t mmsi) {
+    size_t index = index_of(mmsi);
+    if (keys_[index] == mmsi) {
+        return slots_[index];
+    }
+
+    if (free_.empty()) {
+        // Make room by dropping the target with the oldest position
+        size_t oldest = 0;
+        for (size_t slot = 1; slot < capacity_; slot++) {
+            if (t_[slot] < t_[oldest]) {
+                oldest = slot;
+            }
+        }
+        remove(oldest);
+        evicted_++;
+        index = index_of(mmsi);
+    }
+
+    size_t slot = free_.back();
+    free_.pop_back();
+    keys_[index] = mmsi;
+    slots_[index] = static_cast<uint32_t>(slot);
+    mmsi_[slot] = mmsi;
+    alerted_[slot] = 0;
+    size_++;
+    return slot;
+}
+
+void CollisionMonitor::remove(size_t slot) {
+    if (bucket_[slot] != NONE) {
+        unlink(slot);
+    }
+    erase_index(index_of(mmsi_[slot]));
+    mmsi_[slot] = 0;
+    free_.push_back(static_cast<uint32_t>(slot));
+    size_--;
+}
+
+void CollisionMonitor::update(uint32_t mmsi, bool own_ship, const AisPositionFix& fix, Clock::time_point now) {
+    if (capacity_ == 0 || mmsi == 0) {
+        return;
+    }
+    double t = seconds(now);
+
+    if (own_ship) {
+        own_valid_ = true;
+        own_mmsi_ = mmsi;
+        own_lat_ = ais_degrees(fix.lat);
+        own_lon_ = ais_degrees(fix.lon);
+        velocity(fix, own_vx_, own_vy_);
+        own_t_ = t;
+        check_all(t);
+        return;
+    }
+    if (mmsi == own_mmsi_) {
+        return;     // Our own transmission heard back through a repeater
+    }
+
+    size_t slot = claim(mmsi);
+    lat_[slot] = ais_degrees(fix.lat);
+    lon_[slot] = ais_degrees(fix.lon);
+    velocity(fix, vx_[slot], vy_[slot]);
+    t_[slot] = t;
+    link(slot);
+
+    if (own_valid_ && t - own_t_ <= OWN_MAX_AGE_S) {
+        check(slot, t);
+    }
+}
+
+size_t CollisionMonitor::expire(Clock::time_point now) {
+    double t = seconds(now);
+    if (own_valid_ && t - own_t_ > OWN_MAX_AGE_S) {
+        own_valid_ = false;
+    }
+
+    size_t removed = 0;
+    for (size_t slot = 0; slot < capacity_; slot++) {
+        if (mmsi_[slot] != 0 && t - t_[slot] > TARGET_MAX_AGE_S) {
+            remove(slot);
+            removed++;
+        }
+    }
+    return removed;
+}
+
+// Walk the buckets of the cells within range of our own ship
+void CollisionMonitor::check_all(double t) {
+    int32_t row = row_of(own_lat_);
+    int32_t col = col_of(own_lon_);
+
+    // Longitude cells narrow towards the poles
+    double scale = std::max(std::cos(radians(own_lat_)), 0.01);
+    int32_t span = std::min(static_cast<int32_t>(std::ceil(1.0 / scale)), cols_ / 2);
+
+    // Hashing can map two nearby cells to one bucket; walk each bucket once
+    size_t visited[64];
+    size_t visited_count = 0;
+
+    for (int32_t r = row - 1; r <= row + 1; r++) {
+        for (int32_t c = col - span; c <= col + span; c++) {
+            size_t bucket = bucket_of(r, ((c % cols_) + cols_) % cols_);
+            if (std::find(visited, visited + visited_count, bucket) != visited + visited_count) {
+                continue;
+            }
+            if (visited_count < 64) {
+                visited[visited_count++] = bucket;
+            }
+            for (uint32_t slot = heads_[bucket]; slot != NONE; slot = next_[slot]) {
+                check(slot, t);
+            }
+        }
+    }
+}
+
+void CollisionMonitor::check(size_t slot, double t) {
+    checks_++;
+
+    // Local projection around our own ship, in nautical miles
+    double dlon = lon_[slot] - own_lon_;
+    if (dlon > 180.0) dlon -= 360.0;
+    if (dlon < -180.0) dlon += 360.0;
+    double dx = dlon * 60.0 * std::cos(radians(own_lat_));
+    double dy = (lat_[slot] - own_lat_) * 60.0;
+
+    // Dead-reckon both to the current time
+    dx += (vx_[slot] * (t - t_[slot]) - own_vx_ * (t - own_t_)) / 3600.0;
+    dy += (vy_[slot] * (t - t_[slot]) - own_vy_ * (t - own_t_)) / 3600.0;
+
+    double range = std::sqrt(dx * dx + dy * dy);
+    if (range > range_nm_) {
+        alerted_[slot] = 0;
+        return;     // Includes far cells sharing the bucket
+    }
+
+    double vx = vx_[slot] - own_vx_;
+    double vy = vy_[slot] - own_vy_;
+    double speed2 = vx * vx + vy * vy;
+    double tcpa = speed2 > 1e-6 ? -(dx * vx + dy * vy) / speed2 : 0.0;
+    double cx = dx + vx * std::max(tcpa, 0.0);
+    double cy = dy + vy * std::max(tcpa, 0.0);
+    double cpa = std::sqrt(cx * cx + cy * cy);
+
+    bool danger = cpa < cpa_nm_ && tcpa >= 0.0 && tcpa <= tcpa_h_;
+    if (danger && !alerted_[slot]) {
+        alerted_[slot] = 1;
+        alerts_++;
+        if (handler_) {
+            double bearing = std::atan2(dx, dy) * 180.0 / PI;
+            handler_(CpaAlert{mmsi_[slot], cpa, tcpa * 60.0, range, bearing < 0 ? bearing + 360.0 : bearing});
+        }
+    } else if (!danger && alerted_[slot] && (tcpa < 0.0 || cpa > cpa_nm_ * CLEAR_FACTOR)) {
+        alerted_[slot] = 0;
+    }
+}
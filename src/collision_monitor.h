@@ -0,0 +1,125 @@
+/*
+ * Collision Monitor
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Computes the closest point of approach (CPA) and the time to it (TCPA)
+ * between our own ship, as reported by !AIVDO, and every target in range,
+ * and reports a target once when its CPA falls below the alert distance
+ * within the alert time. The alert is re-armed once the target has passed
+ * or its CPA has opened to 1.5 times the alert distance.
+ *
+ * Targets live in fixed arrays indexed by slot, hashed into a uniform grid
+ * whose cells are `range` across: each slot is linked into the list of its
+ * cell's bucket and only relinked when a position report moves it to
+ * another cell. A target update checks that target alone; an own-ship
+ * update walks only the cells within `range`, so the cost depends on local
+ * traffic rather than on every target heard. Cells are hashed into a
+ * fixed bucket array, so the grid covers the globe in bounded memory;
+ * targets from far cells sharing a bucket are skipped by a distance check.
+ * Targets are found by MMSI through an open-addressing index sized at
+ * construction, so tracking a new target allocates nothing.
+ *
+ * CPA is computed on a local flat-earth projection around our own ship,
+ * with both positions dead-reckoned to the current time from SOG and COG,
+ * which is accurate to well within AIS position error over the ranges
+ * involved.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "ais_decoder.h"
+
+struct CpaAlert {
+    uint32_t mmsi;
+    double cpa_nm;                  // Closest point of approach
+    double tcpa_min;                // Minutes until it
+    double range_nm;                // Current distance
+    double bearing_deg;             // True bearing from our own ship
+};
+
+class CollisionMonitor {
+public:
+    using Clock = std::chrono::steady_clock;
+    using AlertHandler = std::function<void(const CpaAlert&)>;
+
+    CollisionMonitor(size_t capacity, double cpa_nm, double tcpa_min, double range_nm);
+
+    void set_alert_handler(AlertHandler handler) { handler_ = std::move(handler); }
+
+    // Record a position report; `own_ship` for !AIVDO
+    void update(uint32_t mmsi, bool own_ship, const AisPositionFix& fix, Clock::time_point now);
+
+    // Drop targets whose last position is too old to extrapolate
+    size_t expire(Clock::time_point now);
+
+    size_t size() const { return size_; }
+    bool own_ship_known() const { return own_valid_; }
+    uint64_t checks() const { return checks_; }
+    uint64_t alerts() const { return alerts_; }
+    uint64_t evicted() const { return evicted_; }
+
+private:
+    static constexpr uint32_t NONE = 0xffffffff;
+
+    double seconds(Clock::time_point now) const;
+    size_t index_of(uint32_t mmsi) const;
+    void erase_index(size_t index);
+    size_t claim(uint32_t mmsi);
+    void remove(size_t slot);
+    void link(size_t slot);
+    void unlink(size_t slot);
+    int32_t row_of(double lat) const;
+    int32_t col_of(double lon) const;
+    size_t bucket_of(int32_t row, int32_t col) const;
+    void check(size_t slot, double t);
+    void check_all(double t);
+
+    size_t capacity_;
+    double cpa_nm_;
+    double tcpa_h_;
+    double range_nm_;
+    double cell_deg_;
+    int32_t cols_;
+    Clock::time_point epoch_;
+    AlertHandler handler_;
+
+    // Our own ship
+    bool own_valid_ = false;
+    uint32_t own_mmsi_ = 0;
+    double own_lat_ = 0, own_lon_ = 0, own_vx_ = 0, own_vy_ = 0, own_t_ = 0;
+
+    // MMSI index: keys_ holds MMSI (0 = empty), slots_ the target slot
+    std::vector<uint32_t> keys_;
+    std::vector<uint32_t> slots_;
+    size_t index_mask_;
+
+    // Targets, indexed by slot
+    std::vector<uint32_t> free_;
+    size_t size_ = 0;
+    std::vector<uint32_t> mmsi_;                    // 0 = free slot
+    std::vector<double> lat_;                       // Degrees
+    std::vector<double> lon_;
+    std::vector<double> vx_;                        // Knots east
+    std::vector<double> vy_;                        // Knots north
+    std::vector<double> t_;                         // Seconds since epoch_ of the position
+    std::vector<uint8_t> alerted_;
+
+    // Grid: one list per bucket, linked through the target slots
+    std::vector<uint32_t> heads_;
+    size_t bucket_mask_;
+    std::vector<uint32_t> bucket_;
+    std::vector<uint32_t> next_;
+    std::vector<uint32_t> prev_;
+
+    uint64_t checks_ = 0;
+    uint64_t alerts_ = 0;
+    uint64_t evicted_ = 0;
+};
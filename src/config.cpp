@@ -0,0 +1,595 @@
+/*
+ * AIS Forwarder Configuration
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "config.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+
+#include "log.h"
+
+namespace {
+
+// Rates with a termios constant on Linux
+const int SERIAL_BAUD_RATES[] = {1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600};
+
+// Split "a,b,c" on a separator; as with std::getline, a trailing separator
+// adds no empty item
+std::vector<std::string> split_list(const std::string& list, char separator) {
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start < list.size()) {
+        size_t end = list.find(separator, start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        items.push_back(list.substr(start, end - start));
+        start = end + 1;
+    }
+    return items;
+}
+
+// Split a spec into its blank-separated words
+std::vector<std::string> split_words(const std::string& spec) {
+    std::vector<std::string> words;
+    size_t start = spec.find_first_not_of(" \t\r\n");
+    while (start != std::string::npos) {
+        size_t end = spec.find_first_of(" \t\r\n", start);
+        words.push_back(spec.substr(start, end - start));     // npos - start runs to the end
+        start = spec.find_first_not_of(" \t\r\n", end);
+    }
+    return words;
+}
+
+}  // namespace
+
+bool parse_input_spec(const std::string& spec, InputConfig& input) {
+    size_t colon = spec.find(':');
+    if (colon == std::string::npos) {
+        return false;
+    }
+
+    std::string type = spec.substr(0, colon);
+    std::string address = spec.substr(colon + 1);
+    input = InputConfig();
+    input.spec = spec;
+
+    try {
+        if (type == "tcp") {
+            size_t port_colon = address.rfind(':');
+            if (port_colon == std::string::npos || port_colon == 0) {
+                return false;
+            }
+            input.type = InputConfig::Type::Tcp;
+            input.host = address.substr(0, port_colon);
+            input.port = std::stoi(address.substr(port_colon + 1));
+        } else if (type == "udp") {
+            size_t port_colon = address.rfind(':');
+            input.type = InputConfig::Type::Udp;
+            if (port_colon == std::string::npos) {
+                input.host = "0.0.0.0";
+                input.port = std::stoi(address);
+            } else {
+                input.host = address.substr(0, port_colon);
+                input.port = std::stoi(address.substr(port_colon + 1));
+            }
+        } else if (type == "file") {
+            if (address.empty()) {
+                return false;
+            }
+            input.type = InputConfig::Type::File;
+            input.path = address;
+            return true;
+        } else if (type == "replay") {
+            if (address.empty()) {
+                return false;
+            }
+            input.type = InputConfig::Type::Replay;
+            input.path = address;
+            return true;
+        } else if (type == "serial") {
+            // A trailing ":<digits>" is the baud rate; device paths such as
+            // /dev/serial/by-path/... may contain colons themselves
+            input.type = InputConfig::Type::Serial;
+            input.path = address;
+            size_t baud_colon = address.rfind(':');
+            if (baud_colon != std::string::npos && baud_colon + 1 < address.size() &&
+                address.find_first_not_of("0123456789", baud_colon + 1) == std::string::npos) {
+                input.path = address.substr(0, baud_colon);
+                input.baud = std::stoi(address.substr(baud_colon + 1));
+            }
+            const int* end = std::end(SERIAL_BAUD_RATES);
+            return !input.path.empty() && std::find(std::begin(SERIAL_BAUD_RATES), end, input.baud) != end;
+        } else {
+            return false;
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    return input.port > 0 && input.port <= 65535;
+}
+
+namespace {
+
+// Parse a message type list such as "1-3,5,18" into a bit mask
+bool parse_type_list(const std::string& list, uint32_t& types) {
+    types = 0;
+    for (const std::string& item : split_list(list, ',')) {
+        size_t dash = item.find('-');
+        int first = std::stoi(item.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+        if (first < 1 || last > 27 || first > last) {
+            return false;
+        }
+        for (int type = first; type <= last; type++) {
+            types |= 1u << type;
+        }
+    }
+    return types != 0;
+}
+
+// Parse an MMSI list such as "211000000-211999999,244660000" into ranges
+bool parse_mmsi_list(const std::string& list, std::vector<std::pair<uint32_t, uint32_t>>& ranges) {
+    for (const std::string& item : split_list(list, ',')) {
+        size_t dash = item.find('-');
+        unsigned long first = std::stoul(item.substr(0, dash));
+        unsigned long last = dash == std::string::npos ? first : std::stoul(item.substr(dash + 1));
+        if (first < 1 || last > 999999999 || first > last) {
+            return false;
+        }
+        ranges.emplace_back(static_cast<uint32_t>(first), static_cast<uint32_t>(last));
+    }
+    return !ranges.empty();
+}
+
+// Parse a CPU list such as "0,2-3" into CPU numbers
+bool parse_cpu_list(const std::string& list, std::vector<int>& cpus) {
+    for (const std::string& item : split_list(list, ',')) {
+        size_t dash = item.find('-');
+        int first = std::stoi(item.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+        if (first < 0 || first > last || last >= 1024) {
+            return false;
+        }
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return !cpus.empty();
+}
+
+enum class OptionResult { Applied, Invalid, Unknown };
+
+// Apply one filter predicate option to `rule`
+OptionResult parse_filter_option(const std::string& name, const std::string& value, FilterRule& rule) {
+    if (name == "types") {
+        return parse_type_list(value, rule.types) ? OptionResult::Applied : OptionResult::Invalid;
+    }
+    if (name == "own") {
+        if (value == "include") rule.own_ship = FilterRule::OwnShip::Include;
+        else if (value == "exclude") rule.own_ship = FilterRule::OwnShip::Exclude;
+        else if (value == "only") rule.own_ship = FilterRule::OwnShip::Only;
+        else return OptionResult::Invalid;
+        return OptionResult::Applied;
+    }
+    if (name == "mmsi" || name == "not_mmsi") {
+        return parse_mmsi_list(value, name == "mmsi" ? rule.mmsi_allow : rule.mmsi_deny) ? OptionResult::Applied
+                                                                                          : OptionResult::Invalid;
+    }
+    if (name == "bbox") {
+        double corners[4];
+        size_t n = 0;
+        for (const std::string& item : split_list(value, ',')) {
+            if (n == 4) {
+                return OptionResult::Invalid;
+            }
+            corners[n++] = std::stod(item);
+        }
+        if (n != 4 || corners[0] < -90 || corners[2] > 90 || corners[0] > corners[2] ||
+            corners[1] < -180 || corners[1] > 180 || corners[3] < -180 || corners[3] > 180) {
+            return OptionResult::Invalid;
+        }
+        rule.has_bbox = true;
+        rule.south = corners[0];
+        rule.west = corners[1];
+        rule.north = corners[2];
+        rule.east = corners[3];
+        return OptionResult::Applied;
+    }
+    if (name == "min_sog") {
+        rule.min_sog = std::stod(value);
+        return rule.min_sog >= 0 && rule.min_sog < 102.3 ? OptionResult::Applied : OptionResult::Invalid;
+    }
+    return OptionResult::Unknown;
+}
+
+}  // namespace
+
+bool parse_filter_spec(const std::string& spec, FilterRule& rule) {
+    std::vector<std::string> words = split_words(spec);
+    rule = FilterRule();
+    rule.spec = spec;
+    if (words.empty()) {
+        return false;
+    }
+    rule.name = words[0];
+
+    try {
+        for (auto option = words.begin() + 1; option != words.end(); ++option) {
+            size_t eq = option->find('=');
+            std::string name = option->substr(0, eq);
+            std::string value = eq == std::string::npos ? "" : option->substr(eq + 1);
+            if (parse_filter_option(name, value, rule) != OptionResult::Applied) {
+                return false;
+            }
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+bool parse_output_spec(const std::string& spec, OutputConfig& output) {
+    std::vector<std::string> words = split_words(spec);
+    std::string address = words.empty() ? "" : words[0];
+    bool tcp_server = address.rfind("tcp-server:", 0) == 0;
+    if (address.rfind("udp:", 0) != 0 && !tcp_server) {
+        return false;
+    }
+
+    output = OutputConfig();
+    output.spec = spec;
+    output.tcp_server = tcp_server;
+
+    try {
+        size_t prefix = address.find(':') + 1;
+        size_t port_colon = address.rfind(':');
+        if (tcp_server && port_colon < prefix) {
+            output.host = "0.0.0.0";
+        } else if (port_colon <= prefix) {
+            return false;
+        } else {
+            output.host = address.substr(prefix, port_colon - prefix);
+        }
+        output.port = std::stoi(address.substr(std::max(port_colon + 1, prefix)));
+
+        for (auto option = words.begin() + 1; option != words.end(); ++option) {
+            size_t eq = option->find('=');
+            std::string name = option->substr(0, eq);
+            std::string value = eq == std::string::npos ? "" : option->substr(eq + 1);
+            OptionResult result = parse_filter_option(name, value, output.filter);
+            if (result == OptionResult::Invalid) {
+                return false;
+            } else if (result == OptionResult::Applied) {
+                continue;
+            }
+
+            if (name == "filter") {
+                std::vector<std::string> names = split_list(value, ',');
+                output.filter_names.insert(output.filter_names.end(), names.begin(), names.end());
+                if (output.filter_names.empty()) {
+                    return false;
+                }
+            } else if (tcp_server && name == "clients") {
+                output.max_clients = std::stoi(value);
+                if (output.max_clients < 1 || output.max_clients > 65536) {
+                    return false;
+                }
+            } else if (tcp_server && name == "buffer") {
+                output.client_buffer = std::stoul(value);
+                if (output.client_buffer < 1024 || output.client_buffer > 64 * 1024 * 1024) {
+                    return false;
+                }
+            } else if (tcp_server && name == "slow") {
+                if (value != "close" && value != "skip") {
+                    return false;
+                }
+                output.skip_slow = value == "skip";
+            } else if (tcp_server) {
+                return false;       // Packing options make no sense on a stream
+            } else if (name == "coalesce") {
+                output.coalesce_bytes = value.empty() ? UDP_MTU_PAYLOAD : std::stoul(value);
+                if (output.coalesce_bytes < 128 || output.coalesce_bytes > 65507) {
+                    return false;
+                }
+            } else if (name == "position_interval" || name == "static_interval") {
+                int seconds = std::stoi(value);
+                if (seconds < 0) {
+                    return false;
+                }
+                (name == "position_interval" ? output.position_interval_s : output.static_interval_s) = seconds;
+            } else if (name == "coalesce_ms") {
+                output.coalesce_ms = std::stoi(value);
+                if (output.coalesce_ms < 1) {
+                    return false;
+                }
+            } else if (name == "spool") {
+                if (value.empty()) {
+                    return false;
+                }
+                output.spool = value;
+            } else if (name == "spool_mb") {
+                output.spool_mb = std::stoul(value);
+                if (output.spool_mb < 1 || output.spool_mb > 65536) {
+                    return false;
+                }
+            } else if (name == "spool_rate") {
+                output.spool_rate = std::stoi(value);
+                if (output.spool_rate < 1 || output.spool_rate > 100000) {
+                    return false;
+                }
+            } else {
+                return false;
+            }
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    return output.port > 0 && output.port <= 65535;
+}
+
+bool same_output(const OutputConfig& a, const OutputConfig& b) {
+    if (a.spec != b.spec || a.any_of.size() != b.any_of.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.any_of.size(); i++) {
+        if (a.any_of[i].spec != b.any_of[i].spec) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Function to load configuration from file
+bool load_config_file(const std::string& filename, Config& config, size_t* rejected) {
+    FILE* file = std::fopen(filename.c_str(), "re");
+    if (file == nullptr) {
+        return false;
+    }
+    
+    size_t ignored = 0;
+    char* buffer = nullptr;
+    size_t buffer_size = 0;
+    ssize_t length;
+    while ((length = getline(&buffer, &buffer_size, file)) != -1) {
+        std::string line(buffer, static_cast<size_t>(length));
+        if (!line.empty() && line.back() == '\n') {
+            line.pop_back();
+        }
+
+        // Skip comments and empty lines
+        if (line.empty() || line[0] == '#') continue;
+        
+        size_t eq_pos = line.find('=');
+        if (eq_pos == std::string::npos) continue;
+        
+        std::string key = line.substr(0, eq_pos);
+        std::string value = line.substr(eq_pos + 1);
+        
+        // Trim whitespace
+        key.erase(0, key.find_first_not_of(" \t"));
+        key.erase(key.find_last_not_of(" \t") + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t") + 1);
+        
+        // A number that doesn't parse rejects the line, not the whole file
+        try {
+            if (key == "ais_ip") config.ais_ip = value;
+            else if (key == "ais_port") config.ais_port = std::stoi(value);
+            else if (key == "mt_ip") config.mt_ip = value;
+            else if (key == "mt_port") config.mt_port = std::stoi(value);
+            else if (key == "notification_user") config.notification_user = value;
+            else if (key == "notification_interval_s") config.notification_interval_s = std::stoi(value);
+            else if (key == "connect_timeout_ms") config.connect_timeout_ms = std::stoi(value);
+            else if (key == "reconnect_min_ms") config.reconnect_min_ms = std::stoi(value);
+            else if (key == "reconnect_max_ms") config.reconnect_max_ms = std::stoi(value);
+            else if (key == "tcp_user_timeout_ms") config.tcp_user_timeout_ms = std::stoi(value);
+            else if (key == "fragment_timeout_ms") config.fragment_timeout_ms = std::stoi(value);
+            else if (key == "dedup_window_ms") config.dedup_window_ms = std::stoi(value);
+            else if (key == "dedup_entries") config.dedup_entries = std::stoi(value);
+            else if (key == "vessel_capacity") config.vessel_capacity = std::stoi(value);
+            else if (key == "vessel_ttl_s") config.vessel_ttl_s = std::stoi(value);
+            else if (key == "query_port") config.query_port = std::stoi(value);
+            else if (key == "query_bind") config.query_bind = value;
+            else if (key == "cpa_alert_nm") config.cpa_alert_nm = std::stod(value);
+            else if (key == "tcpa_alert_min") {
+                double minutes = std::stod(value);
+                if (minutes >= 0 && std::isfinite(minutes)) {
+                    config.tcpa_alert_min = minutes;
+                } else {
+                    log_error() << "Warning: Ignoring invalid tcpa_alert_min '" << value << "' in " << filename;
+                    ignored++;
+                }
+            } else if (key == "cpa_range_nm") {
+                // Sets the grid cell size, so it must be a positive distance
+                double range = std::stod(value);
+                if (range > 0 && std::isfinite(range)) {
+                    config.cpa_range_nm = range;
+                } else {
+                    log_error() << "Warning: Ignoring invalid cpa_range_nm '" << value << "' in " << filename;
+                    ignored++;
+                }
+            } else if (key == "pipeline") {
+                if (value == "on" || value == "off") {
+                    config.pipeline = value == "on";
+                } else {
+                    log_error() << "Warning: Ignoring invalid pipeline '" << value << "' in " << filename;
+                    ignored++;
+                }
+            } else if (key == "pipeline_queue") config.pipeline_queue = std::max(std::stoi(value), 2);
+            else if (key == "pipeline_full") {
+                if (value == "drop" || value == "block") {
+                    config.pipeline_block = value == "block";
+                } else {
+                    log_error() << "Warning: Ignoring invalid pipeline_full '" << value << "' in " << filename;
+                    ignored++;
+                }
+            } else if (key == "cpu_ingest") {
+                std::vector<int> cpus;
+                if (parse_cpu_list(value, cpus)) {
+                    config.cpu_ingest = cpus;
+                } else {
+                    log_error() << "Warning: Ignoring invalid cpu_ingest '" << value << "' in " << filename;
+                    ignored++;
+                }
+            }
+            else if (key == "cpu_decode") config.cpu_decode = std::stoi(value);
+            else if (key == "cpu_egress") config.cpu_egress = std::stoi(value);
+            else if (key == "io_backend") {
+                if (value == "epoll" || value == "io_uring") {
+                    config.io_uring = value == "io_uring";
+                } else {
+                    log_error() << "Warning: Ignoring invalid io_backend '" << value << "' in " << filename;
+                    ignored++;
+                }
+            }
+            else if (key == "capture") config.capture = value;
+            else if (key == "capture_compress") {
+                if (value == "on" || value == "off") {
+                    config.capture_compress = value == "on";
+                } else {
+                    log_error() << "Warning: Ignoring invalid capture_compress '" << value << "' in " << filename;
+                    ignored++;
+                }
+            } else if (key == "replay_speed") {
+                if (value == "max") {
+                    config.replay_speed = 0;
+                } else if (std::stod(value) > 0) {
+                    config.replay_speed = std::stod(value);
+                } else {
+                    log_error() << "Warning: Ignoring invalid replay_speed '" << value << "' in " << filename;
+                    ignored++;
+                }
+            }
+            else if (key == "metrics_port") config.metrics_port = std::stoi(value);
+            else if (key == "metrics_bind") config.metrics_bind = value;
+            else if (key == "metrics_file") config.metrics_file = value;
+            else if (key == "metrics_interval_s") config.metrics_interval_s = std::max(std::stoi(value), 1);
+            else if (key == "config_watch") {
+                if (value == "on" || value == "off") {
+                    config.config_watch = value == "on";
+                } else {
+                    log_error() << "Warning: Ignoring invalid config_watch '" << value << "' in " << filename;
+                    ignored++;
+                }
+            }
+            else if (key == "input") {
+                InputConfig input;
+                if (parse_input_spec(value, input)) {
+                    config.inputs.push_back(input);
+                } else {
+                    log_error() << "Warning: Ignoring invalid input '" << value << "' in " << filename;
+                    ignored++;
+                }
+            } else if (key == "output") {
+                OutputConfig output;
+                if (parse_output_spec(value, output)) {
+                    config.outputs.push_back(output);
+                } else {
+                    log_error() << "Warning: Ignoring invalid output '" << value << "' in " << filename;
+                    ignored++;
+                }
+            } else if (key == "filter") {
+                FilterRule rule;
+                if (parse_filter_spec(value, rule)) {
+                    config.filters.push_back(rule);
+                } else {
+                    log_error() << "Warning: Ignoring invalid filter '" << value << "' in " << filename;
+                    ignored++;
+                }
+            }
+        } catch (const std::exception&) {
+            log_error() << "Warning: Ignoring invalid " << key << " '" << value << "' in " << filename;
+            ignored++;
+        }
+    }
+    std::free(buffer);
+    std::fclose(file);
+
+    // Named rules may be declared after the outputs that use them
+    for (auto it = config.outputs.begin(); it != config.outputs.end();) {
+        it->any_of.clear();
+        std::string missing;
+        for (const auto& name : it->filter_names) {
+            size_t found = 0;
+            for (const auto& rule : config.filters) {
+                if (rule.name == name) {
+                    it->any_of.push_back(rule);
+                    found++;
+                }
+            }
+            if (found == 0) {
+                missing = name;
+            }
+        }
+        if (!missing.empty()) {
+            // Forwarding everything instead would leak what the filter was meant to hold back
+            log_error() << "Warning: Ignoring output '" << it->spec << "' in " << filename << ": unknown filter '"
+                        << missing << "'";
+            ignored++;
+            it = config.outputs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (rejected != nullptr) {
+        *rejected = ignored;
+    }
+    return true;
+}
+
+// Function to load configuration from environment variables
+void load_env_config(Config& config) {
+    const char* env_val;
+    
+    if ((env_val = getenv("AIS_IP")) != nullptr) {
+        config.ais_ip = env_val;
+    }
+    if ((env_val = getenv("AIS_PORT")) != nullptr) {
+        config.ais_port = std::stoi(env_val);
+    }
+    if ((env_val = getenv("MT_IP")) != nullptr) {
+        config.mt_ip = env_val;
+    }
+    if ((env_val = getenv("MT_PORT")) != nullptr) {
+        config.mt_port = std::stoi(env_val);
+    }
+    if ((env_val = getenv("NOTIFICATION_USER")) != nullptr) {
+        config.notification_user = env_val;
+    }
+}
+
+std::vector<InputConfig> effective_inputs(const Config& config) {
+    if (!config.inputs.empty()) {
+        return config.inputs;
+    }
+
+    InputConfig transponder;
+    transponder.type = InputConfig::Type::Tcp;
+    transponder.host = config.ais_ip;
+    transponder.port = config.ais_port;
+    transponder.spec = "tcp:" + config.ais_ip + ":" + std::to_string(config.ais_port);
+    return {transponder};
+}
+
+std::vector<OutputConfig> effective_outputs(const Config& config) {
+    if (!config.outputs.empty()) {
+        return config.outputs;
+    }
+
+    OutputConfig marinetraffic;
+    marinetraffic.host = config.mt_ip;
+    marinetraffic.port = config.mt_port;
+    marinetraffic.spec = "udp:" + config.mt_ip + ":" + std::to_string(config.mt_port);
+    return {marinetraffic};
+}
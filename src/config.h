@@ -0,0 +1,184 @@
+/*
+ * AIS Forwarder Configuration
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Configuration is loaded in priority order: defaults -> config file ->
+ * environment -> command line. The config file uses key=value lines;
+ * `input=`, `output=` and `filter=` may be repeated to declare several data
+ * sources, upstream destinations and the filter rules they use.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// One data source, declared as `input=<type>:<address>`:
+//   input=tcp:192.168.50.37:39150    TCP client to an AIS transponder
+//   input=udp:10110                  UDP NMEA listener on all interfaces
+//   input=udp:127.0.0.1:10110        UDP NMEA listener on one address
+//   input=file:/var/run/ais.fifo     Local file or FIFO
+//   input=serial:/dev/ttyUSB0:38400  Serial or USB-serial port; the baud rate defaults to 38400
+struct InputConfig {
+    enum class Type { Tcp, Udp, File, Replay, Serial };
+
+    Type type = Type::Tcp;
+    std::string host;               // TCP peer or UDP bind address
+    int port = 0;
+    std::string path;               // File, replay and serial inputs
+    int baud = 38400;               // Serial inputs
+    std::string spec;               // Original text, used in log messages
+};
+
+// One filter rule over decoded message fields. A message matches when it
+// satisfies every predicate that is set:
+//   types=1-3,18,19                    Message types
+//   own=include|exclude|only           Our own !AIVDO messages
+//   mmsi=211000000-211999999,244660000 MMSI allow list (single MMSIs or ranges)
+//   not_mmsi=244660000                 MMSI deny list
+//   bbox=<south>,<west>,<north>,<east> Bounding box in decimal degrees; west > east
+//                                      wraps across the antimeridian
+//   min_sog=<knots>                    Minimum speed over ground
+// Messages without a position (static data) are tested against the vessel's
+// last known position and speed.
+struct FilterRule {
+    enum class OwnShip { Include, Exclude, Only };
+
+    std::string name;               // Empty for options given inline on an output
+    std::string spec;               // Original text of a named rule, compared on reload
+    uint32_t types = 0xffffffff;    // Bit n set = message type n (1-27)
+    OwnShip own_ship = OwnShip::Include;
+    std::vector<std::pair<uint32_t, uint32_t>> mmsi_allow;  // Inclusive ranges; empty = any MMSI
+    std::vector<std::pair<uint32_t, uint32_t>> mmsi_deny;
+    bool has_bbox = false;
+    double south = 0, west = 0, north = 0, east = 0;
+    double min_sog = 0;             // Knots, 0 = off
+
+    bool needs_position() const { return has_bbox || min_sog > 0; }
+};
+
+// One upstream UDP destination, or a local TCP server, with an optional
+// filter, declared as `output=udp:<host>:<port>` or
+// `output=tcp-server:[<bind>:]<port>` followed by space-separated options:
+//   output=udp:5.9.207.224:10170                    Everything
+//   output=udp:144.76.105.244:2345 own=exclude      Skip our own !AIVDO
+//   output=udp:127.0.0.1:10110 types=1-3,18,19      Position reports only
+//   output=udp:127.0.0.1:10111 filter=harbour,fast  Messages matching a named rule
+//   output=udp:5.9.207.224:10170 coalesce=1400      Pack sentences into datagrams
+//   output=udp:5.9.207.224:10170 position_interval=30 static_interval=360
+//                                                   One update per ship per interval
+//   output=udp:5.9.207.224:10170 spool=/var/spool/ais/mt.spool spool_mb=64 spool_rate=50
+//                                                   Keep datagrams on disk while unreachable
+//   output=tcp-server:10110 clients=256 buffer=65536 slow=skip
+//                                                   Serve the stream to local TCP clients
+// Filter options given inline form one rule that must always match; named
+// rules (`filter=<name> <predicates>` lines, repeatable per name) are
+// alternatives of which at least one must match as well.
+struct OutputConfig {
+    std::string host;
+    int port = 0;
+    FilterRule filter;              // Inline filter options
+    std::vector<std::string> filter_names;  // From `filter=`, resolved into any_of
+    std::vector<FilterRule> any_of;
+    size_t coalesce_bytes = 0;      // Datagram payload limit when packing sentences, 0 = one per datagram
+    int coalesce_ms = 100;          // Longest a sentence may wait for a packed datagram to fill
+    int position_interval_s = 0;    // Per-MMSI minimum interval between position reports, 0 = off
+    int static_interval_s = 0;      // Same for static data (type 5, type 24 parts), 0 = off
+    std::string spool;              // File holding datagrams while the destination is unreachable
+    size_t spool_mb = 64;           // Spool size; the oldest datagrams are evicted when full
+    int spool_rate = 50;            // Datagrams per second sent from the spool once reachable again
+    bool tcp_server = false;        // Listen for TCP clients at host:port instead of sending datagrams
+    int max_clients = 256;          // TCP server: further connections are refused
+    size_t client_buffer = 65536;   // TCP server: bytes queued per client before it counts as slow
+    bool skip_slow = false;         // TCP server: skip a slow client ahead instead of disconnecting it
+    std::string spec;               // Original text, used in log messages
+};
+
+// Largest UDP payload that fits a 1500-byte Ethernet MTU unfragmented
+// (20-byte IPv4 header, 8-byte UDP header)
+constexpr size_t UDP_MTU_PAYLOAD = 1500 - 28;
+
+// Table sizes. The embedded profile (AIS_FORWARDER_EMBEDDED) sizes them for
+// one receiver's range on a Pi Zero class device; all can still be set.
+#ifdef AIS_FORWARDER_EMBEDDED
+constexpr int DEFAULT_DEDUP_ENTRIES = 4096;
+constexpr int DEFAULT_VESSEL_CAPACITY = 512;
+constexpr int DEFAULT_PIPELINE_QUEUE = 256;
+#else
+constexpr int DEFAULT_DEDUP_ENTRIES = 65536;
+constexpr int DEFAULT_VESSEL_CAPACITY = 16384;
+constexpr int DEFAULT_PIPELINE_QUEUE = 4096;
+#endif
+
+// Configuration structure
+struct Config {
+    std::string ais_ip = "192.168.50.37";     // Default AIS IP
+    int ais_port = 39150;                      // Default AIS port
+    std::string mt_ip = "5.9.207.224";        // Default MarineTraffic IP
+    int mt_port = 10170;                       // Default MarineTraffic port
+    std::string notification_user = "david";   // User for desktop notifications
+    int notification_interval_s = 60;          // Minimum time between notifications with the same title
+    std::string config_file = "";             // Optional config file path
+    int connect_timeout_ms = 3000;             // Give up on a TCP connect attempt after this
+    int reconnect_min_ms = 250;                // First reconnect delay; doubles per failed attempt
+    int reconnect_max_ms = 30000;              // Longest reconnect delay
+    int tcp_user_timeout_ms = 25000;           // TCP_USER_TIMEOUT for input connections (0 = kernel default)
+    int fragment_timeout_ms = 2000;            // Discard incomplete multi-fragment messages after this
+    int dedup_window_ms = 10000;               // Drop repeats of a message within this window (0 = off)
+    int dedup_entries = DEFAULT_DEDUP_ENTRIES; // Size of the duplicate suppression table
+    int vessel_capacity = DEFAULT_VESSEL_CAPACITY; // Vessels tracked in the state table (0 = off)
+    int vessel_ttl_s = 3600;                   // Forget vessels not heard for this long
+    int query_port = 0;                        // Vessel query HTTP server port (0 = off)
+    std::string query_bind = "127.0.0.1";     // Address the query server listens on
+    double cpa_alert_nm = 0;                   // Alert when a target's CPA to own ship is below this (0 = off)
+    double tcpa_alert_min = 15;                // ... and it is reached within this many minutes
+    double cpa_range_nm = 12;                  // Only targets within this range are checked
+    bool pipeline = false;                     // Ingest, decode and egress on separate threads
+    int pipeline_queue = DEFAULT_PIPELINE_QUEUE; // Slots in each queue between pipeline threads
+    bool pipeline_block = false;               // Wait for room in a full queue instead of dropping
+    std::vector<int> cpu_ingest;               // CPUs for the ingest threads, round-robin (empty = any)
+    int cpu_decode = -1;                       // CPU for the decode thread (-1 = any)
+    int cpu_egress = -1;                       // CPU for the egress thread (-1 = any)
+    bool io_uring = false;                     // UDP inputs and outputs use io_uring where the kernel has it
+    std::string capture;                       // Record received sentences to this file (empty = off)
+    bool capture_compress = false;             // zlib-compress capture blocks
+    double replay_speed = 1;                   // Replay inputs run this many times real time (0 = flat out)
+    int metrics_port = 0;                      // Prometheus metrics HTTP port (0 = off)
+    std::string metrics_bind = "127.0.0.1";   // Address the metrics endpoint listens on
+    std::string metrics_file;                  // Also write the metrics to this file (empty = off)
+    int metrics_interval_s = 15;               // How often the metrics file is rewritten
+    bool config_watch = false;                 // Reload when the config file changes, as well as on SIGHUP
+    std::vector<InputConfig> inputs;           // Data sources; defaults to TCP ais_ip:ais_port
+    std::vector<OutputConfig> outputs;         // Destinations; defaults to UDP mt_ip:mt_port
+    std::vector<FilterRule> filters;           // Named filter rules referenced by outputs
+};
+
+// Parse an input declaration such as "tcp:192.168.50.37:39150"
+bool parse_input_spec(const std::string& spec, InputConfig& input);
+
+// Parse an output declaration such as "udp:5.9.207.224:10170 types=1-3,5"
+bool parse_output_spec(const std::string& spec, OutputConfig& output);
+
+// Parse a named filter rule such as "harbour bbox=51.8,4.0,52.0,4.4 min_sog=0.5"
+bool parse_filter_spec(const std::string& spec, FilterRule& rule);
+
+// True if two outputs are declared identically, named filter rules included
+bool same_output(const OutputConfig& a, const OutputConfig& b);
+
+// Load configuration from file; false if it can't be read. Lines that can't
+// be used are reported and skipped, and counted in `rejected` if given.
+bool load_config_file(const std::string& filename, Config& config, size_t* rejected = nullptr);
+
+// Function to load configuration from environment variables
+void load_env_config(Config& config);
+
+// Inputs to open: the declared list, or the single ais_ip/ais_port transponder
+std::vector<InputConfig> effective_inputs(const Config& config);
+
+// Outputs to send to: the declared list, or the single mt_ip/mt_port destination
+std::vector<OutputConfig> effective_outputs(const Config& config);
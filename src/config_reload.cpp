@@ -0,0 +1,281 @@
+/*
+ * Configuration Reload
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "config_reload.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <exception>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+#include "log.h"
+
+namespace {
+
+// Editors and config management tools often write a file in several steps
+constexpr std::chrono::milliseconds SETTLE_DELAY(200);
+
+template <typename T>
+void keep(const char* name, const T& live, T& next, std::vector<std::string>& changed) {
+    if (!(next == live)) {
+        changed.push_back(name);
+        next = live;
+    }
+}
+
+bool same_input_specs(const std::vector<InputConfig>& a, const std::vector<InputConfig>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].spec != b[i].spec) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Settings every input reads; changing one restarts them all
+bool same_input_settings(const Config& a, const Config& b) {
+    return a.connect_timeout_ms == b.connect_timeout_ms && a.reconnect_min_ms == b.reconnect_min_ms &&
+           a.reconnect_max_ms == b.reconnect_max_ms && a.tcp_user_timeout_ms == b.tcp_user_timeout_ms &&
+           a.replay_speed == b.replay_speed;
+}
+
+// Entries of `a` with no counterpart in `b`, each entry of `b` matching once
+template <typename T, typename Same>
+std::vector<T> unmatched(const std::vector<T>& a, const std::vector<T>& b, Same same) {
+    std::vector<bool> used(b.size(), false);
+    std::vector<T> result;
+    for (const auto& entry : a) {
+        bool found = false;
+        for (size_t i = 0; i < b.size() && !found; i++) {
+            if (!used[i] && same(entry, b[i])) {
+                used[i] = true;
+                found = true;
+            }
+        }
+        if (!found) {
+            result.push_back(entry);
+        }
+    }
+    return result;
+}
+
+void split_outputs(const Config& config, std::vector<OutputConfig>& udp, std::vector<OutputConfig>& servers) {
+    for (const auto& output : effective_outputs(config)) {
+        (output.tcp_server ? servers : udp).push_back(output);
+    }
+}
+
+}  // namespace
+
+bool load_snapshot(const std::string& file, const std::function<void(Config&)>& command_line, bool strict,
+                   Config& config) {
+    config = Config();
+    config.config_file = file;
+
+    bool loaded = true;
+    if (!file.empty()) {
+        size_t rejected = 0;
+        loaded = load_config_file(file, config, &rejected);
+        if (strict && !loaded) {
+            log_error() << get_timestamp() << " - Cannot read config file " << file;
+            return false;
+        }
+        if (strict && rejected > 0) {
+            log_error() << get_timestamp() << " - " << rejected << " invalid line" << (rejected == 1 ? "" : "s")
+                        << " in " << file;
+            return false;
+        }
+    }
+
+    if (strict) {
+        try {
+            load_env_config(config);
+        } catch (const std::exception&) {
+            log_error() << get_timestamp() << " - Invalid port in the environment";
+            return false;
+        }
+    } else {
+        load_env_config(config);
+    }
+
+    if (command_line) {
+        command_line(config);
+    }
+    return loaded;
+}
+
+std::vector<std::string> keep_restart_settings(const Config& live, Config& next) {
+    std::vector<std::string> changed;
+    keep("fragment_timeout_ms", live.fragment_timeout_ms, next.fragment_timeout_ms, changed);
+    keep("dedup_window_ms", live.dedup_window_ms, next.dedup_window_ms, changed);
+    keep("dedup_entries", live.dedup_entries, next.dedup_entries, changed);
+    keep("vessel_capacity", live.vessel_capacity, next.vessel_capacity, changed);
+    keep("vessel_ttl_s", live.vessel_ttl_s, next.vessel_ttl_s, changed);
+    keep("query_port", live.query_port, next.query_port, changed);
+    keep("query_bind", live.query_bind, next.query_bind, changed);
+    keep("cpa_alert_nm", live.cpa_alert_nm, next.cpa_alert_nm, changed);
+    keep("tcpa_alert_min", live.tcpa_alert_min, next.tcpa_alert_min, changed);
+    keep("cpa_range_nm", live.cpa_range_nm, next.cpa_range_nm, changed);
+    keep("notification_user", live.notification_user, next.notification_user, changed);
+    keep("pipeline", live.pipeline, next.pipeline, changed);
+    keep("pipeline_queue", live.pipeline_queue, next.pipeline_queue, changed);
+    keep("pipeline_full", live.pipeline_block, next.pipeline_block, changed);
+    keep("cpu_ingest", live.cpu_ingest, next.cpu_ingest, changed);
+    keep("cpu_decode", live.cpu_decode, next.cpu_decode, changed);
+    keep("cpu_egress", live.cpu_egress, next.cpu_egress, changed);
+    keep("io_backend", live.io_uring, next.io_uring, changed);
+    keep("capture", live.capture, next.capture, changed);
+    keep("capture_compress", live.capture_compress, next.capture_compress, changed);
+    keep("metrics_port", live.metrics_port, next.metrics_port, changed);
+    keep("metrics_bind", live.metrics_bind, next.metrics_bind, changed);
+    keep("metrics_file", live.metrics_file, next.metrics_file, changed);
+    keep("metrics_interval_s", live.metrics_interval_s, next.metrics_interval_s, changed);
+    keep("config_watch", live.config_watch, next.config_watch, changed);
+
+    // Pipeline inputs run on threads started with the pipeline
+    if (live.pipeline) {
+        if (!same_input_specs(effective_inputs(live), effective_inputs(next))) {
+            changed.push_back("input");
+            next.inputs = live.inputs;
+            next.ais_ip = live.ais_ip;
+            next.ais_port = live.ais_port;
+        }
+        keep("connect_timeout_ms", live.connect_timeout_ms, next.connect_timeout_ms, changed);
+        keep("reconnect_min_ms", live.reconnect_min_ms, next.reconnect_min_ms, changed);
+        keep("reconnect_max_ms", live.reconnect_max_ms, next.reconnect_max_ms, changed);
+        keep("tcp_user_timeout_ms", live.tcp_user_timeout_ms, next.tcp_user_timeout_ms, changed);
+        keep("replay_speed", live.replay_speed, next.replay_speed, changed);
+    }
+    return changed;
+}
+
+ConfigDiff diff_config(const Config& live, const Config& next) {
+    ConfigDiff diff;
+
+    std::vector<InputConfig> live_inputs = effective_inputs(live);
+    std::vector<InputConfig> next_inputs = effective_inputs(next);
+    if (!same_input_settings(live, next)) {
+        diff.inputs_removed = live_inputs;
+        diff.inputs_added = next_inputs;
+    } else {
+        auto same = [](const InputConfig& a, const InputConfig& b) { return a.spec == b.spec; };
+        diff.inputs_removed = unmatched(live_inputs, next_inputs, same);
+        diff.inputs_added = unmatched(next_inputs, live_inputs, same);
+    }
+
+    // Datagram destinations are addressed by position, so any change
+    // rebuilds the set; each one that stays keeps its queue and spool
+    std::vector<OutputConfig> live_udp, live_servers, next_udp, next_servers;
+    split_outputs(live, live_udp, live_servers);
+    split_outputs(next, next_udp, next_servers);
+    diff.udp_outputs_changed = live_udp.size() != next_udp.size();
+    for (size_t i = 0; i < live_udp.size() && !diff.udp_outputs_changed; i++) {
+        diff.udp_outputs_changed = !same_output(live_udp[i], next_udp[i]);
+    }
+
+    diff.servers_removed = unmatched(live_servers, next_servers, same_output);
+    diff.servers_added = unmatched(next_servers, live_servers, same_output);
+    diff.notification_interval_changed = live.notification_interval_s != next.notification_interval_s;
+    return diff;
+}
+
+void ConfigWatcher::block_signals() {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+}
+
+ConfigWatcher::ConfigWatcher(EventLoop& loop, Callback on_reload) : loop_(loop), on_reload_(std::move(on_reload)) {}
+
+ConfigWatcher::~ConfigWatcher() {
+    loop_.remove_timer(settle_timer_);
+    if (inotify_fd_ != -1) {
+        loop_.remove(inotify_fd_);
+        close(inotify_fd_);
+    }
+    if (signal_fd_ != -1) {
+        loop_.remove(signal_fd_);
+        close(signal_fd_);
+    }
+}
+
+bool ConfigWatcher::start(const std::string& path, bool watch_file) {
+    settle_timer_ = loop_.add_timer(std::chrono::milliseconds(0), std::chrono::milliseconds(0), [this] {
+        on_reload_();
+    });
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGHUP);
+    signal_fd_ = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd_ == -1 || settle_timer_ == -1) {
+        log_error() << get_timestamp() << " - Cannot watch for SIGHUP: " << strerror(errno);
+        return false;
+    }
+    loop_.add(signal_fd_, EPOLLIN, [this](uint32_t) { on_signal(); });
+
+    if (!watch_file || path.empty()) {
+        return true;
+    }
+
+    // Watch the directory: an editor or package manager replacing the file
+    // by renaming over it would leave a watch on the file itself behind
+    size_t slash = path.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    name_ = slash == std::string::npos ? path : path.substr(slash + 1);
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ == -1 || inotify_add_watch(inotify_fd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        log_error() << get_timestamp() << " - Cannot watch " << path << " for changes: " << strerror(errno)
+                    << "; reloading on SIGHUP only";
+        if (inotify_fd_ != -1) {
+            close(inotify_fd_);
+            inotify_fd_ = -1;
+        }
+        return true;
+    }
+    loop_.add(inotify_fd_, EPOLLIN, [this](uint32_t) { on_inotify(); });
+    log_info() << get_timestamp() << " - Watching " << path << " for changes";
+    return true;
+}
+
+void ConfigWatcher::on_signal() {
+    struct signalfd_siginfo info;
+    bool hangup = false;
+    while (read(signal_fd_, &info, sizeof(info)) == static_cast<ssize_t>(sizeof(info))) {
+        hangup = hangup || info.ssi_signo == SIGHUP;
+    }
+    if (hangup) {
+        loop_.arm_timer(settle_timer_, std::chrono::milliseconds(1));
+    }
+}
+
+void ConfigWatcher::on_inotify() {
+    alignas(struct inotify_event) char buffer[4096];
+    bool changed = false;
+    ssize_t n;
+    while ((n = read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t offset = 0; offset < n;) {
+            const auto* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            if (event->len > 0 && name_ == event->name) {
+                changed = true;
+            }
+            offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+        }
+    }
+    if (changed) {
+        // Restarts the delay on each write, so a burst of writes reloads once
+        loop_.arm_timer(settle_timer_, SETTLE_DELAY);
+    }
+}
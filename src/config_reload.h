@@ -0,0 +1,89 @@
+/*
+ * Configuration Reload
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * The running configuration is an immutable snapshot. On SIGHUP, or when
+ * the config file changes with `config_watch=on`, a new snapshot is built
+ * the same way as at startup (see load_snapshot()). A file that can't be
+ * read, or that has a line the loader had to ignore, is rejected and the
+ * running snapshot stays in place.
+ *
+ * keep_restart_settings() carries over the settings that are only read at
+ * startup (pipeline, vessel table, endpoints, capture, ...) and names the
+ * ones the new file changes. diff_config() then works out what is left to
+ * apply: inputs are matched by their spec, so unchanged ones keep their
+ * connections, and outputs by their spec and the text of the named filter
+ * rules they use, so only outputs that changed are recreated.
+ *
+ * ConfigWatcher turns SIGHUP (through a signalfd) and, optionally, inotify
+ * events for the config file into one callback on the event loop thread,
+ * where everything a reload touches lives.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "event_loop.h"
+
+// Build a configuration: defaults -> `file` (if not empty) -> environment
+// -> `command_line`. With `strict`, a file that can't be read or that has
+// rejected lines fails the load; otherwise they are only reported.
+bool load_snapshot(const std::string& file, const std::function<void(Config&)>& command_line, bool strict,
+                   Config& config);
+
+// Copy the settings that only take effect on restart from `live` into
+// `next`; returns the names of those `next` had changed
+std::vector<std::string> keep_restart_settings(const Config& live, Config& next);
+
+// What applying a snapshot changes, after keep_restart_settings()
+struct ConfigDiff {
+    std::vector<InputConfig> inputs_removed;
+    std::vector<InputConfig> inputs_added;
+    bool udp_outputs_changed = false;       // Any UDP destination added, removed, changed or reordered
+    std::vector<OutputConfig> servers_removed;
+    std::vector<OutputConfig> servers_added;
+    bool notification_interval_changed = false;
+
+    bool empty() const {
+        return inputs_removed.empty() && inputs_added.empty() && !udp_outputs_changed && servers_removed.empty() &&
+               servers_added.empty() && !notification_interval_changed;
+    }
+};
+
+ConfigDiff diff_config(const Config& live, const Config& next);
+
+class ConfigWatcher {
+public:
+    using Callback = std::function<void()>;
+
+    // Block SIGHUP in the calling thread so that threads started afterwards
+    // leave it to the signalfd; call before starting any thread
+    static void block_signals();
+
+    ConfigWatcher(EventLoop& loop, Callback on_reload);
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    // Call back on SIGHUP, and on changes to `path` if `watch_file`; false
+    // if SIGHUP can't be watched
+    bool start(const std::string& path, bool watch_file);
+
+private:
+    void on_signal();
+    void on_inotify();
+
+    EventLoop& loop_;
+    Callback on_reload_;
+    int signal_fd_ = -1;
+    int inotify_fd_ = -1;
+    int settle_timer_ = -1;         // Editors write in several steps; reload once they are done
+    std::string name_;              // Config file name within the watched directory
+};
@@ -0,0 +1,45 @@
+/*
+ * Statistics Counter
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * A 64-bit counter written by one thread and readable from any other.
+ * Updates are a plain relaxed load and store, which compile to the same
+ * instructions as a uint64_t increment, so single-threaded code pays
+ * nothing for counters that pipeline mode reads from another thread.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+class Counter {
+public:
+    Counter() = default;
+    Counter(const Counter& other) : value_(other.get()) {}
+    Counter& operator=(const Counter& other) {
+        set(other.get());
+        return *this;
+    }
+
+    uint64_t get() const { return value_.load(std::memory_order_relaxed); }
+    operator uint64_t() const { return get(); }
+
+    // Owning thread only
+    void set(uint64_t value) { value_.store(value, std::memory_order_relaxed); }
+    void add(uint64_t n) { set(get() + n); }
+    Counter& operator=(uint64_t value) {
+        set(value);
+        return *this;
+    }
+    Counter& operator+=(uint64_t n) {
+        add(n);
+        return *this;
+    }
+    void operator++(int) { add(1); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
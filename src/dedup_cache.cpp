@@ -0,0 +1,83 @@
+/*
+ * Duplicate Suppression Cache
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "dedup_cache.h"
+#include "hash.h"
+
+DedupCache::DedupCache(size_t capacity, std::chrono::milliseconds window)
+    : window_ms_(static_cast<uint64_t>(window.count() > 0 ? window.count() : 0)),
+      epoch_(Clock::now()) {
+    size_t size = MAX_PROBE;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    entries_.resize(size);
+    mask_ = size - 1;
+}
+
+uint64_t DedupCache::to_stamp(Clock::time_point now) const {
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - epoch_).count();
+    return ms > 0 ? static_cast<uint64_t>(ms) : 0;
+}
+
+bool DedupCache::seen(std::string_view payload, Clock::time_point now) {
+    if (window_ms_ == 0) {
+        return false;
+    }
+    return seen_hash(hash_bytes(payload), now);
+}
+
+bool DedupCache::seen_hash(uint64_t hash, Clock::time_point now) {
+    if (window_ms_ == 0) {
+        return false;
+    }
+    if (hash == 0) {
+        hash = 1;  // Keep 0 free as the empty marker
+    }
+
+    lookups_++;
+    uint64_t stamp = to_stamp(now);
+    Entry* reuse = nullptr;
+    Entry* oldest = nullptr;
+    uint64_t oldest_age = 0;
+
+    size_t index = static_cast<size_t>(hash) & mask_;
+    for (size_t probe = 0; probe < MAX_PROBE; probe++) {
+        Entry& entry = entries_[(index + probe) & mask_];
+        if (entry.hash == 0) {
+            // End of the chain; nothing further along can match
+            if (reuse == nullptr) {
+                reuse = &entry;
+            }
+            break;
+        }
+
+        uint64_t age = stamp >= entry.stamp ? stamp - entry.stamp : 0;
+        bool live = age < window_ms_;
+        if (entry.hash == hash && live) {
+            hits_++;
+            return true;
+        }
+        if (!live) {
+            if (reuse == nullptr) {
+                reuse = &entry;
+            }
+        } else if (oldest == nullptr || age > oldest_age) {
+            oldest = &entry;
+            oldest_age = age;
+        }
+    }
+
+    if (reuse == nullptr) {
+        // Every probed entry is still live; sacrifice the oldest
+        reuse = oldest;
+        evictions_++;
+    }
+    reuse->hash = hash;
+    reuse->stamp = stamp;
+    return false;
+}
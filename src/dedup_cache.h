@@ -0,0 +1,65 @@
+/*
+ * Duplicate Suppression Cache
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Stations fed by several overlapping receivers see the same AIS message
+ * more than once. This remembers a 64-bit hash of every message payload for
+ * a configurable time window so repeats can be dropped before they are sent
+ * upstream.
+ *
+ * Hashes live in an open-addressing table with linear probing. Entries are
+ * never explicitly deleted: an entry older than the window counts as free
+ * and is reused by the next insert that probes past it. Probing is bounded,
+ * and when no free entry is found within the bound the oldest entry probed
+ * is overwritten, so lookups stay fast at tens of thousands of entries.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+class DedupCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t MAX_PROBE = 16;
+
+    // `capacity` is rounded up to a power of two. A zero window disables the cache.
+    explicit DedupCache(size_t capacity = 65536,
+                        std::chrono::milliseconds window = std::chrono::milliseconds(10000));
+
+    // True if `payload` was already seen within the window; otherwise records it
+    bool seen(std::string_view payload, Clock::time_point now);
+    bool seen_hash(uint64_t hash, Clock::time_point now);
+
+    bool enabled() const { return window_ms_ != 0; }
+    size_t capacity() const { return entries_.size(); }
+
+    uint64_t lookups() const { return lookups_; }
+    uint64_t hits() const { return hits_; }
+    uint64_t evictions() const { return evictions_; }  // Live entries overwritten early
+    double hit_ratio() const { return lookups_ ? static_cast<double>(hits_) / lookups_ : 0.0; }
+
+private:
+    struct Entry {
+        uint64_t hash = 0;      // 0 marks a never-used entry
+        uint64_t stamp = 0;     // Milliseconds since epoch_
+    };
+
+    uint64_t to_stamp(Clock::time_point now) const;
+
+    std::vector<Entry> entries_;
+    size_t mask_;
+    uint64_t window_ms_;
+    Clock::time_point epoch_;
+
+    uint64_t lookups_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t evictions_ = 0;
+};
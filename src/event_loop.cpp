@@ -0,0 +1,143 @@
+/*
+ * Event Loop
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "event_loop.h"
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int MAX_EVENTS = 64;
+
+struct itimerspec make_itimerspec(std::chrono::milliseconds initial, std::chrono::milliseconds interval) {
+    struct itimerspec spec = {};
+    spec.it_value.tv_sec = initial.count() / 1000;
+    spec.it_value.tv_nsec = (initial.count() % 1000) * 1000000;
+    spec.it_interval.tv_sec = interval.count() / 1000;
+    spec.it_interval.tv_nsec = (interval.count() % 1000) * 1000000;
+    return spec;
+}
+
+}  // namespace
+
+EventLoop::EventLoop() : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)) {
+}
+
+EventLoop::~EventLoop() {
+    if (epoll_fd_ != -1) {
+        close(epoll_fd_);
+    }
+}
+
+bool EventLoop::add(int fd, uint32_t events, Handler handler) {
+    if (fd < 0) {
+        return false;
+    }
+
+    struct epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        return false;
+    }
+
+    if (static_cast<size_t>(fd) >= handlers_.size()) {
+        handlers_.resize(fd + 1);
+    }
+    handlers_[fd] = std::move(handler);
+    return true;
+}
+
+bool EventLoop::modify(int fd, uint32_t events) {
+    struct epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = fd;
+    return epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+void EventLoop::remove(int fd) {
+    if (fd < 0) {
+        return;
+    }
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    if (static_cast<size_t>(fd) < handlers_.size()) {
+        handlers_[fd] = nullptr;
+    }
+}
+
+int EventLoop::add_timer(std::chrono::milliseconds initial, std::chrono::milliseconds interval, TimerCallback callback) {
+    int timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer < 0) {
+        return -1;
+    }
+
+    bool added = add(timer, EPOLLIN, [timer, callback = std::move(callback)](uint32_t) {
+        uint64_t expirations;
+        if (read(timer, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+            callback();
+        }
+    });
+    if (!added) {
+        close(timer);
+        return -1;
+    }
+
+    if (initial.count() > 0 && !arm_timer(timer, initial, interval)) {
+        remove_timer(timer);
+        return -1;
+    }
+    return timer;
+}
+
+bool EventLoop::arm_timer(int timer, std::chrono::milliseconds initial, std::chrono::milliseconds interval) {
+    struct itimerspec spec = make_itimerspec(initial, interval);
+    return timerfd_settime(timer, 0, &spec, nullptr) == 0;
+}
+
+void EventLoop::remove_timer(int timer) {
+    if (timer < 0) {
+        return;
+    }
+    remove(timer);
+    close(timer);
+}
+
+bool EventLoop::run_once(int timeout_ms) {
+    struct epoll_event events[MAX_EVENTS];
+    int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout_ms);
+    if (n < 0) {
+        return errno == EINTR;
+    }
+
+    for (int i = 0; i < n; i++) {
+        int fd = events[i].data.fd;
+        // A handler earlier in this batch may have removed this descriptor
+        if (static_cast<size_t>(fd) >= handlers_.size() || !handlers_[fd]) {
+            continue;
+        }
+        // Copy so the handler may safely remove itself
+        Handler handler = handlers_[fd];
+        handler(events[i].events);
+    }
+
+    if (n > 0 && after_dispatch_) {
+        after_dispatch_();
+    }
+    return true;
+}
+
+void EventLoop::run() {
+    running_ = true;
+    while (running_) {
+        if (!run_once(-1)) {
+            break;
+        }
+    }
+}
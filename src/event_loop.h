@@ -0,0 +1,65 @@
+/*
+ * Event Loop
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Single-threaded epoll reactor. File descriptors are registered with a
+ * handler that receives the ready event mask; timers are timerfds
+ * registered the same way, so the loop sleeps in epoll_wait() with no
+ * timeout until a socket or timer is ready and idle CPU stays near zero.
+ *
+ * Handlers run on the loop thread and may add or remove descriptors,
+ * including their own, while being dispatched.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class EventLoop {
+public:
+    using Handler = std::function<void(uint32_t events)>;
+    using TimerCallback = std::function<void()>;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool valid() const { return epoll_fd_ != -1; }
+
+    // Watch `fd` for `events` (EPOLLIN, EPOLLET, ...)
+    bool add(int fd, uint32_t events, Handler handler);
+    bool modify(int fd, uint32_t events);
+    void remove(int fd);
+
+    // Create a timer firing after `initial` and then every `interval`
+    // (zero interval = one-shot). Returns the timer id, or -1 on error.
+    int add_timer(std::chrono::milliseconds initial, std::chrono::milliseconds interval, TimerCallback callback);
+
+    // Re-arm an existing timer; a zero `initial` disarms it
+    bool arm_timer(int timer, std::chrono::milliseconds initial, std::chrono::milliseconds interval = std::chrono::milliseconds(0));
+    void remove_timer(int timer);
+
+    // Run `callback` once after every batch of dispatched events, e.g. to
+    // flush output queued by the handlers in a single system call
+    void set_after_dispatch(std::function<void()> callback) { after_dispatch_ = std::move(callback); }
+
+    // Dispatch ready events, waiting at most `timeout_ms` (-1 = forever)
+    bool run_once(int timeout_ms = -1);
+
+    // Dispatch events until stop() is called
+    void run();
+    void stop() { running_ = false; }
+
+private:
+    int epoll_fd_;
+    bool running_ = false;
+    std::vector<Handler> handlers_;     // Indexed by file descriptor
+    std::function<void()> after_dispatch_;
+};
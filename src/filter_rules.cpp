@@ -0,0 +1,270 @@
+/*
+ * Compiled Filter Rules
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "filter_rules.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+int32_t to_raw_degrees(double degrees) {
+    return static_cast<int32_t>(std::lround(degrees * 600000.0));
+}
+
+size_t sog_bucket(uint16_t sog) {
+    return sog >= AIS_SOG_NOT_AVAILABLE ? 103 : std::min<size_t>(sog / 10, 102);
+}
+
+}  // namespace
+
+CompiledFilter::CompiledFilter(const FilterRule& required, const std::vector<FilterRule>& any_of) {
+    required_ = compile(required);
+    needs_position_ = required.needs_position();
+
+    for (const auto& rule : any_of) {
+        rules_.push_back(compile(rule));
+        needs_position_ |= rule.needs_position();
+    }
+
+    words_ = (rules_.size() + 63) / 64;
+    by_type_.assign(32 * words_, 0);
+    by_origin_.assign(2 * words_, 0);
+    unchecked_.assign(words_, 0);
+    for (size_t r = 0; r < rules_.size(); r++) {
+        uint64_t bit = uint64_t(1) << (r % 64);
+        size_t word = r / 64;
+        for (unsigned type = 0; type < 32; type++) {
+            if ((rules_[r].types >> type) & 1u) {
+                by_type_[type * words_ + word] |= bit;
+            }
+        }
+        for (unsigned own = 0; own < 2; own++) {
+            if ((rules_[r].own_ship >> own) & 1u) {
+                by_origin_[own * words_ + word] |= bit;
+            }
+        }
+        if (rules_[r].checks == 0) {
+            unchecked_[word] |= bit;
+        }
+    }
+
+    by_mmsi_.assign(MMSI_BUCKETS * words_, 0);
+    for (size_t r = 0; r < rules_.size(); r++) {
+        uint64_t bit = uint64_t(1) << (r % 64);
+        size_t word = r / 64;
+        const Rule& rule = rules_[r];
+        if (!(rule.checks & CHECK_ALLOW)) {
+            for (size_t bucket = 0; bucket < MMSI_BUCKETS; bucket++) {
+                by_mmsi_[bucket * words_ + word] |= bit;
+            }
+            continue;
+        }
+        for (uint32_t i = rule.allow_begin; i < rule.allow_end; i++) {
+            for (size_t bucket = ranges_[i].first / 1000000; bucket <= ranges_[i].last / 1000000; bucket++) {
+                by_mmsi_[bucket * words_ + word] |= bit;
+            }
+        }
+    }
+
+    // A rule with a minimum speed is a candidate in every bucket that holds
+    // a speed at or above it
+    by_sog_.assign(SOG_BUCKETS * words_, 0);
+    for (size_t r = 0; r < rules_.size(); r++) {
+        uint64_t bit = uint64_t(1) << (r % 64);
+        bool any_speed = !(rules_[r].checks & CHECK_SOG);
+        for (size_t bucket = 0; bucket < SOG_BUCKETS; bucket++) {
+            bool reachable = bucket == SOG_BUCKETS - 1 ? any_speed
+                           : any_speed || bucket * 10 + 9 >= rules_[r].min_sog;
+            if (reachable) {
+                by_sog_[bucket * words_ + r / 64] |= bit;
+            }
+        }
+    }
+
+    build_grid();
+}
+
+// Index bounding boxes on a grid over their combined extent. Positions off
+// the grid, and messages without one, can only match rules without a box.
+void CompiledFilter::build_grid() {
+    by_cell_.assign((GRID * GRID + 1) * words_, 0);
+
+    bool any = false;
+    int32_t south = 0, north = 0, west = 0, east = 0;
+    for (const auto& rule : rules_) {
+        if (!(rule.checks & CHECK_BBOX)) {
+            continue;
+        }
+        bool wraps = rule.west > rule.east;
+        int32_t rule_west = wraps ? -180 * 600000 : rule.west;
+        int32_t rule_east = wraps ? 180 * 600000 : rule.east;
+        south = any ? std::min(south, rule.south) : rule.south;
+        north = any ? std::max(north, rule.north) : rule.north;
+        west = any ? std::min(west, rule_west) : rule_west;
+        east = any ? std::max(east, rule_east) : rule_east;
+        any = true;
+    }
+    grid_south_ = south;
+    grid_west_ = west;
+    cell_lat_ = (north - south) / static_cast<int32_t>(GRID) + 1;
+    cell_lon_ = (east - west) / static_cast<int32_t>(GRID) + 1;
+
+    for (size_t r = 0; r < rules_.size(); r++) {
+        const Rule& rule = rules_[r];
+        if (!(rule.checks & CHECK_BBOX)) {
+            uint64_t bit = uint64_t(1) << (r % 64);
+            for (size_t cell = 0; cell <= GRID * GRID; cell++) {
+                by_cell_[cell * words_ + r / 64] |= bit;
+            }
+        } else if (rule.west > rule.east) {
+            mark_cells(r, rule.south, rule.north, rule.west, 180 * 600000);
+            mark_cells(r, rule.south, rule.north, -180 * 600000, rule.east);
+        } else {
+            mark_cells(r, rule.south, rule.north, rule.west, rule.east);
+        }
+    }
+}
+
+void CompiledFilter::mark_cells(size_t rule, int32_t south, int32_t north, int32_t west, int32_t east) {
+    uint64_t bit = uint64_t(1) << (rule % 64);
+    int32_t first_row = (south - grid_south_) / cell_lat_;
+    int32_t last_row = (north - grid_south_) / cell_lat_;
+    int32_t first_col = (west - grid_west_) / cell_lon_;
+    int32_t last_col = (east - grid_west_) / cell_lon_;
+    for (int32_t row = first_row; row <= last_row; row++) {
+        for (int32_t col = first_col; col <= last_col; col++) {
+            by_cell_[(static_cast<size_t>(row) * GRID + static_cast<size_t>(col)) * words_ + rule / 64] |= bit;
+        }
+    }
+}
+
+size_t CompiledFilter::cell_of(const FilterFields& fields) const {
+    if (!fields.has_position || fields.lat < grid_south_ || fields.lon < grid_west_) {
+        return GRID * GRID;
+    }
+    uint32_t row = static_cast<uint32_t>(fields.lat - grid_south_) / static_cast<uint32_t>(cell_lat_);
+    uint32_t col = static_cast<uint32_t>(fields.lon - grid_west_) / static_cast<uint32_t>(cell_lon_);
+    if (row >= GRID || col >= GRID) {
+        return GRID * GRID;
+    }
+    return row * GRID + col;
+}
+
+CompiledFilter::Rule CompiledFilter::compile(const FilterRule& rule) {
+    Rule compiled = {};
+    compiled.types = rule.types;
+    compiled.own_ship = rule.own_ship == FilterRule::OwnShip::Include ? 3
+                      : rule.own_ship == FilterRule::OwnShip::Exclude ? 1 : 2;
+
+    if (!rule.mmsi_allow.empty()) {
+        compiled.checks |= CHECK_ALLOW;
+        compiled.allow_begin = add_ranges(rule.mmsi_allow);
+        compiled.allow_end = static_cast<uint32_t>(ranges_.size());
+    }
+    if (!rule.mmsi_deny.empty()) {
+        compiled.checks |= CHECK_DENY;
+        compiled.deny_begin = add_ranges(rule.mmsi_deny);
+        compiled.deny_end = static_cast<uint32_t>(ranges_.size());
+    }
+    if (rule.has_bbox) {
+        compiled.checks |= CHECK_BBOX;
+        compiled.south = to_raw_degrees(rule.south);
+        compiled.north = to_raw_degrees(rule.north);
+        compiled.west = to_raw_degrees(rule.west);
+        compiled.east = to_raw_degrees(rule.east);
+    }
+    if (rule.min_sog > 0) {
+        compiled.checks |= CHECK_SOG;
+        compiled.min_sog = static_cast<uint16_t>(std::lround(rule.min_sog * 10.0));
+    }
+    return compiled;
+}
+
+// Append `ranges` sorted and merged; returns where they start in ranges_
+uint32_t CompiledFilter::add_ranges(std::vector<std::pair<uint32_t, uint32_t>> ranges) {
+    std::sort(ranges.begin(), ranges.end());
+    uint32_t begin = static_cast<uint32_t>(ranges_.size());
+    for (const auto& range : ranges) {
+        if (ranges_.size() > begin && range.first <= ranges_.back().last + 1) {
+            ranges_.back().last = std::max(ranges_.back().last, range.second);
+        } else {
+            ranges_.push_back(Range{range.first, range.second});
+        }
+    }
+    return begin;
+}
+
+bool CompiledFilter::in_ranges(uint32_t mmsi, uint32_t begin, uint32_t end) const {
+    // Last range starting at or below mmsi
+    const Range* first = ranges_.data() + begin;
+    const Range* last = ranges_.data() + end;
+    const Range* after = std::upper_bound(first, last, mmsi,
+                                          [](uint32_t value, const Range& range) { return value < range.first; });
+    return after != first && mmsi <= (after - 1)->last;
+}
+
+bool CompiledFilter::test(const Rule& rule, const FilterFields& fields) const {
+    if (!((rule.types >> fields.type) & 1u) || !((rule.own_ship >> fields.own_ship) & 1u)) {
+        return false;
+    }
+    return rule.checks == 0 || test_checks(rule, fields);
+}
+
+bool CompiledFilter::test_checks(const Rule& rule, const FilterFields& fields) const {
+    if ((rule.checks & CHECK_ALLOW) && !in_ranges(fields.mmsi, rule.allow_begin, rule.allow_end)) {
+        return false;
+    }
+    if ((rule.checks & CHECK_DENY) && in_ranges(fields.mmsi, rule.deny_begin, rule.deny_end)) {
+        return false;
+    }
+    if (rule.checks & CHECK_BBOX) {
+        if (!fields.has_position || fields.lat < rule.south || fields.lat > rule.north) {
+            return false;
+        }
+        bool inside = rule.west <= rule.east ? fields.lon >= rule.west && fields.lon <= rule.east
+                                             : fields.lon >= rule.west || fields.lon <= rule.east;
+        if (!inside) {
+            return false;
+        }
+    }
+    if ((rule.checks & CHECK_SOG) && (fields.sog == AIS_SOG_NOT_AVAILABLE || fields.sog < rule.min_sog)) {
+        return false;
+    }
+    return true;
+}
+
+bool CompiledFilter::matches(const FilterFields& fields) const {
+    if (fields.type >= 32 || !test(required_, fields)) {
+        return false;
+    }
+    if (rules_.empty()) {
+        return true;
+    }
+
+    const uint64_t* type_bits = by_type_.data() + fields.type * words_;
+    const uint64_t* origin_bits = by_origin_.data() + (fields.own_ship ? words_ : 0);
+    const uint64_t* cell_bits = by_cell_.data() + cell_of(fields) * words_;
+    // The field is 30 bits wide; MMSIs past 999999999 share the last bucket
+    size_t mmsi_bucket = std::min<size_t>(fields.mmsi / 1000000, MMSI_BUCKETS - 1);
+    const uint64_t* mmsi_bits = by_mmsi_.data() + mmsi_bucket * words_;
+    const uint64_t* sog_bits = by_sog_.data() + sog_bucket(fields.sog) * words_;
+    for (size_t w = 0; w < words_; w++) {
+        uint64_t candidates = type_bits[w] & origin_bits[w] & cell_bits[w] & mmsi_bits[w] & sog_bits[w];
+        if (candidates & unchecked_[w]) {
+            return true;
+        }
+        while (candidates != 0) {
+            size_t r = w * 64 + static_cast<size_t>(__builtin_ctzll(candidates));
+            if (test_checks(rules_[r], fields)) {
+                return true;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,109 @@
+/*
+ * Compiled Filter Rules
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Turns the filter rules of one output (see FilterRule) into a form that can
+ * be evaluated per message without touching a string: coordinates and speeds
+ * become on-air integer units, MMSI lists become sorted, merged ranges in
+ * one flat array, and each rule becomes a fixed-size record.
+ *
+ * For outputs with many alternative rules, candidate rules are selected by
+ * ANDing precomputed bitsets: one per message type, per own-ship flag, per
+ * cell of a 32x32 grid over the rules' bounding boxes, per million MMSIs and
+ * per knot of speed.
+ * A message then only evaluates the few rules that could match its type,
+ * origin, position and MMSI; rules with no other predicate match as soon as
+ * they are selected.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ais_decoder.h"
+#include "config.h"
+
+// The message fields rules are evaluated against, extracted once per message
+struct FilterFields {
+    uint8_t type = 0;
+    bool own_ship = false;
+    uint32_t mmsi = 0;              // 0 if the message could not be decoded
+    bool has_position = false;
+    int32_t lat = 0;                // 1/10000 minute
+    int32_t lon = 0;
+    uint16_t sog = AIS_SOG_NOT_AVAILABLE;   // 1/10 knot
+};
+
+class CompiledFilter {
+public:
+    // `required` must always match; if `any_of` is not empty, at least one
+    // of its rules must match too
+    CompiledFilter(const FilterRule& required, const std::vector<FilterRule>& any_of);
+
+    bool matches(const FilterFields& fields) const;
+
+    // True if any rule tests position or speed, so the caller must fill them in
+    bool needs_position() const { return needs_position_; }
+    size_t rules() const { return rules_.size() + 1; }
+
+private:
+    static constexpr unsigned GRID = 32;                // Grid rows and columns
+    static constexpr unsigned MMSI_BUCKETS = 1000;      // One per million MMSIs
+    static constexpr unsigned SOG_BUCKETS = 104;        // One per knot up to 102.2, then not available
+
+    enum : uint8_t {
+        CHECK_ALLOW = 1,
+        CHECK_DENY = 2,
+        CHECK_BBOX = 4,
+        CHECK_SOG = 8,
+    };
+
+    struct Rule {
+        uint32_t types;
+        uint8_t own_ship;           // Bit 0: accepts others' messages, bit 1: accepts our own
+        uint8_t checks;             // CHECK_* predicates beyond type and origin
+        uint16_t min_sog;           // 1/10 knot
+        int32_t south;              // 1/10000 minute
+        int32_t north;
+        int32_t west;
+        int32_t east;
+        uint32_t allow_begin;       // MMSI ranges in ranges_
+        uint32_t allow_end;
+        uint32_t deny_begin;
+        uint32_t deny_end;
+    };
+
+    struct Range {
+        uint32_t first;
+        uint32_t last;
+    };
+
+    Rule compile(const FilterRule& rule);
+    uint32_t add_ranges(std::vector<std::pair<uint32_t, uint32_t>> ranges);
+    bool in_ranges(uint32_t mmsi, uint32_t begin, uint32_t end) const;
+    bool test(const Rule& rule, const FilterFields& fields) const;
+    bool test_checks(const Rule& rule, const FilterFields& fields) const;
+    void build_grid();
+    void mark_cells(size_t rule, int32_t south, int32_t north, int32_t west, int32_t east);
+    size_t cell_of(const FilterFields& fields) const;
+
+    Rule required_;
+    std::vector<Rule> rules_;
+    std::vector<Range> ranges_;
+    size_t words_ = 0;                  // 64-bit words per rule bitset
+    std::vector<uint64_t> by_type_;     // words_ per message type 0-31
+    std::vector<uint64_t> by_origin_;   // words_ for others' messages, then for our own
+    std::vector<uint64_t> by_cell_;     // words_ per grid cell, then for no or off-grid position
+    std::vector<uint64_t> by_mmsi_;     // words_ per MMSI bucket
+    std::vector<uint64_t> by_sog_;      // words_ per SOG bucket
+    std::vector<uint64_t> unchecked_;   // Rules with nothing left to test once selected
+    int32_t grid_south_ = 0;            // Grid origin and cell size, 1/10000 minute
+    int32_t grid_west_ = 0;
+    int32_t cell_lat_ = 1;
+    int32_t cell_lon_ = 1;
+    bool needs_position_ = false;
+};
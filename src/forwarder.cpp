@@ -0,0 +1,358 @@
+/*
+ * Forwarding Pipeline
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "forwarder.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+#include "ais_decoder.h"
+#include "hash.h"
+#include "log.h"
+#include "nmea_scan.h"
+#include "notification.h"
+
+namespace {
+
+// `tcp-server:` outputs are served by TcpServer, not sent as datagrams
+std::vector<OutputConfig> udp_outputs(const Config& config) {
+    std::vector<OutputConfig> outputs;
+    for (const auto& output : effective_outputs(config)) {
+        if (!output.tcp_server) {
+            outputs.push_back(output);
+        }
+    }
+    return outputs;
+}
+
+}  // namespace
+
+Forwarder::Forwarder(const Config& config)
+    : reassembler_(64, std::chrono::milliseconds(config.fragment_timeout_ms)),
+      dedup_(config.dedup_entries, std::chrono::milliseconds(config.dedup_window_ms)),
+      output_(std::make_unique<UdpOutput>(udp_outputs(config), config.io_uring)),
+      vessels_(static_cast<size_t>(config.vessel_capacity > 0 ? config.vessel_capacity : 0),
+               std::chrono::seconds(config.vessel_ttl_s)),
+      io_uring_(config.io_uring),
+      needs_position_(output_->needs_position()) {
+    if (!config.capture.empty()) {
+        capture_ = std::make_unique<CaptureWriter>(config.capture, config.capture_compress);
+    }
+    if (config.cpa_alert_nm > 0) {
+        size_t capacity =
+            static_cast<size_t>(config.vessel_capacity > 0 ? config.vessel_capacity : DEFAULT_VESSEL_CAPACITY);
+        collisions_ = std::make_unique<CollisionMonitor>(capacity, config.cpa_alert_nm, config.tcpa_alert_min,
+                                                         config.cpa_range_nm);
+        std::string user = config.notification_user;
+        collisions_->set_alert_handler([this, user](const CpaAlert& alert) {
+            VesselInfo info;
+            long slot = vessels_.find(alert.mmsi);
+            std::string name;
+            if (slot >= 0) {
+                vessels_.get(static_cast<size_t>(slot), info);
+                name = info.shipname;
+                name.erase(name.find_last_not_of(" @") + 1);
+            }
+
+            char text[256];
+            snprintf(text, sizeof(text), "%s%s%u: CPA %.2f nm in %.1f min, now %.1f nm bearing %03.0f",
+                     name.c_str(), name.empty() ? "MMSI " : " / MMSI ", alert.mmsi, alert.cpa_nm, alert.tcpa_min,
+                     alert.range_nm, alert.bearing_deg);
+            log_info() << get_timestamp() << " - Collision alert: " << text;
+
+            // Notifications are rate limited per title; one target's alert
+            // must not hold back another's
+            send_notification("AIS Collision Alert: MMSI " + std::to_string(alert.mmsi), text, user, "critical");
+        });
+    }
+}
+
+void Forwarder::process(std::string_view nmea, Clock::time_point now, uint16_t source) {
+    if (capture_) {
+        capture_->record(nmea, now, source);
+    }
+
+    // Filter out unwanted messages
+    if (nmea.rfind("!AIVDM", 0) != 0 && nmea.rfind("!AIVDO", 0) != 0) {
+        return;
+    }
+
+    // Don't waste uplink bandwidth on corrupt sentences
+    if (!nmea_checksum_valid(nmea)) {
+        checksum_failures_++;
+        return;
+    }
+
+    AivdmSentence header;
+    if (!aivdm_parse(nmea, header)) {
+        malformed_sentences_++;
+        return;
+    }
+
+    // Hold back fragments until the whole message has arrived
+    AisAssembledMessage message;
+    if (reassembler_.add(nmea, header, now, message, source) != FragmentReassembler::Result::Complete) {
+        return;
+    }
+
+    // Another receiver already delivered this message
+    if (dedup_.seen_hash(hash_bytes(message.payload, message.fill_bits), now)) {
+        return;
+    }
+
+    // Decode once for the filters, the rate limiters and the vessel table
+    AisMessage decoded;
+    AisDecodeResult result = ais_decode_payload(message.payload, message.fill_bits, decoded);
+    bool valid = result == AisDecodeResult::Ok;
+    if (valid) {
+        decoded.own_ship = message.own_ship;
+    }
+
+    FilterFields fields;
+    fields.type = static_cast<uint8_t>(ais_payload_type(message.payload));
+    fields.own_ship = message.own_ship;
+    if (valid || result == AisDecodeResult::Unsupported) {
+        fields.mmsi = decoded.mmsi;
+    }
+    if (needs_position_) {
+        // Static data carries no position; use where the vessel was last seen
+        AisPositionFix fix;
+        if (valid && ais_position(decoded, fix)) {
+            fields.has_position = true;
+            fields.lat = fix.lat;
+            fields.lon = fix.lon;
+            fields.sog = fix.sog;
+        } else {
+            fields.has_position = vessels_.position(fields.mmsi, fields.lat, fields.lon, fields.sog);
+        }
+    }
+
+    // Queue NMEA string(s) for every destination that wants this message
+    bool forwarded = false;
+    if (egress_ == nullptr) {
+        forwarded = output_->enqueue(message.sentences, message.fragment_count, fields, valid ? &decoded : nullptr,
+                                    now) > 0;
+    } else {
+        uint64_t selected = output_->select(fields, valid ? &decoded : nullptr, now);
+        forwarded = selected != 0 && egress_->push(message.sentences, message.fragment_count, selected, now);
+    }
+    for (TcpServer* server : servers_) {
+        if (server->select(fields)) {
+            server->send(message.sentences, message.fragment_count);
+            forwarded = true;
+        }
+    }
+    if (forwarded) {
+        sentences_forwarded_ += message.fragment_count;
+    }
+
+    // Keep the live vessel picture up to date
+    if (valid && vessels_.enabled()) {
+        vessels_.update(decoded, message.sentences, message.fragment_count, now);
+    }
+
+    AisPositionFix fix;
+    if (collisions_ && valid && ais_position(decoded, fix)) {
+        collisions_->update(decoded.mmsi, message.own_ship, fix, now);
+    }
+}
+
+void Forwarder::flush(Clock::time_point now) {
+    if (egress_ == nullptr) {
+        output_->flush(now);
+    } else {
+        egress_->commit();
+    }
+    for (TcpServer* server : servers_) {
+        server->flush();
+    }
+}
+
+void Forwarder::add_server(TcpServer* server) {
+    servers_.push_back(server);
+    needs_position_ |= server->needs_position();
+}
+
+void Forwarder::remove_server(TcpServer* server) {
+    servers_.erase(std::remove(servers_.begin(), servers_.end(), server), servers_.end());
+    update_needs_position();
+}
+
+bool Forwarder::reconfigure_outputs(const Config& config) {
+    auto output = std::make_unique<UdpOutput>(udp_outputs(config), io_uring_);
+    output_->flush_all(Clock::now());
+    output->adopt(*output_);
+    if (!output->open()) {
+        return false;
+    }
+    output_ = std::move(output);
+    update_needs_position();
+    return true;
+}
+
+void Forwarder::update_needs_position() {
+    needs_position_ = output_->needs_position();
+    for (const TcpServer* server : servers_) {
+        needs_position_ |= server->needs_position();
+    }
+}
+
+bool Forwarder::next_flush(Clock::time_point& deadline) const {
+    // The egress thread keeps its own packing deadlines
+    return egress_ == nullptr && output_->next_deadline(deadline);
+}
+
+void Forwarder::tick(Clock::time_point now) {
+    // Give up on multi-fragment messages that never completed
+    reassembler_.expire(now);
+    vessels_.expire(now);
+    if (collisions_) {
+        collisions_->expire(now);
+    }
+    if (capture_) {
+        capture_->flush();
+    }
+}
+
+void Forwarder::log_stats() const {
+    log_info() << get_timestamp() << " - Forwarded " << sentences_forwarded_ << " sentences, dropped "
+               << checksum_failures_ << " with bad checksum, " << malformed_sentences_ << " malformed; "
+               << "fragments: " << reassembler_.expired() << " expired, " << reassembler_.evicted()
+               << " evicted, " << reassembler_.dropped() << " dropped; "
+               << "duplicates: " << dedup_.hits() << " of " << dedup_.lookups() << " ("
+               << static_cast<int>(dedup_.hit_ratio() * 100.0 + 0.5) << "%)";
+
+    uint64_t datagrams = 0;
+    for (const auto& destination : output_->destinations()) {
+        datagrams += destination.sent + destination.errors;
+        LogLine line = log_info();
+        line << get_timestamp() << " - Output " << destination.config.spec << ": " << destination.sent << " sent, "
+             << destination.errors << " errors, " << destination.filtered << " filtered";
+        if (destination.config.coalesce_bytes > 0 && destination.sentences > 0) {
+            // Compare bytes on the wire (payload + 28-byte IPv4/UDP header)
+            // with sending each sentence, without its "\r\n", on its own
+            uint64_t packed = destination.bytes + destination.sent * 28;
+            uint64_t unpacked = destination.bytes - destination.sentences * 2 + destination.sentences * 28;
+            uint64_t saved = unpacked > packed ? unpacked - packed : 0;
+            line << "; packed " << destination.sentences << " sentences, " << saved << " of " << unpacked
+                 << " wire bytes saved (" << static_cast<int>(saved * 100.0 / unpacked + 0.5) << "%), latency avg "
+                 << destination.latency_ms / destination.sentences << " ms max " << destination.max_latency_ms << " ms";
+        }
+        if (destination.limiter) {
+            line << "; rate limited " << destination.limiter->positions_suppressed() << " positions, "
+                 << destination.limiter->statics_suppressed() << " static";
+        }
+        if (destination.spool) {
+            const Spool& spool = *destination.spool;
+            line << "; spool " << spool.records() << " datagrams (" << spool.bytes() << " of " << spool.capacity()
+                 << " bytes), " << destination.spooled << " spooled, " << destination.drained << " drained, now "
+                 << destination.drain_rate << "/s, " << spool.evicted() << " evicted";
+        }
+    }
+    for (const TcpServer* server : servers_) {
+        server->log_stats();
+    }
+    if (vessels_.enabled()) {
+        log_info() << get_timestamp() << " - Vessels: " << vessels_.size() << " tracked of " << vessels_.capacity()
+                   << ", " << vessels_.updates() << " updates, " << vessels_.expired() << " expired, "
+                   << vessels_.evicted() << " evicted";
+    }
+    if (collisions_) {
+        log_info() << get_timestamp() << " - Collision monitor: " << collisions_->size() << " targets, own ship "
+                   << (collisions_->own_ship_known() ? "known" : "unknown") << ", " << collisions_->checks()
+                   << " CPA checks, " << collisions_->alerts() << " alerts, " << collisions_->evicted() << " evicted";
+    }
+    if (capture_) {
+        capture_->log_stats();
+    }
+    log_info() << get_timestamp() << " - Output batching: " << datagrams << " datagrams in "
+               << output_->syscalls() << " " << output_->backend() << " calls";
+}
+
+void Forwarder::register_metrics(MetricsRegistry& metrics) const {
+    auto value = [](const uint64_t& count) { return [&count] { return static_cast<double>(count); }; };
+
+    metrics.counter("ais_sentences_forwarded_total", "Sentences forwarded to at least one output", "",
+                    value(sentences_forwarded_));
+    metrics.counter("ais_checksum_failures_total", "AIS sentences dropped with a bad checksum", "",
+                    value(checksum_failures_));
+    metrics.counter("ais_malformed_sentences_total", "AIS sentences dropped as malformed", "",
+                    value(malformed_sentences_));
+    metrics.counter("ais_fragments_discarded_total", "Incomplete multi-fragment messages discarded",
+                    MetricsRegistry::label("reason", "expired"), [this] { return double(reassembler_.expired()); });
+    metrics.counter("ais_fragments_discarded_total", "", MetricsRegistry::label("reason", "evicted"),
+                    [this] { return double(reassembler_.evicted()); });
+    metrics.counter("ais_fragments_discarded_total", "", MetricsRegistry::label("reason", "dropped"),
+                    [this] { return double(reassembler_.dropped()); });
+    metrics.counter("ais_dedup_lookups_total", "Messages checked for duplicates", "",
+                    [this] { return double(dedup_.lookups()); });
+    metrics.counter("ais_duplicates_total", "Messages dropped as duplicates", "",
+                    [this] { return double(dedup_.hits()); });
+
+    for (const auto& destination : output_->destinations()) {
+        std::string labels = MetricsRegistry::label("output", destination.config.spec);
+        metrics.counter("ais_output_datagrams_total", "Datagrams accepted by the kernel", labels, destination.sent);
+        metrics.counter("ais_output_errors_total", "Datagrams the kernel refused", labels, destination.errors);
+        metrics.counter("ais_output_sentences_total", "Sentences carried by the sent datagrams", labels,
+                        destination.sentences);
+        metrics.counter("ais_output_bytes_total", "UDP payload bytes sent", labels, destination.bytes);
+        metrics.counter("ais_output_filtered_total", "Messages rejected by the output's filter", labels,
+                        value(destination.filtered));
+        if (destination.limiter) {
+            const MmsiRateLimiter* limiter = destination.limiter.get();
+            metrics.counter("ais_output_rate_limited_total", "Messages held back by the per-MMSI rate limits",
+                            labels + "," + MetricsRegistry::label("kind", "position"),
+                            [limiter] { return double(limiter->positions_suppressed()); });
+            metrics.counter("ais_output_rate_limited_total", "",
+                            labels + "," + MetricsRegistry::label("kind", "static"),
+                            [limiter] { return double(limiter->statics_suppressed()); });
+        }
+        metrics.histogram("ais_output_latency_seconds",
+                          "Time from receiving a datagram's oldest sentence to the kernel accepting it", labels,
+                          destination.latency);
+        if (destination.spool) {
+            const Spool* spool = destination.spool.get();
+            metrics.gauge("ais_spool_datagrams", "Datagrams waiting in the output's disk spool", labels,
+                          [spool] { return double(spool->records()); });
+            metrics.gauge("ais_spool_bytes", "Bytes used in the output's disk spool", labels,
+                          [spool] { return double(spool->bytes()); });
+            metrics.counter("ais_spool_evicted_total", "Spooled datagrams evicted to make room", labels,
+                            [spool] { return double(spool->evicted()); });
+            metrics.counter("ais_spool_spooled_total", "Datagrams written to the disk spool", labels,
+                            destination.spooled);
+            metrics.counter("ais_spool_drained_total", "Spooled datagrams sent once reachable again", labels,
+                            destination.drained);
+        }
+    }
+    metrics.counter("ais_output_syscalls_total", "System calls made to send datagrams",
+                    MetricsRegistry::label("backend", output_->backend()),
+                    [this] { return double(output_->syscalls()); });
+
+    for (const TcpServer* server : servers_) {
+        server->register_metrics(metrics);
+    }
+    if (vessels_.enabled()) {
+        metrics.gauge("ais_vessels", "Vessels in the state table", "", [this] { return double(vessels_.size()); });
+        metrics.counter("ais_vessel_updates_total", "Vessel state table updates", "",
+                        [this] { return double(vessels_.updates()); });
+        metrics.counter("ais_vessels_removed_total", "Vessels removed from the state table",
+                        MetricsRegistry::label("reason", "expired"), [this] { return double(vessels_.expired()); });
+        metrics.counter("ais_vessels_removed_total", "", MetricsRegistry::label("reason", "evicted"),
+                        [this] { return double(vessels_.evicted()); });
+    }
+    if (collisions_) {
+        const CollisionMonitor* collisions = collisions_.get();
+        metrics.gauge("ais_cpa_targets", "Targets tracked by the collision monitor", "",
+                      [collisions] { return double(collisions->size()); });
+        metrics.counter("ais_cpa_alerts_total", "Collision alerts raised", "",
+                        [collisions] { return double(collisions->alerts()); });
+    }
+    if (capture_) {
+        capture_->register_metrics(metrics);
+    }
+}
@@ -0,0 +1,138 @@
+/*
+ * Forwarding Pipeline
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Takes framed NMEA sentences from any input and forwards the valid AIS
+ * ones upstream:
+ *
+ *   "!AIVDM"/"!AIVDO" filter -> checksum -> header parse
+ *     -> fragment reassembly -> duplicate suppression -> UDP output queue
+ *                                                    \-> TCP server clients
+ *                                                    \-> decode -> vessel table
+ *                                                              \-> collision monitor
+ *
+ * All stages run on the caller's thread with storage allocated up front.
+ * Output is queued and sent in one batch by flush(), which the event loop
+ * calls after each wakeup. With an EgressSink set (pipeline mode), only
+ * the destination choice is made here; the sentences and that choice are
+ * handed to the sink and sent from another thread. TCP servers are always
+ * fed on this thread. With `capture=<path>` every sentence is recorded,
+ * before any filtering, on its way in.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "capture.h"
+#include "collision_monitor.h"
+#include "config.h"
+#include "dedup_cache.h"
+#include "fragment_reassembler.h"
+#include "inputs.h"
+#include "metrics.h"
+#include "tcp_server.h"
+#include "udp_output.h"
+#include "vessel_table.h"
+
+// Receiver of messages ready to send, for sending on another thread
+class EgressSink {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~EgressSink() = default;
+
+    // Hand over one message for the destinations in `selected`; false if
+    // it was dropped
+    virtual bool push(const std::string_view* sentences, size_t count, uint64_t selected, Clock::time_point now) = 0;
+
+    // Make the messages pushed so far visible to the sending thread
+    virtual void commit() = 0;
+};
+
+class Forwarder : public SentenceSink {
+public:
+    explicit Forwarder(const Config& config);
+
+    Forwarder(const Forwarder&) = delete;
+    Forwarder& operator=(const Forwarder&) = delete;
+
+    // Create the upstream socket and open the capture file; false on failure
+    bool open() { return output_->open() && (!capture_ || capture_->open()); }
+
+    // Handle one framed sentence received from input `source` at `now`
+    void process(std::string_view sentence, Clock::time_point now, uint16_t source = 0);
+
+    void on_sentence(std::string_view sentence, Clock::time_point now, uint16_t source) override {
+        process(sentence, now, source);
+    }
+    void on_source_reset(uint16_t source) override { reassembler_.reset(source); }
+
+    // A sentence was received but could not be passed on, so the capture
+    // file will not have it
+    void missed_sentence() {
+        if (capture_) {
+            capture_->missed();
+        }
+    }
+
+    // Send the sentences queued since the last flush, and packed datagrams
+    // that are due
+    void flush(Clock::time_point now);
+
+    // When the next partly filled packed datagram falls due; false if none
+    bool next_flush(Clock::time_point& deadline) const;
+
+    // Hand messages to `egress` instead of sending them on this thread. The
+    // sink then owns the send side of output().
+    void set_egress(EgressSink* egress) { egress_ = egress; }
+    UdpOutput& output() { return *output_; }
+
+    // Also feed `server` (a `tcp-server:` output), flushing it with the rest
+    void add_server(TcpServer* server);
+    void remove_server(TcpServer* server);
+
+    // Replace the UDP destinations with those of `config`; unchanged ones
+    // keep their state (see UdpOutput::adopt()). False, with the current
+    // ones kept, if the new set can't be opened. In pipeline mode the
+    // egress thread must be paused around the call.
+    bool reconfigure_outputs(const Config& config);
+
+    // Periodic housekeeping (fragment, vessel and collision target expiry,
+    // writing out the capture block)
+    void tick(Clock::time_point now);
+
+    const VesselTable& vessels() const { return vessels_; }
+    uint64_t sentences_forwarded() const { return sentences_forwarded_; }
+
+    void log_stats() const;
+
+    // Add the statistics log's counters, and each UDP destination's
+    // latency histogram, to `metrics`
+    void register_metrics(MetricsRegistry& metrics) const;
+
+private:
+    void update_needs_position();
+
+    FragmentReassembler reassembler_;
+    DedupCache dedup_;
+    std::unique_ptr<UdpOutput> output_;
+    VesselTable vessels_;
+    std::unique_ptr<CollisionMonitor> collisions_;  // Null unless CPA alerts are enabled
+    std::unique_ptr<CaptureWriter> capture_;        // Null unless capturing
+    EgressSink* egress_ = nullptr;                  // Null when sending on this thread
+    std::vector<TcpServer*> servers_;
+    bool io_uring_;
+    bool needs_position_;                           // Some output filters on position or speed
+
+    // Forwarding statistics, logged periodically
+    uint64_t sentences_forwarded_ = 0;
+    uint64_t checksum_failures_ = 0;
+    uint64_t malformed_sentences_ = 0;
+};
@@ -0,0 +1,173 @@
+/*
+ * AIVDM Fragment Reassembler
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "fragment_reassembler.h"
+
+#include <cstring>
+
+FragmentReassembler::FragmentReassembler(size_t slots, std::chrono::milliseconds timeout)
+    : slots_(slots > 0 ? slots : 1), timeout_(timeout) {
+}
+
+FragmentReassembler::Result FragmentReassembler::add(std::string_view sentence, const AivdmSentence& header,
+                                                     Clock::time_point now, AisAssembledMessage& out,
+                                                     uint16_t source) {
+    if (header.fragment_count == 1) {
+        out.payload = header.payload;
+        out.fill_bits = header.fill_bits;
+        out.own_ship = header.own_ship;
+        out.fragment_count = 1;
+        out.sentences[0] = sentence;
+        completed_++;
+        return Result::Complete;
+    }
+
+    if (header.fragment_count > AIS_MAX_FRAGMENTS || sentence.size() > AIS_MAX_FRAGMENT_LENGTH) {
+        dropped_++;
+        return Result::Dropped;
+    }
+
+    Slot* slot = find_or_claim(header, source, now);
+    size_t index = header.fragment_number - 1;
+    uint16_t bit = static_cast<uint16_t>(1u << index);
+
+    if (slot->received & bit) {
+        // Fragment seen twice: the sequence id has wrapped around onto a
+        // group that never completed, so start over with this one
+        expired_++;
+        slot->received = 0;
+        slot->first_seen = now;
+    }
+
+    std::memcpy(slot->sentence[index], sentence.data(), sentence.size());
+    slot->length[index] = static_cast<uint8_t>(sentence.size());
+    slot->payload_offset[index] = static_cast<uint8_t>(header.payload.data() - sentence.data());
+    slot->payload_length[index] = static_cast<uint8_t>(header.payload.size());
+    slot->received |= bit;
+    if (header.fragment_number == header.fragment_count) {
+        slot->fill_bits = header.fill_bits;
+    }
+
+    if (slot->received != (1u << slot->fragment_count) - 1) {
+        return Result::Pending;
+    }
+
+    bool ok = assemble(*slot, out);
+    release(*slot);
+    if (!ok) {
+        dropped_++;
+        return Result::Dropped;
+    }
+    completed_++;
+    return Result::Complete;
+}
+
+size_t FragmentReassembler::expire(Clock::time_point now) {
+    if (in_use_ == 0) {
+        return 0;
+    }
+
+    size_t count = 0;
+    for (auto& slot : slots_) {
+        if (slot.in_use && now - slot.first_seen >= timeout_) {
+            release(slot);
+            count++;
+        }
+    }
+    expired_ += count;
+    return count;
+}
+
+void FragmentReassembler::reset() {
+    for (auto& slot : slots_) {
+        slot.in_use = false;
+    }
+    in_use_ = 0;
+}
+
+void FragmentReassembler::reset(uint16_t source) {
+    for (auto& slot : slots_) {
+        if (slot.in_use && slot.source == source) {
+            release(slot);
+        }
+    }
+}
+
+FragmentReassembler::Slot* FragmentReassembler::find_or_claim(const AivdmSentence& header, uint16_t source,
+                                                              Clock::time_point now) {
+    Slot* free_slot = nullptr;
+    Slot* oldest = nullptr;
+
+    for (auto& slot : slots_) {
+        if (!slot.in_use) {
+            if (free_slot == nullptr) {
+                free_slot = &slot;
+            }
+            continue;
+        }
+        if (slot.sequence_id == header.sequence_id && slot.channel == header.channel &&
+            slot.own_ship == header.own_ship && slot.source == source) {
+            if (slot.fragment_count == header.fragment_count) {
+                return &slot;
+            }
+            // Same key but a different message length: the old group is stale
+            expired_++;
+            free_slot = &slot;
+            in_use_--;
+            slot.in_use = false;
+            break;
+        }
+        if (oldest == nullptr || slot.first_seen < oldest->first_seen) {
+            oldest = &slot;
+        }
+    }
+
+    if (free_slot == nullptr) {
+        // Pool exhausted: make room by evicting the oldest incomplete group
+        evicted_++;
+        free_slot = oldest;
+        release(*oldest);
+    }
+
+    free_slot->in_use = true;
+    free_slot->source = source;
+    free_slot->own_ship = header.own_ship;
+    free_slot->channel = header.channel;
+    free_slot->sequence_id = header.sequence_id;
+    free_slot->fragment_count = header.fragment_count;
+    free_slot->fill_bits = 0;
+    free_slot->received = 0;
+    free_slot->first_seen = now;
+    in_use_++;
+    return free_slot;
+}
+
+void FragmentReassembler::release(Slot& slot) {
+    if (slot.in_use) {
+        slot.in_use = false;
+        in_use_--;
+    }
+}
+
+bool FragmentReassembler::assemble(Slot& slot, AisAssembledMessage& out) {
+    size_t total = 0;
+    for (size_t i = 0; i < slot.fragment_count; i++) {
+        size_t len = slot.payload_length[i];
+        if (total + len > sizeof(assembled_)) {
+            return false;
+        }
+        std::memcpy(assembled_ + total, slot.sentence[i] + slot.payload_offset[i], len);
+        total += len;
+        out.sentences[i] = std::string_view(slot.sentence[i], slot.length[i]);
+    }
+
+    out.payload = std::string_view(assembled_, total);
+    out.fill_bits = slot.fill_bits;
+    out.own_ship = slot.own_ship;
+    out.fragment_count = slot.fragment_count;
+    return true;
+}
@@ -0,0 +1,103 @@
+/*
+ * AIVDM Fragment Reassembler
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Long AIS messages (type 5, some type 19/21/24 variants) are split across
+ * two or more !AIVDM sentences that share a sequential message id. This
+ * stitches the fragments back together so later stages see whole messages.
+ *
+ * Fragment groups are keyed by (source, own ship, channel, sequential message
+ * id), where the source identifies the input the fragments arrived on, and are
+ * held in a fixed pool of slots allocated at construction. When the pool is
+ * full the oldest group is evicted, so a noisy or hostile feed cannot grow
+ * memory. Groups that do not complete within the timeout are expired.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "ais_decoder.h"
+
+constexpr size_t AIS_MAX_FRAGMENTS = 5;        // Longest AIS message is five slots
+constexpr size_t AIS_MAX_FRAGMENT_LENGTH = 96; // NMEA 0183 limit is 82, without "\r\n"
+
+// A complete message: the combined payload for decoding and the original
+// sentences for forwarding. Views stay valid until the next call to add().
+struct AisAssembledMessage {
+    std::string_view payload;
+    uint8_t fill_bits = 0;
+    bool own_ship = false;
+    size_t fragment_count = 0;
+    std::string_view sentences[AIS_MAX_FRAGMENTS];
+};
+
+class FragmentReassembler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Result {
+        Complete,   // `out` holds a whole message
+        Pending,    // Fragment stored, waiting for the rest
+        Dropped,    // Fragment rejected (too many fragments or too long)
+    };
+
+    explicit FragmentReassembler(size_t slots = 64,
+                                 std::chrono::milliseconds timeout = std::chrono::milliseconds(2000));
+
+    // Add one parsed sentence from input `source`. Single-fragment sentences
+    // complete immediately without being copied.
+    Result add(std::string_view sentence, const AivdmSentence& header, Clock::time_point now,
+               AisAssembledMessage& out, uint16_t source = 0);
+
+    // Drop groups older than the timeout; returns the number expired
+    size_t expire(Clock::time_point now);
+
+    void reset();
+
+    // Drop the pending groups of one source, e.g. after it reconnects
+    void reset(uint16_t source);
+
+    size_t pending() const { return in_use_; }
+    uint64_t completed() const { return completed_; }
+    uint64_t expired() const { return expired_; }
+    uint64_t evicted() const { return evicted_; }
+    uint64_t dropped() const { return dropped_; }
+
+private:
+    struct Slot {
+        bool in_use = false;
+        uint16_t source = 0;
+        bool own_ship = false;
+        char channel = 0;
+        int8_t sequence_id = -1;
+        uint8_t fragment_count = 0;
+        uint8_t fill_bits = 0;
+        uint16_t received = 0;      // Bit n set once fragment n+1 is stored
+        Clock::time_point first_seen;
+        uint8_t length[AIS_MAX_FRAGMENTS];
+        uint8_t payload_offset[AIS_MAX_FRAGMENTS];
+        uint8_t payload_length[AIS_MAX_FRAGMENTS];
+        char sentence[AIS_MAX_FRAGMENTS][AIS_MAX_FRAGMENT_LENGTH];
+    };
+
+    Slot* find_or_claim(const AivdmSentence& header, uint16_t source, Clock::time_point now);
+    void release(Slot& slot);
+    bool assemble(Slot& slot, AisAssembledMessage& out);
+
+    std::vector<Slot> slots_;
+    std::chrono::milliseconds timeout_;
+    size_t in_use_ = 0;
+    char assembled_[AIS_MAX_PAYLOAD_CHARS];
+
+    uint64_t completed_ = 0;
+    uint64_t expired_ = 0;
+    uint64_t evicted_ = 0;
+    uint64_t dropped_ = 0;
+};
@@ -0,0 +1,48 @@
+/*
+ * Hash Functions
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Small, fast non-cryptographic hashes for the in-memory lookup tables.
+ * Not suitable for anything security related.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// Final avalanche step from SplitMix64; also a good hash for integer keys
+inline uint64_t hash_mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Hash a byte string eight bytes at a time
+inline uint64_t hash_bytes(const char* data, size_t len, uint64_t seed = 0) {
+    const uint64_t k = 0x9E3779B97F4A7C15ULL;
+    uint64_t h = seed ^ (len * k);
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        h = (h ^ hash_mix64(word)) * k;
+    }
+    if (i < len) {
+        uint64_t word = 0;
+        std::memcpy(&word, data + i, len - i);
+        h = (h ^ hash_mix64(word)) * k;
+    }
+    return hash_mix64(h);
+}
+
+inline uint64_t hash_bytes(std::string_view s, uint64_t seed = 0) {
+    return hash_bytes(s.data(), s.size(), seed);
+}
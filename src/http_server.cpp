@@ -0,0 +1,212 @@
+/*
+ * Minimal HTTP Server
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "http_server.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+
+#include "log.h"
+
+namespace {
+
+const auto CLIENT_TIMEOUT = std::chrono::seconds(5);
+const auto ACCEPT_PAUSE = std::chrono::seconds(1);     // Out of descriptors or memory
+
+}  // namespace
+
+std::string http_response(const char* status, const char* content_type, const std::string& body) {
+    std::string response = "HTTP/1.0 ";
+    response += status;
+    response += "\r\nContent-Type: ";
+    response += content_type;
+    response += "\r\nContent-Length: " + std::to_string(body.size());
+    response += "\r\nConnection: close\r\n\r\n";
+    response += body;
+    return response;
+}
+
+HttpServer::HttpServer(EventLoop& loop, size_t max_clients, Handler handler)
+    : loop_(loop), max_clients_(max_clients), handler_(std::move(handler)) {
+}
+
+HttpServer::~HttpServer() {
+    while (!clients_.empty()) {
+        close_client(clients_.begin()->first);
+    }
+    loop_.remove_timer(sweep_timer_);
+    loop_.remove_timer(accept_timer_);
+    if (listen_fd_ != -1) {
+        loop_.remove(listen_fd_);
+        close(listen_fd_);
+    }
+}
+
+bool HttpServer::listen(const std::string& bind, int port, const char* name) {
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, bind.c_str(), &addr.sin_addr) != 1) {
+        log_error() << get_timestamp() << " - Invalid " << name << " address: " << bind;
+        return false;
+    }
+
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ == -1) {
+        log_error() << get_timestamp() << " - Error creating " << name << " socket";
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (::bind(listen_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(listen_fd_, 16) < 0) {
+        log_error() << get_timestamp() << " - Error binding " << name << " to " << bind << ":" << port;
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    loop_.add(listen_fd_, EPOLLIN, [this](uint32_t) { on_accept(); });
+    sweep_timer_ = loop_.add_timer(std::chrono::seconds(1), std::chrono::seconds(1), [this] { sweep(); });
+    accept_timer_ = loop_.add_timer(std::chrono::milliseconds(0), std::chrono::milliseconds(0),
+                                    [this] { loop_.modify(listen_fd_, EPOLLIN); });
+    return true;
+}
+
+void HttpServer::on_accept() {
+    while (true) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                // The connection stays queued; don't wake for it until the pause ends
+                loop_.modify(listen_fd_, 0);
+                loop_.arm_timer(accept_timer_, ACCEPT_PAUSE);
+            }
+            return;     // EAGAIN, or a transient error; try again on the next event
+        }
+        if (clients_.size() >= max_clients_) {
+            close(fd);
+            continue;
+        }
+
+        auto client = std::make_unique<Client>();
+        client->fd = fd;
+        client->accepted = std::chrono::steady_clock::now();
+        clients_[fd] = std::move(client);
+        loop_.add(fd, EPOLLIN | EPOLLRDHUP, [this, fd](uint32_t events) { on_client(fd, events); });
+    }
+}
+
+void HttpServer::on_client(int fd, uint32_t events) {
+    auto it = clients_.find(fd);
+    if (it == clients_.end()) {
+        return;
+    }
+    Client& client = *it->second;
+
+    if (!client.response.empty()) {
+        if (events & (EPOLLERR | EPOLLHUP) || write_pending(client)) {
+            close_client(fd);
+        }
+        return;
+    }
+
+    char buffer[1024];
+    bool read_closed = false;
+    while (true) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            client.request.append(buffer, static_cast<size_t>(n));
+            if (client.request.size() > MAX_REQUEST) {
+                close_client(fd);
+                return;
+            }
+            continue;
+        }
+        if (n == 0) {
+            // e.g. `nc -N`, which shuts down its side after the request;
+            // it is still reading
+            read_closed = true;
+            break;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            close_client(fd);
+            return;
+        }
+        if (errno != EINTR) {
+            break;
+        }
+    }
+
+    // Only the request line matters; wait for the end of the headers, or
+    // settle for the request line once the client has nothing more to send
+    if (client.request.find("\r\n\r\n") == std::string::npos && client.request.find("\n\n") == std::string::npos) {
+        if (!read_closed) {
+            return;
+        }
+        if (client.request.find('\n') == std::string::npos) {
+            close_client(fd);
+            return;
+        }
+    }
+
+    respond(client);
+    if (write_pending(client)) {
+        close_client(fd);
+    } else {
+        loop_.modify(fd, EPOLLOUT);
+    }
+}
+
+void HttpServer::respond(Client& client) {
+    size_t line_end = client.request.find_first_of("\r\n");
+    std::string line = client.request.substr(0, line_end);
+    size_t space = line.find(' ');
+    std::string method = line.substr(0, space);
+    std::string path = space == std::string::npos ? "" : line.substr(space + 1, line.find(' ', space + 1) - space - 1);
+    client.response = handler_(method, path);
+}
+
+// Returns true once the whole response has been written (or writing failed)
+bool HttpServer::write_pending(Client& client) {
+    while (client.written < client.response.size()) {
+        ssize_t n = send(client.fd, client.response.data() + client.written, client.response.size() - client.written,
+                         MSG_NOSIGNAL);
+        if (n > 0) {
+            client.written += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return false;
+        } else {
+            return true;
+        }
+    }
+    return true;
+}
+
+void HttpServer::close_client(int fd) {
+    loop_.remove(fd);
+    close(fd);
+    clients_.erase(fd);
+}
+
+void HttpServer::sweep() {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = clients_.begin(); it != clients_.end();) {
+        int fd = it->first;
+        bool stale = now - it->second->accepted > CLIENT_TIMEOUT;
+        ++it;
+        if (stale) {
+            close_client(fd);
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * Minimal HTTP Server
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * The HTTP/1.0 side shared by the vessel query endpoint and the metrics
+ * exporter, on the event loop: one request per connection, closed after
+ * the response. Clients are limited in number, request size and time, and
+ * responses are written without blocking, so a stuck client cannot affect
+ * forwarding. Running out of descriptors pauses accepting for a second.
+ * The owner supplies the response for each request line.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "event_loop.h"
+
+// A complete response with the given status line ("200 OK"), type and body
+std::string http_response(const char* status, const char* content_type, const std::string& body);
+
+class HttpServer {
+public:
+    static constexpr size_t MAX_REQUEST = 4096;
+
+    // The full response to a request for `path` with `method`
+    using Handler = std::function<std::string(const std::string& method, const std::string& path)>;
+
+    HttpServer(EventLoop& loop, size_t max_clients, Handler handler);
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Listen on bind:port; false on failure, logged as being for `name`
+    bool listen(const std::string& bind, int port, const char* name);
+
+private:
+    struct Client {
+        int fd;
+        std::string request;
+        std::string response;
+        size_t written = 0;
+        std::chrono::steady_clock::time_point accepted;
+    };
+
+    void on_accept();
+    void on_client(int fd, uint32_t events);
+    void respond(Client& client);
+    bool write_pending(Client& client);
+    void close_client(int fd);
+    void sweep();
+
+    EventLoop& loop_;
+    size_t max_clients_;
+    Handler handler_;
+    int listen_fd_ = -1;
+    int sweep_timer_ = -1;
+    int accept_timer_ = -1;         // Re-enables the listener after a pause
+    std::map<int, std::unique_ptr<Client>> clients_;
+};
@@ -0,0 +1,923 @@
+/*
+ * AIS Data Inputs
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "inputs.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/serial.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "notification.h"
+
+namespace {
+
+const auto HEALTH_CHECK_INTERVAL = std::chrono::seconds(5);   // Check every 5 seconds for faster detection
+const auto RETRY_INTERVAL = std::chrono::seconds(10);         // Wait before retrying (no notification spam)
+const auto STABLE_CONNECTION = std::chrono::seconds(10);      // Shorter-lived connections keep backing off
+const auto FILE_POLL_INTERVAL = std::chrono::milliseconds(200);
+const auto SERIAL_RETRY_INTERVAL = std::chrono::seconds(1);    // A replugged USB adapter is back within a second
+constexpr size_t FILE_READ_BUDGET = 256 * 1024;               // Bytes per poll, keeps other inputs responsive
+constexpr unsigned URING_ENTRIES = 8;                         // Submissions: the receive and buffer recycling
+constexpr unsigned URING_BUFFERS = 64;                        // Datagrams in flight before a reap
+constexpr size_t URING_BUFFER_SIZE = 2048;                    // Longer datagrams are truncated
+constexpr size_t REPLAY_BATCH = 1024;                         // Sentences per wakeup, so output keeps up
+
+// Shared by the replay inputs, which may run on different ingest threads
+std::atomic<uint32_t> next_replay_source{0};
+
+// termios constant for a baud rate accepted by parse_input_spec()
+speed_t baud_constant(int baud) {
+    switch (baud) {
+        case 1200: return B1200;
+        case 2400: return B2400;
+        case 4800: return B4800;
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default: return B0;
+    }
+}
+
+// Function to test if connection is still alive
+bool is_connection_alive(int socket_fd) {
+    // Try to send a small amount of data to test the connection
+    // This will fail immediately if the connection is broken
+    char test_byte = 0;
+    ssize_t result = send(socket_fd, &test_byte, 0, MSG_NOSIGNAL);
+
+    if (result < 0) {
+        if (errno == EPIPE || errno == ECONNRESET || errno == ENOTCONN) {
+            return false;  // Connection definitely broken
+        }
+    }
+
+    // Check socket error status
+    int error = 0;
+    socklen_t len = sizeof(error);
+    int retval = getsockopt(socket_fd, SOL_SOCKET, SO_ERROR, &error, &len);
+
+    if (retval != 0 || error != 0) {
+        return false;
+    }
+
+    // Try to peek at data without removing it from the queue
+    char peek_byte;
+    ssize_t peek_result = recv(socket_fd, &peek_byte, 1, MSG_PEEK | MSG_DONTWAIT);
+
+    if (peek_result == 0) {
+        // Connection closed by peer
+        return false;
+    } else if (peek_result < 0) {
+        // Check if it's just no data available (normal) or actual error
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return true;  // No data available, but connection is fine
+        } else if (errno == ECONNRESET || errno == ENOTCONN || errno == EPIPE) {
+            return false;  // Connection broken
+        }
+    }
+
+    return true;  // Data available or connection appears good
+}
+
+// Function to create an AIS socket and start connecting it. The socket is
+// non-blocking, so the connect normally completes later (`in_progress`).
+int connect_to_ais(const std::string& ais_ip, int ais_port, int user_timeout_ms,
+                   const std::string& notification_user, bool& in_progress) {
+    in_progress = false;
+
+    // Define AIS address
+    struct sockaddr_in ais_addr = {};
+    ais_addr.sin_family = AF_INET;
+    ais_addr.sin_port = htons(ais_port);
+    if (inet_pton(AF_INET, ais_ip.c_str(), &ais_addr.sin_addr) != 1) {
+        log_error() << get_timestamp() << " - Invalid AIS address: " << ais_ip;
+        return -1;
+    }
+
+    int ais_sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (ais_sock == -1) {
+        std::string error_msg = "Error creating AIS socket";
+        log_error() << get_timestamp() << " - " << error_msg;
+        send_notification("AIS Socket Error", error_msg, notification_user, "critical");
+        return -1;
+    }
+
+    // Enable TCP keepalive to detect broken connections faster
+    int keepalive = 1;
+    if (setsockopt(ais_sock, SOL_SOCKET, SO_KEEPALIVE, &keepalive, sizeof(keepalive)) < 0) {
+        log_error() << "Warning: Failed to set SO_KEEPALIVE";
+    }
+
+    // Set keepalive parameters for faster detection
+    int keepidle = 10;   // Start keepalive after 10 seconds of inactivity
+    int keepintvl = 5;   // Send keepalive every 5 seconds
+    int keepcnt = 3;     // Give up after 3 failed keepalive attempts
+
+    setsockopt(ais_sock, IPPROTO_TCP, TCP_KEEPIDLE, &keepidle, sizeof(keepidle));
+    setsockopt(ais_sock, IPPROTO_TCP, TCP_KEEPINTVL, &keepintvl, sizeof(keepintvl));
+    setsockopt(ais_sock, IPPROTO_TCP, TCP_KEEPCNT, &keepcnt, sizeof(keepcnt));
+
+    // Fail the connection when sent data (including keepalive probes) stays
+    // unacknowledged this long, rather than after the kernel's ~15 minutes
+    if (user_timeout_ms > 0) {
+        unsigned int user_timeout = static_cast<unsigned int>(user_timeout_ms);
+        setsockopt(ais_sock, IPPROTO_TCP, TCP_USER_TIMEOUT, &user_timeout, sizeof(user_timeout));
+    }
+
+    // Connect to AIS
+    if (connect(ais_sock, (struct sockaddr*)&ais_addr, sizeof(ais_addr)) < 0) {
+        if (errno != EINPROGRESS) {
+            close(ais_sock);
+            return -1;
+        }
+        in_progress = true;
+    }
+
+    return ais_sock;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Input
+
+Input::Input(const InputConfig& input, uint16_t id, EventLoop& loop, SentenceSink& sink, const Config& config)
+    : input_(input), id_(id), loop_(loop), sink_(sink), config_(config) {
+}
+
+Input::~Input() {
+    close_fd();
+}
+
+void Input::deliver(SentenceSink::Clock::time_point now) {
+    std::string_view sentence;
+    while (splitter_.next(sentence)) {
+        sentences_++;
+        bytes_ += sentence.size();
+        sink_.on_sentence(sentence, now, id_);
+    }
+}
+
+void Input::register_metrics(MetricsRegistry& metrics) const {
+    std::string labels = MetricsRegistry::label("input", input_.spec);
+    metrics.counter("ais_input_sentences_total", "Sentences received", labels, sentences_);
+    metrics.counter("ais_input_bytes_total", "Bytes of sentences received, without line endings", labels, bytes_);
+}
+
+void Input::close_fd() {
+    if (fd_ != -1) {
+        loop_.remove(fd_);
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// TcpInput
+
+TcpInput::TcpInput(const InputConfig& input, uint16_t id, EventLoop& loop, SentenceSink& sink, const Config& config)
+    : Input(input, id, loop, sink, config), rng_(std::random_device{}()) {
+}
+
+TcpInput::~TcpInput() {
+    loop_.remove_timer(health_timer_);
+    loop_.remove_timer(reconnect_timer_);
+    loop_.remove_timer(connect_timer_);
+}
+
+void TcpInput::start() {
+    health_timer_ = loop_.add_timer(std::chrono::milliseconds(0), std::chrono::milliseconds(0), [this] { health_check(); });
+    reconnect_timer_ = loop_.add_timer(std::chrono::milliseconds(0), std::chrono::milliseconds(0), [this] { connect(); });
+    connect_timer_ = loop_.add_timer(std::chrono::milliseconds(0), std::chrono::milliseconds(0), [this] {
+        if (connecting_) {
+            connect_failed("timed out");
+        }
+    });
+    connect();
+}
+
+void TcpInput::connect() {
+    std::string address = input_.host + ":" + std::to_string(input_.port);
+    log_info() << get_timestamp() << " - Attempting to connect to AIS transponder at " << address << "...";
+
+    bool in_progress = false;
+    fd_ = connect_to_ais(input_.host, input_.port, config_.tcp_user_timeout_ms, config_.notification_user, in_progress);
+    if (fd_ == -1) {
+        connect_failed(std::strerror(errno));
+        return;
+    }
+
+    if (!in_progress) {
+        loop_.add(fd_, EPOLLIN | EPOLLRDHUP | EPOLLET, [this](uint32_t events) { on_event(events); });
+        connected();
+        return;
+    }
+
+    // Wait for the handshake without blocking the other inputs
+    connecting_ = true;
+    loop_.add(fd_, EPOLLOUT | EPOLLRDHUP, [this](uint32_t events) { on_connect_event(events); });
+    loop_.arm_timer(connect_timer_, std::chrono::milliseconds(config_.connect_timeout_ms));
+}
+
+void TcpInput::on_connect_event(uint32_t) {
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(fd_, SOL_SOCKET, SO_ERROR, &error, &len) != 0) {
+        error = errno;
+    }
+    if (error != 0) {
+        connect_failed(std::strerror(error));
+        return;
+    }
+
+    connecting_ = false;
+    loop_.arm_timer(connect_timer_, std::chrono::milliseconds(0));
+
+    // Switch to the data handler; the handler table is keyed by descriptor
+    int fd = fd_;
+    loop_.remove(fd);
+    loop_.add(fd, EPOLLIN | EPOLLRDHUP | EPOLLET, [this](uint32_t events) { on_event(events); });
+    connected();
+}
+
+void TcpInput::connected() {
+    std::string address = input_.host + ":" + std::to_string(input_.port);
+    std::string success_msg = "Successfully connected to AIS transponder at " + address;
+    log_info() << get_timestamp() << " - " << success_msg;
+
+    // Only send notification if we had a previous connection (reconnection)
+    // or if this is the first successful connection after failed attempts
+    if (was_connected_ || connection_lost_notified_) {
+        send_notification("AIS Connection Restored", success_msg, config_.notification_user, "normal");
+    } else {
+        // First time connecting since service start
+        send_notification("AIS Forwarder Started", success_msg, config_.notification_user, "normal");
+    }
+
+    // Reconnect latency: from detecting the loss to data flowing again
+    connected_at_ = std::chrono::steady_clock::now();
+    if (lost_) {
+        auto gap = connected_at_ - lost_at_;
+        reconnects_++;
+        reconnect_latency_.observe(gap);
+        reconnect_last_ms_ = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(gap).count());
+        if (reconnect_last_ms_ > reconnect_max_ms_) {
+            reconnect_max_ms_ = reconnect_last_ms_.get();
+        }
+        lost_ = false;
+    }
+
+    was_connected_ = true;
+    connection_lost_notified_ = false;  // Reset the notification flag
+    splitter_.reset();  // Clear any partial sentence from the previous connection
+
+    loop_.arm_timer(health_timer_, HEALTH_CHECK_INTERVAL, HEALTH_CHECK_INTERVAL);
+}
+
+void TcpInput::connect_failed(const std::string& reason) {
+    connecting_ = false;
+    loop_.arm_timer(connect_timer_, std::chrono::milliseconds(0));
+    close_fd();
+
+    std::string address = input_.host + ":" + std::to_string(input_.port);
+    log_error() << get_timestamp() << " - Connection to AIS transponder at " << address << " failed: " << reason;
+
+    // Connection failed
+    if (was_connected_ && !connection_lost_notified_) {
+        // We had a connection before and haven't notified about the loss yet
+        std::string error_msg = "Failed to reconnect to AIS transponder at " + address;
+        send_notification("AIS Connection Failed", error_msg, config_.notification_user, "critical");
+        connection_lost_notified_ = true;
+    }
+    schedule_reconnect();
+}
+
+void TcpInput::schedule_reconnect() {
+    // Exponential backoff from reconnect_min_ms, capped at reconnect_max_ms,
+    // with "equal jitter" (half fixed, half random) so several forwarders
+    // restarting together don't reconnect in lockstep
+    int64_t delay = config_.reconnect_min_ms;
+    for (unsigned i = 0; i < attempts_ && delay < config_.reconnect_max_ms; i++) {
+        delay *= 2;
+    }
+    if (delay > config_.reconnect_max_ms) {
+        delay = config_.reconnect_max_ms;
+    }
+    std::uniform_int_distribution<int64_t> jitter(0, delay / 2);
+    delay = delay - delay / 2 + jitter(rng_);
+    attempts_++;
+
+    loop_.arm_timer(reconnect_timer_, std::chrono::milliseconds(std::max<int64_t>(delay, 1)));
+}
+
+void TcpInput::on_event(uint32_t events) {
+    if (events & EPOLLIN) {
+        // Edge-triggered: read until the socket is empty
+        while (fd_ != -1) {
+            char* read_ptr = splitter_.write_ptr();
+            ssize_t bytes_received = recv(fd_, read_ptr, splitter_.write_space(), 0);
+
+            if (bytes_received > 0) {
+                splitter_.commit(static_cast<size_t>(bytes_received));
+                deliver(SentenceSink::Clock::now());
+            } else if (bytes_received == 0) {
+                connection_lost("AIS Connection Closed", "AIS connection closed by remote host");
+                return;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else if (errno != EINTR) {
+                connection_lost("AIS Connection Lost", "Error reading from AIS socket - connection may be lost");
+                return;
+            }
+        }
+    }
+
+    if (fd_ != -1 && (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+        connection_lost("AIS Connection Closed", "AIS connection closed by remote host");
+    }
+}
+
+void TcpInput::health_check() {
+    if (fd_ != -1 && !is_connection_alive(fd_)) {
+        connection_lost("AIS Connection Lost", "AIS connection health check failed - connection lost");
+    }
+}
+
+void TcpInput::connection_lost(const std::string& title, const std::string& error_msg) {
+    log_error() << get_timestamp() << " - " << error_msg << " (" << input_.spec << ")";
+
+    // Send notification only once when connection is lost
+    if (!connection_lost_notified_) {
+        send_notification(title, error_msg, config_.notification_user, "critical");
+        connection_lost_notified_ = true;
+    }
+
+    close_fd();
+    loop_.arm_timer(health_timer_, std::chrono::milliseconds(0));
+    sink_.on_source_reset(id_);
+
+    if (!lost_) {
+        lost_ = true;
+        lost_at_ = std::chrono::steady_clock::now();
+    }
+
+    // A connection that held up starts a fresh backoff sequence and is
+    // retried straight away; one that dropped quickly keeps backing off
+    if (std::chrono::steady_clock::now() - connected_at_ >= STABLE_CONNECTION) {
+        attempts_ = 0;
+        connect();
+    } else {
+        schedule_reconnect();
+    }
+}
+
+void TcpInput::log_stats() const {
+    LogLine line = log_info();
+    line << get_timestamp() << " - Input " << input_.spec << ": " << reconnects_ << " reconnects";
+    if (reconnects_ > 0) {
+        line << ", reconnect latency last " << reconnect_last_ms_ << " ms avg "
+             << reconnect_latency_.sum_ns() / 1000000 / reconnects_ << " ms max " << reconnect_max_ms_ << " ms";
+    }
+}
+
+void TcpInput::register_metrics(MetricsRegistry& metrics) const {
+    Input::register_metrics(metrics);
+    std::string labels = MetricsRegistry::label("input", input_.spec);
+    metrics.counter("ais_input_reconnects_total", "Connections re-established after a loss", labels, reconnects_);
+    metrics.histogram("ais_input_reconnect_seconds", "Time from losing a TCP input's connection to having it back",
+                      labels, reconnect_latency_);
+}
+
+// ---------------------------------------------------------------------------
+// UdpInput
+
+UdpInput::~UdpInput() {
+    loop_.remove_timer(retry_timer_);
+    if (ring_) {
+        loop_.remove(ring_->fd());
+    }
+}
+
+void UdpInput::start() {
+    retry_timer_ = loop_.add_timer(std::chrono::milliseconds(0), std::chrono::milliseconds(0), [this] {
+        if (!open_socket()) {
+            loop_.arm_timer(retry_timer_, RETRY_INTERVAL);
+        }
+    });
+    if (!open_socket()) {
+        loop_.arm_timer(retry_timer_, RETRY_INTERVAL);
+    }
+}
+
+bool UdpInput::open_socket() {
+    fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ == -1) {
+        log_error() << get_timestamp() << " - Error creating UDP input socket for " << input_.spec;
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(input_.port);
+    inet_pton(AF_INET, input_.host.c_str(), &addr.sin_addr);
+
+    if (bind(fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        (!(config_.io_uring && start_uring()) &&
+         !loop_.add(fd_, EPOLLIN | EPOLLET, [this](uint32_t events) { on_event(events); }))) {
+        log_error() << get_timestamp() << " - Failed to listen for NMEA on " << input_.spec << ": "
+                    << strerror(errno);
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    log_info() << get_timestamp() << " - Listening for NMEA on " << input_.spec << (ring_ ? " (io_uring)" : "");
+    return true;
+}
+
+// Arm one multishot receive; every datagram then completes into a provided
+// buffer, and a wakeup costs one submission to recycle the buffers it used
+bool UdpInput::start_uring() {
+    auto ring = std::make_unique<IoUring>();
+    if (!ring->init(URING_ENTRIES, URING_BUFFERS * 2) ||
+        !ring->provide_buffers(0, URING_BUFFERS, URING_BUFFER_SIZE) || !ring->prep_recv_multishot(fd_, 0, 0) ||
+        ring->submit() < 0 || !loop_.add(ring->fd(), EPOLLIN, [this](uint32_t) { on_uring_event(); })) {
+        log_error() << get_timestamp() << " - io_uring unavailable for " << input_.spec << " ("
+                    << (ring->error().empty() ? strerror(errno) : ring->error()) << "), using epoll";
+        return false;
+    }
+    ring_ = std::move(ring);
+    return true;
+}
+
+void UdpInput::on_uring_event() {
+    auto now = SentenceSink::Clock::now();
+    bool rearm = false;
+    bool unsupported = false;
+
+    IoUring::Completion completion;
+    while (ring_->next_completion(completion)) {
+        if (completion.result > 0 && completion.buffer >= 0) {
+            receive(ring_->buffer(completion.buffer), static_cast<size_t>(completion.result), now);
+        }
+        if (completion.buffer >= 0) {
+            ring_->recycle_buffer(completion.buffer);
+        }
+        if (!completion.more) {
+            // Out of buffers ends a multishot receive; the data waits in the socket
+            rearm = true;
+            unsupported |= completion.result == -EINVAL;    // No multishot receive before Linux 6.0
+        }
+    }
+
+    if (unsupported) {
+        log_error() << get_timestamp() << " - io_uring multishot receive unsupported for " << input_.spec
+                    << ", using epoll";
+        loop_.remove(ring_->fd());
+        ring_.reset();
+        if (loop_.add(fd_, EPOLLIN | EPOLLET, [this](uint32_t events) { on_event(events); })) {
+            on_event(EPOLLIN);
+        }
+        return;
+    }
+    if (rearm) {
+        ring_->prep_recv_multishot(fd_, 0, 0);
+    }
+    ring_->submit();
+}
+
+void UdpInput::receive(const char* data, size_t length, SentenceSink::Clock::time_point now) {
+    while (length > 0) {
+        // Leave room to terminate a datagram that lacks a line ending
+        char* write_ptr = splitter_.write_ptr();
+        size_t n = std::min(length, splitter_.write_space() - 1);
+        std::memcpy(write_ptr, data, n);
+        data += n;
+        length -= n;
+        if (length == 0 && write_ptr[n - 1] != '\n') {
+            write_ptr[n++] = '\n';
+        }
+        splitter_.commit(n);
+        deliver(now);
+    }
+}
+
+void UdpInput::on_event(uint32_t events) {
+    if (!(events & EPOLLIN)) {
+        return;
+    }
+
+    for (;;) {
+        // Leave room to terminate a datagram that lacks a line ending
+        char* read_ptr = splitter_.write_ptr();
+        ssize_t n = recv(fd_, read_ptr, splitter_.write_space() - 1, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;  // EAGAIN, or a transient error we can do nothing about
+        }
+        if (n == 0) {
+            continue;
+        }
+        if (read_ptr[n - 1] != '\n') {
+            read_ptr[n++] = '\n';
+        }
+        splitter_.commit(static_cast<size_t>(n));
+        deliver(SentenceSink::Clock::now());
+    }
+}
+
+// ---------------------------------------------------------------------------
+// FileInput
+
+FileInput::~FileInput() {
+    loop_.remove_timer(timer_);
+}
+
+void FileInput::start() {
+    timer_ = loop_.add_timer(std::chrono::milliseconds(0), std::chrono::milliseconds(0), [this] {
+        if (fd_ == -1) {
+            reopen();
+        } else {
+            drain();
+        }
+    });
+    reopen();
+}
+
+bool FileInput::open_file() {
+    fd_ = open(input_.path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd_ == -1) {
+        log_error() << get_timestamp() << " - Cannot open input " << input_.spec << ": " << strerror(errno);
+        return false;
+    }
+
+    splitter_.reset();
+    polled_ = false;
+    if (!loop_.add(fd_, EPOLLIN | EPOLLET, [this](uint32_t) { drain(); })) {
+        if (errno != EPERM) {
+            log_error() << get_timestamp() << " - Cannot watch input " << input_.spec << ": " << strerror(errno);
+            close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        // Regular files are always "ready" and can't be used with epoll
+        polled_ = true;
+        loop_.arm_timer(timer_, FILE_POLL_INTERVAL, FILE_POLL_INTERVAL);
+    }
+
+    log_info() << get_timestamp() << " - Reading NMEA from " << input_.spec;
+    return true;
+}
+
+void FileInput::reopen() {
+    if (!open_file()) {
+        loop_.arm_timer(timer_, RETRY_INTERVAL);
+    } else if (polled_) {
+        drain();
+    }
+    // Watched descriptors that are already readable get an event on registration
+}
+
+void FileInput::drain() {
+    size_t budget = FILE_READ_BUDGET;
+    while (fd_ != -1) {
+        ssize_t n = splitter_.fill(fd_);
+        if (n > 0) {
+            deliver(SentenceSink::Clock::now());
+            budget = budget > static_cast<size_t>(n) ? budget - n : 0;
+            if (budget == 0 && polled_) {
+                return;  // Continue on the next poll
+            }
+        } else if (n == 0) {
+            if (!polled_) {
+                // The FIFO writer went away; reopen to wait for the next one
+                close_fd();
+                sink_.on_source_reset(id_);
+                reopen();
+            }
+            return;  // Regular file: wait for it to grow
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return;
+        } else if (errno != EINTR) {
+            log_error() << get_timestamp() << " - Error reading input " << input_.spec << ": " << strerror(errno);
+            close_fd();
+            sink_.on_source_reset(id_);
+            loop_.arm_timer(timer_, RETRY_INTERVAL);
+            return;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// SerialInput
+
+SerialInput::SerialInput(const InputConfig& input, uint16_t id, EventLoop& loop, SentenceSink& sink,
+                         const Config& config)
+    : Input(input, id, loop, sink, config) {
+}
+
+SerialInput::~SerialInput() {
+    loop_.remove_timer(retry_timer_);
+}
+
+void SerialInput::start() {
+    retry_timer_ = loop_.add_timer(std::chrono::milliseconds(0), std::chrono::milliseconds(0), [this] { reopen(); });
+    reopen();
+}
+
+bool SerialInput::open_device() {
+    std::string error;
+    fd_ = open(input_.path.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd_ == -1) {
+        error = strerror(errno);
+    } else if (!configure(error) ||
+               !loop_.add(fd_, EPOLLIN | EPOLLET, [this](uint32_t events) { on_event(events); })) {
+        if (error.empty()) {
+            error = strerror(errno);
+        }
+        close(fd_);
+        fd_ = -1;
+    }
+
+    if (fd_ == -1) {
+        if (!open_failure_logged_) {
+            log_error() << get_timestamp() << " - Cannot open input " << input_.spec << ": " << error
+                        << "; retrying every " << SERIAL_RETRY_INTERVAL.count() << " s";
+            open_failure_logged_ = true;
+        }
+        return false;
+    }
+
+    open_failure_logged_ = false;
+    splitter_.reset();
+    std::string message = "Reading NMEA from " + input_.spec + " at " + std::to_string(input_.baud) + " baud";
+    log_info() << get_timestamp() << " - " << message << (low_latency_ ? ", low latency mode" : "");
+    if (was_open_) {
+        reopens_++;
+        send_notification("AIS Serial Device Restored", message, config_.notification_user, "normal");
+    }
+    was_open_ = true;
+    lost_notified_ = false;
+    return true;
+}
+
+bool SerialInput::configure(std::string& error) {
+    struct termios tty;
+    if (tcgetattr(fd_, &tty) != 0) {
+        error = std::string("not a terminal: ") + strerror(errno);
+        return false;
+    }
+
+    // Raw 8N1, no flow control, no echo or line editing. VMIN=1/VTIME=0:
+    // epoll reports the device readable as soon as a byte is buffered (a
+    // larger VMIN delays that; VTIME only applies to blocking reads).
+    cfmakeraw(&tty);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tty.c_iflag &= ~(IXON | IXOFF | IXANY);
+    tty.c_cc[VMIN] = 1;
+    tty.c_cc[VTIME] = 0;
+    speed_t speed = baud_constant(input_.baud);
+    if (cfsetispeed(&tty, speed) != 0 || cfsetospeed(&tty, speed) != 0 || tcsetattr(fd_, TCSANOW, &tty) != 0) {
+        error = std::string("cannot set ") + std::to_string(input_.baud) + " baud raw mode: " + strerror(errno);
+        return false;
+    }
+
+    // USB-serial adapters otherwise hold received bytes for up to 16 ms
+    // (FTDI latency timer) before handing them over. Ptys and some
+    // drivers have no such setting, which is fine.
+    struct serial_struct serial;
+    low_latency_ = false;
+    if (ioctl(fd_, TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        low_latency_ = ioctl(fd_, TIOCSSERIAL, &serial) == 0;
+    }
+
+    // Whatever queued up before we opened the port is stale
+    tcflush(fd_, TCIFLUSH);
+    return true;
+}
+
+void SerialInput::reopen() {
+    if (fd_ == -1 && !open_device()) {
+        loop_.arm_timer(retry_timer_, SERIAL_RETRY_INTERVAL);
+    }
+    // A device that already has data gets an event on registration
+}
+
+void SerialInput::on_event(uint32_t events) {
+    if (events & EPOLLIN) {
+        while (fd_ != -1) {
+            ssize_t n = splitter_.fill(fd_);
+            if (n > 0) {
+                deliver(SentenceSink::Clock::now());
+            } else if (n == 0) {
+                device_lost("hung up");     // USB adapter unplugged
+                return;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else if (errno != EINTR) {
+                device_lost(strerror(errno));
+                return;
+            }
+        }
+    }
+
+    if (fd_ != -1 && (events & (EPOLLHUP | EPOLLERR))) {
+        device_lost("hung up");
+    }
+}
+
+void SerialInput::device_lost(const std::string& reason) {
+    std::string message = "Serial input " + input_.spec + " lost: " + reason;
+    log_error() << get_timestamp() << " - " << message;
+    if (!lost_notified_) {
+        send_notification("AIS Serial Device Lost", message, config_.notification_user, "critical");
+        lost_notified_ = true;
+    }
+
+    close_fd();
+    sink_.on_source_reset(id_);
+    loop_.arm_timer(retry_timer_, SERIAL_RETRY_INTERVAL);
+}
+
+void SerialInput::log_stats() const {
+    log_info() << get_timestamp() << " - Input " << input_.spec << ": " << sentences_ << " sentences, " << reopens_
+               << " reopens" << (fd_ == -1 ? ", device missing" : "");
+}
+
+void SerialInput::register_metrics(MetricsRegistry& metrics) const {
+    Input::register_metrics(metrics);
+    metrics.counter("ais_input_reconnects_total", "Connections re-established after a loss",
+                    MetricsRegistry::label("input", input_.spec), reopens_);
+}
+
+// ---------------------------------------------------------------------------
+// ReplayInput
+
+ReplayInput::~ReplayInput() {
+    loop_.remove_timer(timer_);
+    if (ready_fd_ != -1) {
+        loop_.remove(ready_fd_);
+        close(ready_fd_);
+    }
+}
+
+void ReplayInput::start() {
+    timer_ = loop_.add_timer(std::chrono::milliseconds(0), std::chrono::milliseconds(0), [this] { on_timer(); });
+    open_capture();
+}
+
+void ReplayInput::open_capture() {
+    if (!reader_.open(input_.path)) {
+        log_error() << get_timestamp() << " - Cannot open input " << input_.spec << ": " << reader_.error();
+        loop_.arm_timer(timer_, RETRY_INTERVAL);
+        return;
+    }
+    opened_ = true;
+    started_ = SentenceSink::Clock::now();
+    have_pending_ = reader_.next(pending_);
+    first_ns_ = pending_.ns;
+
+    {
+        LogLine line = log_info();
+        line << get_timestamp() << " - Replaying " << input_.spec << " (" << reader_.size() << " bytes) ";
+        if (config_.replay_speed > 0) {
+            line << "at " << config_.replay_speed << "x";
+        } else {
+            line << "as fast as possible";
+        }
+    }
+    if (config_.replay_speed > 0) {
+        on_timer();
+        return;
+    }
+
+    // Level-triggered and never cleared, so the loop comes back for the next
+    // batch after flushing the outputs
+    ready_fd_ = eventfd(1, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (ready_fd_ == -1 || !loop_.add(ready_fd_, EPOLLIN, [this](uint32_t) { on_ready(); })) {
+        log_error() << get_timestamp() << " - Error replaying input " << input_.spec << ": " << strerror(errno);
+        finish();
+    }
+}
+
+void ReplayInput::on_timer() {
+    if (!opened_) {
+        open_capture();
+        return;
+    }
+
+    // Deliver everything that is due; sleep until the next record
+    auto now = SentenceSink::Clock::now();
+    for (size_t batch = 0; have_pending_; batch++) {
+        auto offset = std::chrono::nanoseconds(
+            static_cast<int64_t>(static_cast<double>(pending_.ns - first_ns_) / config_.replay_speed));
+        auto due = started_ + std::chrono::duration_cast<SentenceSink::Clock::duration>(offset);
+        if (due > now || batch == REPLAY_BATCH) {
+            auto wait = std::chrono::ceil<std::chrono::milliseconds>(due - now);
+            loop_.arm_timer(timer_, std::max(wait, std::chrono::milliseconds(1)));
+            return;
+        }
+        deliver_pending(now);
+    }
+    finish();
+}
+
+void ReplayInput::on_ready() {
+    auto now = SentenceSink::Clock::now();
+    for (size_t batch = 0; have_pending_ && batch < REPLAY_BATCH; batch++) {
+        deliver_pending(now);
+    }
+    if (!have_pending_) {
+        finish();
+    }
+}
+
+void ReplayInput::deliver_pending(SentenceSink::Clock::time_point now) {
+    sentences_++;
+    bytes_ += pending_.sentence.size();
+    sink_.on_sentence(pending_.sentence, now, replay_source(pending_.source));
+    have_pending_ = reader_.next(pending_);
+}
+
+// Keep fragments recorded from different inputs apart, from each other and
+// from those of live inputs and other replays, with an id of their own
+uint16_t ReplayInput::replay_source(uint16_t recorded) {
+    for (const auto& source : sources_) {
+        if (source.first == recorded) {
+            return source.second;
+        }
+    }
+    uint32_t n = next_replay_source.fetch_add(1, std::memory_order_relaxed);
+    uint16_t id = static_cast<uint16_t>(FIRST_REPLAY_SOURCE + n % (0x10000 - FIRST_REPLAY_SOURCE));
+    sources_.emplace_back(recorded, id);
+    return id;
+}
+
+void ReplayInput::finish() {
+    if (ready_fd_ != -1) {
+        loop_.remove(ready_fd_);
+        close(ready_fd_);
+        ready_fd_ = -1;
+    }
+    for (const auto& source : sources_) {
+        sink_.on_source_reset(source.second);
+    }
+    if (!reader_.error().empty()) {
+        log_error() << get_timestamp() << " - Replay of " << input_.spec << " stopped early: " << reader_.error();
+    }
+    double seconds = std::chrono::duration<double>(SentenceSink::Clock::now() - started_).count();
+    log_info() << get_timestamp() << " - Finished replaying " << input_.spec << ": " << sentences_ << " sentences in "
+               << seconds << " s";
+}
+
+void ReplayInput::log_stats() const {
+    log_info() << get_timestamp() << " - Input " << input_.spec << ": " << sentences_ << " sentences replayed"
+               << (opened_ && !have_pending_ ? ", finished" : "");
+}
+
+// ---------------------------------------------------------------------------
+
+std::unique_ptr<Input> make_input(const InputConfig& input, uint16_t id, EventLoop& loop, SentenceSink& sink,
+                                  const Config& config) {
+    switch (input.type) {
+        case InputConfig::Type::Tcp:
+            return std::make_unique<TcpInput>(input, id, loop, sink, config);
+        case InputConfig::Type::Udp:
+            return std::make_unique<UdpInput>(input, id, loop, sink, config);
+        case InputConfig::Type::File:
+            return std::make_unique<FileInput>(input, id, loop, sink, config);
+        case InputConfig::Type::Replay:
+            return std::make_unique<ReplayInput>(input, id, loop, sink, config);
+        case InputConfig::Type::Serial:
+            return std::make_unique<SerialInput>(input, id, loop, sink, config);
+    }
+    return nullptr;
+}
@@ -0,0 +1,232 @@
+/*
+ * AIS Data Inputs
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Each configured input owns its descriptor, timers and SentenceSplitter,
+ * registers itself with the EventLoop and hands framed sentences to a
+ * SentenceSink. All descriptors are non-blocking and edge-triggered, so a
+ * ready input is drained until EAGAIN on every wakeup.
+ *
+ * - TcpInput: client connection to a transponder with keepalive,
+ *   TCP_USER_TIMEOUT, a periodic health check and EPOLLRDHUP for immediate
+ *   peer-close detection. Connects are non-blocking with a timeout and
+ *   failed attempts are retried with jittered exponential backoff.
+ * - UdpInput: NMEA-over-UDP listener; every datagram holds whole sentences.
+ *   With `io_backend=io_uring` it receives through a multishot io_uring
+ *   receive instead of a recv() loop (see IoUring).
+ * - FileInput: FIFO or character device watched by epoll, or a regular file
+ *   read on a timer and followed like `tail -f`.
+ * - SerialInput: serial or USB-serial port in raw mode at the configured
+ *   baud rate, with the driver's low-latency mode requested where it has
+ *   one. A device that disappears is reopened once it is back.
+ * - ReplayInput: a memory-mapped capture file (see capture.h) fed back with
+ *   its original spacing scaled by `replay_speed`, or as fast as the
+ *   forwarder takes it. Sentences carry the time they are replayed at.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "capture.h"
+#include "config.h"
+#include "counter.h"
+#include "event_loop.h"
+#include "metrics.h"
+#include "sentence_splitter.h"
+#include "uring.h"
+
+// Receiver of framed sentences
+class SentenceSink {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~SentenceSink() = default;
+
+    // One sentence from input `source`, received at `now`
+    virtual void on_sentence(std::string_view sentence, Clock::time_point now, uint16_t source) = 0;
+
+    // Input `source` lost its stream; discard any partial state from it
+    virtual void on_source_reset(uint16_t source) = 0;
+};
+
+// Source ids from here up stand for the inputs recorded in replayed
+// captures; inputs themselves take the ids below it
+constexpr uint16_t FIRST_REPLAY_SOURCE = 0x8000;
+
+class Input {
+public:
+    Input(const InputConfig& input, uint16_t id, EventLoop& loop, SentenceSink& sink, const Config& config);
+    virtual ~Input();
+
+    Input(const Input&) = delete;
+    Input& operator=(const Input&) = delete;
+
+    // Open the input and register it with the event loop. Inputs that
+    // cannot be opened yet keep retrying on their own.
+    virtual void start() = 0;
+
+    const InputConfig& input_config() const { return input_; }
+    uint16_t id() const { return id_; }
+
+    // Log per-input statistics, if the input keeps any
+    virtual void log_stats() const {}
+
+    // Add the input's counters to `metrics`, labelled with its spec
+    virtual void register_metrics(MetricsRegistry& metrics) const;
+
+protected:
+    // Hand every complete sentence in the splitter to the sink
+    void deliver(SentenceSink::Clock::time_point now);
+
+    // Close and unregister the descriptor
+    void close_fd();
+
+    InputConfig input_;
+    uint16_t id_;
+    EventLoop& loop_;
+    SentenceSink& sink_;
+    const Config& config_;
+    int fd_ = -1;
+    SentenceSplitter splitter_;
+
+    // Counters, as the input may run on an ingest thread
+    Counter sentences_;
+    Counter bytes_;                     // Of the sentences, without line endings
+};
+
+class TcpInput : public Input {
+public:
+    TcpInput(const InputConfig& input, uint16_t id, EventLoop& loop, SentenceSink& sink, const Config& config);
+    ~TcpInput() override;
+
+    void start() override;
+    void log_stats() const override;
+    void register_metrics(MetricsRegistry& metrics) const override;
+
+private:
+    void connect();
+    void on_connect_event(uint32_t events);
+    void connected();
+    void connect_failed(const std::string& reason);
+    void schedule_reconnect();
+    void on_event(uint32_t events);
+    void health_check();
+    void connection_lost(const std::string& title, const std::string& error_msg);
+
+    int health_timer_ = -1;
+    int reconnect_timer_ = -1;
+    int connect_timer_ = -1;
+    bool connecting_ = false;                // Non-blocking connect in progress
+    unsigned attempts_ = 0;                  // Failed attempts since the last stable connection
+    std::mt19937 rng_;                       // Backoff jitter
+    bool was_connected_ = false;             // Track previous connection state
+    bool connection_lost_notified_ = false;  // Track if we've already notified about loss
+
+    // Reconnect latency: time from losing the connection to re-establishing it
+    bool lost_ = false;
+    std::chrono::steady_clock::time_point lost_at_;
+    std::chrono::steady_clock::time_point connected_at_;
+    Counter reconnects_;
+    Histogram reconnect_latency_;
+    Counter reconnect_last_ms_;
+    Counter reconnect_max_ms_;
+};
+
+class UdpInput : public Input {
+public:
+    using Input::Input;
+    ~UdpInput() override;
+
+    void start() override;
+
+private:
+    bool open_socket();
+    void on_event(uint32_t events);
+    bool start_uring();
+    void on_uring_event();
+    void receive(const char* data, size_t length, SentenceSink::Clock::time_point now);
+
+    int retry_timer_ = -1;
+    std::unique_ptr<IoUring> ring_;     // Null when receiving through epoll
+};
+
+class FileInput : public Input {
+public:
+    using Input::Input;
+    ~FileInput() override;
+
+    void start() override;
+
+private:
+    bool open_file();
+    void reopen();
+    void drain();
+
+    int timer_ = -1;            // Polling timer for regular files, retry timer otherwise
+    bool polled_ = false;       // Regular file read on a timer rather than via epoll
+};
+
+class SerialInput : public Input {
+public:
+    SerialInput(const InputConfig& input, uint16_t id, EventLoop& loop, SentenceSink& sink, const Config& config);
+    ~SerialInput() override;
+
+    void start() override;
+    void log_stats() const override;
+    void register_metrics(MetricsRegistry& metrics) const override;
+
+private:
+    bool open_device();
+    bool configure(std::string& error);
+    void reopen();
+    void on_event(uint32_t events);
+    void device_lost(const std::string& reason);
+
+    int retry_timer_ = -1;
+    bool low_latency_ = false;          // The driver accepted ASYNC_LOW_LATENCY
+    bool was_open_ = false;
+    bool lost_notified_ = false;
+    bool open_failure_logged_ = false;  // Log the first failed open of an outage only
+    Counter reopens_;
+};
+
+class ReplayInput : public Input {
+public:
+    using Input::Input;
+    ~ReplayInput() override;
+
+    void start() override;
+    void log_stats() const override;
+
+private:
+    void open_capture();
+    void on_timer();
+    void on_ready();
+    void deliver_pending(SentenceSink::Clock::time_point now);
+    uint16_t replay_source(uint16_t recorded);
+    void finish();
+
+    CaptureReader reader_;
+    CaptureReader::Record pending_{};   // Next record to deliver
+    bool opened_ = false;
+    bool have_pending_ = false;
+    uint64_t first_ns_ = 0;             // Capture time of the first record
+    std::vector<std::pair<uint16_t, uint16_t>> sources_;   // Recorded source and the id it is replayed as
+    SentenceSink::Clock::time_point started_;
+    int timer_ = -1;                    // Paced replay, and retrying the open
+    int ready_fd_ = -1;                 // Always-readable eventfd for flat-out replay
+};
+
+// Create the input for one configuration entry
+std::unique_ptr<Input> make_input(const InputConfig& input, uint16_t id, EventLoop& loop, SentenceSink& sink,
+                                  const Config& config);
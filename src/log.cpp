@@ -0,0 +1,87 @@
+/*
+ * Logging Helpers
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+
+namespace {
+
+std::atomic<bool> info_enabled{true};
+std::atomic<bool> errors_enabled{true};
+
+}  // namespace
+
+// Function to get current timestamp
+Timestamp get_timestamp() {
+    auto now = std::chrono::system_clock::now();
+    auto time_t = std::chrono::system_clock::to_time_t(now);
+    struct tm local;
+    localtime_r(&time_t, &local);     // Called from the pipeline threads too
+    Timestamp timestamp;
+    std::strftime(timestamp.text, sizeof(timestamp.text), "%Y-%m-%d %H:%M:%S", &local);
+    return timestamp;
+}
+
+LogLine::~LogLine() {
+    if (!(fd_ == 2 ? errors_enabled : info_enabled).load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (length_ == CAPACITY) {
+        length_--;
+    }
+    text_[length_++] = '\n';
+    const char* data = text_;
+    while (length_ > 0) {
+        ssize_t n = ::write(fd_, data, length_);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        data += n;
+        length_ -= static_cast<size_t>(n);
+    }
+}
+
+LogLine& LogLine::operator<<(std::string_view text) {
+    size_t n = std::min(text.size(), CAPACITY - length_);
+    std::memcpy(text_ + length_, text.data(), n);
+    length_ += n;
+    return *this;
+}
+
+LogLine& LogLine::operator<<(long long value) {
+    char buffer[24];
+    int n = std::snprintf(buffer, sizeof(buffer), "%lld", value);
+    return *this << std::string_view(buffer, static_cast<size_t>(n));
+}
+
+LogLine& LogLine::operator<<(unsigned long long value) {
+    char buffer[24];
+    int n = std::snprintf(buffer, sizeof(buffer), "%llu", value);
+    return *this << std::string_view(buffer, static_cast<size_t>(n));
+}
+
+LogLine& LogLine::operator<<(double value) {
+    char buffer[32];
+    int n = std::snprintf(buffer, sizeof(buffer), "%g", value);
+    return *this << std::string_view(buffer, static_cast<size_t>(n));
+}
+
+void set_log_enabled(bool info, bool errors) {
+    info_enabled.store(info, std::memory_order_relaxed);
+    errors_enabled.store(errors, std::memory_order_relaxed);
+}
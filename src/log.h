@@ -0,0 +1,67 @@
+/*
+ * Logging Helpers
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * log_info() and log_error() return a line for stdout and stderr. It is
+ * formatted into a fixed buffer and written with a single write(2) when the
+ * statement ends, so logging needs neither iostream nor the heap, and lines
+ * from different threads never interleave:
+ *
+ *     log_info() << get_timestamp() << " - Connected to " << host;
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// Local time as "YYYY-MM-DD HH:MM:SS", in a fixed buffer so that writing a
+// log line allocates nothing
+struct Timestamp {
+    char text[32];
+};
+
+// Function to get current timestamp
+Timestamp get_timestamp();
+
+class LogLine {
+public:
+    static constexpr size_t CAPACITY = 1024;    // Longer lines are truncated
+
+    explicit LogLine(int fd) : fd_(fd) {}
+    ~LogLine();
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    LogLine& operator<<(std::string_view text);
+    LogLine& operator<<(const char* text) { return *this << std::string_view(text); }
+    LogLine& operator<<(char c) { return *this << std::string_view(&c, 1); }
+    LogLine& operator<<(const Timestamp& timestamp) { return *this << timestamp.text; }
+    LogLine& operator<<(int value) { return *this << static_cast<long long>(value); }
+    LogLine& operator<<(long value) { return *this << static_cast<long long>(value); }
+    LogLine& operator<<(long long value);
+    LogLine& operator<<(unsigned value) { return *this << static_cast<unsigned long long>(value); }
+    LogLine& operator<<(unsigned long value) { return *this << static_cast<unsigned long long>(value); }
+    LogLine& operator<<(unsigned long long value);
+    LogLine& operator<<(double value);
+
+private:
+    int fd_;
+    size_t length_ = 0;
+    char text_[CAPACITY];
+};
+
+inline LogLine log_info() {
+    return LogLine(1);
+}
+
+inline LogLine log_error() {
+    return LogLine(2);
+}
+
+// Turn log lines for stdout and stderr off or back on, as the tests and
+// benchmarks do
+void set_log_enabled(bool info, bool errors);
@@ -0,0 +1,129 @@
+/*
+ * Metrics Registry
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metrics.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+const char* type_name(int type) {
+    static const char* names[] = {"counter", "gauge", "histogram"};
+    return names[type];
+}
+
+void append_value(std::string& out, double value) {
+    char number[32];
+    if (value == std::floor(value) && std::fabs(value) < 1e17) {
+        snprintf(number, sizeof(number), "%.0f", value);
+    } else {
+        snprintf(number, sizeof(number), "%.9g", value);
+    }
+    out += number;
+}
+
+void append_series(std::string& out, const std::string& name, const char* suffix, const std::string& labels,
+                   const std::string& extra, double value) {
+    out += name;
+    out += suffix;
+    if (!labels.empty() || !extra.empty()) {
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extra.empty()) {
+            out += ',';
+        }
+        out += extra;
+        out += '}';
+    }
+    out += ' ';
+    append_value(out, value);
+    out += '\n';
+}
+
+}  // namespace
+
+const int64_t Histogram::BOUNDS_NS[Histogram::BUCKETS] = {
+    100000,     250000,     500000,     1000000,    2500000,    5000000,    10000000,    25000000,
+    50000000,   100000000,  250000000,  500000000,  1000000000, 2500000000, 5000000000,  10000000000,
+};
+
+MetricsRegistry::Family& MetricsRegistry::family(const std::string& name, const std::string& help, Type type) {
+    for (auto& family : families_) {
+        if (family.name == name) {
+            return family;
+        }
+    }
+    families_.push_back(Family{name, help, type, {}});
+    return families_.back();
+}
+
+void MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels,
+                              Reader read) {
+    family(name, help, Type::Counter).series.push_back(Series{labels, std::move(read)});
+}
+
+void MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels,
+                              const Counter& value) {
+    counter(name, help, labels, [&value] { return static_cast<double>(value.get()); });
+}
+
+void MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels,
+                            Reader read) {
+    family(name, help, Type::Gauge).series.push_back(Series{labels, std::move(read)});
+}
+
+void MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::string& labels,
+                                const Histogram& histogram) {
+    family(name, help, Type::Histogram).series.push_back(Series{labels, nullptr, &histogram});
+}
+
+std::string MetricsRegistry::label(const std::string& key, const std::string& value) {
+    std::string out = key + "=\"";
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+std::string MetricsRegistry::render() const {
+    std::string out;
+    out.reserve(families_.size() * 256);
+    for (const auto& family : families_) {
+        out += "# HELP " + family.name + " " + family.help + "\n";
+        out += "# TYPE " + family.name + " " + type_name(static_cast<int>(family.type)) + "\n";
+
+        for (const auto& series : family.series) {
+            if (series.histogram == nullptr) {
+                append_series(out, family.name, "", series.labels, "", series.read());
+                continue;
+            }
+
+            const Histogram& histogram = *series.histogram;
+            uint64_t cumulative = 0;
+            char bound[48];
+            for (size_t i = 0; i < Histogram::BUCKETS; i++) {
+                cumulative += histogram.bucket(i);
+                snprintf(bound, sizeof(bound), "le=\"%g\"", Histogram::BOUNDS_NS[i] / 1e9);
+                append_series(out, family.name, "_bucket", series.labels, bound, static_cast<double>(cumulative));
+            }
+            cumulative += histogram.bucket(Histogram::BUCKETS);
+            append_series(out, family.name, "_bucket", series.labels, "le=\"+Inf\"", static_cast<double>(cumulative));
+            append_series(out, family.name, "_sum", series.labels, "", histogram.sum_ns() / 1e9);
+            append_series(out, family.name, "_count", series.labels, "", static_cast<double>(cumulative));
+        }
+    }
+    return out;
+}
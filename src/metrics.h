@@ -0,0 +1,98 @@
+/*
+ * Metrics Registry
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Components keep their statistics where they already count them: plain
+ * members and Counters, updated on the forwarding path with no locks or
+ * allocation. At startup each one registers how to read them here, under a
+ * Prometheus metric name and labels, and render() formats everything in
+ * the Prometheus text exposition format for MetricsExporter.
+ *
+ * A Histogram counts observations in fixed buckets of Counters, so it too
+ * is written by one thread and readable from any other. The buckets suit
+ * latencies from 100 us to 10 s.
+ *
+ * Readers run on the event loop thread when the metrics are scraped or
+ * written. A reader must only touch Counters, atomics, or state owned by
+ * that thread.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "counter.h"
+
+class Histogram {
+public:
+    static constexpr size_t BUCKETS = 16;
+    static const int64_t BOUNDS_NS[BUCKETS];    // Upper bounds; a last bucket takes the rest
+
+    void observe(std::chrono::nanoseconds value) {
+        int64_t ns = value.count();
+        size_t bucket = 0;
+        while (bucket < BUCKETS && ns > BOUNDS_NS[bucket]) {
+            bucket++;
+        }
+        buckets_[bucket]++;
+        sum_ns_ += static_cast<uint64_t>(ns > 0 ? ns : 0);
+    }
+
+    // Observations in one bucket, not cumulative; BUCKETS is the overflow
+    uint64_t bucket(size_t index) const { return buckets_[index]; }
+    uint64_t sum_ns() const { return sum_ns_; }
+
+private:
+    Counter buckets_[BUCKETS + 1];
+    Counter sum_ns_;
+};
+
+class MetricsRegistry {
+public:
+    using Reader = std::function<double()>;
+
+    // A monotonically increasing count, or a value that goes up and down.
+    // `labels` is empty or made with label(), comma-separated.
+    void counter(const std::string& name, const std::string& help, const std::string& labels, Reader read);
+    void counter(const std::string& name, const std::string& help, const std::string& labels, const Counter& value);
+    void gauge(const std::string& name, const std::string& help, const std::string& labels, Reader read);
+    void histogram(const std::string& name, const std::string& help, const std::string& labels,
+                   const Histogram& histogram);
+
+    // `key="value"`, with the value escaped
+    static std::string label(const std::string& key, const std::string& value);
+
+    // Every metric in Prometheus text format, version 0.0.4
+    std::string render() const;
+
+    // Forget every series, e.g. before registering again once the
+    // components they read have been replaced
+    void clear() { families_.clear(); }
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Series {
+        std::string labels;
+        Reader read;                            // Counters and gauges
+        const Histogram* histogram = nullptr;   // Histograms
+    };
+
+    struct Family {
+        std::string name;
+        std::string help;
+        Type type;
+        std::vector<Series> series;
+    };
+
+    Family& family(const std::string& name, const std::string& help, Type type);
+
+    std::vector<Family> families_;              // In registration order
+};
@@ -0,0 +1,99 @@
+/*
+ * Metrics Exporter
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "metrics_exporter.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "log.h"
+
+namespace {
+
+bool write_all(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}  // namespace
+
+MetricsExporter::MetricsExporter(EventLoop& loop, const MetricsRegistry& metrics, const Config& config)
+    : loop_(loop),
+      metrics_(metrics),
+      config_(config),
+      http_(loop, MAX_CLIENTS, [this](const std::string& method, const std::string& path) {
+          return respond(method, path);
+      }) {
+}
+
+MetricsExporter::~MetricsExporter() {
+    loop_.remove_timer(file_timer_);
+}
+
+bool MetricsExporter::start() {
+    if (config_.metrics_port > 0) {
+        if (!http_.listen(config_.metrics_bind, config_.metrics_port, "metrics endpoint")) {
+            return false;
+        }
+        log_info() << get_timestamp() << " - Serving metrics on http://" << config_.metrics_bind << ":"
+                   << config_.metrics_port << "/metrics";
+    }
+    if (!config_.metrics_file.empty()) {
+        auto interval = std::chrono::seconds(config_.metrics_interval_s);
+        file_timer_ = loop_.add_timer(interval, interval, [this] { write_file(); });
+        log_info() << get_timestamp() << " - Writing metrics to " << config_.metrics_file << " every "
+                   << config_.metrics_interval_s << " s";
+    }
+    return true;
+}
+
+void MetricsExporter::write_file() {
+    std::string temp = config_.metrics_file + ".tmp";
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool ok = fd != -1 && write_all(fd, metrics_.render());
+    int error = ok ? 0 : errno;
+    if (fd != -1 && close(fd) != 0 && ok) {
+        ok = false;
+        error = errno;
+    }
+    if (ok && rename(temp.c_str(), config_.metrics_file.c_str()) != 0) {
+        ok = false;
+        error = errno;
+    }
+
+    if (!ok) {
+        unlink(temp.c_str());
+        if (!file_failed_) {
+            log_error() << get_timestamp() << " - Cannot write metrics file " << config_.metrics_file << ": "
+                        << std::strerror(error);
+        }
+    }
+    file_failed_ = !ok;
+}
+
+std::string MetricsExporter::respond(const std::string& method, const std::string& path) const {
+    if (method != "GET") {
+        return http_response("405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+    } else if (path == "/metrics" || path == "/") {
+        return http_response("200 OK", "text/plain; version=0.0.4", metrics_.render());
+    }
+    return http_response("404 Not Found", "text/plain", "Try /metrics\n");
+}
@@ -0,0 +1,54 @@
+/*
+ * Metrics Exporter
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Publishes a MetricsRegistry in the Prometheus text format, either or
+ * both of:
+ *
+ *   metrics_port=<port>   GET /metrics over HTTP/1.0 on metrics_bind
+ *   metrics_file=<path>   Rewritten every metrics_interval_s seconds, for
+ *                         node_exporter's textfile collector or a script
+ *
+ * The HTTP side is an HttpServer, as for QueryServer, taking a few clients
+ * at a time. The file is written to a temporary name and renamed into place,
+ * so a reader never sees half of it.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "config.h"
+#include "event_loop.h"
+#include "http_server.h"
+#include "metrics.h"
+
+class MetricsExporter {
+public:
+    static constexpr size_t MAX_CLIENTS = 4;
+
+    MetricsExporter(EventLoop& loop, const MetricsRegistry& metrics, const Config& config);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Start listening and the file timer, as configured; false on failure
+    bool start();
+
+    // Write the metrics file now
+    void write_file();
+
+private:
+    std::string respond(const std::string& method, const std::string& path) const;
+
+    EventLoop& loop_;
+    const MetricsRegistry& metrics_;
+    const Config& config_;
+    HttpServer http_;
+    int file_timer_ = -1;
+    bool file_failed_ = false;          // Last write failed; log again only once it works
+};
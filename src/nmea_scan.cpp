@@ -0,0 +1,361 @@
+/*
+ * NMEA Scanning Kernels
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "nmea_scan.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define NMEA_HAVE_X86 1
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NMEA_HAVE_NEON 1
+#endif
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Scalar kernel
+
+// XOR [start, len) into `acc` eight bytes at a time, then fold the word down
+// to one byte. Also finishes the final partial block of the vector kernels.
+inline uint8_t xor_tail(const char* data, size_t start, size_t len, uint64_t acc) {
+    size_t i = start;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        acc ^= word;
+    }
+    acc ^= acc >> 32;
+    acc ^= acc >> 16;
+    acc ^= acc >> 8;
+    uint8_t sum = static_cast<uint8_t>(acc);
+    for (; i < len; i++) {
+        sum ^= static_cast<uint8_t>(data[i]);
+    }
+    return sum;
+}
+
+uint8_t scalar_xor_bytes(const char* data, size_t len) {
+    return xor_tail(data, 0, len, 0);
+}
+
+const char* scalar_find_byte(const char* begin, const char* end, char c) {
+    for (const char* p = begin; p < end; p++) {
+        if (*p == c) {
+            return p;
+        }
+    }
+    return end;
+}
+
+// Scan [start, len) one byte at a time, recording absolute offsets. Also
+// finishes the final partial block of the vector kernels.
+size_t scan_tail(const char* data, size_t start, size_t len, uint16_t* commas, size_t max_commas, size_t* star) {
+    size_t count = 0;
+    for (size_t i = start; i < len; i++) {
+        if (data[i] == ',') {
+            if (count < max_commas) {
+                commas[count++] = static_cast<uint16_t>(i);
+            }
+        } else if (data[i] == '*') {
+            *star = i;
+            return count;
+        }
+    }
+    *star = len;
+    return count;
+}
+
+size_t scalar_scan_fields(const char* data, size_t len, uint16_t* commas, size_t max_commas, size_t* star) {
+    return scan_tail(data, 0, len, commas, max_commas, star);
+}
+
+// Walk the set bits of a comma/star bitmask for a block starting at `base`.
+// Returns true once the '*' has been reached.
+inline bool consume_masks(uint64_t comma_mask, uint64_t star_mask, size_t base,
+                          uint16_t* commas, size_t max_commas, size_t& count, size_t* star) {
+    if (star_mask != 0) {
+        // Only commas before the first '*' belong to the sentence body
+        size_t star_bit = static_cast<size_t>(__builtin_ctzll(star_mask));
+        comma_mask &= (1ULL << star_bit) - 1;
+        *star = base + star_bit;
+    }
+    while (comma_mask != 0 && count < max_commas) {
+        commas[count++] = static_cast<uint16_t>(base + __builtin_ctzll(comma_mask));
+        comma_mask &= comma_mask - 1;
+    }
+    return star_mask != 0;
+}
+
+#ifdef NMEA_HAVE_X86
+
+// ---------------------------------------------------------------------------
+// SSE2 kernel (baseline on x86-64)
+
+__attribute__((target("sse2")))
+uint8_t sse2_xor_bytes(const char* data, size_t len) {
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        acc = _mm_xor_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+    }
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 8));
+    return xor_tail(data, i, len, static_cast<uint64_t>(_mm_cvtsi128_si64(acc)));
+}
+
+__attribute__((target("sse2")))
+const char* sse2_find_byte(const char* begin, const char* end, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    const char* p = begin;
+    for (; p + 16 <= end; p += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (mask != 0) {
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+    }
+    return scalar_find_byte(p, end, c);
+}
+
+__attribute__((target("sse2")))
+size_t sse2_scan_fields(const char* data, size_t len, uint16_t* commas, size_t max_commas, size_t* star) {
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i asterisk = _mm_set1_epi8('*');
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        uint64_t comma_mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, comma)));
+        uint64_t star_mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, asterisk)));
+        if (consume_masks(comma_mask, star_mask, i, commas, max_commas, count, star)) {
+            return count;
+        }
+    }
+    return count + scan_tail(data, i, len, commas + count, max_commas - count, star);
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 kernel
+
+__attribute__((target("avx2")))
+uint8_t avx2_xor_bytes(const char* data, size_t len) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        acc = _mm256_xor_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+    }
+    __m128i half = _mm_xor_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    if (i + 16 <= len) {
+        half = _mm_xor_si128(half, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+        i += 16;
+    }
+    half = _mm_xor_si128(half, _mm_srli_si128(half, 8));
+    return xor_tail(data, i, len, static_cast<uint64_t>(_mm_cvtsi128_si64(half)));
+}
+
+__attribute__((target("avx2")))
+const char* avx2_find_byte(const char* begin, const char* end, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    const char* p = begin;
+    for (; p + 32 <= end; p += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return scalar_find_byte(p, end, c);
+}
+
+__attribute__((target("avx2")))
+size_t avx2_scan_fields(const char* data, size_t len, uint16_t* commas, size_t max_commas, size_t* star) {
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i asterisk = _mm256_set1_epi8('*');
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        uint64_t comma_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, comma)));
+        uint64_t star_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, asterisk)));
+        if (consume_masks(comma_mask, star_mask, i, commas, max_commas, count, star)) {
+            return count;
+        }
+    }
+    return count + scan_tail(data, i, len, commas + count, max_commas - count, star);
+}
+
+#endif  // NMEA_HAVE_X86
+
+#ifdef NMEA_HAVE_NEON
+
+// ---------------------------------------------------------------------------
+// NEON kernel
+
+// Compress a byte-wise comparison result into a 64-bit mask, 4 bits per byte
+inline uint64_t neon_nibble_mask(uint8x16_t cmp) {
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+}
+
+// Convert a nibble mask to one bit per byte
+inline uint64_t neon_bit_mask(uint8x16_t cmp) {
+    uint64_t nibbles = neon_nibble_mask(cmp) & 0x1111111111111111ULL;
+    uint64_t bits = 0;
+    while (nibbles != 0) {
+        bits |= 1ULL << (__builtin_ctzll(nibbles) >> 2);
+        nibbles &= nibbles - 1;
+    }
+    return bits;
+}
+
+uint8_t neon_xor_bytes(const char* data, size_t len) {
+    uint8x16_t acc = vdupq_n_u8(0);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        acc = veorq_u8(acc, vld1q_u8(reinterpret_cast<const uint8_t*>(data + i)));
+    }
+    uint8x8_t half = veor_u8(vget_low_u8(acc), vget_high_u8(acc));
+    return xor_tail(data, i, len, vget_lane_u64(vreinterpret_u64_u8(half), 0));
+}
+
+const char* neon_find_byte(const char* begin, const char* end, char c) {
+    const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(c));
+    const char* p = begin;
+    for (; p + 16 <= end; p += 16) {
+        uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        uint64_t mask = neon_nibble_mask(vceqq_u8(block, needle));
+        if (mask != 0) {
+            return p + (__builtin_ctzll(mask) >> 2);
+        }
+    }
+    return scalar_find_byte(p, end, c);
+}
+
+size_t neon_scan_fields(const char* data, size_t len, uint16_t* commas, size_t max_commas, size_t* star) {
+    const uint8x16_t comma = vdupq_n_u8(',');
+    const uint8x16_t asterisk = vdupq_n_u8('*');
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+        uint8x16_t comma_cmp = vceqq_u8(block, comma);
+        uint8x16_t star_cmp = vceqq_u8(block, asterisk);
+        if (neon_nibble_mask(vorrq_u8(comma_cmp, star_cmp)) == 0) {
+            continue;  // Fast skip of payload blocks without separators
+        }
+        if (consume_masks(neon_bit_mask(comma_cmp), neon_bit_mask(star_cmp), i, commas, max_commas, count, star)) {
+            return count;
+        }
+    }
+    return count + scan_tail(data, i, len, commas + count, max_commas - count, star);
+}
+
+#endif  // NMEA_HAVE_NEON
+
+const NmeaKernel scalar_kernel = {"scalar", scalar_xor_bytes, scalar_find_byte, scalar_scan_fields};
+#ifdef NMEA_HAVE_X86
+const NmeaKernel sse2_kernel = {"sse2", sse2_xor_bytes, sse2_find_byte, sse2_scan_fields};
+const NmeaKernel avx2_kernel = {"avx2", avx2_xor_bytes, avx2_find_byte, avx2_scan_fields};
+#endif
+#ifdef NMEA_HAVE_NEON
+const NmeaKernel neon_kernel = {"neon", neon_xor_bytes, neon_find_byte, neon_scan_fields};
+#endif
+
+const NmeaKernel& select_kernel() {
+#ifdef NMEA_HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return avx2_kernel;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return sse2_kernel;
+    }
+#endif
+#ifdef NMEA_HAVE_NEON
+    return neon_kernel;
+#endif
+    return scalar_kernel;
+}
+
+inline int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+}  // namespace
+
+const NmeaKernel& nmea_kernel() {
+    static const NmeaKernel& kernel = select_kernel();
+    return kernel;
+}
+
+std::vector<const NmeaKernel*> nmea_available_kernels() {
+    std::vector<const NmeaKernel*> kernels = {&scalar_kernel};
+#ifdef NMEA_HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        kernels.push_back(&sse2_kernel);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back(&avx2_kernel);
+    }
+#endif
+#ifdef NMEA_HAVE_NEON
+    kernels.push_back(&neon_kernel);
+#endif
+    return kernels;
+}
+
+std::string_view NmeaFields::field(std::string_view sentence, size_t i) const {
+    if (i > count) {
+        return std::string_view();
+    }
+    size_t begin = (i == 0) ? 0 : commas[i - 1] + 1;
+    size_t end = (i < count) ? commas[i] : star;
+    if (end > sentence.size()) {
+        end = sentence.size();
+    }
+    return begin < end ? sentence.substr(begin, end - begin) : std::string_view();
+}
+
+bool nmea_checksum_valid(std::string_view sentence, const NmeaKernel& kernel) {
+    size_t len = sentence.size();
+    if (len < 4 || (sentence[0] != '!' && sentence[0] != '$')) {
+        return false;
+    }
+
+    // The checksum normally ends the sentence; only search if something trails it
+    size_t star = len - 3;
+    if (sentence[star] != '*') {
+        const char* begin = sentence.data() + 1;
+        const char* end = sentence.data() + len;
+        const char* found = kernel.find_byte(begin, end, '*');
+        if (found == end || found + 2 >= end) {
+            return false;
+        }
+        star = static_cast<size_t>(found - sentence.data());
+    }
+
+    int hi = hex_value(sentence[star + 1]);
+    int lo = hex_value(sentence[star + 2]);
+    if (hi < 0 || lo < 0) {
+        return false;
+    }
+
+    uint8_t sum = kernel.xor_bytes(sentence.data() + 1, star - 1);
+    return sum == static_cast<uint8_t>((hi << 4) | lo);
+}
+
+void nmea_scan_fields(std::string_view sentence, NmeaFields& fields, const NmeaKernel& kernel) {
+    fields.count = kernel.scan_fields(sentence.data(), sentence.size(), fields.commas, NMEA_MAX_FIELDS, &fields.star);
+}
@@ -0,0 +1,61 @@
+/*
+ * NMEA Scanning Kernels
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Byte-scanning primitives used on every received sentence: XOR checksum
+ * accumulation, delimiter search and comma/asterisk field scanning.
+ *
+ * Each primitive has a scalar implementation plus vectorized variants for
+ * SSE2 and AVX2 on x86 and NEON on ARM (Raspberry Pi 2 and later; the ARMv6
+ * Pi Zero/Pi 1 use the scalar path). The best kernel supported by the running
+ * CPU is selected once on first use.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Maximum number of field separators recorded per sentence; AIVDM has 6
+constexpr size_t NMEA_MAX_FIELDS = 24;
+
+struct NmeaKernel {
+    const char* name;
+
+    // XOR of all bytes in [data, data + len)
+    uint8_t (*xor_bytes)(const char* data, size_t len);
+
+    // First occurrence of `c` in [begin, end), or `end` if absent
+    const char* (*find_byte)(const char* begin, const char* end, char c);
+
+    // Record the offsets of up to `max_commas` ',' bytes preceding the first
+    // '*'. Stores the '*' offset (or `len` if absent) in `star` and returns the
+    // number of commas found.
+    size_t (*scan_fields)(const char* data, size_t len, uint16_t* commas, size_t max_commas, size_t* star);
+};
+
+// Best kernel for the running CPU
+const NmeaKernel& nmea_kernel();
+
+// Every kernel this build and CPU can run, scalar first (for benchmarking)
+std::vector<const NmeaKernel*> nmea_available_kernels();
+
+// Field layout of one sentence as found by scan_fields()
+struct NmeaFields {
+    uint16_t commas[NMEA_MAX_FIELDS];
+    size_t count = 0;   // Number of commas recorded
+    size_t star = 0;    // Offset of '*', or sentence length if absent
+
+    // Field `i` (0 = talker/sentence id, e.g. "!AIVDM")
+    std::string_view field(std::string_view sentence, size_t i) const;
+};
+
+// Verify the "*hh" XOR checksum of a "!..." or "$..." sentence
+bool nmea_checksum_valid(std::string_view sentence, const NmeaKernel& kernel = nmea_kernel());
+
+// Split a sentence into comma-separated fields up to the checksum
+void nmea_scan_fields(std::string_view sentence, NmeaFields& fields, const NmeaKernel& kernel = nmea_kernel());
@@ -0,0 +1,345 @@
+/*
+ * System Notifications
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "notification.h"
+
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <fcntl.h>
+#include <mutex>
+#include <pwd.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <syslog.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+extern char** environ;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t QUEUE_CAPACITY = 32;
+constexpr size_t MAX_TITLES = 16;
+constexpr auto SPAWN_TIMEOUT = std::chrono::seconds(5);
+
+struct Notification {
+    std::string title;
+    std::string message;
+    std::string user;
+    std::string urgency;
+    unsigned repeats = 0;       // Identical events merged into this one
+};
+
+// Rate limiting state for one notification title
+struct TitleState {
+    std::string title;
+    Clock::time_point last_delivered;
+    bool held = false;
+    Notification latest;        // Most recent event held back
+    unsigned skipped = 0;       // Events held back since the last delivery
+};
+
+int syslog_priority(const std::string& urgency) {
+    if (urgency == "critical") return LOG_CRIT;
+    if (urgency == "low") return LOG_INFO;
+    return LOG_NOTICE;
+}
+
+// Run a program directly (no shell) with output discarded; give up after
+// SPAWN_TIMEOUT so a hung D-Bus session cannot stall the worker for good
+void run_program(const std::vector<std::string>& args, const std::vector<std::string>& env) {
+    std::vector<char*> argv;
+    for (const auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    std::vector<char*> envp;
+    for (const auto& var : env) envp.push_back(const_cast<char*>(var.c_str()));
+    envp.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+    pid_t pid;
+    int rc = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), envp.data());
+    posix_spawn_file_actions_destroy(&actions);
+    if (rc != 0) {
+        return;
+    }
+
+    auto deadline = Clock::now() + SPAWN_TIMEOUT;
+    while (waitpid(pid, nullptr, WNOHANG) == 0) {
+        if (Clock::now() >= deadline) {
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+}
+
+// Look up `user`'s account; false if there is none
+bool find_user(const std::string& user, struct passwd& pw, std::vector<char>& buffer) {
+    struct passwd* found = nullptr;
+#ifdef AIS_FORWARDER_STATIC
+    // A static glibc binary can't load the NSS modules getpwnam_r() may
+    // need (it crashes in libnss_systemd), so read /etc/passwd directly
+    FILE* file = fopen("/etc/passwd", "re");
+    if (file == nullptr) {
+        return false;
+    }
+    while (fgetpwent_r(file, &pw, buffer.data(), buffer.size(), &found) == 0) {
+        if (user == pw.pw_name) {
+            break;
+        }
+        found = nullptr;
+    }
+    fclose(file);
+#else
+    getpwnam_r(user.c_str(), &pw, buffer.data(), buffer.size(), &found);
+#endif
+    return found != nullptr;
+}
+
+// Desktop notification for `user`, through sudo unless we already are them
+void notify_desktop(const Notification& n, const std::string& text) {
+    std::vector<char> buffer(4096);
+    struct passwd pw;
+    if (!find_user(n.user, pw, buffer)) {
+        return;
+    }
+
+    std::string display = "DISPLAY=:0";
+    std::string bus = "DBUS_SESSION_BUS_ADDRESS=unix:path=/run/user/" + std::to_string(pw.pw_uid) + "/bus";
+    std::vector<std::string> notify = {"notify-send", "--urgency=" + n.urgency, n.title, text};
+
+    std::vector<std::string> env;
+    for (char** var = environ; *var != nullptr; var++) {
+        env.push_back(*var);
+    }
+
+    if (geteuid() == pw.pw_uid) {
+        env.push_back(display);
+        env.push_back(bus);
+        run_program(notify, env);
+    } else {
+        // -n: never prompt for a password from a background thread
+        std::vector<std::string> args = {"sudo", "-n", "-u", n.user, display, bus};
+        args.insert(args.end(), notify.begin(), notify.end());
+        run_program(args, env);
+    }
+}
+
+class Notifier {
+public:
+    static Notifier& instance() {
+        static Notifier notifier;
+        return notifier;
+    }
+
+    ~Notifier() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+
+    void post(Notification n) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.posted++;
+
+            // Started on first use, so a daemonizing fork() comes first
+            if (!worker_.joinable()) {
+                worker_ = std::thread(&Notifier::run, this);
+            }
+
+            for (size_t i = 0; i < count_; i++) {
+                Notification& queued = queue_[(head_ + i) % QUEUE_CAPACITY];
+                if (queued.title == n.title && queued.message == n.message) {
+                    queued.repeats++;
+                    stats_.coalesced++;
+                    return;
+                }
+            }
+
+            if (count_ == QUEUE_CAPACITY) {
+                stats_.dropped++;
+                return;
+            }
+            queue_[(head_ + count_) % QUEUE_CAPACITY] = std::move(n);
+            count_++;
+        }
+        wake_.notify_one();
+    }
+
+    void set_interval(std::chrono::seconds interval) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        interval_ = interval;
+    }
+
+    NotificationStats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    Notifier() : queue_(QUEUE_CAPACITY) {}
+
+    void run() {
+        openlog("ais_forwarder", LOG_PID, LOG_USER);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            if (count_ > 0) {
+                Notification n = std::move(queue_[head_]);
+                head_ = (head_ + 1) % QUEUE_CAPACITY;
+                count_--;
+                admit(std::move(n), lock);
+                continue;
+            }
+
+            release_due(Clock::now(), lock);
+            if (stopping_) {
+                break;
+            }
+
+            Clock::time_point next;
+            if (next_release(next)) {
+                wake_.wait_until(lock, next);
+            } else {
+                wake_.wait(lock);
+            }
+        }
+
+        // Deliver whatever is still held back before exiting
+        release_due(Clock::time_point::max(), lock);
+        closelog();
+    }
+
+    // Deliver `n` now, or hold it if its title was delivered too recently
+    void admit(Notification n, std::unique_lock<std::mutex>& lock) {
+        Clock::time_point now = Clock::now();
+        TitleState& state = title_state(n.title);
+
+        if (state.last_delivered != Clock::time_point() && now - state.last_delivered < interval_) {
+            if (state.held) {
+                state.skipped += 1 + state.latest.repeats;
+            }
+            state.latest = std::move(n);
+            state.held = true;
+            stats_.suppressed++;
+            return;
+        }
+
+        state.last_delivered = now;
+        unsigned skipped = n.repeats;
+        deliver(n, skipped, lock);
+    }
+
+    // Deliver held notifications whose title interval has ended
+    void release_due(Clock::time_point now, std::unique_lock<std::mutex>& lock) {
+        for (auto& state : titles_) {
+            if (state.held && (now == Clock::time_point::max() || now - state.last_delivered >= interval_)) {
+                Notification n = std::move(state.latest);
+                unsigned skipped = state.skipped + n.repeats;
+                state.held = false;
+                state.skipped = 0;
+                state.last_delivered = Clock::now();
+                deliver(n, skipped, lock);
+            }
+        }
+    }
+
+    bool next_release(Clock::time_point& next) const {
+        bool any = false;
+        for (const auto& state : titles_) {
+            if (state.held && (!any || state.last_delivered + interval_ < next)) {
+                next = state.last_delivered + interval_;
+                any = true;
+            }
+        }
+        return any;
+    }
+
+    TitleState& title_state(const std::string& title) {
+        for (auto& state : titles_) {
+            if (state.title == title) {
+                return state;
+            }
+        }
+        if (titles_.size() < MAX_TITLES) {
+            titles_.push_back(TitleState{title, {}, false, {}, 0});
+            return titles_.back();
+        }
+        // Table full: reuse the least recently delivered idle title
+        TitleState* oldest = nullptr;
+        for (auto& state : titles_) {
+            if (!state.held && (oldest == nullptr || state.last_delivered < oldest->last_delivered)) {
+                oldest = &state;
+            }
+        }
+        if (oldest == nullptr) {
+            oldest = &titles_.front();
+        }
+        *oldest = TitleState{title, {}, false, {}, 0};
+        return *oldest;
+    }
+
+    // Runs with the lock released so posting never waits on syslog or exec
+    void deliver(const Notification& n, unsigned skipped, std::unique_lock<std::mutex>& lock) {
+        stats_.delivered++;
+        lock.unlock();
+
+        std::string text = n.message;
+        if (skipped > 0) {
+            text += " (" + std::to_string(skipped) + " similar event" + (skipped == 1 ? "" : "s") + " suppressed)";
+        }
+        syslog(syslog_priority(n.urgency), "%s: %s", n.title.c_str(), text.c_str());
+        notify_desktop(n, text);
+
+        lock.lock();
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread worker_;
+    bool stopping_ = false;
+
+    std::vector<Notification> queue_;   // Ring of QUEUE_CAPACITY entries
+    size_t head_ = 0;
+    size_t count_ = 0;
+
+    std::vector<TitleState> titles_;
+    std::chrono::seconds interval_{60};
+    NotificationStats stats_;
+};
+
+}  // namespace
+
+// Function to send system notification
+void send_notification(const std::string& title, const std::string& message, const std::string& notification_user, const std::string& urgency) {
+    Notifier::instance().post(Notification{title, message, notification_user, urgency, 0});
+}
+
+void set_notification_interval(std::chrono::seconds interval) {
+    Notifier::instance().set_interval(interval);
+}
+
+NotificationStats notification_stats() {
+    return Notifier::instance().stats();
+}
@@ -0,0 +1,39 @@
+/*
+ * System Notifications
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Connection events are reported to syslog and, when a desktop session is
+ * available, as a desktop notification for `notification_user`.
+ *
+ * send_notification() only appends to a small bounded queue and returns; a
+ * background worker thread does the slow part (syslog(3) and spawning
+ * notify-send without a shell), so the forwarding loop never waits on it.
+ * Identical events still queued are coalesced, and each title is delivered
+ * at most once per interval: repeats inside the interval are held back and
+ * the latest one is delivered when it ends, with a count of those skipped.
+ * When the queue is full new events are dropped and counted.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+struct NotificationStats {
+    uint64_t posted = 0;        // send_notification() calls
+    uint64_t delivered = 0;     // Notifications written to syslog
+    uint64_t coalesced = 0;     // Merged into an identical queued event
+    uint64_t suppressed = 0;    // Held back by the per-title interval
+    uint64_t dropped = 0;       // Queue full
+};
+
+// Function to send system notification
+void send_notification(const std::string& title, const std::string& message, const std::string& notification_user, const std::string& urgency = "normal");
+
+// Minimum time between two notifications with the same title (default 60 s)
+void set_notification_interval(std::chrono::seconds interval);
+
+NotificationStats notification_stats();
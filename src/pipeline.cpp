@@ -0,0 +1,421 @@
+/*
+ * Threaded Pipeline
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "pipeline.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "log.h"
+
+namespace {
+
+// Ingest sentences handled per ring per wakeup, so a flooded input cannot
+// starve the others or the timers on the decode thread
+constexpr size_t DRAIN_BUDGET = 1024;
+
+void notify(int fd) {
+    uint64_t one = 1;
+    ssize_t written = write(fd, &one, sizeof(one));
+    (void)written;      // Only fails if the counter would overflow, which still wakes the reader
+}
+
+void clear(int fd) {
+    uint64_t value;
+    ssize_t got = read(fd, &value, sizeof(value));
+    (void)got;
+}
+
+void setup_thread(const std::string& name, int cpu) {
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+    if (cpu < 0) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        log_error() << get_timestamp() << " - Could not pin " << name << " to CPU " << cpu << ": "
+                    << std::strerror(err);
+    }
+}
+
+}  // namespace
+
+// One input on its own thread, feeding one ring
+struct Pipeline::Ingest : public SentenceSink {
+    Ingest(Pipeline& pipeline, const InputConfig& input, uint16_t id, int cpu)
+        : pipeline(pipeline),
+          ring(static_cast<size_t>(pipeline.config_.pipeline_queue)),
+          id(id),
+          cpu(cpu),
+          capturing(!pipeline.config_.capture.empty()) {
+        this->input = make_input(input, id, loop, *this, pipeline.config_);
+    }
+
+    ~Ingest() override {
+        if (stop_fd != -1) {
+            close(stop_fd);
+        }
+    }
+
+    void on_sentence(std::string_view sentence, Clock::time_point now, uint16_t) override {
+        // The forwarder drops everything else anyway; don't queue it, unless
+        // it is to be captured
+        if (!capturing && sentence.rfind("!AIVD", 0) != 0) {
+            return;
+        }
+        bool fits = sentence.size() <= sizeof(IngestSlot::text);
+        if (!fits) {
+            oversize++;
+            if (!capturing) {
+                return;
+            }
+        }
+        IngestSlot* slot = pipeline.claim(ring, dropped, pipeline.wake_fd_);
+        if (slot == nullptr) {
+            return;
+        }
+        slot->time = now;
+        slot->length = fits ? static_cast<uint16_t>(sentence.size()) : SLOT_MISSED;
+        if (fits) {
+            std::memcpy(slot->text, sentence.data(), sentence.size());
+        }
+        ring.publish();
+        queued++;
+        published = true;
+    }
+
+    void on_source_reset(uint16_t) override {
+        // Never dropped: fragments from the old stream must not complete
+        // messages from the new one
+        IngestSlot* slot;
+        while ((slot = ring.claim()) == nullptr) {
+            if (pipeline.stopping_.load(std::memory_order_relaxed)) {
+                return;
+            }
+            notify(pipeline.wake_fd_);
+            std::this_thread::yield();
+        }
+        slot->time = Clock::now();
+        slot->length = 0;
+        ring.publish();
+        published = true;
+    }
+
+    void run() {
+        setup_thread("ais-ingest-" + std::to_string(id), cpu);
+
+        // Wake the decode thread once per batch rather than per sentence
+        loop.set_after_dispatch([this] {
+            if (published) {
+                published = false;
+                notify(pipeline.wake_fd_);
+            }
+        });
+        loop.add(stop_fd, EPOLLIN, [this](uint32_t) { loop.stop(); });
+
+        // Input statistics belong to this thread
+        loop.add_timer(std::chrono::minutes(10), std::chrono::minutes(10), [this] { input->log_stats(); });
+
+        input->start();
+        loop.run();
+    }
+
+    Pipeline& pipeline;
+    SpscRing<IngestSlot> ring;
+    EventLoop loop;
+    std::unique_ptr<Input> input;
+    uint16_t id;
+    int cpu;
+    bool capturing;                 // Everything is queued for the capture file
+    int stop_fd = -1;
+    std::thread thread;
+    bool published = false;         // Since the last wakeup of the decode thread
+    Counter queued;
+    Counter dropped;                // Ring full
+    Counter oversize;               // Sentence longer than a slot
+};
+
+Pipeline::Pipeline(const Config& config, const std::vector<InputConfig>& inputs, Forwarder& forwarder,
+                   EventLoop& loop)
+    : config_(config),
+      inputs_(inputs),
+      forwarder_(forwarder),
+      loop_(loop),
+      output_(&forwarder.output()),
+      egress_ring_(static_cast<size_t>(config.pipeline_queue)) {
+}
+
+Pipeline::~Pipeline() {
+    stop();
+    for (int fd : {wake_fd_, egress_fd_, egress_stop_fd_}) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+}
+
+bool Pipeline::start() {
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    egress_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    egress_stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ == -1 || egress_fd_ == -1 || egress_stop_fd_ == -1 ||
+        !loop_.add(wake_fd_, EPOLLIN, [this](uint32_t) { drain(); })) {
+        log_error() << get_timestamp() << " - Error creating pipeline: " << std::strerror(errno);
+        return false;
+    }
+
+    std::vector<std::unique_ptr<Ingest>> ingests;
+    for (size_t i = 0; i < inputs_.size(); i++) {
+        int cpu = config_.cpu_ingest.empty() ? -1 : config_.cpu_ingest[i % config_.cpu_ingest.size()];
+        auto ingest = std::make_unique<Ingest>(*this, inputs_[i], static_cast<uint16_t>(i), cpu);
+        ingest->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (ingest->stop_fd == -1 || !ingest->loop.valid()) {
+            log_error() << get_timestamp() << " - Error creating pipeline input thread for " << inputs_[i].spec;
+            loop_.remove(wake_fd_);
+            return false;
+        }
+        ingests.push_back(std::move(ingest));
+    }
+
+    // This thread becomes the decode stage
+    setup_thread("ais-decode", config_.cpu_decode);
+
+    forwarder_.set_egress(this);
+    started_ = true;
+    egress_thread_ = std::thread(&Pipeline::run_egress, this);
+    ingests_ = std::move(ingests);
+    for (auto& ingest : ingests_) {
+        ingest->thread = std::thread(&Ingest::run, ingest.get());
+    }
+
+    log_info() << get_timestamp() << " - Pipeline mode: " << ingests_.size() << " input thread"
+               << (ingests_.size() == 1 ? "" : "s") << ", " << egress_ring_.capacity() << "-slot queues, "
+               << (config_.pipeline_block ? "blocking" : "dropping") << " when full";
+    return true;
+}
+
+void Pipeline::stop() {
+    if (!started_) {
+        return;
+    }
+    started_ = false;
+    stopping_.store(true, std::memory_order_relaxed);
+
+    for (auto& ingest : ingests_) {
+        notify(ingest->stop_fd);
+        ingest->thread.join();
+    }
+    ingests_.clear();
+
+    notify(egress_stop_fd_);
+    egress_thread_.join();
+
+    forwarder_.set_egress(nullptr);
+    loop_.remove(wake_fd_);
+}
+
+void Pipeline::pause_egress() {
+    if (!started_) {
+        return;
+    }
+    commit();
+    notify(egress_stop_fd_);
+    egress_thread_.join();
+    clear(egress_stop_fd_);
+}
+
+void Pipeline::resume_egress() {
+    if (!started_) {
+        return;
+    }
+    output_ = &forwarder_.output();
+    egress_thread_ = std::thread(&Pipeline::run_egress, this);
+}
+
+template <typename T>
+T* Pipeline::claim(SpscRing<T>& ring, Counter& dropped, int consumer_fd) {
+    T* slot = ring.claim();
+    if (slot != nullptr) {
+        return slot;
+    }
+    if (config_.pipeline_block) {
+        // The consumer may be asleep until our next batch wakeup; wake it now
+        notify(consumer_fd);
+        while (!stopping_.load(std::memory_order_relaxed)) {
+            std::this_thread::yield();
+            if ((slot = ring.claim()) != nullptr) {
+                return slot;
+            }
+        }
+    }
+    dropped++;
+    return nullptr;
+}
+
+void Pipeline::drain() {
+    // Clear first: anything queued after this point wakes us again
+    clear(wake_fd_);
+
+    bool more = false;
+    for (auto& ingest : ingests_) {
+        size_t handled = 0;
+        IngestSlot* slot;
+        while (handled < DRAIN_BUDGET && (slot = ingest->ring.peek()) != nullptr) {
+            if (slot->length == 0) {
+                forwarder_.on_source_reset(ingest->id);
+            } else if (slot->length == SLOT_MISSED) {
+                forwarder_.missed_sentence();
+            } else {
+                forwarder_.process(std::string_view(slot->text, slot->length), slot->time, ingest->id);
+            }
+            ingest->ring.release();
+            handled++;
+        }
+        decoded_ += handled;
+        more |= handled == DRAIN_BUDGET;
+    }
+    if (more) {
+        notify(wake_fd_);
+    }
+}
+
+bool Pipeline::push(const std::string_view* sentences, size_t count, uint64_t selected, Clock::time_point now) {
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        bytes += sentences[i].size();
+    }
+    if (count > AIS_MAX_FRAGMENTS || bytes > sizeof(EgressSlot::text)) {
+        egress_oversize_++;
+        return false;
+    }
+
+    EgressSlot* slot = claim(egress_ring_, egress_dropped_, egress_fd_);
+    if (slot == nullptr) {
+        return false;
+    }
+    slot->time = now;
+    slot->selected = selected;
+    slot->count = static_cast<uint8_t>(count);
+    char* text = slot->text;
+    for (size_t i = 0; i < count; i++) {
+        slot->lengths[i] = static_cast<uint16_t>(sentences[i].size());
+        std::memcpy(text, sentences[i].data(), sentences[i].size());
+        text += sentences[i].size();
+    }
+    egress_ring_.publish();
+    egress_queued_++;
+    pushed_ = true;
+    return true;
+}
+
+void Pipeline::commit() {
+    if (pushed_) {
+        pushed_ = false;
+        notify(egress_fd_);
+    }
+}
+
+void Pipeline::send_egress() {
+    EgressSlot* slot;
+    while ((slot = egress_ring_.peek()) != nullptr) {
+        std::string_view sentences[AIS_MAX_FRAGMENTS];
+        const char* text = slot->text;
+        for (size_t i = 0; i < slot->count; i++) {
+            sentences[i] = std::string_view(text, slot->lengths[i]);
+            text += slot->lengths[i];
+        }
+        output_->send(sentences, slot->count, slot->selected, slot->time);
+        egress_ring_.release();
+    }
+}
+
+void Pipeline::run_egress() {
+    setup_thread("ais-egress", config_.cpu_egress);
+
+    EventLoop loop;
+    if (!loop.valid()) {
+        log_error() << get_timestamp() << " - Error creating egress event loop";
+        return;
+    }
+    loop.add(egress_fd_, EPOLLIN, [this](uint32_t) {
+        clear(egress_fd_);
+        send_egress();
+    });
+    loop.add(egress_stop_fd_, EPOLLIN, [&loop](uint32_t) { loop.stop(); });
+
+    // Same batching as the single-threaded loop: send after each wakeup and
+    // wake for the next packed datagram deadline
+    int flush_timer = loop.add_timer(std::chrono::milliseconds(0), std::chrono::milliseconds(0), [] {});
+    Clock::time_point flush_armed;
+    loop.set_after_dispatch([this, &loop, flush_timer, &flush_armed] {
+        auto now = Clock::now();
+        output_->flush(now);
+
+        Clock::time_point deadline;
+        if (output_->next_deadline(deadline) && (deadline != flush_armed || flush_armed <= now)) {
+            auto wait = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+            loop.arm_timer(flush_timer, std::max(wait, std::chrono::milliseconds(1)));
+            flush_armed = deadline;
+        }
+    });
+
+    loop.run();
+
+    // Send what the decode thread handed over before stopping
+    send_egress();
+    output_->flush(Clock::now());
+    loop.remove_timer(flush_timer);
+}
+
+bool Pipeline::idle() const {
+    for (const auto& ingest : ingests_) {
+        if (ingest->ring.size() != 0) {
+            return false;
+        }
+    }
+    return egress_ring_.size() == 0;
+}
+
+void Pipeline::log_stats() const {
+    for (const auto& ingest : ingests_) {
+        log_info() << get_timestamp() << " - Pipeline input " << ingest->input->input_config().spec << ": "
+                   << ingest->queued << " queued, " << ingest->dropped << " dropped when full, " << ingest->oversize
+                   << " oversize";
+    }
+    log_info() << get_timestamp() << " - Pipeline egress: " << decoded_ << " sentences decoded, " << egress_queued_
+               << " messages queued, " << egress_dropped_ << " dropped when full, " << egress_oversize_
+               << " oversize";
+}
+
+void Pipeline::register_metrics(MetricsRegistry& metrics) const {
+    for (const auto& ingest : ingests_) {
+        ingest->input->register_metrics(metrics);
+        std::string labels = MetricsRegistry::label("input", ingest->input->input_config().spec);
+        metrics.counter("ais_pipeline_ingest_queued_total", "Sentences queued for the decode thread", labels,
+                        ingest->queued);
+        metrics.counter("ais_pipeline_ingest_dropped_total", "Sentences dropped on the way to the decode thread",
+                        labels + "," + MetricsRegistry::label("reason", "full"), ingest->dropped);
+        metrics.counter("ais_pipeline_ingest_dropped_total", "",
+                        labels + "," + MetricsRegistry::label("reason", "oversize"), ingest->oversize);
+    }
+    metrics.counter("ais_pipeline_decoded_total", "Sentences taken by the decode thread", "", decoded_);
+    metrics.counter("ais_pipeline_egress_queued_total", "Messages queued for the egress thread", "", egress_queued_);
+    metrics.counter("ais_pipeline_egress_dropped_total", "Messages dropped on the way to the egress thread",
+                    MetricsRegistry::label("reason", "full"), egress_dropped_);
+    metrics.counter("ais_pipeline_egress_dropped_total", "", MetricsRegistry::label("reason", "oversize"),
+                    egress_oversize_);
+}
@@ -0,0 +1,131 @@
+/*
+ * Threaded Pipeline
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Optional multi-threaded mode (`pipeline=on`) for stations with many busy
+ * inputs and cores to spare. The default single-threaded loop is cheaper
+ * on one core, so this stays off unless asked for.
+ *
+ *   ingest thread per input --SPSC ring--> decode thread --SPSC ring--> egress thread
+ *   (socket, framing)                      (Forwarder)                  (UdpOutput send)
+ *
+ * Each ingest thread runs its Input on its own EventLoop and copies every
+ * "!AIVD" sentence into its ring, waking the decode thread through an
+ * eventfd once per batch. The decode thread is the caller's loop: it drains
+ * the rings into the Forwarder, which picks destinations and pushes the
+ * sentences and that choice into the egress ring. The egress thread owns
+ * the send side of UdpOutput, including packing deadlines and sendmmsg().
+ *
+ * A full ring either drops the new item and counts it (`pipeline_full=drop`,
+ * the default, so a stalled stage never backs up into socket buffers) or
+ * waits for room (`pipeline_full=block`). Each thread can be pinned to a
+ * CPU with `cpu_ingest`, `cpu_decode` and `cpu_egress`.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "config.h"
+#include "counter.h"
+#include "event_loop.h"
+#include "forwarder.h"
+#include "fragment_reassembler.h"
+#include "inputs.h"
+#include "metrics.h"
+#include "spsc_ring.h"
+
+class Pipeline : public EgressSink {
+public:
+    Pipeline(const Config& config, const std::vector<InputConfig>& inputs, Forwarder& forwarder, EventLoop& loop);
+    ~Pipeline() override;
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    // Start the egress and ingest threads and take over the forwarder's
+    // output; false on failure
+    bool start();
+
+    // Stop and join every thread; the forwarder sends on its own again
+    void stop();
+
+    // Send what is queued and stop the egress thread, e.g. while the
+    // forwarder's output is replaced; resume_egress() restarts it on the
+    // forwarder's current output. Called on the decode thread.
+    void pause_egress();
+    void resume_egress();
+
+    bool push(const std::string_view* sentences, size_t count, uint64_t selected, Clock::time_point now) override;
+    void commit() override;
+
+    // True once every ring is empty, e.g. after a finite input
+    bool idle() const;
+
+    void log_stats() const;
+
+    // Add the queue counters, and those of the inputs run by the ingest
+    // threads, to `metrics`
+    void register_metrics(MetricsRegistry& metrics) const;
+
+private:
+    // Sentence as received, plus input resets
+    struct IngestSlot {
+        Clock::time_point time;
+        uint16_t length;            // 0 = the input was reset, SLOT_MISSED = see below
+        char text[118];
+    };
+
+    // A sentence too long for a slot was received, and the capture file
+    // should count it as missed
+    static constexpr uint16_t SLOT_MISSED = 0xffff;
+
+    // Message ready to send
+    struct EgressSlot {
+        Clock::time_point time;
+        uint64_t selected;
+        uint8_t count;
+        uint16_t lengths[AIS_MAX_FRAGMENTS];
+        char text[484];
+    };
+
+    struct Ingest;
+
+    void drain();
+    void run_egress();
+    void send_egress();
+    template <typename T>
+    T* claim(SpscRing<T>& ring, Counter& dropped, int consumer_fd);
+
+    const Config& config_;
+    std::vector<InputConfig> inputs_;
+    Forwarder& forwarder_;
+    EventLoop& loop_;
+    UdpOutput* output_;             // Replaced while the egress thread is paused
+    std::atomic<bool> stopping_{false};
+    bool started_ = false;
+
+    // Decode side
+    int wake_fd_ = -1;              // Ingest threads have queued sentences
+    std::vector<std::unique_ptr<Ingest>> ingests_;
+    Counter decoded_;
+
+    // Egress side
+    SpscRing<EgressSlot> egress_ring_;
+    int egress_fd_ = -1;            // Messages have been pushed
+    int egress_stop_fd_ = -1;
+    std::thread egress_thread_;
+    bool pushed_ = false;           // Since the last commit()
+    Counter egress_queued_;
+    Counter egress_dropped_;
+    Counter egress_oversize_;
+};
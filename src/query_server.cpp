@@ -0,0 +1,156 @@
+/*
+ * Vessel Query Server
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "query_server.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "log.h"
+
+namespace {
+
+// Append a JSON string, trimming the '@'/space padding of AIS text fields
+void append_json_string(std::string& out, const char* text) {
+    std::string_view value(text);
+    size_t end = value.find_last_not_of(" @");
+    value = end == std::string_view::npos ? std::string_view() : value.substr(0, end + 1);
+
+    out += '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+}  // namespace
+
+QueryServer::QueryServer(EventLoop& loop, const VesselTable& vessels, const Config& config)
+    : vessels_(vessels),
+      config_(config),
+      http_(loop, MAX_CLIENTS, [this](const std::string& method, const std::string& path) {
+          return respond(method, path);
+      }) {
+}
+
+bool QueryServer::start() {
+    if (!http_.listen(config_.query_bind, config_.query_port, "query server")) {
+        return false;
+    }
+    log_info() << get_timestamp() << " - Serving vessel queries on http://" << config_.query_bind << ":"
+               << config_.query_port << "/vessels";
+    return true;
+}
+
+std::string QueryServer::respond(const std::string& method, const std::string& path) {
+    requests_++;
+
+    if (method != "GET") {
+        return http_response("405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+    } else if (path == "/" || path == "/vessels" || path == "/vessels.json") {
+        return http_response("200 OK", "application/json", vessels_json());
+    } else if (path == "/vessels.nmea") {
+        return http_response("200 OK", "text/plain", vessels_nmea());
+    } else if (path.rfind("/vessels/", 0) == 0) {
+        char* end = nullptr;
+        unsigned long mmsi = std::strtoul(path.c_str() + 9, &end, 10);
+        long slot = (*end == '\0' && mmsi > 0 && mmsi <= 999999999) ? vessels_.find(static_cast<uint32_t>(mmsi)) : -1;
+        if (slot < 0) {
+            return http_response("404 Not Found", "text/plain", "Unknown MMSI\n");
+        }
+        return http_response("200 OK", "application/json", vessel_json(static_cast<size_t>(slot)) + "\n");
+    }
+    return http_response("404 Not Found", "text/plain", "Try /vessels, /vessels/<mmsi> or /vessels.nmea\n");
+}
+
+std::string QueryServer::vessel_json(size_t slot) const {
+    VesselInfo v;
+    vessels_.get(slot, v);
+    auto now = std::chrono::steady_clock::now();
+
+    char number[256];
+    std::string out;
+    snprintf(number, sizeof(number), "{\"mmsi\":%u,\"type\":%u,\"own_ship\":%s,", v.mmsi, v.last_type,
+             v.own_ship ? "true" : "false");
+    out += number;
+
+    if (v.has_position) {
+        snprintf(number, sizeof(number), "\"lat\":%.6f,\"lon\":%.6f,", ais_degrees(v.lat), ais_degrees(v.lon));
+        out += number;
+    } else {
+        out += "\"lat\":null,\"lon\":null,";
+    }
+    if (v.sog != AIS_SOG_NOT_AVAILABLE) {
+        snprintf(number, sizeof(number), "\"sog\":%.1f,", ais_knots(v.sog));
+        out += number;
+    } else {
+        out += "\"sog\":null,";
+    }
+    if (v.cog != AIS_COG_NOT_AVAILABLE) {
+        snprintf(number, sizeof(number), "\"cog\":%.1f,", ais_course(v.cog));
+        out += number;
+    } else {
+        out += "\"cog\":null,";
+    }
+    if (v.heading != AIS_HEADING_NOT_AVAILABLE) {
+        snprintf(number, sizeof(number), "\"heading\":%u,", v.heading);
+        out += number;
+    } else {
+        out += "\"heading\":null,";
+    }
+
+    snprintf(number, sizeof(number),
+             "\"nav_status\":%u,\"imo\":%u,\"shiptype\":%u,\"length\":%u,\"beam\":%u,\"draught\":%.1f,",
+             v.nav_status, v.imo, v.shiptype, v.to_bow + v.to_stern, v.to_port + v.to_starboard, v.draught / 10.0);
+    out += number;
+
+    out += "\"name\":";
+    append_json_string(out, v.shipname);
+    out += ",\"callsign\":";
+    append_json_string(out, v.callsign);
+    out += ",\"destination\":";
+    append_json_string(out, v.destination);
+
+    snprintf(number, sizeof(number), ",\"last_seen\":%lld,\"age\":%lld}",
+             static_cast<long long>(vessels_.wall_time(v.last_seen)),
+             static_cast<long long>(std::chrono::duration_cast<std::chrono::seconds>(now - v.last_seen).count()));
+    out += number;
+    return out;
+}
+
+std::string QueryServer::vessels_json() const {
+    std::string out = "{\"count\":" + std::to_string(vessels_.size()) + ",\"vessels\":[";
+    out.reserve(vessels_.size() * 320 + 64);
+    for (size_t slot = 0; slot < vessels_.size(); slot++) {
+        if (slot > 0) {
+            out += ',';
+        }
+        out += vessel_json(slot);
+    }
+    out += "]}\n";
+    return out;
+}
+
+std::string QueryServer::vessels_nmea() const {
+    std::string out;
+    out.reserve(vessels_.size() * 160);
+    VesselInfo v;
+    for (size_t slot = 0; slot < vessels_.size(); slot++) {
+        vessels_.get(slot, v);
+        for (std::string_view sentence : {v.static_sentences[0], v.static_sentences[1], v.position_sentence}) {
+            if (!sentence.empty()) {
+                out.append(sentence.data(), sentence.size());
+                out += "\r\n";
+            }
+        }
+    }
+    return out;
+}
@@ -0,0 +1,54 @@
+/*
+ * Vessel Query Server
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Minimal HTTP/1.0 endpoint on the event loop serving snapshots of the
+ * vessel table, so dashboards can query the forwarder instead of running
+ * their own decoder:
+ *
+ *   GET /vessels          All vessels as JSON
+ *   GET /vessels/<mmsi>   One vessel as JSON
+ *   GET /vessels.nmea     Latest position and static sentences of every
+ *                         vessel, replayed as NMEA
+ *
+ * The connections are handled by HttpServer.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "config.h"
+#include "event_loop.h"
+#include "http_server.h"
+#include "vessel_table.h"
+
+class QueryServer {
+public:
+    static constexpr size_t MAX_CLIENTS = 16;
+
+    QueryServer(EventLoop& loop, const VesselTable& vessels, const Config& config);
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    // Start listening on query_bind:query_port; false on failure
+    bool start();
+
+    uint64_t requests() const { return requests_; }
+
+private:
+    std::string respond(const std::string& method, const std::string& path);
+    std::string vessels_json() const;
+    std::string vessel_json(size_t slot) const;
+    std::string vessels_nmea() const;
+
+    const VesselTable& vessels_;
+    const Config& config_;
+    HttpServer http_;
+    uint64_t requests_ = 0;
+};
@@ -0,0 +1,110 @@
+/*
+ * Per-MMSI Rate Limiter
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "rate_limiter.h"
+
+#include <algorithm>
+
+#include "hash.h"
+
+MmsiRateLimiter::MmsiRateLimiter(std::chrono::seconds position_interval, std::chrono::seconds static_interval,
+                                 size_t capacity)
+    : position_interval_(static_cast<uint32_t>(std::max<int64_t>(position_interval.count(), 0) * 10)),
+      static_interval_(static_cast<uint32_t>(std::max<int64_t>(static_interval.count(), 0) * 10)),
+      max_interval_(std::max(position_interval_, static_interval_)),
+      epoch_(Clock::now()) {
+    size_t size = MAX_PROBE;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    entries_.resize(size);
+    mask_ = size - 1;
+}
+
+uint32_t MmsiRateLimiter::to_stamp(Clock::time_point now) const {
+    auto ds = std::chrono::duration_cast<std::chrono::milliseconds>(now - epoch_).count() / 100;
+    return static_cast<uint32_t>(ds > 0 ? ds : 0) + 1;    // Never 0, which means "never"
+}
+
+MmsiRateLimiter::Entry& MmsiRateLimiter::lookup(uint32_t mmsi, uint32_t stamp) {
+    Entry* reuse = nullptr;
+    Entry* oldest = nullptr;
+    uint32_t oldest_used = 0;
+
+    size_t index = static_cast<size_t>(hash_mix64(mmsi)) & mask_;
+    for (size_t probe = 0; probe < MAX_PROBE; probe++) {
+        Entry& entry = entries_[(index + probe) & mask_];
+        if (entry.mmsi == mmsi) {
+            return entry;
+        }
+        if (entry.mmsi == 0) {
+            if (reuse == nullptr) {
+                reuse = &entry;
+            }
+            break;
+        }
+
+        uint32_t used = std::max({entry.position, entry.static_a, entry.static_b});
+        if (stamp - used >= max_interval_) {
+            // Too old to suppress anything any more
+            if (reuse == nullptr) {
+                reuse = &entry;
+            }
+        } else if (oldest == nullptr || used < oldest_used) {
+            oldest = &entry;
+            oldest_used = used;
+        }
+    }
+
+    if (reuse == nullptr) {
+        reuse = oldest;
+        evictions_++;
+    }
+    *reuse = Entry();
+    reuse->mmsi = mmsi;
+    return *reuse;
+}
+
+bool MmsiRateLimiter::allow(const AisMessage& msg, Clock::time_point now) {
+    uint32_t interval;
+    switch (msg.type) {
+    case 1: case 2: case 3: case 4: case 18: case 19: case 21:
+        interval = position_interval_;
+        break;
+    case 5: case 24:
+        interval = static_interval_;
+        break;
+    default:
+        return true;
+    }
+    if (interval == 0 || msg.mmsi == 0) {
+        return true;
+    }
+
+    uint32_t stamp = to_stamp(now);
+    Entry& entry = lookup(msg.mmsi, stamp);
+
+    uint32_t* last;
+    if (msg.type == 5 || (msg.type == 24 && msg.static_b.part == 0)) {
+        last = &entry.static_a;
+    } else if (msg.type == 24) {
+        last = &entry.static_b;
+    } else {
+        last = &entry.position;
+    }
+
+    if (*last != 0 && stamp - *last < interval) {
+        if (last == &entry.position) {
+            positions_suppressed_++;
+        } else {
+            statics_suppressed_++;
+        }
+        return false;
+    }
+    *last = stamp;
+    return true;
+}
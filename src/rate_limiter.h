@@ -0,0 +1,74 @@
+/*
+ * Per-MMSI Rate Limiter
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Class A vessels underway report every 2-10 seconds, but aggregators only
+ * need an update every 30-60 seconds per ship. This enforces a minimum
+ * interval between messages forwarded for each MMSI, with separate budgets
+ * for position reports and for static data, so a burst of positions never
+ * starves a ship's name and dimensions:
+ *
+ *   position budget   types 1, 2, 3, 4, 18, 19, 21
+ *   static budget     type 5 and type 24 part A, type 24 part B (own stamp)
+ *
+ * Any other type (safety messages, binary messages, ...) always passes.
+ * Only decoded messages reach the limiter, so types ais_decode_payload()
+ * does not decode, such as type 27 long-range positions, are never limited.
+ *
+ * State lives in an open-addressing table of 16-byte entries with bounded
+ * linear probing. An entry whose stamps are all older than the longest
+ * interval can no longer suppress anything and is reused; if a probe finds
+ * no reusable entry the least recently used one is overwritten, so memory
+ * is fixed however many ships are heard.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ais_decoder.h"
+
+class MmsiRateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t MAX_PROBE = 16;
+
+    // A zero interval disables that budget. `capacity` is rounded up to a power of two.
+    MmsiRateLimiter(std::chrono::seconds position_interval, std::chrono::seconds static_interval,
+                    size_t capacity = 16384);
+
+    // True if `msg` may be forwarded now; records it if so
+    bool allow(const AisMessage& msg, Clock::time_point now);
+
+    uint64_t positions_suppressed() const { return positions_suppressed_; }
+    uint64_t statics_suppressed() const { return statics_suppressed_; }
+    uint64_t evictions() const { return evictions_; }
+
+private:
+    struct Entry {
+        uint32_t mmsi = 0;          // 0 marks a never-used entry
+        uint32_t position = 0;      // Stamps in 1/10 s since epoch_, 0 = never
+        uint32_t static_a = 0;      // Type 5 or type 24 part A
+        uint32_t static_b = 0;      // Type 24 part B
+    };
+
+    Entry& lookup(uint32_t mmsi, uint32_t stamp);
+    uint32_t to_stamp(Clock::time_point now) const;
+
+    uint32_t position_interval_;    // In 1/10 s
+    uint32_t static_interval_;
+    uint32_t max_interval_;
+    std::vector<Entry> entries_;
+    size_t mask_;
+    Clock::time_point epoch_;
+
+    uint64_t positions_suppressed_ = 0;
+    uint64_t statics_suppressed_ = 0;
+    uint64_t evictions_ = 0;
+};
@@ -0,0 +1,99 @@
+/*
+ * Sentence Splitter
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "sentence_splitter.h"
+
+#include <cstring>
+#include <unistd.h>
+
+SentenceSplitter::SentenceSplitter(size_t capacity, size_t max_sentence)
+    : find_byte_(nmea_kernel().find_byte), capacity_(capacity), max_sentence_(max_sentence) {
+    // The buffer must be able to hold one maximum-length partial line plus
+    // a full read behind it, otherwise compaction could never free space
+    if (capacity_ < max_sentence_ * 2) {
+        capacity_ = max_sentence_ * 2;
+    }
+    buffer_.reset(new char[capacity_]);
+}
+
+char* SentenceSplitter::write_ptr() {
+    if (head_ == tail_) {
+        // Nothing pending, start again from the front for free
+        head_ = scan_ = tail_ = 0;
+    } else if (capacity_ - tail_ < max_sentence_) {
+        // Move the incomplete line to the front to make room
+        size_t pending = tail_ - head_;
+        std::memmove(buffer_.get(), buffer_.get() + head_, pending);
+        scan_ -= head_;
+        tail_ = pending;
+        head_ = 0;
+    }
+    return buffer_.get() + tail_;
+}
+
+void SentenceSplitter::commit(size_t n) {
+    if (n > capacity_ - tail_) {
+        n = capacity_ - tail_;
+    }
+    tail_ += n;
+}
+
+ssize_t SentenceSplitter::fill(int fd) {
+    char* dst = write_ptr();
+    ssize_t n = read(fd, dst, write_space());
+    if (n > 0) {
+        commit(static_cast<size_t>(n));
+    }
+    return n;
+}
+
+bool SentenceSplitter::next(std::string_view& sentence) {
+    const char* base = buffer_.get();
+
+    while (scan_ < tail_) {
+        const char* nl = find_byte_(base + scan_, base + tail_, '\n');
+        if (nl == base + tail_) {
+            scan_ = tail_;
+            break;
+        }
+
+        size_t start = head_;
+        size_t end = static_cast<size_t>(nl - base);
+        head_ = scan_ = end + 1;
+
+        if (discarding_) {
+            // This line ending terminates the overlong line we were skipping
+            discarding_ = false;
+            continue;
+        }
+
+        if (end > start && base[end - 1] == '\r') {
+            end--;
+        }
+        if (end == start) {
+            continue;  // Blank line
+        }
+
+        sentence = std::string_view(base + start, end - start);
+        return true;
+    }
+
+    // No complete line left; bound the size of the partial one
+    if (tail_ - head_ > max_sentence_) {
+        if (!discarding_) {
+            overlong_dropped_++;
+            discarding_ = true;
+        }
+        head_ = scan_ = tail_;
+    }
+    return false;
+}
+
+void SentenceSplitter::reset() {
+    head_ = scan_ = tail_ = 0;
+    discarding_ = false;
+}
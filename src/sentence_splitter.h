@@ -0,0 +1,76 @@
+/*
+ * Sentence Splitter
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Frames a byte stream from the AIS transponder into individual NMEA sentences.
+ * Data is received directly into a fixed-size buffer allocated once at startup,
+ * and complete sentences are handed out as std::string_view pointing into that
+ * buffer, so no per-sentence allocation or copy takes place.
+ *
+ * - Accepts both "\r\n" and bare "\n" line endings.
+ * - Embedded NUL bytes are carried through rather than truncating the stream.
+ * - A partial line longer than the configured maximum is discarded up to the
+ *   next line ending, so a garbage feed cannot grow memory or stall framing.
+ *
+ * Line endings are located with the vectorized search from nmea_scan.h.
+ *
+ * When the free space at the end of the buffer runs out, the single incomplete
+ * line at the front is moved back to offset zero. That copy is bounded by the
+ * maximum sentence length and happens once per buffer wrap, not once per line.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <sys/types.h>
+
+#include "nmea_scan.h"
+
+class SentenceSplitter {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 16 * 1024;
+    static constexpr size_t DEFAULT_MAX_SENTENCE = 512;   // NMEA allows 82, leave room for tag blocks
+
+    explicit SentenceSplitter(size_t capacity = DEFAULT_CAPACITY,
+                              size_t max_sentence = DEFAULT_MAX_SENTENCE);
+
+    SentenceSplitter(const SentenceSplitter&) = delete;
+    SentenceSplitter& operator=(const SentenceSplitter&) = delete;
+
+    // Writable region for the next recv()/read(); always at least max_sentence bytes
+    char* write_ptr();
+    size_t write_space() const { return capacity_ - tail_; }
+
+    // Mark `n` bytes written at write_ptr() as received
+    void commit(size_t n);
+
+    // Convenience wrapper: read(2) from `fd` straight into the buffer and commit.
+    // Returns the read() result unchanged so callers keep their own error handling.
+    ssize_t fill(int fd);
+
+    // Fetch the next complete sentence without its line ending. The view stays
+    // valid until the next call to write_ptr(), fill() or reset().
+    bool next(std::string_view& sentence);
+
+    // Drop all buffered data, e.g. after a reconnect
+    void reset();
+
+    size_t buffered() const { return tail_ - head_; }
+    uint64_t overlong_dropped() const { return overlong_dropped_; }
+
+private:
+    const char* (*find_byte_)(const char*, const char*, char);  // Newline search from the active scan kernel
+    std::unique_ptr<char[]> buffer_;
+    size_t capacity_;
+    size_t max_sentence_;
+    size_t head_ = 0;       // Start of the first unconsumed byte
+    size_t scan_ = 0;       // Everything in [head_, scan_) is known to contain no '\n'
+    size_t tail_ = 0;       // End of received data
+    bool discarding_ = false;  // Skipping the remainder of an overlong line
+    uint64_t overlong_dropped_ = 0;
+};
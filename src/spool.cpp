@@ -0,0 +1,231 @@
+/*
+ * Disk Spool
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "spool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "hash.h"
+#include "log.h"
+
+namespace {
+
+constexpr char MAGIC[8] = {'A', 'I', 'S', 'S', 'P', 'O', 'O', 'L'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 4096;
+constexpr size_t RECORD_HEADER = 8;
+
+// Layout of the first bytes of the header page
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t capacity;
+    uint64_t head;
+    uint64_t tail;
+};
+
+}  // namespace
+
+Spool::Spool(const std::string& path, size_t capacity) : path_(path), capacity_(capacity) {
+}
+
+Spool::~Spool() {
+    if (map_ != nullptr) {
+        msync(map_, HEADER_SIZE + capacity_, MS_SYNC);
+        munmap(map_, HEADER_SIZE + capacity_);
+    }
+}
+
+bool Spool::open() {
+    int fd = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        log_error() << get_timestamp() << " - Cannot open spool " << path_ << ": " << strerror(errno);
+        return false;
+    }
+
+    // Allocate the whole file up front so a full disk shows up now, not as
+    // SIGBUS when a page is first written
+    struct stat st;
+    size_t size = HEADER_SIZE + capacity_;
+    bool existing = fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == size;
+    int error = existing ? 0 : ftruncate(fd, 0) < 0 ? errno : posix_fallocate(fd, 0, static_cast<off_t>(size));
+    if (error == 0) {
+        void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        map_ = map == MAP_FAILED ? nullptr : static_cast<char*>(map);
+        error = map_ == nullptr ? errno : 0;
+    }
+    close(fd);
+    if (error != 0) {
+        log_error() << get_timestamp() << " - Cannot map spool " << path_ << ": " << strerror(error);
+        return false;
+    }
+    ring_ = map_ + HEADER_SIZE;
+
+    Header header;
+    std::memcpy(&header, map_, sizeof(header));
+    if (existing && std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+        header.capacity == capacity_ && header.head <= header.tail && header.tail - header.head <= capacity_) {
+        head_ = header.head;
+        tail_ = header.tail;
+        recover();
+    } else {
+        if (existing) {
+            log_error() << get_timestamp() << " - Spool " << path_ << " has a different size or format; starting empty";
+        }
+        header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.capacity = capacity_;
+        std::memcpy(map_, &header, sizeof(header));
+        dirty_ = true;
+    }
+    synced_tail_ = tail_;
+    return true;
+}
+
+// Walk the records from the head; keep those that verify
+void Spool::recover() {
+    std::vector<char> data(MAX_RECORD);
+    uint64_t offset = head_;
+    uint64_t count = 0;
+    while (offset < tail_) {
+        uint32_t fields[2];
+        if (tail_ - offset < RECORD_HEADER) {
+            break;
+        }
+        read_at(offset, fields, sizeof(fields));
+        if (fields[0] == 0 || fields[0] > MAX_RECORD || fields[0] > tail_ - offset - RECORD_HEADER) {
+            break;
+        }
+        read_at(offset + RECORD_HEADER, data.data(), fields[0]);
+        if (check(offset, data.data(), fields[0]) != fields[1]) {
+            break;
+        }
+        offset += RECORD_HEADER + fields[0];
+        count++;
+    }
+
+    if (offset != tail_) {
+        log_error() << get_timestamp() << " - Spool " << path_ << ": discarded " << tail_ - offset
+                    << " bytes of records that did not survive a crash";
+        tail_ = offset;
+        publish();
+    }
+    records_ = count;
+    bytes_ = tail_ - head_;
+    if (count > 0) {
+        log_info() << get_timestamp() << " - Spool " << path_ << " holds " << count << " datagrams";
+    }
+}
+
+bool Spool::push(const char* data, size_t length) {
+    size_t needed = RECORD_HEADER + length;
+    if (length == 0 || length > MAX_RECORD || needed > capacity_) {
+        return false;
+    }
+
+    // Oldest first
+    while (tail_ + needed - head_ > capacity_) {
+        uint32_t evicted_length;
+        read_at(head_, &evicted_length, sizeof(evicted_length));
+        head_ += RECORD_HEADER + evicted_length;
+        records_ = records_ - 1;
+        evicted_++;
+    }
+
+    uint32_t fields[2] = {static_cast<uint32_t>(length), check(tail_, data, length)};
+    write_at(tail_, fields, sizeof(fields));
+    write_at(tail_ + RECORD_HEADER, data, length);
+    tail_ += needed;
+    records_++;
+    bytes_ = tail_ - head_;
+    publish();
+    return true;
+}
+
+size_t Spool::front(char* out) const {
+    if (empty()) {
+        return 0;
+    }
+    uint32_t length;
+    read_at(head_, &length, sizeof(length));
+    read_at(head_ + RECORD_HEADER, out, length);
+    return length;
+}
+
+void Spool::pop() {
+    if (empty()) {
+        return;
+    }
+    uint32_t length;
+    read_at(head_, &length, sizeof(length));
+    head_ += RECORD_HEADER + length;
+    records_ = records_ - 1;
+    bytes_ = tail_ - head_;
+    publish();
+}
+
+void Spool::sync() {
+    if (!dirty_) {
+        return;
+    }
+    // Only the header and the records appended since the last sync changed;
+    // popping moves the head without touching the ring
+    msync(map_, HEADER_SIZE, MS_ASYNC);
+    uint64_t from = std::max(synced_tail_, tail_ > capacity_ ? tail_ - capacity_ : 0);
+    if (from < tail_) {
+        size_t position = static_cast<size_t>(from % capacity_);
+        size_t length = static_cast<size_t>(tail_ - from);
+        size_t first = std::min(length, capacity_ - position);
+        sync_ring(position, first);
+        if (length > first) {
+            sync_ring(0, length - first);
+        }
+    }
+    synced_tail_ = tail_;
+    dirty_ = false;
+}
+
+// msync() takes whole pages; the ring starts on one
+void Spool::sync_ring(size_t position, size_t length) {
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin = position / page * page;
+    msync(ring_ + begin, position + length - begin, MS_ASYNC);
+}
+
+void Spool::publish() {
+    Header* header = reinterpret_cast<Header*>(map_);
+    header->head = head_;
+    header->tail = tail_;
+    dirty_ = true;
+}
+
+void Spool::read_at(uint64_t offset, void* out, size_t length) const {
+    size_t position = static_cast<size_t>(offset % capacity_);
+    size_t first = std::min(length, capacity_ - position);
+    std::memcpy(out, ring_ + position, first);
+    std::memcpy(static_cast<char*>(out) + first, ring_, length - first);
+}
+
+void Spool::write_at(uint64_t offset, const void* data, size_t length) {
+    size_t position = static_cast<size_t>(offset % capacity_);
+    size_t first = std::min(length, capacity_ - position);
+    std::memcpy(ring_ + position, data, first);
+    std::memcpy(ring_, static_cast<const char*>(data) + first, length - first);
+}
+
+uint32_t Spool::check(uint64_t offset, const char* data, size_t length) const {
+    return static_cast<uint32_t>(hash_bytes(data, length, offset));
+}
@@ -0,0 +1,97 @@
+/*
+ * Disk Spool
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * A fixed-size, memory-mapped FIFO of datagrams kept for a destination
+ * while it is unreachable (`spool=<path>` on a UDP output). The file is a
+ * 4 KB header holding the capacity and the head and tail offsets, then a
+ * ring of `capacity` bytes of records:
+ *
+ *   record:  u32 length | u32 check | length bytes
+ *
+ * Offsets count bytes ever written, so they only grow; a record lives at
+ * offset % capacity and may wrap around the end of the ring. When a new
+ * record does not fit, the oldest ones are evicted.
+ *
+ * Offsets are stored in the mapped header as soon as they move, so a crash
+ * of the process loses nothing: the kernel still has the pages. sync(),
+ * called at most once a second, starts write-back of the header and of the
+ * records appended since the last call without waiting for it, as it runs
+ * on the sending thread while the destination is down; closing the spool
+ * waits for everything to reach the disk. After a power loss the
+ * header and the records may have reached the disk in any order, so each
+ * record's check is a hash of its bytes seeded with its offset, and
+ * recovery keeps the records from the head up to the first one that does
+ * not verify (a torn write, or a stale record from a previous lap).
+ *
+ * Single-threaded: the UDP output's sending thread owns it. The depth and
+ * eviction counts are Counters so the statistics log can read them.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "counter.h"
+
+class Spool {
+public:
+    Spool(const std::string& path, size_t capacity);
+    ~Spool();
+
+    Spool(const Spool&) = delete;
+    Spool& operator=(const Spool&) = delete;
+
+    // Create or map the file and recover the records it holds; false on failure
+    bool open();
+    bool is_open() const { return map_ != nullptr; }
+
+    // Append a datagram, evicting the oldest ones to make room; false if it
+    // can never fit
+    bool push(const char* data, size_t length);
+
+    // Copy the oldest datagram into `out` (at least MAX_RECORD bytes); its
+    // length, or 0 if the spool is empty
+    size_t front(char* out) const;
+
+    // Remove the oldest datagram
+    void pop();
+
+    // Start writing changed pages to disk; does not wait for the writes
+    void sync();
+
+    bool empty() const { return head_ == tail_; }
+    bool dirty() const { return dirty_; }
+    const std::string& path() const { return path_; }
+    size_t capacity() const { return capacity_; }
+    uint64_t records() const { return records_; }
+    uint64_t bytes() const { return bytes_; }       // Including record headers
+    uint64_t evicted() const { return evicted_; }
+
+    static constexpr size_t MAX_RECORD = 65536;
+
+private:
+    void read_at(uint64_t offset, void* out, size_t length) const;
+    void write_at(uint64_t offset, const void* data, size_t length);
+    void sync_ring(size_t position, size_t length);
+    uint32_t check(uint64_t offset, const char* data, size_t length) const;
+    void publish();
+    void recover();
+
+    std::string path_;
+    size_t capacity_;
+    char* map_ = nullptr;
+    char* ring_ = nullptr;
+    uint64_t head_ = 0;                 // Offset of the oldest record
+    uint64_t tail_ = 0;                 // Offset the next record goes to
+    uint64_t synced_tail_ = 0;          // Tail at the last sync()
+    bool dirty_ = false;                // Changed since the last sync()
+
+    Counter records_;
+    Counter bytes_;
+    Counter evicted_;
+};
@@ -0,0 +1,78 @@
+/*
+ * Single-Producer Single-Consumer Ring
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Bounded lock-free queue between exactly two threads. Slots are filled and
+ * drained in place (claim/publish, peek/release), so an item is copied
+ * once, by the producer. The producer and consumer indices live on separate
+ * cache lines, and each side keeps a cached copy of the other's index so it
+ * only touches the shared line when the ring looks full or empty.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+template <typename T>
+class SpscRing {
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer: slot to fill, or null if the ring is full
+    T* claim() {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                return nullptr;
+            }
+        }
+        return &slots_[tail & mask_];
+    }
+
+    // Producer: make the claimed slot visible to the consumer
+    void publish() { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer: oldest published slot, or null if the ring is empty
+    T* peek() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return nullptr;
+            }
+        }
+        return &slots_[head & mask_];
+    }
+
+    // Consumer: hand the slot returned by peek() back to the producer
+    void release() { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Approximate when called from a third thread
+    size_t size() const { return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire); }
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_;
+
+    alignas(64) std::atomic<size_t> head_{0};   // Written by the consumer
+    size_t cached_tail_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0};   // Written by the producer
+    size_t cached_head_ = 0;
+};
@@ -0,0 +1,331 @@
+/*
+ * NMEA TCP Server
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "tcp_server.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "log.h"
+
+namespace {
+
+// How long to stop accepting when out of descriptors or memory
+const auto ACCEPT_PAUSE = std::chrono::seconds(1);
+
+}  // namespace
+
+TcpServer::TcpServer(EventLoop& loop, const OutputConfig& config)
+    : loop_(loop), config_(config), filter_(config.filter, config.any_of) {
+}
+
+TcpServer::~TcpServer() {
+    for (auto& client : clients_) {
+        loop_.remove(client->fd);
+        close(client->fd);
+    }
+    loop_.remove_timer(accept_timer_);
+    if (listen_fd_ != -1) {
+        loop_.remove(listen_fd_);
+        close(listen_fd_);
+    }
+}
+
+bool TcpServer::start() {
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.port);
+    if (inet_pton(AF_INET, config_.host.c_str(), &addr.sin_addr) != 1) {
+        log_error() << get_timestamp() << " - Invalid output address: " << config_.spec;
+        return false;
+    }
+
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ == -1) {
+        log_error() << get_timestamp() << " - Error creating TCP server socket for " << config_.spec;
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(listen_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd_, 128) < 0 ||
+        !loop_.add(listen_fd_, EPOLLIN, [this](uint32_t) { on_accept(); })) {
+        log_error() << get_timestamp() << " - Failed to listen on " << config_.spec << ": " << strerror(errno);
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    accept_timer_ = loop_.add_timer(std::chrono::milliseconds(0), std::chrono::milliseconds(0),
+                                    [this] { loop_.modify(listen_fd_, EPOLLIN); });
+
+    log_info() << get_timestamp() << " - Serving NMEA on " << config_.spec;
+    return true;
+}
+
+void TcpServer::on_accept() {
+    while (true) {
+        struct sockaddr_in addr = {};
+        socklen_t length = sizeof(addr);
+        int fd = accept4(listen_fd_, (struct sockaddr*)&addr, &length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                pause_accepting();
+            }
+            return;     // EAGAIN, or a transient error; try again on the next event
+        }
+        if (clients_.size() >= static_cast<size_t>(config_.max_clients)) {
+            refused_++;
+            close(fd);
+            continue;
+        }
+
+        // Sentences go out once per wakeup anyway; don't hold them for Nagle
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        auto client = std::make_unique<Client>();
+        client->fd = fd;
+        client->ring.reset(new char[config_.client_buffer]);
+        char host[INET_ADDRSTRLEN] = "?";
+        inet_ntop(AF_INET, &addr.sin_addr, host, sizeof(host));
+        client->peer = std::string(host) + ":" + std::to_string(ntohs(addr.sin_port));
+
+        Client* raw = client.get();
+        if (!loop_.add(fd, EPOLLIN, [this, raw](uint32_t events) { on_client(raw, events); })) {
+            close(fd);
+            continue;
+        }
+        clients_.push_back(std::move(client));
+        accepted_++;
+        log_info() << get_timestamp() << " - NMEA client " << raw->peer << " connected to " << config_.spec << " ("
+                   << clients_.size() << " clients)";
+    }
+}
+
+// The pending connection stays queued and the listener level-triggered, so
+// without a pause every wakeup would fail the same accept again
+void TcpServer::pause_accepting() {
+    log_error() << get_timestamp() << " - Cannot accept on " << config_.spec << ": " << strerror(errno)
+                << "; pausing for " << ACCEPT_PAUSE.count() << " s";
+    loop_.modify(listen_fd_, 0);
+    loop_.arm_timer(accept_timer_, ACCEPT_PAUSE);
+}
+
+void TcpServer::on_client(Client* client, uint32_t events) {
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        close_client(client, "disconnected");
+        return;
+    }
+
+    if (events & EPOLLIN) {
+        // Clients have nothing to say; discard whatever they send
+        char discard[512];
+        while (true) {
+            ssize_t n = recv(client->fd, discard, sizeof(discard), 0);
+            if (n > 0 || (n < 0 && errno == EINTR)) {
+                continue;
+            }
+            if (n == 0) {
+                // e.g. `nc host port < /dev/null`; it may still be reading
+                client->read_closed = true;
+                watch(*client);
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                close_client(client, "disconnected");
+                return;
+            }
+            break;
+        }
+    }
+
+    if ((events & EPOLLOUT) && client->blocked) {
+        if (!write_pending(*client)) {
+            close_client(client, "disconnected");
+        } else if (client->head == client->tail) {
+            client->blocked = false;
+            watch(*client);
+        }
+    }
+}
+
+void TcpServer::watch(Client& client) {
+    uint32_t events = 0;
+    if (!client.read_closed) {
+        events |= EPOLLIN;
+    }
+    if (client.blocked) {
+        events |= EPOLLOUT;
+    }
+    loop_.modify(client.fd, events);
+}
+
+void TcpServer::send(const std::string_view* sentences, size_t count) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += sentences[i].size() + 2;
+    }
+    if (total > config_.client_buffer) {
+        return;
+    }
+    messages_++;
+
+    const size_t capacity = config_.client_buffer;
+    for (auto& client : clients_) {
+        if (client->closing != nullptr) {
+            continue;
+        }
+        if (capacity - (client->tail - client->head) < total && !client->blocked) {
+            // A busy wakeup can fill the ring of a client that keeps up;
+            // give its socket what it will take before judging it
+            if (!write_pending(*client)) {
+                client->closing = "disconnected";
+                closing_ = true;
+                continue;
+            }
+        }
+        if (capacity - (client->tail - client->head) < total) {
+            if (!config_.skip_slow) {
+                client->closing = "too slow, disconnected";
+                closing_ = true;
+                evicted_++;
+                continue;
+            }
+            skip_ahead(*client);
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            for (std::string_view part : {sentences[i], std::string_view("\r\n", 2)}) {
+                size_t offset = client->tail % capacity;
+                size_t first = std::min(part.size(), capacity - offset);
+                std::memcpy(client->ring.get() + offset, part.data(), first);
+                std::memcpy(client->ring.get(), part.data() + first, part.size() - first);
+                client->tail += part.size();
+            }
+        }
+    }
+}
+
+// Drop the backlog, keeping the rest of a sentence the socket already has
+// part of so the client still sees whole lines
+void TcpServer::skip_ahead(Client& client) {
+    const size_t capacity = config_.client_buffer;
+    uint64_t keep = client.head;
+    while (keep < client.tail && client.ring[keep % capacity] != '\n') {
+        keep++;
+    }
+    if (keep < client.tail) {
+        keep++;
+    }
+    skipped_ += client.tail - keep;
+    client.tail = keep;
+}
+
+void TcpServer::flush() {
+    for (auto& client : clients_) {
+        if (client->closing == nullptr && !client->blocked && client->head != client->tail) {
+            if (!write_pending(*client)) {
+                client->closing = "disconnected";
+                closing_ = true;
+            } else if (client->head != client->tail) {
+                client->blocked = true;
+                watch(*client);
+            }
+        }
+    }
+
+    if (closing_) {
+        closing_ = false;
+        for (size_t i = clients_.size(); i-- > 0;) {
+            if (clients_[i]->closing != nullptr) {
+                close_client(clients_[i].get(), clients_[i]->closing);
+            }
+        }
+    }
+}
+
+// Write as much of the ring as the socket takes; false if the connection failed
+bool TcpServer::write_pending(Client& client) {
+    const size_t capacity = config_.client_buffer;
+    while (client.head != client.tail) {
+        size_t offset = client.head % capacity;
+        size_t pending = client.tail - client.head;
+        struct iovec parts[2];
+        parts[0].iov_base = client.ring.get() + offset;
+        parts[0].iov_len = std::min(pending, capacity - offset);
+        parts[1].iov_base = client.ring.get();
+        parts[1].iov_len = pending - parts[0].iov_len;
+
+        // writev() with MSG_NOSIGNAL, so a vanished client can't raise SIGPIPE
+        struct msghdr message = {};
+        message.msg_iov = parts;
+        message.msg_iovlen = parts[1].iov_len > 0 ? 2 : 1;
+        ssize_t n = sendmsg(client.fd, &message, MSG_NOSIGNAL);
+        writes_++;
+        if (n > 0) {
+            client.head += static_cast<uint64_t>(n);
+            bytes_ += static_cast<uint64_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TcpServer::close_client(Client* client, const char* reason) {
+    log_info() << get_timestamp() << " - NMEA client " << client->peer << " " << reason << " ("
+               << clients_.size() - 1 << " clients on " << config_.spec << ")";
+    loop_.remove(client->fd);
+    close(client->fd);
+
+    // Order doesn't matter; swap with the last client
+    for (auto& slot : clients_) {
+        if (slot.get() == client) {
+            std::swap(slot, clients_.back());
+            clients_.pop_back();
+            break;
+        }
+    }
+}
+
+void TcpServer::log_stats() const {
+    LogLine line = log_info();
+    line << get_timestamp() << " - Output " << config_.spec << ": " << clients_.size() << " clients, " << accepted_
+         << " accepted, " << refused_ << " refused, " << evicted_ << " evicted as slow; " << messages_ << " messages, "
+         << bytes_ << " bytes in " << writes_ << " writes";
+    if (config_.skip_slow) {
+        line << ", " << skipped_ << " bytes skipped";
+    }
+}
+
+void TcpServer::register_metrics(MetricsRegistry& metrics) const {
+    std::string labels = MetricsRegistry::label("output", config_.spec);
+    metrics.gauge("ais_tcp_clients", "Connected TCP server clients", labels,
+                  [this] { return static_cast<double>(clients_.size()); });
+    metrics.counter("ais_tcp_clients_accepted_total", "TCP server connections accepted", labels,
+                    [this] { return static_cast<double>(accepted_); });
+    metrics.counter("ais_tcp_clients_refused_total", "TCP server connections refused at the client limit", labels,
+                    [this] { return static_cast<double>(refused_); });
+    metrics.counter("ais_tcp_clients_evicted_total", "TCP server clients disconnected as slow", labels,
+                    [this] { return static_cast<double>(evicted_); });
+    metrics.counter("ais_tcp_skipped_bytes_total", "Bytes skipped for slow TCP server clients", labels,
+                    [this] { return static_cast<double>(skipped_); });
+    metrics.counter("ais_tcp_messages_total", "Messages queued for TCP server clients", labels,
+                    [this] { return static_cast<double>(messages_); });
+    metrics.counter("ais_tcp_bytes_total", "Bytes written to TCP server clients", labels,
+                    [this] { return static_cast<double>(bytes_); });
+}
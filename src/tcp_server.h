@@ -0,0 +1,102 @@
+/*
+ * NMEA TCP Server
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Re-serves the forwarded stream to local TCP clients (OpenCPN, Signal K,
+ * loggers) declared as `output=tcp-server:[<bind>:]<port>`, so they need
+ * no connection of their own to the transponder. Each client has a fixed
+ * ring of `buffer` bytes: send() copies a message into every client's
+ * ring and flush(), once per event loop wakeup, hands each ring to the
+ * kernel with one gather write (both halves of the ring, if it wraps, in a
+ * single sendmsg()). Sockets are non-blocking, and a client whose
+ * socket is full is written again when it turns writable.
+ *
+ * A client that falls so far behind that its ring cannot take the next
+ * message is disconnected (`slow=close`, the default) or has its backlog
+ * discarded up to the next sentence boundary (`slow=skip`), so a stalled
+ * consumer costs at most its ring and never holds up the inputs.
+ *
+ * If accept() fails for lack of descriptors or memory the listener is
+ * paused for a second rather than woken for the same failure in a loop.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config.h"
+#include "event_loop.h"
+#include "filter_rules.h"
+#include "metrics.h"
+
+class TcpServer {
+public:
+    TcpServer(EventLoop& loop, const OutputConfig& config);
+    ~TcpServer();
+
+    TcpServer(const TcpServer&) = delete;
+    TcpServer& operator=(const TcpServer&) = delete;
+
+    // Start listening; false on failure
+    bool start();
+
+    // True if this server's filter accepts a message
+    bool select(const FilterFields& fields) const { return filter_.matches(fields); }
+    bool needs_position() const { return filter_.needs_position(); }
+
+    // Queue the sentences of one message for every client
+    void send(const std::string_view* sentences, size_t count);
+
+    // Write what each client has queued and close the clients that failed
+    void flush();
+
+    const OutputConfig& config() const { return config_; }
+    size_t clients() const { return clients_.size(); }
+    uint64_t evicted() const { return evicted_; }
+
+    void log_stats() const;
+    void register_metrics(MetricsRegistry& metrics) const;
+
+private:
+    struct Client {
+        int fd;
+        std::unique_ptr<char[]> ring;
+        uint64_t head = 0;          // Bytes written to the socket
+        uint64_t tail = 0;          // Bytes queued
+        bool blocked = false;       // Waiting for EPOLLOUT
+        bool read_closed = false;   // The client shut down its side; keep writing
+        const char* closing = nullptr;  // Reason, once marked for closing
+        std::string peer;
+    };
+
+    void on_accept();
+    void pause_accepting();
+    void on_client(Client* client, uint32_t events);
+    bool write_pending(Client& client);
+    void skip_ahead(Client& client);
+    void watch(Client& client);
+    void close_client(Client* client, const char* reason);
+
+    EventLoop& loop_;
+    OutputConfig config_;
+    CompiledFilter filter_;
+    int listen_fd_ = -1;
+    int accept_timer_ = -1;         // Re-enables the listener after a pause
+    std::vector<std::unique_ptr<Client>> clients_;
+    bool closing_ = false;          // Some client is marked for closing
+
+    uint64_t accepted_ = 0;
+    uint64_t refused_ = 0;
+    uint64_t evicted_ = 0;
+    uint64_t skipped_ = 0;          // Bytes discarded by `slow=skip`
+    uint64_t messages_ = 0;
+    uint64_t bytes_ = 0;            // Bytes written to clients
+    uint64_t writes_ = 0;           // sendmsg() calls
+};
@@ -0,0 +1,528 @@
+/*
+ * UDP Output
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "udp_output.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#include "fragment_reassembler.h"
+#include "log.h"
+
+namespace {
+
+const auto SPOOL_PROBE_INTERVAL = std::chrono::seconds(5);     // While unreachable
+const auto SPOOL_DRAIN_INTERVAL = std::chrono::milliseconds(100);
+const auto SPOOL_SYNC_INTERVAL = std::chrono::seconds(1);
+
+int64_t to_ms(UdpOutput::Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+}
+
+// Errors that mean the destination can't be reached from here right now,
+// as opposed to something wrong with the datagram
+bool unreachable(int error) {
+    return error == ENETUNREACH || error == EHOSTUNREACH || error == ENETDOWN || error == EADDRNOTAVAIL ||
+           error == ECONNREFUSED || error == EPERM;
+}
+
+}  // namespace
+
+UdpOutput::UdpOutput(const std::vector<OutputConfig>& outputs, bool io_uring)
+    : use_uring_(io_uring),
+      packers_(outputs.size()),
+      spool_states_(outputs.size()),
+      arena_(new char[ARENA_BYTES]),
+      messages_(MAX_BATCH),
+      iovecs_(MAX_BATCH),
+      message_destination_(MAX_BATCH),
+      message_sentences_(MAX_BATCH),
+      message_received_(MAX_BATCH) {
+    for (size_t d = 0; d < outputs.size(); d++) {
+        const OutputConfig& output = outputs[d];
+        Destination destination(output);
+        needs_position_ |= destination.filter.needs_position();
+        if (output.position_interval_s > 0 || output.static_interval_s > 0) {
+            destination.limiter = std::make_shared<MmsiRateLimiter>(std::chrono::seconds(output.position_interval_s),
+                                                                    std::chrono::seconds(output.static_interval_s));
+        }
+        if (!output.spool.empty()) {
+            destination.spool = std::make_shared<Spool>(output.spool, output.spool_mb * 1024 * 1024);
+        }
+        destinations_.push_back(destination);
+
+        if (outputs[d].coalesce_bytes > 0) {
+            packers_[d].buffers.reset(new char[outputs[d].coalesce_bytes * 2]);
+        }
+    }
+}
+
+UdpOutput::~UdpOutput() {
+    if (sock_ != -1) {
+        // Don't lose partly filled packed datagrams on shutdown
+        flush_all(Clock::now());
+        close(sock_);
+    }
+}
+
+bool UdpOutput::open() {
+    if (destinations_.size() > MAX_DESTINATIONS) {
+        log_error() << get_timestamp() << " - Too many outputs: " << destinations_.size() << " (at most "
+                    << MAX_DESTINATIONS << ")";
+        return false;
+    }
+
+    // One unconnected socket serves every destination
+    sock_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sock_ == -1) {
+        log_error() << "Error creating UDP output socket";
+        return false;
+    }
+
+    if (use_uring_) {
+        ring_ = std::make_unique<IoUring>();
+        if (!ring_->init(MAX_BATCH)) {
+            log_error() << get_timestamp() << " - io_uring unavailable for output (" << ring_->error()
+                        << "), using sendmmsg";
+            ring_.reset();
+        }
+    }
+
+    for (auto& destination : destinations_) {
+        destination.addr.sin_family = AF_INET;
+        destination.addr.sin_port = htons(destination.config.port);
+        if (inet_pton(AF_INET, destination.config.host.c_str(), &destination.addr.sin_addr) != 1) {
+            log_error() << get_timestamp() << " - Invalid output address: " << destination.config.spec;
+            return false;
+        }
+        if (destination.spool) {
+            if (!destination.spool->is_open() && !destination.spool->open()) {
+                return false;
+            }
+            drain_buffer_.reset(new char[Spool::MAX_RECORD]);
+        }
+    }
+    return true;
+}
+
+void UdpOutput::adopt(const UdpOutput& old) {
+    std::vector<bool> taken(old.destinations_.size(), false);
+    std::vector<bool> adopted(destinations_.size(), false);
+    for (size_t d = 0; d < destinations_.size(); d++) {
+        for (size_t o = 0; o < old.destinations_.size(); o++) {
+            if (!taken[o] && same_output(old.destinations_[o].config, destinations_[d].config)) {
+                destinations_[d] = old.destinations_[o];
+                spool_states_[d] = old.spool_states_[o];
+                taken[o] = adopted[d] = true;
+                break;
+            }
+        }
+    }
+
+    // A changed destination can't open a second mapping of a spool in use
+    for (size_t d = 0; d < destinations_.size(); d++) {
+        if (adopted[d] || !destinations_[d].spool) {
+            continue;
+        }
+        for (size_t o = 0; o < old.destinations_.size(); o++) {
+            if (old.destinations_[o].spool && old.destinations_[o].config.spool == destinations_[d].config.spool) {
+                destinations_[d].spool = old.destinations_[o].spool;
+                spool_states_[d] = old.spool_states_[o];
+                break;
+            }
+        }
+    }
+}
+
+size_t UdpOutput::enqueue(const std::string_view* sentences, size_t count, const FilterFields& fields,
+                          const AisMessage* decoded, Clock::time_point now) {
+    uint64_t selected = select(fields, decoded, now);
+    if (selected == 0 || !send(sentences, count, selected, now)) {
+        return 0;
+    }
+    return static_cast<size_t>(__builtin_popcountll(selected));
+}
+
+uint64_t UdpOutput::select(const FilterFields& fields, const AisMessage* decoded, Clock::time_point now) {
+    uint64_t selected = 0;
+    for (size_t d = 0; d < destinations_.size(); d++) {
+        Destination& destination = destinations_[d];
+        if (!destination.filter.matches(fields)) {
+            destination.filtered++;
+            continue;
+        }
+        if (destination.limiter && decoded != nullptr && !destination.limiter->allow(*decoded, now)) {
+            continue;
+        }
+        selected |= uint64_t(1) << d;
+    }
+    return selected;
+}
+
+bool UdpOutput::send(const std::string_view* sentences, size_t count, uint64_t selected, Clock::time_point now) {
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        bytes += sentences[i].size();
+    }
+    if (count > AIS_MAX_FRAGMENTS || count > MAX_BATCH || bytes > ARENA_BYTES) {
+        return false;
+    }
+
+    // Packing destinations first: they copy into their own buffers
+    size_t plain = 0;
+    for (size_t d = 0; d < destinations_.size(); d++) {
+        if (!((selected >> d) & 1u)) {
+            continue;
+        }
+        const Destination& destination = destinations_[d];
+        if (destination.config.coalesce_bytes == 0) {
+            plain++;
+            continue;
+        }
+
+        Packer& packer = packers_[d];
+        for (size_t i = 0; i < count; i++) {
+            size_t needed = sentences[i].size() + 2;
+            if (packer.length + needed > destination.config.coalesce_bytes) {
+                seal(d, now);
+            }
+            if (needed > destination.config.coalesce_bytes) {
+                continue;   // Cannot happen with the minimum size, but never overrun
+            }
+
+            char* buffer = packer.buffers.get() + packer.active * destination.config.coalesce_bytes;
+            std::memcpy(buffer + packer.length, sentences[i].data(), sentences[i].size());
+            std::memcpy(buffer + packer.length + sentences[i].size(), "\r\n", 2);
+            packer.length += needed;
+
+            if (packer.held == 0) {
+                packer.first = now;
+            }
+            packer.held++;
+            packer.queued_ms_sum += to_ms(now);
+        }
+    }
+
+    if (plain == 0) {
+        return true;
+    }
+
+    // Copy once; every plain destination's datagram points at the same bytes
+    char* copies[AIS_MAX_FRAGMENTS];
+    bool copied = false;
+
+    for (size_t d = 0; d < destinations_.size(); d++) {
+        if (!((selected >> d) & 1u) || destinations_[d].config.coalesce_bytes != 0) {
+            continue;
+        }
+
+        if (queued_ + count > MAX_BATCH) {
+            send_queued();
+            copied = false;
+        }
+        if (!copied) {
+            if (arena_used_ + bytes > ARENA_BYTES) {
+                send_queued();
+            }
+            for (size_t i = 0; i < count; i++) {
+                copies[i] = arena_.get() + arena_used_;
+                std::memcpy(copies[i], sentences[i].data(), sentences[i].size());
+                arena_used_ += sentences[i].size();
+            }
+            copied = true;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            queue(d, copies[i], sentences[i].size(), 1, now);
+        }
+    }
+    return true;
+}
+
+void UdpOutput::queue(size_t destination, const char* data, size_t length, uint32_t sentences,
+                      Clock::time_point received) {
+    if (spool_states_[destination].down) {
+        destinations_[destination].spool->push(data, length);
+        destinations_[destination].spooled++;
+        return;
+    }
+
+    iovecs_[queued_].iov_base = const_cast<char*>(data);
+    iovecs_[queued_].iov_len = length;
+
+    struct msghdr& header = messages_[queued_].msg_hdr;
+    header = {};
+    header.msg_name = &destinations_[destination].addr;
+    header.msg_namelen = sizeof(destinations_[destination].addr);
+    header.msg_iov = &iovecs_[queued_];
+    header.msg_iovlen = 1;
+
+    message_destination_[queued_] = static_cast<uint16_t>(destination);
+    message_sentences_[queued_] = static_cast<uint16_t>(sentences);
+    message_received_[queued_] = received;
+    queued_++;
+}
+
+void UdpOutput::seal(size_t destination, Clock::time_point now) {
+    Packer& packer = packers_[destination];
+    if (packer.length == 0) {
+        return;
+    }
+
+    // The buffer we switch to must not still be waiting for sendmmsg()
+    if (queued_ == MAX_BATCH || packer.in_flight[packer.active ^ 1]) {
+        send_queued();
+    }
+
+    size_t size = destinations_[destination].config.coalesce_bytes;
+    queue(destination, packer.buffers.get() + packer.active * size, packer.length, packer.held, packer.first);
+    packer.in_flight[packer.active] = true;
+
+    // Added latency: how long each packed sentence waited for this datagram
+    Destination& stats = destinations_[destination];
+    stats.latency_ms += static_cast<uint64_t>(packer.held * to_ms(now) - packer.queued_ms_sum);
+    uint64_t oldest = static_cast<uint64_t>(to_ms(now) - to_ms(packer.first));
+    if (oldest > stats.max_latency_ms) {
+        stats.max_latency_ms = oldest;
+    }
+
+    packer.active ^= 1;
+    packer.length = 0;
+    packer.held = 0;
+    packer.queued_ms_sum = 0;
+}
+
+void UdpOutput::flush(Clock::time_point now) {
+    for (size_t d = 0; d < destinations_.size(); d++) {
+        const Packer& packer = packers_[d];
+        if (packer.length > 0 &&
+            now - packer.first >= std::chrono::milliseconds(destinations_[d].config.coalesce_ms)) {
+            seal(d, now);
+        }
+    }
+    send_queued();
+    if (drain_buffer_) {
+        drain_spools(now);
+    }
+}
+
+void UdpOutput::flush_all(Clock::time_point now) {
+    for (size_t d = 0; d < destinations_.size(); d++) {
+        seal(d, now);
+    }
+    send_queued();
+}
+
+bool UdpOutput::next_deadline(Clock::time_point& deadline) const {
+    bool pending = false;
+    for (size_t d = 0; d < destinations_.size(); d++) {
+        const Packer& packer = packers_[d];
+        if (packer.length == 0) {
+            continue;
+        }
+        Clock::time_point due = packer.first + std::chrono::milliseconds(destinations_[d].config.coalesce_ms);
+        if (!pending || due < deadline) {
+            deadline = due;
+            pending = true;
+        }
+    }
+    for (size_t d = 0; d < destinations_.size(); d++) {
+        const Spool* spool = destinations_[d].spool.get();
+        if (spool == nullptr || (spool->empty() && !spool->dirty())) {
+            continue;
+        }
+        const SpoolState& state = spool_states_[d];
+        Clock::time_point due = spool->empty() ? state.next_sync : std::min(state.next_drain, state.next_sync);
+        if (!pending || due < deadline) {
+            deadline = due;
+            pending = true;
+        }
+    }
+    return pending;
+}
+
+void UdpOutput::send_queued() {
+    if (ring_) {
+        send_queued_uring();
+        return;
+    }
+
+    size_t done = 0;
+    while (done < queued_) {
+        int sent = sendmmsg(sock_, &messages_[done], static_cast<unsigned>(queued_ - done), 0);
+        syscalls_++;
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // The first remaining datagram failed; count it and move past it
+            failed(done, errno);
+            done++;
+            continue;
+        }
+        Clock::time_point now = Clock::now();
+        for (size_t i = done; i < done + static_cast<size_t>(sent); i++) {
+            this->sent(i, now);
+        }
+        done += static_cast<size_t>(sent);
+    }
+
+    queued_ = 0;
+    arena_used_ = 0;
+    for (auto& packer : packers_) {
+        packer.in_flight[0] = packer.in_flight[1] = false;
+    }
+}
+
+// One io_uring_enter() submits the batch and collects the results; UDP sends
+// complete inline, so waiting for them adds no sleep
+void UdpOutput::send_queued_uring() {
+    for (size_t i = 0; i < queued_; i++) {
+        ring_->prep_sendmsg(sock_, &messages_[i].msg_hdr, i);
+    }
+
+    size_t done = 0;
+    while (done < queued_) {
+        int result = ring_->submit(static_cast<unsigned>(queued_ - done));
+        syscalls_++;
+        if (result < 0 && result != -EINTR) {
+            // Pending requests point into buffers about to be reused; drop the ring
+            log_error() << get_timestamp() << " - io_uring submit failed (" << std::strerror(-result)
+                        << "), using sendmmsg";
+            for (size_t i = done; i < queued_; i++) {
+                failed(i, -result);
+            }
+            ring_.reset();
+            break;
+        }
+
+        IoUring::Completion completion;
+        Clock::time_point now = Clock::now();
+        while (ring_->next_completion(completion)) {
+            size_t i = static_cast<size_t>(completion.user_data);
+            if (completion.result < 0) {
+                failed(i, -completion.result);
+            } else {
+                sent(i, now);
+            }
+            done++;
+        }
+    }
+
+    queued_ = 0;
+    arena_used_ = 0;
+    for (auto& packer : packers_) {
+        packer.in_flight[0] = packer.in_flight[1] = false;
+    }
+}
+
+void UdpOutput::sent(size_t message, Clock::time_point now) {
+    Destination& destination = destinations_[message_destination_[message]];
+    destination.sent++;
+    destination.sentences += message_sentences_[message];
+    destination.bytes += iovecs_[message].iov_len;
+    destination.latency.observe(now - message_received_[message]);
+}
+
+void UdpOutput::failed(size_t message, int error) {
+    size_t d = message_destination_[message];
+    Destination& destination = destinations_[d];
+    destination.errors++;
+    if (!destination.spool || !unreachable(error)) {
+        return;
+    }
+
+    SpoolState& state = spool_states_[d];
+    if (!state.down) {
+        log_error() << get_timestamp() << " - Output " << destination.config.spec << " unreachable ("
+                    << std::strerror(error) << "), spooling to " << destination.spool->path();
+        state.down = true;
+        state.next_drain = Clock::now() + SPOOL_PROBE_INTERVAL;
+        state.next_sync = Clock::now() + SPOOL_SYNC_INTERVAL;
+    }
+    destination.spool->push(static_cast<const char*>(iovecs_[message].iov_base), iovecs_[message].iov_len);
+    destination.spooled++;
+}
+
+void UdpOutput::drain_spools(Clock::time_point now) {
+    for (size_t d = 0; d < destinations_.size(); d++) {
+        Spool* spool = destinations_[d].spool.get();
+        if (spool == nullptr) {
+            continue;
+        }
+        SpoolState& state = spool_states_[d];
+        if (!spool->empty() && now >= state.next_drain) {
+            drain(d, now);
+        }
+        if (spool->dirty() && now >= state.next_sync) {
+            spool->sync();
+            state.next_sync = now + SPOOL_SYNC_INTERVAL;
+        }
+    }
+}
+
+// Send the spool's oldest datagrams: one as a probe while the destination
+// is down, otherwise as many as the drain rate allows for this step
+void UdpOutput::drain(size_t d, Clock::time_point now) {
+    Destination& destination = destinations_[d];
+    SpoolState& state = spool_states_[d];
+    Spool& spool = *destination.spool;
+
+    auto step = std::max<Clock::duration>(SPOOL_DRAIN_INTERVAL,
+                                          std::chrono::nanoseconds(std::chrono::seconds(1)) /
+                                              destination.config.spool_rate);
+    uint64_t budget = state.down ? 1
+                                 : std::max<uint64_t>(1, destination.config.spool_rate *
+                                                             std::chrono::duration<double>(step).count());
+    bool was_down = state.down;
+    uint64_t drained = 0;
+    while (drained < budget && !spool.empty()) {
+        size_t length = spool.front(drain_buffer_.get());
+        ssize_t n = sendto(sock_, drain_buffer_.get(), length, 0, reinterpret_cast<struct sockaddr*>(&destination.addr),
+                           sizeof(destination.addr));
+        syscalls_++;
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && unreachable(errno)) {
+            if (!was_down) {
+                log_error() << get_timestamp() << " - Output " << destination.config.spec << " unreachable again ("
+                            << std::strerror(errno) << "), spooling to " << spool.path();
+            }
+            state.down = true;
+            break;
+        }
+        // Delivered, or refused for a reason retrying won't fix
+        spool.pop();
+        drained++;
+        if (n < 0) {
+            destination.errors++;
+        }
+    }
+
+    if (was_down && drained > 0) {
+        log_info() << get_timestamp() << " - Output " << destination.config.spec << " reachable again, draining "
+                   << spool.records() << " spooled datagrams";
+        state.down = false;
+        state.window = now;
+        state.window_drained = 0;
+    }
+    destination.drained += drained;
+    state.window_drained += drained;
+    if (now - state.window >= std::chrono::seconds(1) || spool.empty()) {
+        double seconds = std::chrono::duration<double>(now - state.window).count();
+        destination.drain_rate = spool.empty() || seconds <= 0 ? 0 : static_cast<uint64_t>(state.window_drained / seconds);
+        state.window = now;
+        state.window_drained = 0;
+    }
+    if (spool.empty() && !state.down) {
+        log_info() << get_timestamp() << " - Output " << destination.config.spec << " spool drained";
+    }
+    state.next_drain = now + (state.down ? Clock::duration(SPOOL_PROBE_INTERVAL) : step);
+}
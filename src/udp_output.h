@@ -0,0 +1,193 @@
+/*
+ * UDP Output
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Fans forwarded sentences out to any number of UDP destinations, each with
+ * its own compiled message filter (see CompiledFilter). Sentences are copied once into a fixed arena and
+ * queued as one datagram per destination; flush() hands the whole queue to
+ * the kernel with sendmmsg(), so an event loop wakeup that produced N
+ * sentences costs one system call rather than N x destinations sendto()s.
+ *
+ * A destination configured with `coalesce=<bytes>` instead packs sentences,
+ * each terminated by "\r\n", into datagrams of up to that many bytes. A
+ * packed datagram is sent when the next sentence would not fit or when its
+ * oldest sentence has waited `coalesce_ms`, whichever comes first; the
+ * caller arms a timer for next_deadline() so a quiet feed still flushes.
+ *
+ * A destination with `position_interval=` or `static_interval=` forwards
+ * at most one message per MMSI and budget within the interval (see
+ * MmsiRateLimiter) to stay within aggregator rules on metered links.
+ *
+ * A destination with `spool=<path>` keeps its datagrams in a disk Spool
+ * while the kernel reports it unreachable (no route, interface down, as
+ * when a cellular uplink drops). Every five seconds the oldest spooled
+ * datagram is sent as a probe; once one goes through, live traffic is sent
+ * directly again and the backlog follows, oldest first, at `spool_rate`
+ * datagrams per second. The drain is paced through next_deadline().
+ *
+ * With `io_backend=io_uring` a batch is submitted as sendmsg requests on an
+ * io_uring instead (see IoUring); otherwise, or if the kernel lacks it,
+ * sendmmsg() is used.
+ *
+ * enqueue() is select() followed by send(). Pipeline mode calls them on
+ * different threads: select() touches only the filters, rate limiters and
+ * `filtered` counts, send() and flush() everything else. The send-side
+ * counters are Counters so the stats log can read them from either thread.
+ *
+ * Each destination keeps a Histogram of how long its datagrams took from
+ * the receipt of their oldest sentence to being accepted by the kernel.
+ *
+ * A configuration reload builds a new UdpOutput and lets it adopt() the
+ * running one: destinations declared the same way carry over their
+ * counters, rate limiters and spool, so only the changed ones start afresh.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "ais_decoder.h"
+#include "config.h"
+#include "counter.h"
+#include "filter_rules.h"
+#include "metrics.h"
+#include "rate_limiter.h"
+#include "spool.h"
+#include "uring.h"
+
+class UdpOutput {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t MAX_BATCH = 256;         // Datagrams per sendmmsg()
+    static constexpr size_t ARENA_BYTES = 32 * 1024; // Sentence copies awaiting flush
+    static constexpr size_t MAX_DESTINATIONS = 64;   // One bit each in a selection mask
+
+    struct Destination {
+        explicit Destination(const OutputConfig& output) : config(output), filter(output.filter, output.any_of) {}
+
+        OutputConfig config;
+        CompiledFilter filter;
+        struct sockaddr_in addr = {};
+        Counter sent;               // Datagrams accepted by the kernel
+        Counter errors;             // Datagrams the kernel refused
+        uint64_t filtered = 0;      // Messages rejected by this destination's filter
+        std::shared_ptr<MmsiRateLimiter> limiter;   // Null unless rate limited
+        Counter sentences;          // Sentences carried by the sent datagrams
+        Counter bytes;              // UDP payload bytes sent
+        Counter latency_ms;         // Total time sentences spent waiting in packed datagrams
+        Counter max_latency_ms;
+        Histogram latency;          // Receipt of a datagram's oldest sentence to the kernel taking it
+        std::shared_ptr<Spool> spool;   // Null unless spooling
+        Counter spooled;            // Datagrams written to the spool
+        Counter drained;            // Spooled datagrams sent once reachable again
+        Counter drain_rate;         // Datagrams per second drained over the last second
+    };
+
+    explicit UdpOutput(const std::vector<OutputConfig>& outputs, bool io_uring = false);
+    ~UdpOutput();
+
+    UdpOutput(const UdpOutput&) = delete;
+    UdpOutput& operator=(const UdpOutput&) = delete;
+
+    // Create the socket, resolve destinations and open spools; false on failure
+    bool open();
+
+    // Take over the state of `old`'s destinations that are declared the same
+    // way, and the spools of those that spool to the same file. Call before
+    // open(), after old.flush_all().
+    void adopt(const UdpOutput& old);
+
+    // Queue the sentences of one message for every destination whose filter
+    // accepts `fields`. `decoded` is the decoded message, or null if it could
+    // not be decoded (it then bypasses rate limits). Returns the number of
+    // destinations it was queued for.
+    size_t enqueue(const std::string_view* sentences, size_t count, const FilterFields& fields,
+                   const AisMessage* decoded, Clock::time_point now);
+
+    // Bitmask of the destinations that accept a message, by index
+    uint64_t select(const FilterFields& fields, const AisMessage* decoded, Clock::time_point now);
+
+    // Queue the sentences of one message for the destinations in `selected`;
+    // false if the message is too large to queue
+    bool send(const std::string_view* sentences, size_t count, uint64_t selected, Clock::time_point now);
+
+    // Send everything queued, plus packed datagrams whose deadline has passed
+    // and spooled datagrams that are due
+    void flush(Clock::time_point now);
+
+    // Send everything queued, including partly filled packed datagrams
+    void flush_all(Clock::time_point now);
+
+    // Earliest deadline of a partly filled packed datagram or a spool drain;
+    // false if none
+    bool next_deadline(Clock::time_point& deadline) const;
+
+    // True if some destination filters on position or speed
+    bool needs_position() const { return needs_position_; }
+
+    const std::vector<Destination>& destinations() const { return destinations_; }
+    size_t queued() const { return queued_; }
+    uint64_t syscalls() const { return syscalls_; }
+    const char* backend() const { return ring_ ? "io_uring" : "sendmmsg"; }
+
+private:
+    // Packing state of one coalescing destination. Two buffers alternate so
+    // one can fill while the other is queued for sendmmsg().
+    struct Packer {
+        std::unique_ptr<char[]> buffers;
+        int active = 0;
+        bool in_flight[2] = {false, false};
+        size_t length = 0;
+        uint32_t held = 0;              // Sentences in the active buffer
+        Clock::time_point first;        // When the oldest of them was queued
+        int64_t queued_ms_sum = 0;      // Sum of their queue times, for latency
+    };
+
+    // Drain state of one spooling destination
+    struct SpoolState {
+        bool down = false;              // Unreachable; datagrams go to the spool
+        Clock::time_point next_drain;   // Next probe or drain step
+        Clock::time_point next_sync;
+        Clock::time_point window;       // Start of the current drain rate window
+        uint64_t window_drained = 0;
+    };
+
+    void queue(size_t destination, const char* data, size_t length, uint32_t sentences, Clock::time_point received);
+    void seal(size_t destination, Clock::time_point now);
+    void send_queued();
+    void send_queued_uring();
+    void sent(size_t message, Clock::time_point now);
+    void failed(size_t message, int error);
+    void drain_spools(Clock::time_point now);
+    void drain(size_t destination, Clock::time_point now);
+
+    int sock_ = -1;
+    bool use_uring_;
+    std::unique_ptr<IoUring> ring_;     // Null when sending with sendmmsg()
+    std::vector<Destination> destinations_;
+    std::vector<Packer> packers_;
+    std::vector<SpoolState> spool_states_;
+    std::unique_ptr<char[]> drain_buffer_;  // One spooled datagram; null unless spooling
+
+    std::unique_ptr<char[]> arena_;
+    size_t arena_used_ = 0;
+    std::vector<struct mmsghdr> messages_;
+    std::vector<struct iovec> iovecs_;
+    std::vector<uint16_t> message_destination_;
+    std::vector<uint16_t> message_sentences_;
+    std::vector<Clock::time_point> message_received_;
+    size_t queued_ = 0;
+
+    Counter syscalls_;
+    bool needs_position_ = false;
+};
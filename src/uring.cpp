@@ -0,0 +1,248 @@
+/*
+ * io_uring Ring
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "uring.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef AIS_FORWARDER_HAVE_IO_URING
+
+#include <linux/io_uring.h>
+
+namespace {
+
+int io_uring_setup(unsigned entries, struct io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+template <typename T>
+T* at(void* base, size_t offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+}  // namespace
+
+struct IoUring::Sqe : io_uring_sqe {};
+
+IoUring::~IoUring() {
+    if (fd_ != -1) {
+        close(fd_);
+    }
+    if (sqes_ != nullptr) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) {
+        munmap(sq_ring_, sq_ring_size_);
+    }
+}
+
+bool IoUring::init(unsigned entries, unsigned cq_entries) {
+    struct io_uring_params params = {};
+    if (cq_entries > 2 * entries) {
+        params.flags |= IORING_SETUP_CQSIZE;
+        params.cq_entries = cq_entries;
+    }
+    fd_ = io_uring_setup(entries, &params);
+    if (fd_ < 0) {
+        error_ = std::strerror(errno);
+        fd_ = -1;
+        return false;
+    }
+    if (!(params.features & IORING_FEAT_NODROP) || !(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        error_ = "kernel too old";
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    // One mapping covers both rings on every kernel with FEAT_SINGLE_MMAP
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (cq_size > sq_ring_size_) {
+        sq_ring_size_ = cq_size;
+    }
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                    IORING_OFF_SQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+        error_ = std::strerror(errno);
+        if (sq_ring_ == MAP_FAILED) sq_ring_ = nullptr;
+        if (sqes_ == MAP_FAILED) sqes_ = nullptr;
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    cq_ring_ = sq_ring_;
+    cq_ring_size_ = sq_ring_size_;
+
+    sq_head_ = at<unsigned>(sq_ring_, params.sq_off.head);
+    sq_tail_ = at<unsigned>(sq_ring_, params.sq_off.tail);
+    sq_mask_ = *at<unsigned>(sq_ring_, params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    cq_head_ = at<unsigned>(cq_ring_, params.cq_off.head);
+    cq_tail_ = at<unsigned>(cq_ring_, params.cq_off.tail);
+    cq_mask_ = *at<unsigned>(cq_ring_, params.cq_off.ring_mask);
+    cqes_ = at<void>(cq_ring_, params.cq_off.cqes);
+
+    // Submission slots map one-to-one onto entries
+    unsigned* array = at<unsigned>(sq_ring_, params.sq_off.array);
+    for (unsigned i = 0; i < params.sq_entries; i++) {
+        array[i] = i;
+    }
+    sqe_tail_ = submitted_ = __atomic_load_n(sq_tail_, __ATOMIC_RELAXED);
+    return true;
+}
+
+bool IoUring::provide_buffers(uint16_t group, unsigned count, size_t size) {
+    buffers_.reset(new char[count * size]);
+    buffer_size_ = size;
+    buffer_group_ = group;
+    for (unsigned id = 0; id < count; id++) {
+        if (!recycle_buffer(static_cast<int>(id))) {
+            error_ = "submission queue full";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Classic provided buffers rather than a registered buffer ring: they work
+// on every kernel with multishot receive, and a run of consecutive ids goes
+// back in a single request
+bool IoUring::recycle_buffer(int id) {
+    if (provide_ != nullptr && provide_->buf_group == buffer_group_ &&
+        provide_->off + provide_->fd == static_cast<uint64_t>(id)) {
+        provide_->fd++;
+        return true;
+    }
+    Sqe* sqe = get_sqe();
+    if (sqe == nullptr && submit() >= 0) {
+        sqe = get_sqe();
+    }
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = 1;                                    // Number of buffers
+    sqe->addr = reinterpret_cast<uint64_t>(buffers_.get() + static_cast<size_t>(id) * buffer_size_);
+    sqe->len = static_cast<uint32_t>(buffer_size_);
+    sqe->off = static_cast<uint64_t>(id);           // First buffer id
+    sqe->buf_group = buffer_group_;
+    sqe->user_data = PROVIDE_USER_DATA;
+    provide_ = sqe;
+    return true;
+}
+
+IoUring::Sqe* IoUring::get_sqe() {
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sqe_tail_ - head >= sq_entries_) {
+        return nullptr;
+    }
+    Sqe* sqe = static_cast<Sqe*>(sqes_) + (sqe_tail_ & sq_mask_);
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe_tail_++;
+    return sqe;
+}
+
+bool IoUring::prep_recv_multishot(int fd, uint16_t group, uint64_t user_data) {
+    Sqe* sqe = get_sqe();
+    provide_ = nullptr;
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = group;
+    sqe->user_data = user_data;
+    return true;
+}
+
+bool IoUring::prep_sendmsg(int fd, const struct msghdr* message, uint64_t user_data) {
+    Sqe* sqe = get_sqe();
+    provide_ = nullptr;
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(message);
+    sqe->len = 1;
+    sqe->user_data = user_data;
+    return true;
+}
+
+int IoUring::submit(unsigned wait) {
+    unsigned pending = sqe_tail_ - submitted_;
+    if (pending == 0 && wait == 0) {
+        return 0;
+    }
+    __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+    provide_ = nullptr;
+    int result = io_uring_enter(fd_, pending, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0);
+    if (result < 0) {
+        return -errno;
+    }
+    submitted_ += static_cast<unsigned>(result);
+    return result;
+}
+
+bool IoUring::next_completion(Completion& completion) {
+    unsigned head = *cq_head_;
+    const struct io_uring_cqe* cqe;
+    for (;; head++) {
+        if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+            return false;
+        }
+        cqe = static_cast<const struct io_uring_cqe*>(cqes_) + (head & cq_mask_);
+        if (cqe->user_data != PROVIDE_USER_DATA) {
+            break;
+        }
+    }
+    completion.user_data = cqe->user_data;
+    completion.result = cqe->res;
+    completion.more = (cqe->flags & IORING_CQE_F_MORE) != 0;
+    completion.buffer = (cqe->flags & IORING_CQE_F_BUFFER) ? static_cast<int>(cqe->flags >> IORING_CQE_BUFFER_SHIFT)
+                                                           : -1;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+#else  // !AIS_FORWARDER_HAVE_IO_URING
+
+struct IoUring::Sqe {};
+
+IoUring::~IoUring() = default;
+
+bool IoUring::init(unsigned, unsigned) {
+    error_ = "not built with io_uring support";
+    return false;
+}
+
+bool IoUring::provide_buffers(uint16_t, unsigned, size_t) { return false; }
+bool IoUring::recycle_buffer(int) { return false; }
+IoUring::Sqe* IoUring::get_sqe() { return nullptr; }
+bool IoUring::prep_recv_multishot(int, uint16_t, uint64_t) { return false; }
+bool IoUring::prep_sendmsg(int, const struct msghdr*, uint64_t) { return false; }
+int IoUring::submit(unsigned) { return -ENOSYS; }
+bool IoUring::next_completion(Completion&) { return false; }
+
+#endif  // AIS_FORWARDER_HAVE_IO_URING
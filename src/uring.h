@@ -0,0 +1,105 @@
+/*
+ * io_uring Ring
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Minimal io_uring wrapper over the raw system calls, so the daemon needs
+ * no liburing. It covers what the UDP input and output use: multishot
+ * receive into a pool of provided buffers, batched sendmsg, and reaping
+ * completions straight from the shared completion queue.
+ *
+ * The ring's descriptor is pollable, so a ring is registered with the
+ * EventLoop like a socket: it turns readable when completions are waiting,
+ * and reaping them costs no system call. A multishot receive stays armed
+ * across datagrams and consumed buffers go back to the kernel in one
+ * batched submission, so a busy UDP input costs one io_uring_enter() per wakeup
+ * however many datagrams it brings.
+ *
+ * Built without io_uring support (AIS_FORWARDER_HAVE_IO_URING unset), or
+ * on a kernel without it, init() fails and callers use their epoll path.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+
+class IoUring {
+public:
+    struct Completion {
+        uint64_t user_data;
+        int32_t result;             // Bytes, or -errno
+        bool more;                  // A multishot request is still armed
+        int buffer;                 // Provided buffer holding the data, or -1
+    };
+
+    IoUring() = default;
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // Create a ring with `entries` submission slots and at least
+    // `cq_entries` completion slots. False with `error()` set if the build
+    // or the kernel has no io_uring, or it is disabled.
+    bool init(unsigned entries, unsigned cq_entries = 0);
+    bool valid() const { return fd_ != -1; }
+    int fd() const { return fd_; }
+    const std::string& error() const { return error_; }
+
+    // Queue `count` buffers of `size` bytes for the kernel as provided
+    // buffer group `group`, for requests submitted after them
+    bool provide_buffers(uint16_t group, unsigned count, size_t size);
+    const char* buffer(int id) const { return buffers_.get() + static_cast<size_t>(id) * buffer_size_; }
+
+    // Queue a consumed buffer to go back to the kernel on the next submit()
+    bool recycle_buffer(int id);
+
+    // Queue requests; false if the submission queue is full
+    bool prep_recv_multishot(int fd, uint16_t group, uint64_t user_data);
+    bool prep_sendmsg(int fd, const struct msghdr* message, uint64_t user_data);
+
+    // Submit queued requests and wait for `wait` completions. Returns the
+    // number submitted, or -errno; no system call if there is nothing to do.
+    int submit(unsigned wait = 0);
+
+    // Take the oldest completion; false if there is none. Completions of
+    // buffer recycling are consumed here.
+    bool next_completion(Completion& completion);
+
+private:
+    struct Sqe;
+    Sqe* get_sqe();
+
+    int fd_ = -1;
+    std::string error_;
+
+    // Mapped rings
+    void* sq_ring_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    void* cq_ring_ = nullptr;
+    size_t cq_ring_size_ = 0;
+    void* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    void* cqes_ = nullptr;
+    unsigned sqe_tail_ = 0;         // Local tail, published by submit()
+    unsigned submitted_ = 0;
+
+    // Provided buffers
+    static constexpr uint64_t PROVIDE_USER_DATA = ~uint64_t(0);
+    std::unique_ptr<char[]> buffers_;
+    size_t buffer_size_ = 0;
+    uint16_t buffer_group_ = 0;
+    Sqe* provide_ = nullptr;        // Unsubmitted recycle request to extend
+};
@@ -0,0 +1,377 @@
+/*
+ * Vessel State Table
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "vessel_table.h"
+
+#include <cstring>
+
+#include "hash.h"
+
+namespace {
+
+constexpr uint8_t FLAG_OWN_SHIP = 1;
+constexpr uint8_t FLAG_POSITION = 2;
+constexpr uint8_t NAV_STATUS_UNDEFINED = 15;
+
+constexpr size_t CALLSIGN_LEN = 8;
+constexpr size_t SHIPNAME_LEN = 21;
+constexpr size_t DESTINATION_LEN = 21;
+
+void copy_text(char* dst, const char* src, size_t size) {
+    std::memcpy(dst, src, size);
+    dst[size - 1] = '\0';
+}
+
+}  // namespace
+
+VesselTable::VesselTable(size_t capacity, std::chrono::seconds ttl)
+    : capacity_(capacity),
+      ttl_s_(static_cast<uint32_t>(ttl.count() > 0 ? ttl.count() : 0)),
+      epoch_(Clock::now()),
+      wall_epoch_(std::time(nullptr)) {
+    if (capacity_ == 0) {
+        return;
+    }
+
+    // Keep the index at most half full so probe chains stay short
+    size_t index_size = 16;
+    while (index_size < capacity_ * 2) {
+        index_size <<= 1;
+    }
+    keys_.assign(index_size, 0);
+    slots_.assign(index_size, 0);
+    mask_ = index_size - 1;
+
+    mmsi_.resize(capacity_);
+    last_seen_.resize(capacity_);
+    position_seen_.resize(capacity_);
+    last_type_.resize(capacity_);
+    flags_.resize(capacity_);
+    nav_status_.resize(capacity_);
+    lat_.resize(capacity_);
+    lon_.resize(capacity_);
+    sog_.resize(capacity_);
+    cog_.resize(capacity_);
+    heading_.resize(capacity_);
+    imo_.resize(capacity_);
+    shiptype_.resize(capacity_);
+    to_bow_.resize(capacity_);
+    to_stern_.resize(capacity_);
+    to_port_.resize(capacity_);
+    to_starboard_.resize(capacity_);
+    draught_.resize(capacity_);
+    callsign_.resize(capacity_ * CALLSIGN_LEN);
+    shipname_.resize(capacity_ * SHIPNAME_LEN);
+    destination_.resize(capacity_ * DESTINATION_LEN);
+    position_sentence_.resize(capacity_);
+    static_sentences_.resize(capacity_ * 2);
+}
+
+size_t VesselTable::memory_bytes() const {
+    size_t per_vessel = 4 * 3 + 1 * 3 + 4 * 2 + 2 * 3 + 4 + 1 + 2 * 2 + 1 * 3 + CALLSIGN_LEN + SHIPNAME_LEN +
+                        DESTINATION_LEN + sizeof(Sentence) * 3;
+    return capacity_ * per_vessel + keys_.size() * (sizeof(uint32_t) * 2);
+}
+
+uint32_t VesselTable::to_stamp(Clock::time_point now) const {
+    auto s = std::chrono::duration_cast<std::chrono::seconds>(now - epoch_).count();
+    return s > 0 ? static_cast<uint32_t>(s) : 0;
+}
+
+std::time_t VesselTable::wall_time(Clock::time_point stamp) const {
+    return wall_epoch_ + std::chrono::duration_cast<std::chrono::seconds>(stamp - epoch_).count();
+}
+
+size_t VesselTable::index_of(uint32_t mmsi) const {
+    size_t index = static_cast<size_t>(hash_mix64(mmsi)) & mask_;
+    while (keys_[index] != 0 && keys_[index] != mmsi) {
+        index = (index + 1) & mask_;
+    }
+    return index;
+}
+
+long VesselTable::find(uint32_t mmsi) const {
+    if (capacity_ == 0 || mmsi == 0) {
+        return -1;
+    }
+    size_t index = index_of(mmsi);
+    return keys_[index] == mmsi ? static_cast<long>(slots_[index]) : -1;
+}
+
+bool VesselTable::position(uint32_t mmsi, int32_t& lat, int32_t& lon, uint16_t& sog) const {
+    long slot = find(mmsi);
+    if (slot < 0 || !(flags_[slot] & FLAG_POSITION)) {
+        return false;
+    }
+    lat = lat_[slot];
+    lon = lon_[slot];
+    sog = sog_[slot];
+    return true;
+}
+
+void VesselTable::erase_index(size_t hole) {
+    // Backward-shift deletion: pull later members of the probe chain into
+    // the hole unless their home position lies cyclically after it
+    size_t next = hole;
+    while (true) {
+        next = (next + 1) & mask_;
+        if (keys_[next] == 0) {
+            break;
+        }
+        size_t home = static_cast<size_t>(hash_mix64(keys_[next])) & mask_;
+        bool stays = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (!stays) {
+            keys_[hole] = keys_[next];
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+    }
+    keys_[hole] = 0;
+}
+
+void VesselTable::move_slot(size_t from, size_t to) {
+    mmsi_[to] = mmsi_[from];
+    last_seen_[to] = last_seen_[from];
+    position_seen_[to] = position_seen_[from];
+    last_type_[to] = last_type_[from];
+    flags_[to] = flags_[from];
+    nav_status_[to] = nav_status_[from];
+    lat_[to] = lat_[from];
+    lon_[to] = lon_[from];
+    sog_[to] = sog_[from];
+    cog_[to] = cog_[from];
+    heading_[to] = heading_[from];
+    imo_[to] = imo_[from];
+    shiptype_[to] = shiptype_[from];
+    to_bow_[to] = to_bow_[from];
+    to_stern_[to] = to_stern_[from];
+    to_port_[to] = to_port_[from];
+    to_starboard_[to] = to_starboard_[from];
+    draught_[to] = draught_[from];
+    std::memcpy(&callsign_[to * CALLSIGN_LEN], &callsign_[from * CALLSIGN_LEN], CALLSIGN_LEN);
+    std::memcpy(&shipname_[to * SHIPNAME_LEN], &shipname_[from * SHIPNAME_LEN], SHIPNAME_LEN);
+    std::memcpy(&destination_[to * DESTINATION_LEN], &destination_[from * DESTINATION_LEN], DESTINATION_LEN);
+    position_sentence_[to] = position_sentence_[from];
+    static_sentences_[to * 2] = static_sentences_[from * 2];
+    static_sentences_[to * 2 + 1] = static_sentences_[from * 2 + 1];
+}
+
+void VesselTable::remove(size_t slot) {
+    erase_index(index_of(mmsi_[slot]));
+
+    // Keep slots dense: the last vessel fills the gap
+    size_t last = size_ - 1;
+    if (slot != last) {
+        move_slot(last, slot);
+        slots_[index_of(mmsi_[slot])] = static_cast<uint32_t>(slot);
+    }
+    size_--;
+}
+
+size_t VesselTable::claim(uint32_t mmsi, Clock::time_point now) {
+    size_t index = index_of(mmsi);
+    if (keys_[index] == mmsi) {
+        return slots_[index];
+    }
+
+    if (size_ == capacity_) {
+        // Make room by dropping the vessel heard least recently
+        size_t oldest = 0;
+        for (size_t i = 1; i < size_; i++) {
+            if (last_seen_[i] < last_seen_[oldest]) {
+                oldest = i;
+            }
+        }
+        remove(oldest);
+        evicted_++;
+        index = index_of(mmsi);
+    }
+
+    size_t slot = size_++;
+    keys_[index] = mmsi;
+    slots_[index] = static_cast<uint32_t>(slot);
+
+    mmsi_[slot] = mmsi;
+    last_seen_[slot] = to_stamp(now);
+    position_seen_[slot] = 0;
+    last_type_[slot] = 0;
+    flags_[slot] = 0;
+    nav_status_[slot] = NAV_STATUS_UNDEFINED;
+    lat_[slot] = AIS_LAT_NOT_AVAILABLE;
+    lon_[slot] = AIS_LON_NOT_AVAILABLE;
+    sog_[slot] = AIS_SOG_NOT_AVAILABLE;
+    cog_[slot] = AIS_COG_NOT_AVAILABLE;
+    heading_[slot] = AIS_HEADING_NOT_AVAILABLE;
+    imo_[slot] = 0;
+    shiptype_[slot] = 0;
+    to_bow_[slot] = to_stern_[slot] = 0;
+    to_port_[slot] = to_starboard_[slot] = 0;
+    draught_[slot] = 0;
+    callsign_[slot * CALLSIGN_LEN] = '\0';
+    shipname_[slot * SHIPNAME_LEN] = '\0';
+    destination_[slot * DESTINATION_LEN] = '\0';
+    position_sentence_[slot].length = 0;
+    static_sentences_[slot * 2].length = 0;
+    static_sentences_[slot * 2 + 1].length = 0;
+    return slot;
+}
+
+void VesselTable::store(Sentence& dst, std::string_view sentence) {
+    if (sentence.size() > MAX_SENTENCE) {
+        dst.length = 0;
+        return;
+    }
+    std::memcpy(dst.text, sentence.data(), sentence.size());
+    dst.length = static_cast<uint8_t>(sentence.size());
+}
+
+void VesselTable::update(const AisMessage& msg, const std::string_view* sentences, size_t count,
+                         Clock::time_point now) {
+    if (capacity_ == 0 || msg.mmsi == 0) {
+        return;
+    }
+    updates_++;
+
+    size_t slot = claim(msg.mmsi, now);
+    uint32_t stamp = to_stamp(now);
+    last_seen_[slot] = stamp;
+    last_type_[slot] = msg.type;
+    if (msg.own_ship) {
+        flags_[slot] |= FLAG_OWN_SHIP;
+    }
+
+    AisPositionFix fix;
+    if (ais_position(msg, fix)) {
+        lat_[slot] = fix.lat;
+        lon_[slot] = fix.lon;
+        sog_[slot] = fix.sog;
+        cog_[slot] = fix.cog;
+        heading_[slot] = fix.heading;
+        position_seen_[slot] = stamp;
+        flags_[slot] |= FLAG_POSITION;
+        if (count == 1) {
+            store(position_sentence_[slot], sentences[0]);
+        }
+    }
+
+    auto dimensions = [&](uint16_t bow, uint16_t stern, uint8_t port, uint8_t starboard) {
+        to_bow_[slot] = bow;
+        to_stern_[slot] = stern;
+        to_port_[slot] = port;
+        to_starboard_[slot] = starboard;
+    };
+
+    switch (msg.type) {
+    case 1:
+    case 2:
+    case 3:
+        nav_status_[slot] = msg.position_a.nav_status;
+        break;
+    case 5: {
+        const AisStaticVoyageData& v = msg.static_voyage;
+        imo_[slot] = v.imo;
+        shiptype_[slot] = v.shiptype;
+        draught_[slot] = v.draught;
+        dimensions(v.to_bow, v.to_stern, v.to_port, v.to_starboard);
+        copy_text(&callsign_[slot * CALLSIGN_LEN], v.callsign, CALLSIGN_LEN);
+        copy_text(&shipname_[slot * SHIPNAME_LEN], v.shipname, SHIPNAME_LEN);
+        copy_text(&destination_[slot * DESTINATION_LEN], v.destination, DESTINATION_LEN);
+        if (count <= 2) {
+            for (size_t i = 0; i < 2; i++) {
+                if (i < count) {
+                    store(static_sentences_[slot * 2 + i], sentences[i]);
+                } else {
+                    static_sentences_[slot * 2 + i].length = 0;
+                }
+            }
+        }
+        break;
+    }
+    case 19: {
+        const AisExtendedPositionReportB& b = msg.extended_b;
+        shiptype_[slot] = b.shiptype;
+        dimensions(b.to_bow, b.to_stern, b.to_port, b.to_starboard);
+        copy_text(&shipname_[slot * SHIPNAME_LEN], b.shipname, SHIPNAME_LEN);
+        break;
+    }
+    case 21: {
+        const AisAidToNavigation& a = msg.aid;
+        shiptype_[slot] = a.aid_type;
+        dimensions(a.to_bow, a.to_stern, a.to_port, a.to_starboard);
+        copy_text(&shipname_[slot * SHIPNAME_LEN], a.name, SHIPNAME_LEN);
+        break;
+    }
+    case 24: {
+        const AisStaticDataB& b = msg.static_b;
+        if (b.part == 0) {
+            copy_text(&shipname_[slot * SHIPNAME_LEN], b.shipname, SHIPNAME_LEN);
+        } else {
+            shiptype_[slot] = b.shiptype;
+            dimensions(b.to_bow, b.to_stern, b.to_port, b.to_starboard);
+            copy_text(&callsign_[slot * CALLSIGN_LEN], b.callsign, CALLSIGN_LEN);
+        }
+        if (count == 1) {
+            store(static_sentences_[slot * 2 + (b.part == 0 ? 0 : 1)], sentences[0]);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+size_t VesselTable::expire(Clock::time_point now) {
+    if (capacity_ == 0 || ttl_s_ == 0) {
+        return 0;
+    }
+
+    uint32_t stamp = to_stamp(now);
+    size_t removed = 0;
+    size_t slot = 0;
+    while (slot < size_) {
+        if (stamp - last_seen_[slot] >= ttl_s_) {
+            remove(slot);   // The last vessel moves into `slot`; check it next
+            removed++;
+        } else {
+            slot++;
+        }
+    }
+    expired_ += removed;
+    return removed;
+}
+
+void VesselTable::get(size_t slot, VesselInfo& out) const {
+    out.mmsi = mmsi_[slot];
+    out.last_type = last_type_[slot];
+    out.own_ship = flags_[slot] & FLAG_OWN_SHIP;
+    out.has_position = flags_[slot] & FLAG_POSITION;
+    out.nav_status = nav_status_[slot];
+    out.lat = lat_[slot];
+    out.lon = lon_[slot];
+    out.sog = sog_[slot];
+    out.cog = cog_[slot];
+    out.heading = heading_[slot];
+    out.imo = imo_[slot];
+    out.shiptype = shiptype_[slot];
+    out.to_bow = to_bow_[slot];
+    out.to_stern = to_stern_[slot];
+    out.to_port = to_port_[slot];
+    out.to_starboard = to_starboard_[slot];
+    out.draught = draught_[slot];
+    std::memcpy(out.callsign, &callsign_[slot * CALLSIGN_LEN], CALLSIGN_LEN);
+    std::memcpy(out.shipname, &shipname_[slot * SHIPNAME_LEN], SHIPNAME_LEN);
+    std::memcpy(out.destination, &destination_[slot * DESTINATION_LEN], DESTINATION_LEN);
+    out.last_seen = epoch_ + std::chrono::seconds(last_seen_[slot]);
+    out.position_seen = epoch_ + std::chrono::seconds(position_seen_[slot]);
+
+    const Sentence& position = position_sentence_[slot];
+    out.position_sentence = std::string_view(position.text, position.length);
+    for (size_t i = 0; i < 2; i++) {
+        const Sentence& s = static_sentences_[slot * 2 + i];
+        out.static_sentences[i] = std::string_view(s.text, s.length);
+    }
+}
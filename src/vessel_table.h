@@ -0,0 +1,151 @@
+/*
+ * Vessel State Table
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Live picture of every vessel heard: latest position, speed and course,
+ * static and voyage data, last-seen time and the original NMEA sentences
+ * for replay, keyed by MMSI.
+ *
+ * Vessels are stored as a structure of arrays in dense slots 0..size()-1,
+ * so scans over one field (ages for expiry, positions for queries) touch
+ * only that column. An open-addressing MMSI index with linear probing maps
+ * MMSI to slot; removal swaps the last slot into the hole and uses
+ * backward-shift deletion in the index, so neither ever needs tombstones.
+ * Everything is allocated at construction: a full table of 16384 vessels
+ * takes about 6 MB, most of it the replay sentences.
+ *
+ * When the table is full the vessel heard least recently is evicted.
+ * Vessels not heard for the TTL are removed by expire().
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string_view>
+#include <vector>
+
+#include "ais_decoder.h"
+
+// Copy of one vessel's state, for readers
+struct VesselInfo {
+    uint32_t mmsi;
+    uint8_t last_type;              // Type of the most recent message
+    bool own_ship;                  // Heard as !AIVDO
+    bool has_position;
+    uint8_t nav_status;             // 15 = not defined (also for class B)
+    int32_t lat;                    // 1/10000 minute, see ais_degrees()
+    int32_t lon;
+    uint16_t sog;                   // 1/10 knot
+    uint16_t cog;                   // 1/10 degree
+    uint16_t heading;
+    uint32_t imo;
+    uint8_t shiptype;
+    uint16_t to_bow;
+    uint16_t to_stern;
+    uint8_t to_port;
+    uint8_t to_starboard;
+    uint8_t draught;                // 1/10 metre
+    char callsign[8];
+    char shipname[21];
+    char destination[21];
+    std::chrono::steady_clock::time_point last_seen;
+    std::chrono::steady_clock::time_point position_seen;
+    std::string_view position_sentence;     // Empty if none stored
+    std::string_view static_sentences[2];   // Type 5 fragments, or type 24 part A and B
+};
+
+class VesselTable {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t MAX_SENTENCE = 82;  // NMEA 0183 limit, without "\r\n"
+
+    // A zero capacity disables the table
+    explicit VesselTable(size_t capacity = 16384, std::chrono::seconds ttl = std::chrono::seconds(3600));
+
+    // Record a decoded message; `sentences` are the NMEA sentence(s) it came in
+    void update(const AisMessage& msg, const std::string_view* sentences, size_t count, Clock::time_point now);
+
+    // Remove vessels not heard within the TTL; returns the number removed
+    size_t expire(Clock::time_point now);
+
+    // Slot of `mmsi`, or -1
+    long find(uint32_t mmsi) const;
+
+    // Last known position and speed of `mmsi`; false if unknown or never positioned
+    bool position(uint32_t mmsi, int32_t& lat, int32_t& lon, uint16_t& sog) const;
+
+    // Copy the state of the vessel in `slot` (0..size()-1)
+    void get(size_t slot, VesselInfo& out) const;
+
+    // Wall-clock time corresponding to a steady-clock stamp
+    std::time_t wall_time(Clock::time_point stamp) const;
+
+    bool enabled() const { return capacity_ != 0; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    size_t memory_bytes() const;
+
+    uint64_t updates() const { return updates_; }
+    uint64_t evicted() const { return evicted_; }
+    uint64_t expired() const { return expired_; }
+
+private:
+    struct Sentence {
+        uint8_t length;
+        char text[MAX_SENTENCE];
+    };
+
+    size_t claim(uint32_t mmsi, Clock::time_point now);
+    void remove(size_t slot);
+    void move_slot(size_t from, size_t to);
+    size_t index_of(uint32_t mmsi) const;
+    void erase_index(size_t index);
+    uint32_t to_stamp(Clock::time_point now) const;
+    static void store(Sentence& dst, std::string_view sentence);
+
+    size_t capacity_;
+    size_t size_ = 0;
+    uint32_t ttl_s_;
+    Clock::time_point epoch_;
+    std::time_t wall_epoch_;
+
+    // MMSI index: keys_ holds MMSI (0 = empty), slots_ the vessel slot
+    std::vector<uint32_t> keys_;
+    std::vector<uint32_t> slots_;
+    size_t mask_ = 0;
+
+    // Vessel columns, indexed by slot
+    std::vector<uint32_t> mmsi_;
+    std::vector<uint32_t> last_seen_;       // Seconds since epoch_
+    std::vector<uint32_t> position_seen_;
+    std::vector<uint8_t> last_type_;
+    std::vector<uint8_t> flags_;
+    std::vector<uint8_t> nav_status_;
+    std::vector<int32_t> lat_;
+    std::vector<int32_t> lon_;
+    std::vector<uint16_t> sog_;
+    std::vector<uint16_t> cog_;
+    std::vector<uint16_t> heading_;
+    std::vector<uint32_t> imo_;
+    std::vector<uint8_t> shiptype_;
+    std::vector<uint16_t> to_bow_;
+    std::vector<uint16_t> to_stern_;
+    std::vector<uint8_t> to_port_;
+    std::vector<uint8_t> to_starboard_;
+    std::vector<uint8_t> draught_;
+    std::vector<char> callsign_;            // 8 bytes per slot
+    std::vector<char> shipname_;            // 21 bytes per slot
+    std::vector<char> destination_;         // 21 bytes per slot
+    std::vector<Sentence> position_sentence_;
+    std::vector<Sentence> static_sentences_;  // 2 per slot
+
+    uint64_t updates_ = 0;
+    uint64_t evicted_ = 0;
+    uint64_t expired_ = 0;
+};
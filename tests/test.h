@@ -0,0 +1,73 @@
+/*
+ * Minimal unit test harness
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * TEST(name) defines a test case that registers itself; CHECK and
+ * CHECK_EQ record a failure and carry on, so one run reports every broken
+ * expectation. test_main.cpp runs the cases whose names contain the first
+ * command line argument, or all of them.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<TestCase>& test_cases() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, void (*run)()) { test_cases().push_back({name, run}); }
+};
+
+inline void test_fail(const char* file, int line, const std::string& what) {
+    std::fprintf(stderr, "%s:%d: FAILED: %s\n", file, line, what.c_str());
+    test_failures()++;
+}
+
+// A file name under /tmp unique to this run; the test removes what it creates
+inline std::string test_temp_path(const char* name) {
+    return "/tmp/ais_forwarder_test_" + std::to_string(getpid()) + "_" + name;
+}
+
+template <typename A, typename B>
+void test_check_eq(const A& actual, const B& expected, const char* file, int line, const char* text) {
+    if (actual == expected) {
+        return;
+    }
+    std::ostringstream what;
+    what << text << " (got " << actual << ", expected " << expected << ")";
+    test_fail(file, line, what.str());
+}
+
+#define TEST(name)                                             \
+    static void test_##name();                                 \
+    static TestRegistrar registrar_##name(#name, test_##name); \
+    static void test_##name()
+
+#define CHECK(condition)                                    \
+    do {                                                    \
+        if (!(condition)) {                                 \
+            test_fail(__FILE__, __LINE__, #condition);      \
+        }                                                   \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    test_check_eq((actual), (expected), __FILE__, __LINE__, #actual " == " #expected)
@@ -0,0 +1,78 @@
+/*
+ * AIS decoder tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Known vectors from the gpsd AIVDM documentation.
+ */
+
+#include <string>
+
+#include "ais_decoder.h"
+#include "test.h"
+
+TEST(decode_position_report_a) {
+    AisMessage msg;
+    CHECK(ais_decode_sentence("!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C", msg) == AisDecodeResult::Ok);
+    CHECK_EQ(msg.type, 1);
+    CHECK_EQ(msg.mmsi, 477553000u);
+    CHECK(!msg.own_ship);
+    CHECK_EQ(msg.position_a.nav_status, 5);
+    CHECK_EQ(msg.position_a.sog, 0);
+    CHECK_EQ(msg.position_a.lon, -73407500);
+    CHECK_EQ(msg.position_a.lat, 28549700);
+    CHECK_EQ(msg.position_a.cog, 510);
+    CHECK_EQ(msg.position_a.heading, 181);
+    CHECK_EQ(msg.position_a.second, 15);
+
+    AisPositionFix fix;
+    CHECK(ais_position(msg, fix));
+    CHECK(ais_degrees(fix.lat) > 47.58 && ais_degrees(fix.lat) < 47.59);
+}
+
+TEST(decode_static_voyage_data) {
+    AisMessage msg;
+    CHECK(ais_decode_payload("55P5TL01VIaAL@7WKO@mBplU@<PDhh000000001S;AJ::4A80?4i@E531@0000000000000", 2, msg) ==
+          AisDecodeResult::Ok);
+    CHECK_EQ(msg.type, 5);
+    CHECK_EQ(msg.mmsi, 369190000u);
+    CHECK_EQ(msg.static_voyage.imo, 6710932u);
+    CHECK_EQ(std::string(msg.static_voyage.callsign), "WDA9674");
+    CHECK_EQ(std::string(msg.static_voyage.shipname), "MT.MITCHELL");
+    CHECK_EQ(std::string(msg.static_voyage.destination), "SEATTLE");
+    CHECK_EQ(msg.static_voyage.shiptype, 99);
+    CHECK_EQ(msg.static_voyage.to_bow, 90);
+    CHECK_EQ(msg.static_voyage.draught, 60);
+
+    AisPositionFix fix;
+    CHECK(!ais_position(msg, fix));
+}
+
+TEST(decode_own_ship_class_b) {
+    AisMessage msg;
+    CHECK(ais_decode_sentence("!AIVDM,1,1,,A,B52K>;h00Fc>jpUlNV@ikwpUoP06,0*4C", msg) == AisDecodeResult::Ok);
+    CHECK_EQ(msg.type, 18);
+    CHECK_EQ(msg.mmsi, 338087471u);
+}
+
+TEST(decode_rejects_bad_input) {
+    AisMessage msg;
+    CHECK(ais_decode_payload("177KQJ50", 0, msg) == AisDecodeResult::TooShort);
+    CHECK(ais_decode_payload("177KQJ5000G?tO`K>RA1wUbN0TK\x7f", 0, msg) == AisDecodeResult::BadPayload);
+    CHECK(ais_decode_sentence("$GPGGA,123519,4807.038,N*00", msg) == AisDecodeResult::BadSentence);
+    CHECK_EQ(ais_payload_type("177KQJ"), 1u);
+    CHECK_EQ(ais_payload_type(""), 0u);
+}
+
+TEST(parse_aivdm_header) {
+    AivdmSentence header;
+    CHECK(aivdm_parse("!AIVDO,2,1,7,A,55P5TL01VIaAL@7WKO@mBplU@<PDhh000000001S;AJ::4A80?4i@E53,0*3B", header));
+    CHECK(header.own_ship);
+    CHECK_EQ(header.fragment_count, 2);
+    CHECK_EQ(header.fragment_number, 1);
+    CHECK_EQ(header.sequence_id, 7);
+    CHECK_EQ(header.channel, 'A');
+    CHECK_EQ(header.fill_bits, 0);
+    CHECK(!aivdm_parse("!AIVDM,1,1,,B", header));
+}
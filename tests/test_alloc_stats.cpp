@@ -0,0 +1,70 @@
+/*
+ * Allocation statistics tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * The embedded profile relies on forwarding making no heap allocations once
+ * the tables are set up; this holds the forwarder to that.
+ */
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "alloc_stats.h"
+#include "config.h"
+#include "forwarder.h"
+#include "test.h"
+#include "traffic.h"
+
+TEST(alloc_stats_counts) {
+    MemoryStats before = memory_stats();
+    auto value = std::make_unique<std::string>(64, 'x');
+    value.reset();
+    MemoryStats after = memory_stats();
+    CHECK_EQ(after.allocations - before.allocations, 2u);
+    CHECK_EQ(after.frees - before.frees, 2u);
+    CHECK(after.peak_rss_bytes > 0);
+}
+
+TEST(forwarder_steady_state_allocates_nothing) {
+    Config config;
+    config.dedup_window_ms = 0;         // Each pass forwards the same traffic again
+    config.cpa_alert_nm = 0.5;
+    for (const char* spec : {"udp:127.0.0.1:9", "udp:127.0.0.1:9 coalesce=1400 position_interval=30",
+                             "udp:127.0.0.1:9 bbox=50,-10,60,10 types=1-3,5,18,19,24"}) {
+        OutputConfig output;
+        CHECK(parse_output_spec(spec, output));
+        config.outputs.push_back(output);
+    }
+    Forwarder forwarder(config);
+    CHECK(forwarder.open());
+
+    TrafficGenerator traffic{TrafficOptions()};
+    std::string capture;
+    for (int i = 0; i < 5000; i++) {
+        traffic.next(capture);
+        traffic.advance(0.01);
+    }
+
+    auto now = SentenceSink::Clock::now();
+    auto forward = [&] {
+        size_t start = 0;
+        while (start < capture.size()) {
+            size_t end = capture.find("\r\n", start);
+            forwarder.process(std::string_view(capture).substr(start, end - start), now);
+            forwarder.flush(now);
+            now += std::chrono::milliseconds(1);
+            start = end + 2;
+        }
+    };
+    forward();
+
+    uint64_t forwarded = forwarder.sentences_forwarded();
+    MemoryStats before = memory_stats();
+    forward();
+    MemoryStats after = memory_stats();
+    CHECK(forwarder.sentences_forwarded() > forwarded);
+    CHECK_EQ(after.allocations - before.allocations, 0u);
+}
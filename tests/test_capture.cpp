@@ -0,0 +1,252 @@
+/*
+ * Capture file tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "capture.h"
+#include "config.h"
+#include "event_loop.h"
+#include "forwarder.h"
+#include "inputs.h"
+#include "metrics.h"
+#include "pipeline.h"
+#include "test.h"
+
+namespace {
+
+struct RecordingSink : SentenceSink {
+    std::vector<std::string> sentences;
+    std::vector<uint16_t> sources;
+
+    void on_sentence(std::string_view sentence, Clock::time_point, uint16_t source) override {
+        sentences.emplace_back(sentence);
+        sources.push_back(source);
+    }
+    void on_source_reset(uint16_t) override {}
+};
+
+// Replay `path` at `speed` until every record is delivered or `timeout` passes
+RecordingSink replay(const std::string& path, double speed, std::chrono::milliseconds timeout, size_t expected) {
+    Config config;
+    config.replay_speed = speed;
+    InputConfig input;
+    CHECK(parse_input_spec("replay:" + path, input));
+    EventLoop loop;
+    RecordingSink sink;
+    auto replay = make_input(input, 0, loop, sink, config);
+    replay->start();
+    auto end = std::chrono::steady_clock::now() + timeout;
+    while (sink.sentences.size() < expected && std::chrono::steady_clock::now() < end) {
+        loop.run_once(10);
+    }
+    return sink;
+}
+
+void round_trip(bool compress) {
+    std::string path = test_temp_path(compress ? "compressed.cap" : "plain.cap");
+    std::remove(path.c_str());
+    auto start = CaptureWriter::Clock::time_point(std::chrono::seconds(1000));
+
+    // More than one block's worth, so block boundaries are crossed
+    constexpr int COUNT = 5000;
+    {
+        CaptureWriter writer(path, compress);
+        CHECK(writer.open());
+        for (int i = 0; i < COUNT; i++) {
+            std::string sentence = "!AIVDM,1,1,,A,sentence " + std::to_string(i) + ",0*00";
+            writer.record(sentence, start + std::chrono::microseconds(i * 250), static_cast<uint16_t>(i % 3));
+        }
+    }
+
+    CaptureReader reader;
+    CHECK(reader.open(path));
+    CaptureReader::Record record;
+    int count = 0;
+    bool intact = true;
+    while (reader.next(record)) {
+        std::string expected = "!AIVDM,1,1,,A,sentence " + std::to_string(count) + ",0*00";
+        intact = intact && record.sentence == expected && record.source == count % 3 &&
+                 record.ns == 1000000000000ull + static_cast<uint64_t>(count) * 250000;
+        count++;
+    }
+    CHECK_EQ(count, COUNT);
+    CHECK(intact);
+
+    reader.rewind();
+    CHECK(reader.next(record));
+    CHECK_EQ(record.sentence, "!AIVDM,1,1,,A,sentence 0,0*00");
+    std::remove(path.c_str());
+}
+
+}  // namespace
+
+TEST(capture_round_trip) {
+    round_trip(false);
+}
+
+TEST(capture_round_trip_compressed) {
+    round_trip(true);
+}
+
+TEST(capture_appends) {
+    std::string path = test_temp_path("append.cap");
+    std::remove(path.c_str());
+    auto now = CaptureWriter::Clock::now();
+    for (int run = 0; run < 2; run++) {
+        CaptureWriter writer(path, false);
+        CHECK(writer.open());
+        writer.record("!AIVDM,1,1,,A,x,0*00", now + std::chrono::seconds(run), 0);
+    }
+
+    CaptureReader reader;
+    CHECK(reader.open(path));
+    CaptureReader::Record record;
+    int count = 0;
+    while (reader.next(record)) {
+        count++;
+    }
+    CHECK_EQ(count, 2);
+    std::remove(path.c_str());
+}
+
+TEST(capture_joins_sessions) {
+    // One run, then a run after a reboot with a smaller clock, then one an
+    // hour later: each session's clock means nothing to the others
+    std::string path = test_temp_path("sessions.cap");
+    std::remove(path.c_str());
+    for (int base_s : {5000, 100, 8600}) {
+        CaptureWriter writer(path, false);
+        CHECK(writer.open());
+        auto start = CaptureWriter::Clock::time_point(std::chrono::seconds(base_s));
+        for (int i = 0; i < 100; i++) {
+            writer.record("!AIVDM,1,1,,A,x" + std::to_string(i) + ",0*00", start + std::chrono::milliseconds(i * 10),
+                          0);
+        }
+    }
+
+    CaptureReader reader;
+    CHECK(reader.open(path));
+    CaptureReader::Record record;
+    uint64_t first = 0;
+    uint64_t last = 0;
+    int count = 0;
+    bool forward = true;
+    while (reader.next(record)) {
+        if (count++ == 0) {
+            first = record.ns;
+        }
+        forward = forward && record.ns >= last;
+        last = record.ns;
+    }
+    CHECK_EQ(count, 300);
+    CHECK(forward);
+    CHECK(last - first < 3000000000ull);
+
+    // Paced at 10x, the 3 s of traffic take about 0.3 s, not the downtime between runs
+    RecordingSink sink = replay(path, 10, std::chrono::milliseconds(2000), 300);
+    CHECK_EQ(sink.sentences.size(), 300u);
+    std::remove(path.c_str());
+}
+
+TEST(capture_replay_keeps_sources_apart) {
+    std::string path = test_temp_path("sources.cap");
+    std::remove(path.c_str());
+    const uint16_t recorded[] = {0, 1, 256, 257, 0x8000};
+    {
+        CaptureWriter writer(path, false);
+        CHECK(writer.open());
+        auto now = CaptureWriter::Clock::now();
+        for (uint16_t source : recorded) {
+            writer.record("!AIVDM,2,1,3,A,x,0*00", now, source);
+        }
+    }
+
+    RecordingSink sink = replay(path, 0, std::chrono::milliseconds(2000), 5);
+    CHECK_EQ(sink.sources.size(), 5u);
+    bool distinct = true;
+    for (size_t i = 0; i < sink.sources.size(); i++) {
+        distinct = distinct && sink.sources[i] >= FIRST_REPLAY_SOURCE;
+        for (size_t j = 0; j < i; j++) {
+            distinct = distinct && sink.sources[i] != sink.sources[j];
+        }
+    }
+    CHECK(distinct);
+    std::remove(path.c_str());
+}
+
+TEST(capture_in_pipeline_mode_records_everything) {
+    // Sentences the forwarder itself ignores, and one too long for an
+    // ingest slot, which can only be counted
+    std::string input_path = test_temp_path("pipeline.nmea");
+    std::string capture_path = test_temp_path("pipeline.cap");
+    std::remove(capture_path.c_str());
+    FILE* file = std::fopen(input_path.c_str(), "w");
+    std::fputs("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n"
+               "!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C\r\n",
+               file);
+    std::fputs(("$PXYZ," + std::string(200, 'x') + "*00\r\n").c_str(), file);
+    std::fclose(file);
+
+    Config config;
+    config.pipeline = true;
+    config.capture = capture_path;
+    InputConfig input;
+    CHECK(parse_input_spec("file:" + input_path, input));
+    config.inputs.push_back(input);
+    OutputConfig output;
+    CHECK(parse_output_spec("udp:127.0.0.1:9", output));
+    config.outputs.push_back(output);
+
+    std::string metrics_text;
+    {
+        EventLoop loop;
+        Forwarder forwarder(config);
+        CHECK(forwarder.open());
+        Pipeline pipeline(config, config.inputs, forwarder, loop);
+        CHECK(pipeline.start());
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+        while (std::chrono::steady_clock::now() < end) {
+            loop.run_once(10);
+        }
+        pipeline.stop();
+
+        MetricsRegistry metrics;
+        forwarder.register_metrics(metrics);
+        metrics_text = metrics.render();
+    }
+
+    CaptureReader reader;
+    CHECK(reader.open(capture_path));
+    CaptureReader::Record record;
+    std::vector<std::string> recorded;
+    while (reader.next(record)) {
+        recorded.emplace_back(record.sentence);
+    }
+    CHECK_EQ(recorded.size(), 2u);
+    if (recorded.size() == 2) {
+        CHECK(recorded[0].rfind("$GPRMC", 0) == 0);
+    }
+    CHECK(metrics_text.find("ais_capture_sentences_missed_total{path=\"" + capture_path + "\"} 1") !=
+          std::string::npos);
+    std::remove(input_path.c_str());
+    std::remove(capture_path.c_str());
+}
+
+TEST(capture_rejects_other_files) {
+    std::string path = test_temp_path("not_a_capture");
+    FILE* file = std::fopen(path.c_str(), "w");
+    std::fputs("!AIVDM,1,1,,A,x,0*00\r\n", file);
+    std::fclose(file);
+
+    CaptureReader reader;
+    CHECK(!reader.open(path));
+    CHECK(!reader.error().empty());
+    std::remove(path.c_str());
+}
@@ -0,0 +1,233 @@
+/*
+ * Collision monitor tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "collision_monitor.h"
+#include "config.h"
+#include "forwarder.h"
+#include "notification.h"
+#include "test.h"
+
+namespace {
+
+// Single-fragment sentence for a type 1 position report, for feeding a
+// Forwarder: `lat`/`lon` in degrees, `sog` in knots, `cog` in degrees
+std::string position_report(bool own_ship, uint32_t mmsi, double lat, double lon, double sog, double cog) {
+    struct Field {
+        uint32_t value;
+        unsigned width;
+    };
+    const Field fields[] = {
+        {1, 6},                                                     // Type
+        {0, 2},                                                     // Repeat
+        {mmsi, 30},
+        {0, 4},                                                     // Under way using engine
+        {128, 8},                                                   // ROT not available
+        {static_cast<uint32_t>(sog * 10), 10},
+        {0, 1},
+        {static_cast<uint32_t>(static_cast<int32_t>(lon * 600000)) & 0xfffffff, 28},
+        {static_cast<uint32_t>(static_cast<int32_t>(lat * 600000)) & 0x7ffffff, 27},
+        {static_cast<uint32_t>(cog * 10), 12},
+        {511, 9},                                                   // Heading not available
+        {60, 6},                                                    // Second not available
+        {0, 2}, {0, 3}, {0, 1}, {0, 19},
+    };
+
+    std::string bits;
+    for (const Field& field : fields) {
+        for (unsigned bit = field.width; bit-- > 0;) {
+            bits += (field.value >> bit) & 1 ? '1' : '0';
+        }
+    }
+    std::string payload;
+    for (size_t i = 0; i < bits.size(); i += 6) {
+        unsigned value = static_cast<unsigned>(std::stoul(bits.substr(i, 6), nullptr, 2));
+        payload += static_cast<char>(value < 40 ? value + 48 : value + 56);
+    }
+
+    std::string sentence = std::string(own_ship ? "!AIVDO" : "!AIVDM") + ",1,1,,A," + payload + ",0";
+    unsigned char sum = 0;
+    for (size_t i = 1; i < sentence.size(); i++) {
+        sum ^= static_cast<unsigned char>(sentence[i]);
+    }
+    char checksum[4];
+    std::snprintf(checksum, sizeof(checksum), "*%02X", sum);
+    return sentence + checksum;
+}
+
+// Position fix at `lat`/`lon` degrees, `sog` knots, `cog` degrees
+AisPositionFix fix(double lat, double lon, double sog, double cog) {
+    AisPositionFix fix;
+    fix.lat = static_cast<int32_t>(std::lround(lat * 600000));
+    fix.lon = static_cast<int32_t>(std::lround(lon * 600000));
+    fix.sog = static_cast<uint16_t>(std::lround(sog * 10));
+    fix.cog = static_cast<uint16_t>(std::lround(cog * 10));
+    fix.heading = AIS_HEADING_NOT_AVAILABLE;
+    return fix;
+}
+
+// Nautical miles north and east of 50N 0E, where our own ship waits
+double north(double nm) {
+    return 50.0 + nm / 60.0;
+}
+
+double east(double nm) {
+    return nm / 60.0 / std::cos(50.0 * 3.14159265358979323846 / 180.0);
+}
+
+constexpr uint32_t OWN = 235000001;
+
+struct Alerts {
+    std::vector<CpaAlert> seen;
+
+    explicit Alerts(CollisionMonitor& monitor) {
+        monitor.set_alert_handler([this](const CpaAlert& alert) { seen.push_back(alert); });
+    }
+};
+
+}  // namespace
+
+TEST(collision_alerts_for_two_targets_both_delivered) {
+    Config config;
+    config.cpa_alert_nm = 0.5;
+    config.tcpa_alert_min = 15;
+    config.notification_user = "";
+    Forwarder forwarder(config);
+    set_notification_interval(std::chrono::seconds(60));
+
+    // Stopped at 50N 0E; one target 2 nm north heading south, one 2 nm
+    // east heading west, both at 10 knots: CPA 0 in 12 minutes each
+    auto now = std::chrono::steady_clock::now();
+    forwarder.process(position_report(true, 235000001, 50.0, 0.0, 0, 0), now);
+    NotificationStats before = notification_stats();
+    forwarder.process(position_report(false, 235000002, 50.0 + 2.0 / 60, 0.0, 10, 180), now);
+    forwarder.process(position_report(false, 235000003, 50.0, 2.0 / 60 / 0.6428, 10, 270), now);
+
+    // Well inside one notification interval, neither is held back
+    NotificationStats after = notification_stats();
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (after.delivered < before.delivered + 2 && std::chrono::steady_clock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        after = notification_stats();
+    }
+    CHECK_EQ(after.posted - before.posted, 2u);
+    CHECK(after.delivered - before.delivered >= 2);
+    CHECK_EQ(after.suppressed, before.suppressed);
+}
+
+TEST(collision_cpa_and_tcpa) {
+    CollisionMonitor monitor(64, 0.5, 30, 12);
+    Alerts alerts(monitor);
+    auto now = std::chrono::steady_clock::now();
+    monitor.update(OWN, true, fix(50.0, 0.0, 0, 0), now);
+
+    // 4 nm north and 0.3 nm east, heading south at 12 knots: passes 0.3 nm
+    // off in 20 minutes
+    monitor.update(235000002, false, fix(north(4), east(0.3), 12, 180), now);
+    CHECK_EQ(alerts.seen.size(), 1u);
+    if (alerts.seen.size() == 1) {
+        const CpaAlert& alert = alerts.seen[0];
+        CHECK_EQ(alert.mmsi, 235000002u);
+        CHECK(std::fabs(alert.cpa_nm - 0.3) < 0.01);
+        CHECK(std::fabs(alert.tcpa_min - 20.0) < 0.1);
+        CHECK(std::fabs(alert.range_nm - std::sqrt(16.09)) < 0.01);
+        CHECK(std::fabs(alert.bearing_deg - std::atan2(0.3, 4.0) * 180.0 / 3.14159265358979323846) < 0.2);
+    }
+
+    // Passing 1 nm off, moving away, too far off in time, out of range
+    monitor.update(235000003, false, fix(north(4), east(1), 12, 180), now);
+    monitor.update(235000004, false, fix(north(4), 0.0, 12, 0), now);
+    monitor.update(235000005, false, fix(north(8), 0.0, 12, 180), now);
+    monitor.update(235000006, false, fix(north(13), 0.0, 30, 180), now);
+    CHECK_EQ(alerts.seen.size(), 1u);
+    CHECK_EQ(monitor.alerts(), 1u);
+
+    // A report heard back from our own MMSI is not a target
+    monitor.update(OWN, false, fix(north(0.1), 0.0, 12, 180), now);
+    CHECK_EQ(monitor.size(), 5u);
+}
+
+TEST(collision_alert_rearms) {
+    CollisionMonitor monitor(64, 0.5, 30, 12);
+    Alerts alerts(monitor);
+    auto now = std::chrono::steady_clock::now();
+    monitor.update(OWN, true, fix(50.0, 0.0, 0, 0), now);
+    const uint32_t target = 235000002;
+
+    monitor.update(target, false, fix(north(4), 0.0, 12, 180), now);
+    monitor.update(target, false, fix(north(3.9), 0.0, 12, 180), now);
+    monitor.update(OWN, true, fix(50.0, 0.0, 0, 0), now);
+    CHECK_EQ(alerts.seen.size(), 1u);
+
+    // CPA opening to 0.6 nm is inside the 1.5x hysteresis; 0.8 nm is not
+    monitor.update(target, false, fix(north(3.8), east(0.6), 12, 180), now);
+    monitor.update(target, false, fix(north(3.7), 0.0, 12, 180), now);
+    CHECK_EQ(alerts.seen.size(), 1u);
+    monitor.update(target, false, fix(north(3.6), east(0.8), 12, 180), now);
+    monitor.update(target, false, fix(north(3.5), 0.0, 12, 180), now);
+    CHECK_EQ(alerts.seen.size(), 2u);
+
+    // Once past, the next approach alerts again
+    monitor.update(target, false, fix(north(-0.5), 0.0, 12, 180), now);
+    monitor.update(target, false, fix(north(-3), 0.0, 12, 0), now);
+    CHECK_EQ(alerts.seen.size(), 3u);
+}
+
+TEST(collision_grid_relinks_moved_targets) {
+    CollisionMonitor monitor(256, 0.5, 30, 12);
+    Alerts alerts(monitor);
+    auto now = std::chrono::steady_clock::now();
+
+    // Targets heard before our own position, far away in one cell
+    for (uint32_t i = 0; i < 100; i++) {
+        monitor.update(236000000 + i, false, fix(55.0, 10.0 + i * 0.001, 12, 180), now);
+    }
+    // One of them later reports from across several cells, closing on us
+    monitor.update(236000007, false, fix(north(4), 0.0, 12, 180), now);
+
+    // Our own report only walks nearby cells, and must find it there
+    monitor.update(OWN, true, fix(50.0, 0.0, 0, 0), now);
+    CHECK_EQ(alerts.seen.size(), 1u);
+    if (!alerts.seen.empty()) {
+        CHECK_EQ(alerts.seen[0].mmsi, 236000007u);
+    }
+    CHECK(monitor.checks() < 10);
+}
+
+TEST(collision_targets_expire_and_evict) {
+    CollisionMonitor monitor(3, 0.5, 30, 12);
+    auto start = std::chrono::steady_clock::now();
+    monitor.update(236000001, false, fix(50.0, 1.0, 0, 0), start);
+    monitor.update(236000002, false, fix(50.0, 1.1, 0, 0), start + std::chrono::seconds(100));
+    monitor.update(236000003, false, fix(50.0, 1.2, 0, 0), start + std::chrono::seconds(200));
+    CHECK_EQ(monitor.size(), 3u);
+
+    // Full: the target with the oldest position makes room
+    monitor.update(236000004, false, fix(50.0, 1.3, 0, 0), start + std::chrono::seconds(300));
+    CHECK_EQ(monitor.size(), 3u);
+    CHECK_EQ(monitor.evicted(), 1u);
+
+    // Six minutes without a report
+    CHECK_EQ(monitor.expire(start + std::chrono::seconds(470)), 1u);
+    CHECK_EQ(monitor.size(), 2u);
+    CHECK_EQ(monitor.expire(start + std::chrono::seconds(700)), 2u);
+    CHECK_EQ(monitor.size(), 0u);
+
+    // Slots and index entries freed by expiry are reused
+    for (uint32_t i = 0; i < 3; i++) {
+        monitor.update(237000000 + i, false, fix(50.0, 1.0, 0, 0), start + std::chrono::seconds(700));
+    }
+    CHECK_EQ(monitor.size(), 3u);
+    CHECK_EQ(monitor.evicted(), 1u);
+}
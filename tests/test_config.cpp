@@ -0,0 +1,164 @@
+/*
+ * Configuration parsing tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "config.h"
+#include "test.h"
+
+TEST(config_input_specs) {
+    InputConfig input;
+    CHECK(parse_input_spec("tcp:192.168.50.37:39150", input));
+    CHECK(input.type == InputConfig::Type::Tcp);
+    CHECK_EQ(input.host, "192.168.50.37");
+    CHECK_EQ(input.port, 39150);
+
+    CHECK(parse_input_spec("udp:10110", input));
+    CHECK(input.type == InputConfig::Type::Udp);
+    CHECK_EQ(input.host, "0.0.0.0");
+    CHECK_EQ(input.port, 10110);
+
+    CHECK(parse_input_spec("file:/var/run/ais.fifo", input));
+    CHECK(input.type == InputConfig::Type::File);
+    CHECK_EQ(input.path, "/var/run/ais.fifo");
+
+    CHECK(parse_input_spec("replay:/var/lib/ais/day.cap", input));
+    CHECK(input.type == InputConfig::Type::Replay);
+
+    CHECK(parse_input_spec("serial:/dev/ttyUSB0", input));
+    CHECK(input.type == InputConfig::Type::Serial);
+    CHECK_EQ(input.path, "/dev/ttyUSB0");
+    CHECK_EQ(input.baud, 38400);
+
+    CHECK(parse_input_spec("serial:/dev/serial/by-path/pci-0000:00:14.0-usb-0:2:1.0-port0:4800", input));
+    CHECK_EQ(input.path, "/dev/serial/by-path/pci-0000:00:14.0-usb-0:2:1.0-port0");
+    CHECK_EQ(input.baud, 4800);
+
+    CHECK(!parse_input_spec("tcp:39150", input));
+    CHECK(!parse_input_spec("udp:70000", input));
+    CHECK(!parse_input_spec("serial:/dev/ttyUSB0:12345", input));
+    CHECK(!parse_input_spec("serial:", input));
+    CHECK(!parse_input_spec("gps:/dev/ttyUSB0", input));
+    CHECK(!parse_input_spec("file:", input));
+}
+
+TEST(config_output_specs) {
+    OutputConfig output;
+    CHECK(parse_output_spec("udp:5.9.207.224:10170", output));
+    CHECK_EQ(output.host, "5.9.207.224");
+    CHECK_EQ(output.port, 10170);
+    CHECK(!output.tcp_server);
+
+    CHECK(parse_output_spec("udp:127.0.0.1:10110 types=1-3,18 own=exclude coalesce=1400 filter=harbour,fast", output));
+    CHECK_EQ(output.filter.types, (1u << 1) | (1u << 2) | (1u << 3) | (1u << 18));
+    CHECK(output.filter.own_ship == FilterRule::OwnShip::Exclude);
+    CHECK_EQ(output.coalesce_bytes, 1400u);
+    CHECK_EQ(output.filter_names.size(), 2u);
+
+    CHECK(parse_output_spec("tcp-server:10110 clients=8 slow=skip", output));
+    CHECK(output.tcp_server);
+    CHECK_EQ(output.host, "0.0.0.0");
+    CHECK_EQ(output.max_clients, 8);
+    CHECK(output.skip_slow);
+
+    CHECK(!parse_output_spec("udp:10170", output));
+    CHECK(!parse_output_spec("udp:127.0.0.1:10110 coalesce=64", output));
+    CHECK(!parse_output_spec("tcp-server:10110 coalesce=1400", output));
+    CHECK(!parse_output_spec("udp:127.0.0.1:10110 bogus=1", output));
+}
+
+TEST(config_filter_specs) {
+    FilterRule rule;
+    CHECK(parse_filter_spec("harbour bbox=51.8,4.0,52.0,4.4 min_sog=0.5 mmsi=244000000-246999999", rule));
+    CHECK_EQ(rule.name, "harbour");
+    CHECK(rule.has_bbox);
+    CHECK_EQ(rule.north, 52.0);
+    CHECK_EQ(rule.min_sog, 0.5);
+    CHECK_EQ(rule.mmsi_allow.size(), 1u);
+    CHECK(rule.needs_position());
+
+    CHECK(!parse_filter_spec("harbour bbox=51.8,4.0", rule));
+    CHECK(!parse_filter_spec("harbour types=0", rule));
+}
+
+TEST(config_file) {
+    std::string path = test_temp_path("config.conf");
+    {
+        std::ofstream file(path);
+        file << "# Comment\n"
+                "ais_ip = 10.0.0.5\n"
+                "dedup_window_ms=5000\n"
+                "input=tcp:10.0.0.5:39150\n"
+                "input=udp:10110\n"
+                "input=bogus\n"
+                "output=udp:127.0.0.1:10110 filter=fast\n"
+                "output=udp:127.0.0.1:10111 filter=missing\n"
+                "filter=fast min_sog=15\n"
+                "pipeline=on\n"
+                "metrics_port=9100\n"
+                "metrics_interval_s=0\n";
+    }
+
+    Config config;
+    CHECK(load_config_file(path, config));
+    std::remove(path.c_str());
+
+    CHECK_EQ(config.ais_ip, "10.0.0.5");
+    CHECK_EQ(config.dedup_window_ms, 5000);
+    CHECK_EQ(config.inputs.size(), 2u);
+    CHECK_EQ(config.outputs.size(), 1u);
+    if (!config.outputs.empty()) {
+        CHECK_EQ(config.outputs[0].any_of.size(), 1u);
+    }
+    CHECK(config.pipeline);
+    CHECK_EQ(config.metrics_port, 9100);
+    CHECK_EQ(config.metrics_interval_s, 1);
+
+    CHECK(!load_config_file(test_temp_path("missing.conf"), config));
+}
+
+TEST(config_rejects_invalid_cpa_settings) {
+    std::string path = test_temp_path("cpa.conf");
+    {
+        std::ofstream file(path);
+        file << "cpa_alert_nm=0.5\n"
+                "cpa_range_nm=0\n"
+                "cpa_range_nm=-3\n"
+                "cpa_range_nm=inf\n"
+                "tcpa_alert_min=-1\n";
+    }
+
+    Config config;
+    CHECK(load_config_file(path, config));
+    CHECK_EQ(config.cpa_alert_nm, 0.5);
+    CHECK_EQ(config.cpa_range_nm, 12.0);
+    CHECK_EQ(config.tcpa_alert_min, 15.0);
+
+    {
+        std::ofstream file(path);
+        file << "cpa_range_nm=6\n"
+                "tcpa_alert_min=0\n";
+    }
+    CHECK(load_config_file(path, config));
+    std::remove(path.c_str());
+    CHECK_EQ(config.cpa_range_nm, 6.0);
+    CHECK_EQ(config.tcpa_alert_min, 0.0);
+}
+
+TEST(config_effective_defaults) {
+    Config config;
+    auto inputs = effective_inputs(config);
+    auto outputs = effective_outputs(config);
+    CHECK_EQ(inputs.size(), 1u);
+    CHECK_EQ(outputs.size(), 1u);
+    if (!inputs.empty() && !outputs.empty()) {
+        CHECK_EQ(inputs[0].host, config.ais_ip);
+        CHECK_EQ(outputs[0].port, config.mt_port);
+    }
+}
@@ -0,0 +1,134 @@
+/*
+ * Configuration reload tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "config.h"
+#include "config_reload.h"
+#include "test.h"
+
+namespace {
+
+Config load(const std::string& text) {
+    std::string path = test_temp_path("reload.conf");
+    {
+        std::ofstream file(path);
+        file << text;
+    }
+    Config config;
+    load_snapshot(path, nullptr, false, config);
+    std::remove(path.c_str());
+    return config;
+}
+
+}  // namespace
+
+TEST(reload_rejects_invalid_file) {
+    std::string path = test_temp_path("reload_invalid.conf");
+    {
+        std::ofstream file(path);
+        file << "input=tcp:10.0.0.5:39150\n"
+                "output=udp:127.0.0.1:10110 filter=missing\n";
+    }
+    Config config;
+    CHECK(!load_snapshot(path, nullptr, true, config));
+    CHECK(load_snapshot(path, nullptr, false, config));
+    CHECK_EQ(config.outputs.size(), 0u);
+
+    {
+        std::ofstream file(path);
+        file << "input=tcp:10.0.0.5:39150\n"
+                "dedup_window_ms=soon\n";
+    }
+    CHECK(!load_snapshot(path, nullptr, true, config));
+    std::remove(path.c_str());
+
+    CHECK(!load_snapshot(test_temp_path("missing.conf"), nullptr, true, config));
+}
+
+TEST(reload_command_line_wins) {
+    std::string path = test_temp_path("reload_override.conf");
+    {
+        std::ofstream file(path);
+        file << "mt_port=2000\n";
+    }
+    Config config;
+    CHECK(load_snapshot(path, [](Config& c) { c.mt_port = 3000; }, true, config));
+    std::remove(path.c_str());
+    CHECK_EQ(config.mt_port, 3000);
+    CHECK_EQ(config.config_file, path);
+}
+
+TEST(reload_keeps_restart_settings) {
+    Config live = load("input=tcp:10.0.0.5:39150\nvessel_capacity=1000\n");
+    Config next = load("input=tcp:10.0.0.6:39150\nvessel_capacity=2000\nreconnect_max_ms=5000\n");
+    auto changed = keep_restart_settings(live, next);
+    CHECK_EQ(changed.size(), 1u);
+    CHECK(std::find(changed.begin(), changed.end(), "vessel_capacity") != changed.end());
+    CHECK_EQ(next.vessel_capacity, 1000);
+    CHECK_EQ(next.inputs[0].spec, "tcp:10.0.0.6:39150");
+
+    // Pipeline inputs belong to threads started once
+    live.pipeline = true;
+    next.pipeline = true;
+    changed = keep_restart_settings(live, next);
+    CHECK(std::find(changed.begin(), changed.end(), "input") != changed.end());
+    CHECK(std::find(changed.begin(), changed.end(), "reconnect_max_ms") != changed.end());
+    CHECK_EQ(next.inputs[0].spec, "tcp:10.0.0.5:39150");
+    CHECK(diff_config(live, next).empty());
+}
+
+TEST(reload_diff_inputs) {
+    Config live = load("input=tcp:10.0.0.5:39150\ninput=udp:10110\ninput=udp:10110\n");
+    Config next = load("input=udp:10110\ninput=tcp:10.0.0.5:39150\ninput=file:/tmp/ais.fifo\n");
+    ConfigDiff diff = diff_config(live, next);
+    CHECK_EQ(diff.inputs_removed.size(), 1u);
+    CHECK_EQ(diff.inputs_added.size(), 1u);
+    if (diff.inputs_removed.size() == 1 && diff.inputs_added.size() == 1) {
+        CHECK_EQ(diff.inputs_removed[0].spec, "udp:10110");
+        CHECK_EQ(diff.inputs_added[0].spec, "file:/tmp/ais.fifo");
+    }
+    CHECK(!diff.udp_outputs_changed);
+
+    // Settings every input reads restart them all
+    next = load("input=tcp:10.0.0.5:39150\ninput=udp:10110\ninput=udp:10110\nconnect_timeout_ms=1000\n");
+    diff = diff_config(live, next);
+    CHECK_EQ(diff.inputs_removed.size(), 3u);
+    CHECK_EQ(diff.inputs_added.size(), 3u);
+
+    // The default transponder follows ais_ip
+    diff = diff_config(load("ais_ip=10.0.0.5\n"), load("ais_ip=10.0.0.6\n"));
+    CHECK_EQ(diff.inputs_removed.size(), 1u);
+    CHECK_EQ(diff.inputs_added.size(), 1u);
+}
+
+TEST(reload_diff_outputs) {
+    const std::string outputs = "output=udp:127.0.0.1:10110 filter=fast\n"
+                                "output=tcp-server:10111\n";
+    Config live = load(outputs + "filter=fast min_sog=15\n");
+    CHECK(diff_config(live, load(outputs + "filter=fast min_sog=15\n")).empty());
+
+    // A named rule changing changes the outputs using it
+    ConfigDiff diff = diff_config(live, load(outputs + "filter=fast min_sog=20\n"));
+    CHECK(diff.udp_outputs_changed);
+    CHECK(diff.servers_added.empty());
+    CHECK(diff.servers_removed.empty());
+
+    diff = diff_config(live, load("output=udp:127.0.0.1:10110 filter=fast\n"
+                                  "output=tcp-server:10112\n"
+                                  "filter=fast min_sog=15\n"));
+    CHECK(!diff.udp_outputs_changed);
+    CHECK_EQ(diff.servers_removed.size(), 1u);
+    CHECK_EQ(diff.servers_added.size(), 1u);
+
+    diff = diff_config(live, load(outputs + "filter=fast min_sog=15\nnotification_interval_s=5\n"));
+    CHECK(diff.notification_interval_changed);
+    CHECK(!diff.empty());
+}
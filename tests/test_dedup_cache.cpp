@@ -0,0 +1,57 @@
+/*
+ * Duplicate suppression tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <string>
+
+#include "dedup_cache.h"
+#include "test.h"
+
+namespace {
+
+using Clock = DedupCache::Clock;
+
+}  // namespace
+
+TEST(dedup_within_window) {
+    DedupCache cache(1024, std::chrono::milliseconds(10000));
+    auto now = Clock::now();
+    CHECK(!cache.seen("177KQJ5000G?tO`K>RA1wUbN0TKH", now));
+    CHECK(cache.seen("177KQJ5000G?tO`K>RA1wUbN0TKH", now + std::chrono::milliseconds(5000)));
+    CHECK(!cache.seen("177KQJ5000G?tO`K>RA1wUbN0TKI", now));
+    CHECK_EQ(cache.lookups(), 3u);
+    CHECK_EQ(cache.hits(), 1u);
+}
+
+TEST(dedup_forgets_after_window) {
+    DedupCache cache(1024, std::chrono::milliseconds(1000));
+    auto now = Clock::now();
+    CHECK(!cache.seen("payload", now));
+    CHECK(!cache.seen("payload", now + std::chrono::milliseconds(1500)));
+    CHECK(cache.seen("payload", now + std::chrono::milliseconds(2000)));
+}
+
+TEST(dedup_disabled) {
+    DedupCache cache(1024, std::chrono::milliseconds(0));
+    auto now = Clock::now();
+    CHECK(!cache.enabled());
+    CHECK(!cache.seen("payload", now));
+    CHECK(!cache.seen("payload", now));
+}
+
+TEST(dedup_capacity_rounds_up) {
+    DedupCache cache(1000);
+    CHECK_EQ(cache.capacity(), 1024u);
+
+    // Far more distinct payloads than entries: nothing is reported twice
+    auto now = Clock::now();
+    size_t false_hits = 0;
+    for (int i = 0; i < 10000; i++) {
+        false_hits += cache.seen("payload " + std::to_string(i), now) ? 1 : 0;
+    }
+    CHECK_EQ(false_hits, 0u);
+}
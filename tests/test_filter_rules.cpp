@@ -0,0 +1,105 @@
+/*
+ * Compiled filter tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <vector>
+
+#include "config.h"
+#include "filter_rules.h"
+#include "test.h"
+
+namespace {
+
+FilterRule rule(const char* spec) {
+    FilterRule out;
+    CHECK(parse_filter_spec(spec, out));
+    return out;
+}
+
+FilterFields fields(uint8_t type, uint32_t mmsi, double lat, double lon, double knots) {
+    FilterFields out;
+    out.type = type;
+    out.mmsi = mmsi;
+    out.has_position = true;
+    out.lat = static_cast<int32_t>(lat * 600000);
+    out.lon = static_cast<int32_t>(lon * 600000);
+    out.sog = static_cast<uint16_t>(knots * 10);
+    return out;
+}
+
+}  // namespace
+
+TEST(filter_types_and_own_ship) {
+    CompiledFilter filter(rule("any types=1-3,18 own=exclude"), {});
+    CHECK(filter.matches(fields(1, 244660000, 52, 4, 0)));
+    CHECK(filter.matches(fields(18, 244660000, 52, 4, 0)));
+    CHECK(!filter.matches(fields(5, 244660000, 52, 4, 0)));
+
+    FilterFields own = fields(1, 244660000, 52, 4, 0);
+    own.own_ship = true;
+    CHECK(!filter.matches(own));
+}
+
+TEST(filter_mmsi_lists) {
+    CompiledFilter filter(rule("dutch mmsi=244000000-246999999 not_mmsi=244660000"), {});
+    CHECK(filter.matches(fields(1, 245123456, 52, 4, 0)));
+    CHECK(!filter.matches(fields(1, 244660000, 52, 4, 0)));
+    CHECK(!filter.matches(fields(1, 211000000, 52, 4, 0)));
+}
+
+TEST(filter_mmsi_beyond_nine_digits) {
+    // The largest value the 30-bit field can hold
+    std::vector<FilterRule> any_of = {rule("dutch mmsi=244000000-246999999"), rule("top mmsi=999000000-999999999")};
+    CompiledFilter filter(FilterRule(), any_of);
+    CHECK(!filter.matches(fields(1, 1073741823, 52, 4, 0)));
+    CHECK(filter.matches(fields(1, 999999999, 52, 4, 0)));
+
+    CompiledFilter all(rule("all types=1-3"), {});
+    CHECK(all.matches(fields(1, 1073741823, 52, 4, 0)));
+}
+
+TEST(filter_any_of_bbox_and_speed) {
+    std::vector<FilterRule> any_of = {rule("harbour bbox=51.8,4.0,52.0,4.4"), rule("fast min_sog=15")};
+    CompiledFilter filter(FilterRule(), any_of);
+    CHECK(filter.needs_position());
+    CHECK(filter.matches(fields(1, 244000001, 51.9, 4.2, 0)));
+    CHECK(filter.matches(fields(1, 244000001, 53.5, 3.0, 20)));
+    CHECK(!filter.matches(fields(1, 244000001, 53.5, 3.0, 10)));
+
+    FilterFields no_position;
+    no_position.type = 5;
+    no_position.mmsi = 244000001;
+    CHECK(!filter.matches(no_position));
+}
+
+TEST(filter_bbox_across_antimeridian) {
+    CompiledFilter filter(rule("pacific bbox=-10,170,10,-170"), {});
+    CHECK(filter.matches(fields(1, 1, 0, 175, 0)));
+    CHECK(filter.matches(fields(1, 1, 0, -175, 0)));
+    CHECK(!filter.matches(fields(1, 1, 0, 0, 0)));
+}
+
+TEST(filter_many_rules_agree_with_each_rule) {
+    std::vector<FilterRule> any_of;
+    for (int i = 0; i < 40; i++) {
+        FilterRule r;
+        r.has_bbox = true;
+        r.south = 50 + i * 0.1;
+        r.north = r.south + 0.05;
+        r.west = 3;
+        r.east = 5;
+        any_of.push_back(r);
+    }
+    CompiledFilter filter(FilterRule(), any_of);
+    for (int i = 0; i < 400; i++) {
+        double lat = 49.903 + i * 0.0125;     // Clear of the rule edges
+        bool expected = false;
+        for (const auto& r : any_of) {
+            expected = expected || (lat >= r.south && lat <= r.north);
+        }
+        CHECK_EQ(filter.matches(fields(1, 1, lat, 4, 0)), expected);
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * Fragment reassembler tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <string>
+
+#include "ais_decoder.h"
+#include "fragment_reassembler.h"
+#include "test.h"
+
+namespace {
+
+using Clock = FragmentReassembler::Clock;
+using Result = FragmentReassembler::Result;
+
+const char* const PART1 = "!AIVDM,2,1,3,B,55P5TL01VIaAL@7WKO@mBplU@<PDhh000000001S;AJ::4A80?4i@E53,0*3E";
+const char* const PART2 = "!AIVDM,2,2,3,B,1@0000000000000,2*55";
+
+Result add(FragmentReassembler& reassembler, const char* sentence, Clock::time_point now, AisAssembledMessage& out,
+           uint16_t source = 0) {
+    AivdmSentence header;
+    if (!aivdm_parse(sentence, header)) {
+        return Result::Dropped;
+    }
+    return reassembler.add(sentence, header, now, out, source);
+}
+
+}  // namespace
+
+TEST(reassemble_two_fragments) {
+    FragmentReassembler reassembler;
+    AisAssembledMessage out;
+    auto now = Clock::now();
+    CHECK(add(reassembler, PART1, now, out) == Result::Pending);
+    CHECK_EQ(reassembler.pending(), 1u);
+    CHECK(add(reassembler, PART2, now, out) == Result::Complete);
+    CHECK_EQ(reassembler.pending(), 0u);
+    CHECK_EQ(out.fragment_count, 2u);
+    CHECK_EQ(out.sentences[0], PART1);
+    CHECK_EQ(out.sentences[1], PART2);
+    CHECK_EQ(static_cast<unsigned>(out.fill_bits), 2u);
+
+    AisMessage msg;
+    CHECK(ais_decode_payload(out.payload, out.fill_bits, msg) == AisDecodeResult::Ok);
+    CHECK_EQ(msg.mmsi, 369190000u);
+    CHECK_EQ(std::string(msg.static_voyage.destination), "SEATTLE");
+}
+
+TEST(reassemble_out_of_order) {
+    FragmentReassembler reassembler;
+    AisAssembledMessage out;
+    auto now = Clock::now();
+    CHECK(add(reassembler, PART2, now, out) == Result::Pending);
+    CHECK(add(reassembler, PART1, now, out) == Result::Complete);
+    CHECK_EQ(out.sentences[0], PART1);
+}
+
+TEST(reassemble_keeps_sources_apart) {
+    FragmentReassembler reassembler;
+    AisAssembledMessage out;
+    auto now = Clock::now();
+    CHECK(add(reassembler, PART1, now, out, 0) == Result::Pending);
+    CHECK(add(reassembler, PART2, now, out, 1) == Result::Pending);
+    CHECK_EQ(reassembler.pending(), 2u);
+    reassembler.reset(1);
+    CHECK_EQ(reassembler.pending(), 1u);
+    CHECK(add(reassembler, PART2, now, out, 0) == Result::Complete);
+}
+
+TEST(reassemble_single_fragment_passes_through) {
+    FragmentReassembler reassembler;
+    AisAssembledMessage out;
+    const char* sentence = "!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C";
+    CHECK(add(reassembler, sentence, Clock::now(), out) == Result::Complete);
+    CHECK_EQ(out.fragment_count, 1u);
+    CHECK_EQ(out.payload, "177KQJ5000G?tO`K>RA1wUbN0TKH");
+}
+
+TEST(reassemble_expires_stale_groups) {
+    FragmentReassembler reassembler(64, std::chrono::milliseconds(2000));
+    AisAssembledMessage out;
+    auto now = Clock::now();
+    CHECK(add(reassembler, PART1, now, out) == Result::Pending);
+    CHECK_EQ(reassembler.expire(now + std::chrono::milliseconds(1000)), 0u);
+    CHECK_EQ(reassembler.expire(now + std::chrono::milliseconds(3000)), 1u);
+    CHECK_EQ(reassembler.pending(), 0u);
+    CHECK_EQ(reassembler.expired(), 1u);
+    CHECK(add(reassembler, PART2, now, out) == Result::Pending);
+}
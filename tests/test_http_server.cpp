@@ -0,0 +1,169 @@
+/*
+ * HTTP server tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include "event_loop.h"
+#include "http_server.h"
+#include "test.h"
+
+namespace {
+
+constexpr int PORT = 39871;
+
+int connect_local() {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    struct timeval timeout = {3, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Send `request` from another thread and collect everything the server
+// sends back before it closes the connection; `half_close` shuts down the
+// sending side after the request, as `nc -N` does
+std::string exchange(EventLoop& loop, const std::string& request, bool half_close = false) {
+    std::string reply;
+    std::atomic<bool> done{false};
+    std::thread client([&] {
+        int fd = connect_local();
+        if (fd != -1) {
+            send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+            if (half_close) {
+                shutdown(fd, SHUT_WR);
+            }
+            char buffer[1024];
+            ssize_t n;
+            while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+                reply.append(buffer, static_cast<size_t>(n));
+            }
+            close(fd);
+        }
+        done = true;
+    });
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (!done && std::chrono::steady_clock::now() < end) {
+        loop.run_once(10);
+    }
+    client.join();
+    return reply;
+}
+
+}  // namespace
+
+TEST(http_server_answers_request_line) {
+    EventLoop loop;
+    std::string seen;
+    HttpServer server(loop, 2, [&seen](const std::string& method, const std::string& path) {
+        seen = method + " " + path;
+        return http_response("200 OK", "text/plain", "hello\n");
+    });
+    CHECK(server.listen("127.0.0.1", PORT, "test server"));
+
+    std::string reply = exchange(loop, "GET /status HTTP/1.0\r\nHost: localhost\r\n\r\n");
+    CHECK_EQ(seen, "GET /status");
+    CHECK(reply.rfind("HTTP/1.0 200 OK\r\n", 0) == 0);
+    CHECK(reply.find("Content-Length: 6\r\n") != std::string::npos);
+    CHECK(reply.size() >= 6 && reply.compare(reply.size() - 6, 6, "hello\n") == 0);
+}
+
+TEST(http_server_answers_half_closed_client) {
+    EventLoop loop;
+    std::string seen;
+    HttpServer server(loop, 2, [&seen](const std::string& method, const std::string& path) {
+        seen = method + " " + path;
+        return http_response("200 OK", "text/plain", "hello\n");
+    });
+    CHECK(server.listen("127.0.0.1", PORT, "test server"));
+
+    // Complete headers, then only a request line, then not even that
+    std::string reply = exchange(loop, "GET /vessels HTTP/1.0\r\n\r\n", true);
+    CHECK_EQ(seen, "GET /vessels");
+    CHECK(reply.rfind("HTTP/1.0 200 OK\r\n", 0) == 0);
+
+    seen.clear();
+    reply = exchange(loop, "GET /status HTTP/1.0\r\n", true);
+    CHECK_EQ(seen, "GET /status");
+    CHECK(reply.rfind("HTTP/1.0 200 OK\r\n", 0) == 0);
+
+    seen.clear();
+    reply = exchange(loop, "GET /sta", true);
+    CHECK(seen.empty());
+    CHECK(reply.empty());
+}
+
+TEST(http_server_drops_oversized_request) {
+    EventLoop loop;
+    bool called = false;
+    HttpServer server(loop, 2, [&called](const std::string&, const std::string&) {
+        called = true;
+        return http_response("200 OK", "text/plain", "");
+    });
+    CHECK(server.listen("127.0.0.1", PORT, "test server"));
+
+    std::string reply = exchange(loop, "GET /" + std::string(HttpServer::MAX_REQUEST, 'x'));
+    CHECK(reply.empty());
+    CHECK(!called);
+}
+
+TEST(http_server_pauses_when_out_of_descriptors) {
+    EventLoop loop;
+    bool called = false;
+    HttpServer server(loop, 2, [&called](const std::string&, const std::string&) {
+        called = true;
+        return http_response("200 OK", "text/plain", "ok\n");
+    });
+    CHECK(server.listen("127.0.0.1", PORT, "test server"));
+
+    // The connection completes in the kernel backlog; accept() then needs
+    // a descriptor above the lowered limit
+    int fd = connect_local();
+    CHECK(fd != -1);
+    send(fd, "GET / HTTP/1.0\r\n\r\n", 18, MSG_NOSIGNAL);
+    int lowest = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    close(lowest);
+    struct rlimit saved;
+    getrlimit(RLIMIT_NOFILE, &saved);
+    struct rlimit limit = saved;
+    limit.rlim_cur = static_cast<rlim_t>(lowest);
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    // A spinning listener would wake on every iteration
+    int wakeups = 0;
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+    while (std::chrono::steady_clock::now() < end) {
+        loop.run_once(20);
+        wakeups++;
+    }
+    setrlimit(RLIMIT_NOFILE, &saved);
+    CHECK(wakeups < 30);
+    CHECK(!called);
+
+    // Once the pause ends the queued connection is served
+    end = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (!called && std::chrono::steady_clock::now() < end) {
+        loop.run_once(20);
+    }
+    CHECK(called);
+    close(fd);
+}
@@ -0,0 +1,35 @@
+/*
+ * Unit test runner
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Usage: ais_forwarder_tests [name filter]
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "log.h"
+#include "test.h"
+
+int main(int argc, char* argv[]) {
+    const char* filter = argc > 1 ? argv[1] : "";
+
+    // Keep the components' log lines out of the results
+    set_log_enabled(false, false);
+
+    int run = 0;
+    for (const auto& test : test_cases()) {
+        if (std::strstr(test.name, filter) == nullptr) {
+            continue;
+        }
+        int before = test_failures();
+        test.run();
+        run++;
+        std::printf("%-44s %s\n", test.name, test_failures() == before ? "ok" : "FAILED");
+    }
+
+    std::printf("%d tests, %d failures\n", run, test_failures());
+    return test_failures() == 0 && run > 0 ? 0 : 1;
+}
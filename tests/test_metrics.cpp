@@ -0,0 +1,71 @@
+/*
+ * Metrics registry tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <string>
+
+#include "counter.h"
+#include "metrics.h"
+#include "test.h"
+
+namespace {
+
+bool contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+}  // namespace
+
+TEST(metrics_counters_and_gauges) {
+    MetricsRegistry metrics;
+    Counter sent;
+    sent += 41;
+    sent++;
+    metrics.counter("ais_sent_total", "Datagrams sent", MetricsRegistry::label("output", "a"), sent);
+    metrics.counter("ais_sent_total", "Datagrams sent", MetricsRegistry::label("output", "b"), [] { return 7.0; });
+    metrics.gauge("ais_vessels", "Vessels tracked", "", [] { return 12.0; });
+
+    std::string text = metrics.render();
+    CHECK(contains(text, "# HELP ais_sent_total Datagrams sent\n# TYPE ais_sent_total counter\n"));
+    CHECK(contains(text, "ais_sent_total{output=\"a\"} 42\n"));
+    CHECK(contains(text, "ais_sent_total{output=\"b\"} 7\n"));
+    CHECK(contains(text, "# TYPE ais_vessels gauge\nais_vessels 12\n"));
+
+    // One family per name, however many series
+    CHECK_EQ(text.find("# TYPE ais_sent_total"), text.rfind("# TYPE ais_sent_total"));
+
+    // Counters are read at render time
+    sent++;
+    CHECK(contains(metrics.render(), "ais_sent_total{output=\"a\"} 43\n"));
+}
+
+TEST(metrics_label_escaping) {
+    CHECK_EQ(MetricsRegistry::label("spec", "udp:1.2.3.4:5 filter=\"x\""), "spec=\"udp:1.2.3.4:5 filter=\\\"x\\\"\"");
+    CHECK_EQ(MetricsRegistry::label("path", "a\\b\nc"), "path=\"a\\\\b\\nc\"");
+}
+
+TEST(metrics_histogram) {
+    Histogram histogram;
+    histogram.observe(std::chrono::microseconds(50));
+    histogram.observe(std::chrono::microseconds(100));
+    histogram.observe(std::chrono::milliseconds(3));
+    histogram.observe(std::chrono::seconds(60));
+    CHECK_EQ(histogram.bucket(0), 2u);
+    CHECK_EQ(histogram.bucket(5), 1u);
+    CHECK_EQ(histogram.bucket(Histogram::BUCKETS), 1u);
+    CHECK_EQ(histogram.sum_ns(), 60003150000ull);
+
+    MetricsRegistry metrics;
+    metrics.histogram("ais_latency_seconds", "Latency", MetricsRegistry::label("output", "a"), histogram);
+    std::string text = metrics.render();
+    CHECK(contains(text, "# TYPE ais_latency_seconds histogram\n"));
+    CHECK(contains(text, "ais_latency_seconds_bucket{output=\"a\",le=\"0.0001\"} 2\n"));
+    CHECK(contains(text, "ais_latency_seconds_bucket{output=\"a\",le=\"0.005\"} 3\n"));
+    CHECK(contains(text, "ais_latency_seconds_bucket{output=\"a\",le=\"10\"} 3\n"));
+    CHECK(contains(text, "ais_latency_seconds_bucket{output=\"a\",le=\"+Inf\"} 4\n"));
+    CHECK(contains(text, "ais_latency_seconds_count{output=\"a\"} 4\n"));
+}
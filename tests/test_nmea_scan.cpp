@@ -0,0 +1,51 @@
+/*
+ * NMEA scanning tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "nmea_scan.h"
+#include "test.h"
+
+namespace {
+
+const char* const SENTENCE = "!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C";
+
+}  // namespace
+
+TEST(checksum_valid_sentences) {
+    CHECK(nmea_checksum_valid(SENTENCE));
+    CHECK(nmea_checksum_valid("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47"));
+    CHECK(nmea_checksum_valid("!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5c"));
+}
+
+TEST(checksum_rejects_damage) {
+    CHECK(!nmea_checksum_valid("!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKI,0*5C"));
+    CHECK(!nmea_checksum_valid("!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5D"));
+    CHECK(!nmea_checksum_valid("!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0"));
+    CHECK(!nmea_checksum_valid("!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5"));
+    CHECK(!nmea_checksum_valid(""));
+}
+
+TEST(every_kernel_agrees) {
+    std::string text = SENTENCE;
+    for (const NmeaKernel* kernel : nmea_available_kernels()) {
+        CHECK(nmea_checksum_valid(SENTENCE, *kernel));
+        CHECK(!nmea_checksum_valid("!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,1*5C", *kernel));
+        CHECK_EQ(static_cast<unsigned>(kernel->xor_bytes(text.data() + 1, text.size() - 4)), 0x5cu);
+        CHECK(kernel->find_byte(text.data(), text.data() + text.size(), '*') == text.data() + text.size() - 3);
+        CHECK(kernel->find_byte(text.data(), text.data() + text.size(), '\n') == text.data() + text.size());
+    }
+}
+
+TEST(scan_fields) {
+    NmeaFields fields;
+    nmea_scan_fields(SENTENCE, fields);
+    CHECK_EQ(fields.count, 6u);
+    CHECK(fields.field(SENTENCE, 0) == "!AIVDM");
+    CHECK(fields.field(SENTENCE, 3) == "");
+    CHECK(fields.field(SENTENCE, 4) == "B");
+    CHECK(fields.field(SENTENCE, 5) == "177KQJ5000G?tO`K>RA1wUbN0TKH");
+    CHECK(fields.field(SENTENCE, 6) == "0");
+}
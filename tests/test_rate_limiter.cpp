@@ -0,0 +1,99 @@
+/*
+ * Rate limiter tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <cstdint>
+
+#include "ais_decoder.h"
+#include "rate_limiter.h"
+#include "test.h"
+
+namespace {
+
+using Clock = MmsiRateLimiter::Clock;
+
+AisMessage message(uint8_t type, uint32_t mmsi, uint8_t part = 0) {
+    AisMessage msg{};
+    msg.type = type;
+    msg.mmsi = mmsi;
+    if (type == 24) {
+        msg.static_b.part = part;
+    }
+    return msg;
+}
+
+Clock::time_point at(Clock::time_point start, double seconds) {
+    return start + std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000));
+}
+
+}  // namespace
+
+TEST(rate_limiter_separate_budgets) {
+    MmsiRateLimiter limiter(std::chrono::seconds(30), std::chrono::seconds(360));
+    auto start = Clock::now();
+
+    CHECK(limiter.allow(message(1, 244660000), at(start, 0)));
+    CHECK(!limiter.allow(message(3, 244660000), at(start, 10)));
+    CHECK(!limiter.allow(message(18, 244660000), at(start, 29.8)));
+
+    // A burst of positions doesn't use up the static budget, nor the
+    // other way round
+    CHECK(limiter.allow(message(5, 244660000), at(start, 10)));
+    CHECK(limiter.allow(message(1, 244660000), at(start, 30)));
+    CHECK(!limiter.allow(message(5, 244660000), at(start, 100)));
+
+    // Type 24 part A shares type 5's stamp; part B has its own
+    CHECK(!limiter.allow(message(24, 244660000, 0), at(start, 100)));
+    CHECK(limiter.allow(message(24, 244660000, 1), at(start, 100)));
+    CHECK(!limiter.allow(message(24, 244660000, 1), at(start, 200)));
+    CHECK(limiter.allow(message(5, 244660000), at(start, 370)));
+
+    // Other ships have budgets of their own
+    CHECK(limiter.allow(message(1, 244660001), at(start, 10)));
+
+    CHECK_EQ(limiter.positions_suppressed(), 2u);
+    CHECK_EQ(limiter.statics_suppressed(), 3u);
+}
+
+TEST(rate_limiter_passes_unlimited_messages) {
+    MmsiRateLimiter limiter(std::chrono::seconds(30), std::chrono::seconds(0));
+    auto start = Clock::now();
+
+    for (int i = 0; i < 3; i++) {
+        CHECK(limiter.allow(message(8, 244660000), at(start, i)));     // Binary broadcast
+        CHECK(limiter.allow(message(14, 244660000), at(start, i)));    // Safety broadcast
+        CHECK(limiter.allow(message(5, 244660000), at(start, i)));     // Static budget disabled
+        CHECK(limiter.allow(message(1, 0), at(start, i)));             // No MMSI to key on
+    }
+    CHECK_EQ(limiter.positions_suppressed(), 0u);
+    CHECK_EQ(limiter.statics_suppressed(), 0u);
+}
+
+TEST(rate_limiter_ages_and_evicts_entries) {
+    // Sixteen entries, all within one probe window
+    MmsiRateLimiter limiter(std::chrono::seconds(30), std::chrono::seconds(60), 16);
+    auto start = Clock::now();
+    for (uint32_t mmsi = 1; mmsi <= 16; mmsi++) {
+        CHECK(limiter.allow(message(1, mmsi), at(start, mmsi * 0.1)));
+    }
+    CHECK_EQ(limiter.evictions(), 0u);
+
+    // Full and nothing aged out: the least recently used ship goes, and
+    // forgets its stamp
+    CHECK(limiter.allow(message(1, 17), at(start, 2)));
+    CHECK_EQ(limiter.evictions(), 1u);
+    CHECK(!limiter.allow(message(1, 2), at(start, 3)));
+    CHECK(limiter.allow(message(1, 1), at(start, 3)));
+    CHECK_EQ(limiter.evictions(), 2u);
+
+    // Once every stamp is older than the longest interval, entries are
+    // reused without evicting anything
+    for (uint32_t mmsi = 100; mmsi < 116; mmsi++) {
+        CHECK(limiter.allow(message(1, mmsi), at(start, 70)));
+    }
+    CHECK_EQ(limiter.evictions(), 2u);
+}
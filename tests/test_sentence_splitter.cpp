@@ -0,0 +1,84 @@
+/*
+ * Sentence splitter tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sentence_splitter.h"
+#include "test.h"
+
+namespace {
+
+void feed(SentenceSplitter& splitter, const std::string& data) {
+    std::memcpy(splitter.write_ptr(), data.data(), data.size());
+    splitter.commit(data.size());
+}
+
+std::vector<std::string> drain(SentenceSplitter& splitter) {
+    std::vector<std::string> sentences;
+    std::string_view sentence;
+    while (splitter.next(sentence)) {
+        sentences.emplace_back(sentence);
+    }
+    return sentences;
+}
+
+}  // namespace
+
+TEST(splitter_line_endings) {
+    SentenceSplitter splitter;
+    feed(splitter, "!AIVDM,a*00\r\n!AIVDM,b*00\n\r\n$GPGGA,c*00\r\n");
+    auto sentences = drain(splitter);
+    CHECK_EQ(sentences.size(), 3u);
+    if (sentences.size() == 3) {
+        CHECK_EQ(sentences[0], "!AIVDM,a*00");
+        CHECK_EQ(sentences[1], "!AIVDM,b*00");
+        CHECK_EQ(sentences[2], "$GPGGA,c*00");
+    }
+}
+
+TEST(splitter_partial_lines) {
+    SentenceSplitter splitter;
+    feed(splitter, "!AIVDM,first");
+    CHECK(drain(splitter).empty());
+    CHECK_EQ(splitter.buffered(), 12u);
+    feed(splitter, " half*00\r\n!AIV");
+    auto sentences = drain(splitter);
+    CHECK_EQ(sentences.size(), 1u);
+    if (!sentences.empty()) {
+        CHECK_EQ(sentences[0], "!AIVDM,first half*00");
+    }
+    splitter.reset();
+    CHECK_EQ(splitter.buffered(), 0u);
+}
+
+TEST(splitter_drops_overlong_lines) {
+    SentenceSplitter splitter(1024, 64);
+    feed(splitter, std::string(100, 'x'));
+    CHECK(drain(splitter).empty());
+    feed(splitter, std::string(100, 'x') + "\r\n!AIVDM,ok*00\r\n");
+    auto sentences = drain(splitter);
+    CHECK_EQ(sentences.size(), 1u);
+    if (!sentences.empty()) {
+        CHECK_EQ(sentences[0], "!AIVDM,ok*00");
+    }
+    CHECK_EQ(splitter.overlong_dropped(), 1u);
+}
+
+TEST(splitter_wraps_buffer) {
+    SentenceSplitter splitter(1024, 128);
+    std::string line = "!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C\r\n";
+    size_t count = 0;
+    for (int i = 0; i < 1000; i++) {
+        feed(splitter, line.substr(0, 20));
+        count += drain(splitter).size();
+        feed(splitter, line.substr(20));
+        count += drain(splitter).size();
+    }
+    CHECK_EQ(count, 1000u);
+}
@@ -0,0 +1,125 @@
+/*
+ * Serial input tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * A pty pair stands in for the USB-serial adapter: the forwarder opens the
+ * slave through a symlink, as it would a udev name, and the test writes to
+ * the master. Closing the master hangs the slave up like an unplugged
+ * adapter; pointing the symlink at a new pty plugs it back in.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "config.h"
+#include "event_loop.h"
+#include "inputs.h"
+#include "test.h"
+
+namespace {
+
+const char* const SENTENCE = "!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C";
+
+struct RecordingSink : SentenceSink {
+    std::vector<std::string> sentences;
+    int resets = 0;
+
+    void on_sentence(std::string_view sentence, Clock::time_point, uint16_t) override {
+        sentences.emplace_back(sentence);
+    }
+    void on_source_reset(uint16_t) override { resets++; }
+};
+
+// Open a pty master and point `link` at its slave; -1 on failure
+int plug_in(const std::string& link) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (master == -1 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        return -1;
+    }
+    unlink(link.c_str());
+    if (symlink(ptsname(master), link.c_str()) != 0) {
+        close(master);
+        return -1;
+    }
+    return master;
+}
+
+// Run the loop until `done` or the timeout
+template <typename Done>
+bool run_until(EventLoop& loop, Done done, std::chrono::milliseconds timeout = std::chrono::milliseconds(3000)) {
+    auto end = std::chrono::steady_clock::now() + timeout;
+    while (!done() && std::chrono::steady_clock::now() < end) {
+        loop.run_once(10);
+    }
+    return done();
+}
+
+bool write_text(int fd, const std::string& text) {
+    return write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+}
+
+}  // namespace
+
+TEST(serial_reads_and_survives_replug) {
+    std::string link = test_temp_path("tty");
+    int master = plug_in(link);
+    CHECK(master != -1);
+    if (master == -1) {
+        return;
+    }
+
+    Config config;
+    InputConfig input;
+    CHECK(parse_input_spec("serial:" + link + ":38400", input));
+    EventLoop loop;
+    RecordingSink sink;
+    SerialInput serial(input, 0, loop, sink, config);
+    serial.start();
+
+    CHECK(write_text(master, std::string(SENTENCE) + "\r\n" + SENTENCE + "\r\n!AIVDM,partial"));
+    CHECK(run_until(loop, [&] { return sink.sentences.size() == 2; }));
+    CHECK_EQ(sink.sentences[0], SENTENCE);
+
+    // Unplug: the partial sentence is discarded with the source reset
+    close(master);
+    CHECK(run_until(loop, [&] { return sink.resets == 1; }));
+
+    master = plug_in(link);
+    CHECK(master != -1);
+    auto replugged = std::chrono::steady_clock::now();
+    bool delivered = run_until(loop, [&] {
+        write_text(master, std::string(SENTENCE) + "\r\n");
+        return sink.sentences.size() > 2;
+    });
+    CHECK(delivered);
+    CHECK(std::chrono::steady_clock::now() - replugged < std::chrono::milliseconds(2500));
+    if (delivered) {
+        CHECK_EQ(sink.sentences[2], SENTENCE);
+    }
+
+    close(master);
+    unlink(link.c_str());
+}
+
+TEST(serial_rejects_non_terminals) {
+    std::string path = test_temp_path("not_a_tty");
+    std::fclose(std::fopen(path.c_str(), "w"));
+
+    Config config;
+    InputConfig input;
+    CHECK(parse_input_spec("serial:" + path, input));
+    EventLoop loop;
+    RecordingSink sink;
+    SerialInput serial(input, 0, loop, sink, config);
+    serial.start();
+    loop.run_once(10);
+    CHECK(sink.sentences.empty());
+    std::remove(path.c_str());
+}
@@ -0,0 +1,82 @@
+/*
+ * Disk spool tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "spool.h"
+#include "test.h"
+
+namespace {
+
+std::string pop_front(Spool& spool) {
+    std::vector<char> out(Spool::MAX_RECORD);
+    size_t length = spool.front(out.data());
+    spool.pop();
+    return std::string(out.data(), length);
+}
+
+}  // namespace
+
+TEST(spool_fifo_order) {
+    std::string path = test_temp_path("fifo.spool");
+    {
+        Spool spool(path, 64 * 1024);
+        CHECK(spool.open());
+        CHECK(spool.empty());
+        CHECK(spool.push("first", 5));
+        CHECK(spool.push("second", 6));
+        CHECK_EQ(spool.records(), 2u);
+        CHECK_EQ(pop_front(spool), "first");
+        CHECK_EQ(pop_front(spool), "second");
+        CHECK(spool.empty());
+        CHECK(!spool.push("", 0));
+    }
+    std::remove(path.c_str());
+}
+
+TEST(spool_evicts_oldest) {
+    std::string path = test_temp_path("evict.spool");
+    {
+        Spool spool(path, 4096);
+        CHECK(spool.open());
+        std::string datagram(1000, 'x');
+        for (int i = 0; i < 10; i++) {
+            datagram[0] = static_cast<char>('0' + i);
+            CHECK(spool.push(datagram.data(), datagram.size()));
+        }
+        CHECK(spool.evicted() > 0);
+        CHECK_EQ(spool.records() + spool.evicted(), 10u);
+        std::string last;
+        while (!spool.empty()) {
+            last = pop_front(spool);
+        }
+        CHECK_EQ(last[0], '9');
+        CHECK(!spool.push(std::string(8192, 'x').data(), 8192));
+    }
+    std::remove(path.c_str());
+}
+
+TEST(spool_survives_restart) {
+    std::string path = test_temp_path("restart.spool");
+    {
+        Spool spool(path, 64 * 1024);
+        CHECK(spool.open());
+        spool.push("kept one", 8);
+        spool.push("kept two", 8);
+        pop_front(spool);
+        spool.sync();
+    }
+    {
+        Spool spool(path, 64 * 1024);
+        CHECK(spool.open());
+        CHECK_EQ(spool.records(), 1u);
+        CHECK_EQ(pop_front(spool), "kept two");
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,102 @@
+/*
+ * TCP input tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * A listening socket in the test stands in for the transponder; closing
+ * the accepted connection drops the input's connection.
+ */
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "event_loop.h"
+#include "inputs.h"
+#include "metrics.h"
+#include "test.h"
+
+namespace {
+
+constexpr int PORT = 39872;
+
+struct NullSink : SentenceSink {
+    void on_sentence(std::string_view, Clock::time_point, uint16_t) override {}
+    void on_source_reset(uint16_t) override {}
+};
+
+int listen_local() {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 4) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Run the loop until a connection arrives on `listener` or the timeout
+int accept_within(EventLoop& loop, int listener, std::chrono::milliseconds timeout) {
+    auto end = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < end) {
+        int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd != -1) {
+            return fd;
+        }
+        loop.run_once(10);
+    }
+    return -1;
+}
+
+}  // namespace
+
+TEST(tcp_input_exports_reconnect_latency) {
+    int listener = listen_local();
+    CHECK(listener != -1);
+    if (listener == -1) {
+        return;
+    }
+
+    Config config;
+    config.notification_user = "";
+    config.reconnect_min_ms = 20;
+    InputConfig input;
+    CHECK(parse_input_spec("tcp:127.0.0.1:" + std::to_string(PORT), input));
+    EventLoop loop;
+    NullSink sink;
+    auto tcp = make_input(input, 0, loop, sink, config);
+    tcp->start();
+
+    // Drop the first connection; the input comes back on its own
+    int first = accept_within(loop, listener, std::chrono::seconds(2));
+    CHECK(first != -1);
+    close(first);
+    int second = accept_within(loop, listener, std::chrono::seconds(2));
+    CHECK(second != -1);
+    for (int i = 0; i < 10; i++) {
+        loop.run_once(10);
+    }
+
+    MetricsRegistry metrics;
+    tcp->register_metrics(metrics);
+    std::string text = metrics.render();
+    std::string labels = "{input=\"" + input.spec + "\"}";
+    CHECK(text.find("ais_input_reconnects_total" + labels + " 1") != std::string::npos);
+    CHECK(text.find("ais_input_reconnect_seconds_count" + labels + " 1") != std::string::npos);
+    CHECK(text.find("ais_input_reconnect_seconds_bucket{input=\"" + input.spec + "\",le=\"10\"} 1") !=
+          std::string::npos);
+
+    tcp.reset();
+    close(second);
+    close(listener);
+}
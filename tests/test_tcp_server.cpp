@@ -0,0 +1,165 @@
+/*
+ * TCP server tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * The client is a socket in the test with a small receive buffer that
+ * stops reading, so the kernel buffers fill and the server's ring for it
+ * is all that is left.
+ */
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <netinet/in.h>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "event_loop.h"
+#include "metrics.h"
+#include "tcp_server.h"
+#include "test.h"
+
+namespace {
+
+constexpr int PORT = 39875;
+
+OutputConfig server_config(const std::string& options) {
+    OutputConfig config;
+    CHECK(parse_output_spec("tcp-server:127.0.0.1:" + std::to_string(PORT) + " " + options, config));
+    return config;
+}
+
+// Connect a client that takes little before its window closes
+int connect_slow_client(EventLoop& loop, TcpServer& server) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int size = 2048;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    for (int i = 0; i < 100 && server.clients() == 0; i++) {
+        loop.run_once(10);
+    }
+    return fd;
+}
+
+// "$TEST,<n>,<padding>" with a length that varies with n
+std::string sentence(unsigned n) {
+    return "$TEST," + std::to_string(n) + "," + std::string(n % 40, 'x');
+}
+
+// Queue numbered sentences one per flush until `done`, or give up
+template <typename Done>
+unsigned feed(TcpServer& server, Done done) {
+    unsigned n = 0;
+    while (!done() && n < 2000000) {
+        std::string text = sentence(n++);
+        std::string_view view = text;
+        server.send(&view, 1);
+        server.flush();
+    }
+    return n;
+}
+
+double skipped_bytes(const TcpServer& server) {
+    MetricsRegistry metrics;
+    server.register_metrics(metrics);
+    std::string text = metrics.render();
+    size_t at = text.find("ais_tcp_skipped_bytes_total{");
+    if (at == std::string::npos) {
+        return 0;
+    }
+    return std::stod(text.substr(text.find("} ", at) + 2));
+}
+
+}  // namespace
+
+TEST(tcp_server_closes_slow_client) {
+    EventLoop loop;
+    TcpServer server(loop, server_config("buffer=1024"));
+    CHECK(server.start());
+    int fd = connect_slow_client(loop, server);
+    CHECK(fd != -1);
+    CHECK_EQ(server.clients(), 1u);
+
+    feed(server, [&server] { return server.evicted() > 0; });
+    CHECK_EQ(server.evicted(), 1u);
+    CHECK_EQ(server.clients(), 0u);
+
+    // The client reads what was sent before, then the end of the stream
+    char buffer[4096];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    }
+    CHECK_EQ(n, 0);
+    close(fd);
+}
+
+TEST(tcp_server_skips_to_whole_lines) {
+    EventLoop loop;
+    TcpServer server(loop, server_config("buffer=1024 slow=skip"));
+    CHECK(server.start());
+    int fd = connect_slow_client(loop, server);
+    CHECK(fd != -1);
+
+    unsigned last = 0;
+    unsigned count = 0;
+    feed(server, [&server, &count] { return ++count % 1000 == 0 && skipped_bytes(server) > 0; });
+    CHECK(skipped_bytes(server) > 0);
+    CHECK_EQ(server.evicted(), 0u);
+    CHECK_EQ(server.clients(), 1u);
+
+    // Drain the client: every line is a whole sentence, in order, with a
+    // gap where the backlog was skipped
+    std::string received;
+    char buffer[4096];
+    auto quiet_until = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+    while (std::chrono::steady_clock::now() < quiet_until) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (n > 0) {
+            received.append(buffer, static_cast<size_t>(n));
+            quiet_until = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+        }
+        loop.run_once(1);
+        server.flush();
+    }
+
+    bool whole = true;
+    bool ordered = true;
+    bool gap = false;
+    bool first = true;
+    size_t lines = 0;
+    size_t start = 0;
+    size_t end;
+    while ((end = received.find("\r\n", start)) != std::string::npos) {
+        std::string line = received.substr(start, end - start);
+        start = end + 2;
+        lines++;
+        unsigned n = line.rfind("$TEST,", 0) == 0 ? static_cast<unsigned>(std::stoul(line.substr(6))) : 0;
+        if (line != sentence(n)) {
+            whole = false;
+            break;
+        }
+        if (!first) {
+            ordered &= n > last;
+            gap |= n > last + 1;
+        }
+        first = false;
+        last = n;
+    }
+    CHECK(lines > 0);
+    CHECK_EQ(start, received.size());
+    CHECK(whole);
+    CHECK(ordered);
+    CHECK(gap);
+    close(fd);
+}
@@ -0,0 +1,121 @@
+/*
+ * Synthetic traffic tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * The generator feeds the benchmarks and the load test tool, so its output
+ * has to be what the forwarder accepts from a real transponder.
+ */
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ais_decoder.h"
+#include "fragment_reassembler.h"
+#include "nmea_scan.h"
+#include "test.h"
+#include "traffic.h"
+
+namespace {
+
+std::vector<std::string> split_lines(const std::string& text) {
+    std::vector<std::string> lines;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find("\r\n", start);
+        lines.push_back(text.substr(start, end - start));
+        start = end + 2;
+    }
+    return lines;
+}
+
+bool in_fleet(uint32_t mmsi, size_t vessels) {
+    uint32_t index = mmsi % 1000000 - 100000;
+    return mmsi % 1000000 >= 100000 && index < vessels;
+}
+
+}  // namespace
+
+TEST(traffic_decodes) {
+    TrafficOptions options;
+    options.static_ratio = 0.3;
+    TrafficGenerator traffic(options);
+    std::string text;
+    for (int i = 0; i < 2000; i++) {
+        traffic.next(text);
+        traffic.advance(1);
+    }
+    CHECK_EQ(traffic.messages(), 2000u);
+
+    FragmentReassembler reassembler;
+    auto now = FragmentReassembler::Clock::now();
+    int types[32] = {};
+    size_t sentences = 0;
+    for (const auto& line : split_lines(text)) {
+        sentences++;
+        CHECK(nmea_checksum_valid(line));
+        AivdmSentence header;
+        CHECK(aivdm_parse(line, header));
+        CHECK(line.size() <= 82);
+
+        AisAssembledMessage assembled;
+        if (reassembler.add(line, header, now, assembled) != FragmentReassembler::Result::Complete) {
+            continue;
+        }
+        AisMessage msg;
+        CHECK(ais_decode_payload(assembled.payload, assembled.fill_bits, msg) == AisDecodeResult::Ok);
+        CHECK(in_fleet(msg.mmsi, options.vessels));
+        types[msg.type]++;
+
+        AisPositionFix fix;
+        if (ais_position(msg, fix)) {
+            CHECK(ais_degrees(fix.lat) > 51 && ais_degrees(fix.lat) < 53);
+            CHECK(ais_degrees(fix.lon) > 3 && ais_degrees(fix.lon) < 5);
+        }
+    }
+    CHECK_EQ(sentences, traffic.sentences());
+    CHECK_EQ(reassembler.pending(), 0u);
+    CHECK_EQ(types[1] + types[5] + types[18] + types[24], 2000);
+    CHECK(types[1] > 0 && types[5] > 0 && types[18] > 0 && types[24] > 0);
+    CHECK(types[5] + types[24] > 400 && types[5] + types[24] < 800);
+}
+
+TEST(traffic_corruption) {
+    TrafficOptions options;
+    options.corrupt_ratio = 0.05;
+    TrafficGenerator traffic(options);
+    std::string text;
+    for (int i = 0; i < 4000; i++) {
+        traffic.next(text);
+    }
+
+    uint64_t bad = 0;
+    for (const auto& line : split_lines(text)) {
+        bad += nmea_checksum_valid(line) ? 0 : 1;
+    }
+    CHECK_EQ(bad, traffic.corrupted());
+    CHECK(bad > traffic.sentences() * 3 / 100 && bad < traffic.sentences() * 7 / 100);
+}
+
+TEST(traffic_deterministic) {
+    TrafficOptions options;
+    options.seed = 42;
+    TrafficGenerator first(options);
+    TrafficGenerator second(options);
+    options.seed = 43;
+    TrafficGenerator other(options);
+
+    std::string a, b, c;
+    for (int i = 0; i < 500; i++) {
+        first.next(a);
+        second.next(b);
+        other.next(c);
+        first.advance(0.5);
+        second.advance(0.5);
+        other.advance(0.5);
+    }
+    CHECK(a == b);
+    CHECK(a != c);
+}
@@ -0,0 +1,166 @@
+/*
+ * UDP output tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Destinations point at sockets bound on the loopback interface, which
+ * have the datagrams as soon as sendmmsg() returns.
+ */
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <netinet/in.h>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include "config.h"
+#include "filter_rules.h"
+#include "test.h"
+#include "udp_output.h"
+
+namespace {
+
+using Clock = UdpOutput::Clock;
+
+constexpr int PORT = 39873;
+const std::string_view SENTENCE = "!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C";   // 47 bytes
+
+int bind_receiver(int port) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Every datagram waiting on `fd`
+std::vector<std::string> receive(int fd) {
+    std::vector<std::string> datagrams;
+    char buffer[2048];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT)) >= 0) {
+        datagrams.emplace_back(buffer, static_cast<size_t>(n));
+    }
+    return datagrams;
+}
+
+OutputConfig output(const std::string& spec) {
+    OutputConfig config;
+    CHECK(parse_output_spec(spec, config));
+    return config;
+}
+
+FilterFields fields(uint8_t type) {
+    FilterFields fields;
+    fields.type = type;
+    fields.mmsi = 244660000;
+    return fields;
+}
+
+}  // namespace
+
+TEST(udp_output_one_datagram_per_sentence) {
+    int all = bind_receiver(PORT);
+    int statics = bind_receiver(PORT + 1);
+    CHECK(all != -1 && statics != -1);
+
+    UdpOutput udp({output("udp:127.0.0.1:" + std::to_string(PORT)),
+                   output("udp:127.0.0.1:" + std::to_string(PORT + 1) + " types=5")});
+    CHECK(udp.open());
+    auto now = Clock::now();
+
+    std::string_view fragments[2] = {"!AIVDM,2,1,3,A,first,0*00", "!AIVDM,2,2,3,A,second,2*00"};
+    CHECK_EQ(udp.enqueue(&SENTENCE, 1, fields(1), nullptr, now), 1u);
+    CHECK_EQ(udp.enqueue(fragments, 2, fields(5), nullptr, now), 2u);
+    CHECK_EQ(udp.queued(), 5u);
+    udp.flush(now);
+    CHECK_EQ(udp.queued(), 0u);
+    CHECK_EQ(udp.syscalls(), 1u);
+
+    // One datagram per sentence, fragments in order
+    std::vector<std::string> got = receive(all);
+    CHECK_EQ(got.size(), 3u);
+    if (got.size() == 3) {
+        CHECK_EQ(got[0], SENTENCE);
+        CHECK_EQ(got[1], fragments[0]);
+        CHECK_EQ(got[2], fragments[1]);
+    }
+    got = receive(statics);
+    CHECK_EQ(got.size(), 2u);
+
+    const auto& destinations = udp.destinations();
+    CHECK_EQ(destinations[0].sent.get(), 3u);
+    CHECK_EQ(destinations[1].sent.get(), 2u);
+    CHECK_EQ(destinations[1].filtered, 1u);
+    close(all);
+    close(statics);
+}
+
+TEST(udp_output_packs_until_full) {
+    int fd = bind_receiver(PORT);
+    CHECK(fd != -1);
+    UdpOutput udp({output("udp:127.0.0.1:" + std::to_string(PORT) + " coalesce=128 coalesce_ms=50")});
+    CHECK(udp.open());
+    auto now = Clock::now();
+
+    // 49 bytes each with "\r\n": two fit in 128, the third starts a new datagram
+    for (int i = 0; i < 3; i++) {
+        udp.enqueue(&SENTENCE, 1, fields(1), nullptr, now);
+    }
+    udp.flush(now);
+    std::vector<std::string> got = receive(fd);
+    CHECK_EQ(got.size(), 1u);
+    if (!got.empty()) {
+        std::string line = std::string(SENTENCE) + "\r\n";
+        CHECK_EQ(got[0], line + line);
+    }
+    CHECK_EQ(udp.destinations()[0].sentences.get(), 2u);
+
+    // The third is held for its deadline
+    Clock::time_point deadline;
+    CHECK(udp.next_deadline(deadline));
+    CHECK(deadline == now + std::chrono::milliseconds(50));
+    close(fd);
+}
+
+TEST(udp_output_flushes_at_deadline) {
+    int fd = bind_receiver(PORT);
+    CHECK(fd != -1);
+    UdpOutput udp({output("udp:127.0.0.1:" + std::to_string(PORT) + " coalesce=1400 coalesce_ms=50")});
+    CHECK(udp.open());
+    auto now = Clock::now();
+
+    udp.enqueue(&SENTENCE, 1, fields(1), nullptr, now);
+    udp.enqueue(&SENTENCE, 1, fields(1), nullptr, now + std::chrono::milliseconds(30));
+    udp.flush(now + std::chrono::milliseconds(30));
+    CHECK(receive(fd).empty());
+
+    // The oldest sentence sets the deadline, not the newest
+    Clock::time_point deadline;
+    CHECK(udp.next_deadline(deadline));
+    CHECK(deadline == now + std::chrono::milliseconds(50));
+    udp.flush(now + std::chrono::milliseconds(49));
+    CHECK(receive(fd).empty());
+    udp.flush(now + std::chrono::milliseconds(50));
+    std::vector<std::string> got = receive(fd);
+    CHECK_EQ(got.size(), 1u);
+    if (!got.empty()) {
+        CHECK_EQ(got[0].size(), 2 * (SENTENCE.size() + 2));
+    }
+    CHECK(!udp.next_deadline(deadline));
+
+    // flush_all() doesn't wait
+    udp.enqueue(&SENTENCE, 1, fields(1), nullptr, now + std::chrono::milliseconds(60));
+    udp.flush_all(now + std::chrono::milliseconds(60));
+    CHECK_EQ(receive(fd).size(), 1u);
+    close(fd);
+}
@@ -0,0 +1,179 @@
+/*
+ * Vessel table tests
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "ais_decoder.h"
+#include "hash.h"
+#include "test.h"
+#include "vessel_table.h"
+
+namespace {
+
+using Clock = VesselTable::Clock;
+
+const std::string_view SENTENCE = "!AIVDM,1,1,,B,177KQJ5000G?tO`K>RA1wUbN0TKH,0*5C";
+
+AisMessage position_report(uint32_t mmsi, double lat, double lon) {
+    AisMessage msg{};
+    msg.type = 1;
+    msg.mmsi = mmsi;
+    msg.position_a.lat = static_cast<int32_t>(lat * 600000);
+    msg.position_a.lon = static_cast<int32_t>(lon * 600000);
+    msg.position_a.sog = 123;
+    msg.position_a.cog = 900;
+    msg.position_a.heading = 91;
+    msg.position_a.nav_status = 0;
+    return msg;
+}
+
+void update(VesselTable& table, uint32_t mmsi, Clock::time_point now) {
+    AisMessage msg = position_report(mmsi, 51.9, 4.1);
+    table.update(msg, &SENTENCE, 1, now);
+}
+
+// Every vessel in `mmsis` can be found, and its slot holds that MMSI
+bool all_found(const VesselTable& table, const std::vector<uint32_t>& mmsis) {
+    for (uint32_t mmsi : mmsis) {
+        long slot = table.find(mmsi);
+        if (slot < 0) {
+            return false;
+        }
+        VesselInfo info;
+        table.get(static_cast<size_t>(slot), info);
+        if (info.mmsi != mmsi) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST(vessel_table_records_vessel_state) {
+    VesselTable table(16);
+    auto now = Clock::now();
+    AisMessage position = position_report(244660000, 51.9, 4.1);
+    table.update(position, &SENTENCE, 1, now);
+
+    AisMessage voyage{};
+    voyage.type = 5;
+    voyage.mmsi = 244660000;
+    voyage.static_voyage.imo = 9074729;
+    voyage.static_voyage.to_bow = 120;
+    voyage.static_voyage.to_stern = 30;
+    std::strcpy(voyage.static_voyage.shipname, "ORANGE STAR");
+    std::strcpy(voyage.static_voyage.callsign, "PDGH");
+    std::string_view fragments[2] = {"!AIVDM,2,1,3,A,x,0*00", "!AIVDM,2,2,3,A,y,2*00"};
+    table.update(voyage, fragments, 2, now);
+
+    CHECK_EQ(table.size(), 1u);
+    long slot = table.find(244660000);
+    CHECK(slot >= 0);
+    if (slot < 0) {
+        return;
+    }
+    VesselInfo info;
+    table.get(static_cast<size_t>(slot), info);
+    CHECK(info.has_position);
+    CHECK_EQ(info.last_type, 5);
+    CHECK_EQ(info.lat, position.position_a.lat);
+    CHECK_EQ(info.sog, 123);
+    CHECK_EQ(info.imo, 9074729u);
+    CHECK_EQ(info.to_bow, 120);
+    CHECK_EQ(std::string_view(info.shipname), "ORANGE STAR");
+    CHECK_EQ(info.position_sentence, SENTENCE);
+    CHECK_EQ(info.static_sentences[1], fragments[1]);
+
+    int32_t lat, lon;
+    uint16_t sog;
+    CHECK(table.position(244660000, lat, lon, sog));
+    CHECK_EQ(lon, position.position_a.lon);
+    CHECK(!table.position(244660001, lat, lon, sog));
+    CHECK_EQ(table.find(0), -1);
+}
+
+TEST(vessel_table_evicts_least_recently_heard) {
+    VesselTable table(4);
+    auto start = Clock::now();
+    for (uint32_t mmsi = 1; mmsi <= 4; mmsi++) {
+        update(table, mmsi, start + std::chrono::seconds(mmsi));
+    }
+    update(table, 1, start + std::chrono::seconds(5));    // 2 is now the stalest
+    update(table, 5, start + std::chrono::seconds(6));
+
+    CHECK_EQ(table.size(), 4u);
+    CHECK_EQ(table.evicted(), 1u);
+    CHECK_EQ(table.find(2), -1);
+    CHECK(all_found(table, {1, 3, 4, 5}));
+
+    update(table, 6, start + std::chrono::seconds(7));
+    CHECK_EQ(table.find(3), -1);
+    CHECK(all_found(table, {1, 4, 5, 6}));
+}
+
+TEST(vessel_table_expire_keeps_slots_dense) {
+    VesselTable table(8, std::chrono::seconds(60));
+    auto start = Clock::now();
+    std::vector<uint32_t> fresh;
+    for (uint32_t mmsi = 1; mmsi <= 8; mmsi++) {
+        // Odd MMSIs are heard early and expire; even ones stay
+        update(table, mmsi, start + std::chrono::seconds(mmsi % 2 ? 1 : 50));
+        if (mmsi % 2 == 0) {
+            fresh.push_back(mmsi);
+        }
+    }
+
+    CHECK_EQ(table.expire(start + std::chrono::seconds(80)), 4u);
+    CHECK_EQ(table.size(), 4u);
+    CHECK_EQ(table.expired(), 4u);
+    CHECK(all_found(table, fresh));
+    for (uint32_t mmsi = 1; mmsi <= 8; mmsi += 2) {
+        CHECK_EQ(table.find(mmsi), -1);
+    }
+
+    CHECK_EQ(table.expire(start + std::chrono::seconds(200)), 4u);
+    CHECK_EQ(table.size(), 0u);
+}
+
+TEST(vessel_table_erase_keeps_probe_chains) {
+    // Capacity 8 gives a 16-entry index. Pick MMSIs that share home
+    // index 3, plus one at home 4 whose probe passes through the chain.
+    VesselTable table(8, std::chrono::seconds(60));
+    std::vector<uint32_t> chain;
+    uint32_t neighbour = 0;
+    for (uint32_t mmsi = 200000000; chain.size() < 3 || neighbour == 0; mmsi++) {
+        size_t home = static_cast<size_t>(hash_mix64(mmsi)) & 15;
+        if (home == 3 && chain.size() < 3) {
+            chain.push_back(mmsi);
+        } else if (home == 4 && neighbour == 0) {
+            neighbour = mmsi;
+        }
+    }
+
+    // The head of the chain goes stale; the rest stay
+    auto start = Clock::now();
+    update(table, chain[0], start);
+    update(table, chain[1], start + std::chrono::seconds(50));
+    update(table, chain[2], start + std::chrono::seconds(50));
+    update(table, neighbour, start + std::chrono::seconds(50));
+    CHECK(all_found(table, {chain[0], chain[1], chain[2], neighbour}));
+
+    // Removing the head must pull the rest of the chain back, or they
+    // would sit behind an empty entry and be lost
+    CHECK_EQ(table.expire(start + std::chrono::seconds(70)), 1u);
+    CHECK_EQ(table.find(chain[0]), -1);
+    CHECK(all_found(table, {chain[1], chain[2], neighbour}));
+
+    update(table, chain[0], start + std::chrono::seconds(71));
+    CHECK(all_found(table, {chain[0], chain[1], chain[2], neighbour}));
+    CHECK_EQ(table.size(), 4u);
+}
@@ -0,0 +1,225 @@
+/*
+ * AIS Traffic Generator
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Stands in for a transponder: listens on a TCP port and streams synthetic
+ * !AIVDM traffic (see TrafficGenerator) to each client that connects, one
+ * client at a time, at a set message rate or as fast as the client reads.
+ * Point an `input=tcp:` of the forwarder at it to load test a build on the
+ * target hardware before rolling it out.
+ *
+ * Usage: ais_generator [options]   (see --help)
+ */
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include "traffic.h"
+
+namespace {
+
+struct Options {
+    std::string bind = "127.0.0.1";
+    int port = 39150;
+    double rate = 50;               // Messages per second, 0 = as fast as the client reads
+    double duration = 0;            // Seconds per client, 0 = until the client disconnects
+    TrafficOptions traffic;
+};
+
+void show_usage(const char* program) {
+    std::printf("Usage: %s [options]\n\n"
+                "Serve synthetic AIVDM traffic to TCP clients.\n\n"
+                "  -b, --bind <address>     Listen address (default: 127.0.0.1)\n"
+                "  -p, --port <port>        Listen port (default: 39150)\n"
+                "  -n, --vessels <count>    Simulated vessels (default: 200)\n"
+                "  -r, --rate <messages/s>  Message rate, 0 = flat out (default: 50)\n"
+                "  -s, --static <ratio>     Share of messages that are static data, two\n"
+                "                           fragments for class A (default: 0.1)\n"
+                "  -B, --class-b <ratio>    Share of vessels that are class B (default: 0.25)\n"
+                "  -c, --corrupt <ratio>    Share of sentences with a damaged payload (default: 0)\n"
+                "  -d, --duration <s>       Close each client after this long, 0 = never (default: 0)\n"
+                "  -S, --seed <n>           Random seed (default: 1)\n"
+                "  -h, --help               Show this help\n",
+                program);
+}
+
+bool parse_ratio(const char* text, double& out) {
+    char* end = nullptr;
+    double value = std::strtod(text, &end);
+    if (*end != '\0' || value < 0 || value > 1) {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+bool send_all(int fd, const std::string& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Stream to one client until it goes away or the duration is up
+void serve(int fd, const Options& options, TrafficGenerator& traffic) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    auto last = start;
+    double owed = 0;                // Messages due but not yet sent
+    uint64_t first = traffic.messages();
+    std::string batch;
+
+    while (options.duration <= 0 || std::chrono::duration<double>(Clock::now() - start).count() < options.duration) {
+        auto now = Clock::now();
+        double elapsed = std::chrono::duration<double>(now - last).count();
+        last = now;
+        traffic.advance(elapsed);
+
+        size_t count = 256;
+        if (options.rate > 0) {
+            owed += elapsed * options.rate;
+            count = static_cast<size_t>(owed);
+            owed -= static_cast<double>(count);
+        }
+
+        batch.clear();
+        for (size_t i = 0; i < count; i++) {
+            traffic.next(batch);
+        }
+        if (!batch.empty() && !send_all(fd, batch)) {
+            break;
+        }
+        if (options.rate > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    uint64_t sent = traffic.messages() - first;
+    std::fprintf(stderr, "Client done: %llu messages in %.1f s (%.0f/s); %llu sentences, %llu corrupted in total\n",
+                 static_cast<unsigned long long>(sent), seconds, seconds > 0 ? sent / seconds : 0.0,
+                 static_cast<unsigned long long>(traffic.sentences()),
+                 static_cast<unsigned long long>(traffic.corrupted()));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    static struct option long_options[] = {
+        {"help", no_argument, 0, 'h'},
+        {"bind", required_argument, 0, 'b'},
+        {"port", required_argument, 0, 'p'},
+        {"vessels", required_argument, 0, 'n'},
+        {"rate", required_argument, 0, 'r'},
+        {"static", required_argument, 0, 's'},
+        {"class-b", required_argument, 0, 'B'},
+        {"corrupt", required_argument, 0, 'c'},
+        {"duration", required_argument, 0, 'd'},
+        {"seed", required_argument, 0, 'S'},
+        {0, 0, 0, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "hb:p:n:r:s:B:c:d:S:", long_options, nullptr)) != -1) {
+        bool ok = true;
+        switch (c) {
+            case 'h':
+                show_usage(argv[0]);
+                return 0;
+            case 'b':
+                options.bind = optarg;
+                break;
+            case 'p':
+                options.port = std::atoi(optarg);
+                ok = options.port > 0 && options.port < 65536;
+                break;
+            case 'n':
+                options.traffic.vessels = std::strtoul(optarg, nullptr, 10);
+                ok = options.traffic.vessels > 0;
+                break;
+            case 'r':
+                options.rate = std::strtod(optarg, nullptr);
+                ok = options.rate >= 0;
+                break;
+            case 's':
+                ok = parse_ratio(optarg, options.traffic.static_ratio);
+                break;
+            case 'B':
+                ok = parse_ratio(optarg, options.traffic.class_b_ratio);
+                break;
+            case 'c':
+                ok = parse_ratio(optarg, options.traffic.corrupt_ratio);
+                break;
+            case 'd':
+                options.duration = std::strtod(optarg, nullptr);
+                break;
+            case 'S':
+                options.traffic.seed = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10));
+                break;
+            default:
+                show_usage(argv[0]);
+                return 1;
+        }
+        if (!ok) {
+            std::fprintf(stderr, "Invalid value for -%c: %s\n", c, optarg);
+            return 1;
+        }
+    }
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(options.port));
+    if (inet_pton(AF_INET, options.bind.c_str(), &addr.sin_addr) != 1) {
+        std::fprintf(stderr, "Invalid bind address: %s\n", options.bind.c_str());
+        return 1;
+    }
+
+    int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (listen_fd == -1 || bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 4) < 0) {
+        std::fprintf(stderr, "Cannot listen on %s:%d: %s\n", options.bind.c_str(), options.port, std::strerror(errno));
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::fprintf(stderr, "Serving %zu vessels on %s:%d at %g messages/s%s\n", options.traffic.vessels,
+                 options.bind.c_str(), options.port, options.rate, options.rate > 0 ? "" : " (flat out)");
+
+    TrafficGenerator traffic(options.traffic);
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::fprintf(stderr, "accept: %s\n", std::strerror(errno));
+            return 1;
+        }
+        serve(fd, options, traffic);
+        close(fd);
+    }
+}
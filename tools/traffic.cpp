@@ -0,0 +1,265 @@
+/*
+ * Synthetic AIS Traffic
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "traffic.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+constexpr size_t FRAGMENT_CHARS = 60;       // Payload characters per sentence, as transponders send them
+constexpr double PI = 3.14159265358979323846;
+
+const uint32_t MIDS[] = {211, 219, 230, 244, 245, 257, 265, 276, 305, 636};
+const char* const DESTINATIONS[] = {"ROTTERDAM", "ANTWERP", "HAMBURG", "FELIXSTOWE", "IJMUIDEN", "DORDRECHT",
+                                    "VLISSINGEN", "MOERDIJK"};
+const uint8_t CLASS_A_TYPES[] = {70, 71, 79, 80, 89, 60, 52, 31, 30};
+const uint8_t CLASS_B_TYPES[] = {36, 37, 30, 50};
+
+int32_t to_ais_degrees(double degrees) {
+    return static_cast<int32_t>(std::lround(degrees * 600000.0));
+}
+
+// ITU-R M.1371 six-bit ASCII
+uint32_t to_sixbit(char c) {
+    unsigned char u = static_cast<unsigned char>(c);
+    return u >= 64 ? (u - 64) & 0x3f : u & 0x3f;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Bits
+
+void TrafficGenerator::Bits::put(uint32_t value, unsigned width) {
+    for (unsigned i = width; i-- > 0;) {
+        bits_.push_back(static_cast<uint8_t>((value >> i) & 1u));
+    }
+}
+
+void TrafficGenerator::Bits::put_signed(int32_t value, unsigned width) {
+    put(static_cast<uint32_t>(value) & ((1u << width) - 1), width);
+}
+
+void TrafficGenerator::Bits::put_text(const std::string& text, unsigned chars) {
+    for (unsigned i = 0; i < chars; i++) {
+        put(i < text.size() ? to_sixbit(text[i]) : 0, 6);     // '@' padding
+    }
+}
+
+std::string TrafficGenerator::Bits::armor(unsigned& fill_bits) const {
+    fill_bits = static_cast<unsigned>((6 - bits_.size() % 6) % 6);
+    std::string payload;
+    for (size_t i = 0; i < bits_.size(); i += 6) {
+        unsigned value = 0;
+        for (size_t j = i; j < i + 6; j++) {
+            value = (value << 1) | (j < bits_.size() ? bits_[j] : 0u);
+        }
+        payload += static_cast<char>(value < 40 ? value + 48 : value + 56);
+    }
+    return payload;
+}
+
+// ---------------------------------------------------------------------------
+// TrafficGenerator
+
+TrafficGenerator::TrafficGenerator(const TrafficOptions& options) : options_(options), rng_(options.seed) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t i = 0; i < options_.vessels; i++) {
+        Vessel vessel;
+        vessel.mmsi = MIDS[i % (sizeof(MIDS) / sizeof(MIDS[0]))] * 1000000 + 100000 + static_cast<uint32_t>(i);
+        vessel.class_b = unit(rng_) < options_.class_b_ratio;
+
+        double angle = unit(rng_) * 2 * PI;
+        double distance = std::sqrt(unit(rng_)) * options_.radius_deg;
+        vessel.lat = options_.lat + distance * std::sin(angle);
+        vessel.lon = options_.lon + distance * std::cos(angle) / std::cos(options_.lat * PI / 180.0);
+
+        // A third of the fleet is moored or at anchor
+        bool underway = unit(rng_) < 0.67;
+        vessel.nav_status = underway ? 0 : (unit(rng_) < 0.5 ? 5 : 1);
+        vessel.sog = underway ? 2.0 + unit(rng_) * (vessel.class_b ? 8.0 : 16.0) : 0.0;
+        vessel.cog = unit(rng_) * 360.0;
+
+        vessel.shiptype = vessel.class_b ? CLASS_B_TYPES[rng_() % sizeof(CLASS_B_TYPES)]
+                                         : CLASS_A_TYPES[rng_() % sizeof(CLASS_A_TYPES)];
+        vessel.imo = vessel.class_b ? 0 : 9000000 + static_cast<uint32_t>(rng_() % 999999);
+        vessel.name = random_text(4 + rng_() % 12, true);
+        vessel.callsign = random_text(4 + rng_() % 3, false);
+        vessel.destination = DESTINATIONS[rng_() % (sizeof(DESTINATIONS) / sizeof(DESTINATIONS[0]))];
+        vessel.to_bow = static_cast<uint16_t>(vessel.class_b ? 4 + rng_() % 12 : 20 + rng_() % 250);
+        vessel.to_stern = static_cast<uint16_t>(vessel.class_b ? 2 + rng_() % 6 : 10 + rng_() % 60);
+        vessel.to_port = static_cast<uint8_t>(vessel.class_b ? 1 + rng_() % 3 : 5 + rng_() % 20);
+        vessel.to_starboard = static_cast<uint8_t>(vessel.class_b ? 1 + rng_() % 3 : 5 + rng_() % 20);
+        vessel.draught = static_cast<uint8_t>(vessel.class_b ? 0 : 30 + rng_() % 150);
+        vessels_.push_back(vessel);
+    }
+}
+
+std::string TrafficGenerator::random_text(size_t length, bool letters_only) {
+    static const char letters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    static const char alnum[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    std::string text;
+    for (size_t i = 0; i < length; i++) {
+        text += letters_only ? letters[rng_() % 26] : alnum[rng_() % 36];
+    }
+    return text;
+}
+
+size_t TrafficGenerator::next(std::string& out) {
+    if (vessels_.empty()) {
+        return 0;
+    }
+    const Vessel& vessel = vessels_[rng_() % vessels_.size()];
+
+    Bits bits;
+    if (std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < options_.static_ratio) {
+        static_data(vessel, bits);
+    } else {
+        position(vessel, bits);
+    }
+
+    unsigned fill_bits;
+    std::string payload = bits.armor(fill_bits);
+    messages_++;
+    return emit(payload, fill_bits, out);
+}
+
+void TrafficGenerator::position(const Vessel& vessel, Bits& bits) {
+    uint32_t sog = static_cast<uint32_t>(std::lround(vessel.sog * 10.0));
+    uint32_t cog = static_cast<uint32_t>(std::lround(vessel.cog * 10.0)) % 3600;
+    uint32_t heading = vessel.sog > 0 ? static_cast<uint32_t>(std::lround(vessel.cog)) % 360 : 511;
+    uint32_t second = static_cast<uint32_t>(messages_ % 60);
+
+    if (vessel.class_b) {
+        bits.put(18, 6);
+        bits.put(0, 2);                         // Repeat indicator
+        bits.put(vessel.mmsi, 30);
+        bits.put(0, 8);                         // Reserved
+        bits.put(sog, 10);
+        bits.put(0, 1);                         // Accuracy
+        bits.put_signed(to_ais_degrees(vessel.lon), 28);
+        bits.put_signed(to_ais_degrees(vessel.lat), 27);
+        bits.put(cog, 12);
+        bits.put(heading, 9);
+        bits.put(second, 6);
+        bits.put(0, 2);                         // Reserved
+        bits.put(1, 1);                         // Carrier-sense unit
+        bits.put(0, 4);                         // Display, DSC, band, message 22
+        bits.put(0, 1);                         // Assigned
+        bits.put(0, 1);                         // RAIM
+        bits.put(0, 20);                        // Radio status
+        return;
+    }
+
+    bits.put(1, 6);
+    bits.put(0, 2);
+    bits.put(vessel.mmsi, 30);
+    bits.put(vessel.nav_status, 4);
+    bits.put_signed(-128, 8);                   // Rate of turn not available
+    bits.put(sog, 10);
+    bits.put(1, 1);
+    bits.put_signed(to_ais_degrees(vessel.lon), 28);
+    bits.put_signed(to_ais_degrees(vessel.lat), 27);
+    bits.put(cog, 12);
+    bits.put(heading, 9);
+    bits.put(second, 6);
+    bits.put(0, 2);                             // Maneuver indicator
+    bits.put(0, 3);                             // Spare
+    bits.put(0, 1);
+    bits.put(0, 19);
+}
+
+void TrafficGenerator::static_data(const Vessel& vessel, Bits& bits) {
+    if (vessel.class_b) {
+        bits.put(24, 6);
+        bits.put(0, 2);
+        bits.put(vessel.mmsi, 30);
+        bits.put(0, 2);                         // Part A
+        bits.put_text(vessel.name, 20);
+        return;
+    }
+
+    bits.put(5, 6);
+    bits.put(0, 2);
+    bits.put(vessel.mmsi, 30);
+    bits.put(0, 2);                             // AIS version
+    bits.put(vessel.imo, 30);
+    bits.put_text(vessel.callsign, 7);
+    bits.put_text(vessel.name, 20);
+    bits.put(vessel.shiptype, 8);
+    bits.put(vessel.to_bow, 9);
+    bits.put(vessel.to_stern, 9);
+    bits.put(vessel.to_port, 6);
+    bits.put(vessel.to_starboard, 6);
+    bits.put(1, 4);                             // EPFD: GPS
+    bits.put(6, 4);                             // ETA month, day, hour, minute
+    bits.put(15, 5);
+    bits.put(14, 5);
+    bits.put(30, 6);
+    bits.put(vessel.draught, 8);
+    bits.put_text(vessel.destination, 20);
+    bits.put(0, 1);                             // DTE
+    bits.put(0, 1);                             // Spare
+}
+
+size_t TrafficGenerator::emit(const std::string& payload, unsigned fill_bits, std::string& out) {
+    size_t count = (payload.size() + FRAGMENT_CHARS - 1) / FRAGMENT_CHARS;
+    char sequence[4] = "";
+    if (count > 1) {
+        std::snprintf(sequence, sizeof(sequence), "%u", sequence_);
+        sequence_ = (sequence_ + 1) % 10;
+    }
+    char channel = channel_b_ ? 'B' : 'A';
+    channel_b_ = !channel_b_;
+
+    for (size_t i = 0; i < count; i++) {
+        std::string chunk = payload.substr(i * FRAGMENT_CHARS, FRAGMENT_CHARS);
+        char head[64];      // Fits any size_t count
+        std::snprintf(head, sizeof(head), "!AIVDM,%zu,%zu,%s,%c,", count, i + 1, sequence, channel);
+        std::string sentence = head + chunk + "," + std::to_string(i + 1 == count ? fill_bits : 0);
+
+        unsigned char sum = 0;
+        for (size_t j = 1; j < sentence.size(); j++) {
+            sum ^= static_cast<unsigned char>(sentence[j]);
+        }
+        char tail[8];
+        std::snprintf(tail, sizeof(tail), "*%02X\r\n", sum);
+
+        if (options_.corrupt_ratio > 0 &&
+            std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < options_.corrupt_ratio) {
+            char& c = sentence[std::string(head).size() + rng_() % chunk.size()];
+            c = c == '0' ? '1' : '0';
+            corrupted_++;
+        }
+        out += sentence;
+        out += tail;
+        sentences_++;
+    }
+    return count;
+}
+
+void TrafficGenerator::advance(double seconds) {
+    double nm = 1.0 / 60.0;     // Degrees of latitude per nautical mile
+    for (auto& vessel : vessels_) {
+        if (vessel.sog <= 0) {
+            continue;
+        }
+        double distance = vessel.sog * seconds / 3600.0 * nm;
+        double course = vessel.cog * PI / 180.0;
+        vessel.lat += distance * std::cos(course);
+        vessel.lon += distance * std::sin(course) / std::cos(vessel.lat * PI / 180.0);
+
+        // Turn back towards the centre on leaving the area
+        double dlat = vessel.lat - options_.lat;
+        double dlon = (vessel.lon - options_.lon) * std::cos(options_.lat * PI / 180.0);
+        if (dlat * dlat + dlon * dlon > options_.radius_deg * options_.radius_deg * 2.25) {
+            vessel.cog = std::fmod(std::atan2(-dlon, -dlat) * 180.0 / PI + 360.0, 360.0);
+        }
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * Synthetic AIS Traffic
+ *
+ * Copyright (c) 2025 David Hoy
+ * SPDX-License-Identifier: MIT
+ *
+ * Generates a plausible !AIVDM stream from a fleet of simulated vessels
+ * moving around a harbour area, for the traffic generator tool, the
+ * loopback benchmark and the unit tests:
+ *
+ *   Class A vessels  type 1 position reports, type 5 static and voyage
+ *                    data (two fragments)
+ *   Class B vessels  type 18 position reports, type 24 part A static data
+ *
+ * Each message comes from a random vessel. `static_ratio` of them are
+ * static data rather than positions, so it sets the share of two-fragment
+ * messages. `corrupt_ratio` of the sentences have one payload character
+ * damaged after the checksum was computed, as a noisy receiver would
+ * deliver them. The same seed always gives the same stream.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+struct TrafficOptions {
+    size_t vessels = 200;
+    double class_b_ratio = 0.25;    // Share of vessels that are class B
+    double static_ratio = 0.1;      // Share of messages that are static data rather than positions
+    double corrupt_ratio = 0;       // Share of sentences with a damaged payload
+    double lat = 51.95;             // Centre of the area, degrees
+    double lon = 4.05;
+    double radius_deg = 0.25;       // Vessels start within this many degrees of the centre
+    uint32_t seed = 1;
+};
+
+class TrafficGenerator {
+public:
+    explicit TrafficGenerator(const TrafficOptions& options);
+
+    // Append the sentences of one message, each ending in "\r\n"; returns
+    // the number of sentences
+    size_t next(std::string& out);
+
+    // Move every vessel on by `seconds` of simulated time
+    void advance(double seconds);
+
+    uint64_t messages() const { return messages_; }
+    uint64_t sentences() const { return sentences_; }
+    uint64_t corrupted() const { return corrupted_; }
+
+private:
+    struct Vessel {
+        uint32_t mmsi;
+        bool class_b;
+        double lat;
+        double lon;
+        double sog;                 // Knots
+        double cog;                 // Degrees
+        uint8_t nav_status;
+        uint8_t shiptype;
+        uint32_t imo;
+        std::string name;
+        std::string callsign;
+        std::string destination;
+        uint16_t to_bow;
+        uint16_t to_stern;
+        uint8_t to_port;
+        uint8_t to_starboard;
+        uint8_t draught;            // 1/10 metre
+    };
+
+    // Payload bits under construction, armored into 6-bit characters
+    class Bits {
+    public:
+        void put(uint32_t value, unsigned width);
+        void put_signed(int32_t value, unsigned width);
+        void put_text(const std::string& text, unsigned chars);
+        std::string armor(unsigned& fill_bits) const;
+
+    private:
+        std::vector<uint8_t> bits_;
+    };
+
+    void position(const Vessel& vessel, Bits& bits);
+    void static_data(const Vessel& vessel, Bits& bits);
+    size_t emit(const std::string& payload, unsigned fill_bits, std::string& out);
+    std::string random_text(size_t length, bool letters_only);
+
+    TrafficOptions options_;
+    std::mt19937 rng_;
+    std::vector<Vessel> vessels_;
+    unsigned sequence_ = 0;         // Sequential message id for multi-fragment messages
+    bool channel_b_ = false;
+
+    uint64_t messages_ = 0;
+    uint64_t sentences_ = 0;
+    uint64_t corrupted_ = 0;
+};